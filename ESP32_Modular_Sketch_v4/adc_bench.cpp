@@ -0,0 +1,57 @@
+#include "adc_bench.h"
+#include "adc_values.h"
+#include "trimmed_filter.h"
+
+namespace AdcBench {
+
+static const size_t kSamples  = 64;   // wejście powtarzane w kółko
+static const int    kChannels = 8;    // klatka jak w dawnym układzie 2 x MCP3424
+
+template <typename T>
+static uint32_t cyclesPerFrame(uint32_t frames, uint32_t& checksum) {
+  static TrimmedMeanFilter<10, 2, T> filt[kChannels];
+  for (auto& f : filt) f.reset();
+
+  // sygnał jak z MCP3424 18-bit: ~1 V + drobne zmiany
+  T in[kSamples];
+  for (size_t i = 0; i < kSamples; ++i) in[i] = (T)(1.0 + 0.0001 * (double)((i * 37) % 23));
+  const T a = (T)1.5, b = (T)-0.25;
+  const T hi = (T)1.2, lo = (T)0.8, hp = (T)0.01, hn = (T)0.01;
+
+  uint32_t hits = 0;
+  const uint32_t c0 = ESP.getCycleCount();
+  for (uint32_t k = 0; k < frames; ++k) {
+    for (int ch = 0; ch < kChannels; ++ch) {
+      const T x = in[(k * kChannels + ch) % kSamples];
+      (void)filt[ch].update(x);            // 12-bit próbny
+      const T v = filt[ch].update(x);      // 18-bit precyzyjny
+      const T calc = a * v + b;            // kalibracja
+      if (calc > hi || calc < lo) ++hits;  // przekroczenie
+      if (calc <= hi - hp && calc >= lo + hn) ++hits;  // powrót z histerezą
+    }
+  }
+  const uint32_t c1 = ESP.getCycleCount();
+  checksum += hits;
+  return frames ? (c1 - c0) / frames : 0;
+}
+
+Result run(uint32_t frames) {
+  Result r = {};
+  r.frames = frames;
+  r.cyclesFloat  = cyclesPerFrame<float>(frames, r.checksum);
+  r.cyclesDouble = cyclesPerFrame<double>(frames, r.checksum);
+  return r;
+}
+
+String toJson(const Result& r) {
+  String js = "{";
+  js += "\"frames\":";        js += (unsigned)r.frames;
+  js += ",\"cyclesFloat\":";  js += (unsigned)r.cyclesFloat;
+  js += ",\"cyclesDouble\":"; js += (unsigned)r.cyclesDouble;
+  js += ",\"active\":\"";     js += ADC_USE_DOUBLE ? "double" : "float";
+  js += "\",\"checksum\":";   js += (unsigned)r.checksum;
+  js += "}";
+  return js;
+}
+
+} // namespace AdcBench
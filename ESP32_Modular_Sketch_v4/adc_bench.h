@@ -0,0 +1,19 @@
+#pragma once
+#include <Arduino.h>
+
+// Benchmark ścieżki klatki ADC (2 aktualizacje filtra na kanał, kalibracja,
+// progi i histereza alarmów dla 8 kanałów) w float i w double, niezależnie od
+// ADC_USE_DOUBLE. Wynik w cyklach CPU na klatkę (ESP.getCycleCount()).
+namespace AdcBench {
+
+struct Result {
+  uint32_t frames;
+  uint32_t cyclesFloat;    // cykli / klatkę
+  uint32_t cyclesDouble;
+  uint32_t checksum;       // żeby kompilator nie wyciął obliczeń
+};
+
+Result run(uint32_t frames);   // blokuje loop() na czas pomiaru
+String toJson(const Result& r);
+
+} // namespace AdcBench
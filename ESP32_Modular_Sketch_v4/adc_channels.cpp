@@ -0,0 +1,133 @@
+#include "adc_channels.h"
+#include "seqlock.h"
+#include "log.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+namespace AdcChannels {
+
+static const char* kPath = "/adc_channels.json";
+
+static Channel* g      = nullptr;   // alokowane w load() wg liczby kanałów
+static int      gN     = 0;
+static uint8_t  gChips[kMaxChips];
+static int      gChipN = 0;
+static Channel  gNone  = { "?", 0, 0, 1, 0 };
+// kopia A/B dla zadania akwizycji: pisze tylko loop() (load/setCal)
+static SeqLock<Cal>* gCal = nullptr;
+
+static void rebuildChips() {
+  gChipN = 0;
+  for (int i=0;i<gN;++i) {
+    bool seen = false;
+    for (int c=0;c<gChipN;++c) if (gChips[c] == g[i].addr) { seen = true; break; }
+    if (!seen && gChipN < kMaxChips) gChips[gChipN++] = g[i].addr;
+  }
+}
+
+static void assign(Channel* arr, int n) {
+  delete[] g;
+  delete[] gCal;
+  g    = arr;
+  gN   = n;
+  gCal = new SeqLock<Cal>[n];
+  for (int i=0;i<n;++i) gCal[i].write(Cal{ arr[i].A, arr[i].B });
+  rebuildChips();
+}
+
+// dawny układ: A001..A004 = 0x68 CH1..4, A005..A008 = 0x6E CH1..4
+static void defaults() {
+  Channel* arr = new Channel[8];
+  for (int i=0;i<8;++i) {
+    snprintf(arr[i].id, sizeof(arr[i].id), "A%03d", i+1);
+    arr[i].addr  = i < 4 ? 0x68 : 0x6E;
+    arr[i].input = (uint8_t)(i % 4);
+    arr[i].A = 1;
+    arr[i].B = 0;
+  }
+  assign(arr, 8);
+}
+
+bool load() {
+  if (!LittleFS.exists(kPath)) { defaults(); return save(); }
+  File f = LittleFS.open(kPath, "r");
+  if (!f) { defaults(); return save(); }
+
+  JsonDocument doc;
+  DeserializationError e = deserializeJson(doc, f);
+  f.close();
+  JsonArray list = doc["channels"];
+  if (e || list.size() == 0) {
+    LOGW("%s: brak/błąd – domyślne A001..A008", kPath);
+    defaults();
+    return save();
+  }
+
+  Channel* arr = new Channel[list.size() < (size_t)ADC_MAX_CHANNELS ? list.size() : ADC_MAX_CHANNELS];
+  int n = 0;
+  for (size_t k = 0; k < list.size() && n < ADC_MAX_CHANNELS; ++k) {
+    JsonObject o = list[k];
+    Channel c = {};
+    snprintf(c.id, sizeof(c.id), "%s", o["id"] | "");
+    c.addr  = o["addr"].is<const char*>() ? (uint8_t)strtoul(o["addr"].as<const char*>(), nullptr, 0)
+                                          : o["addr"].as<uint8_t>();
+    c.input = (uint8_t)(o["ch"].as<int>() - 1);   // w pliku CH1..CH4
+    c.A = o["A"].isNull() ? 1.0f : o["A"].as<float>();
+    c.B = o["B"].isNull() ? 0.0f : o["B"].as<float>();
+
+    bool ok = c.id[0] && c.addr >= 0x68 && c.addr <= 0x6F && c.input < 4;
+    for (int j=0;ok && j<n;++j) {
+      if (!strcmp(arr[j].id, c.id) || (arr[j].addr == c.addr && arr[j].input == c.input)) ok = false;
+    }
+    if (!ok) { LOGW("%s: pominięty wpis %u (id/adres/kanał)", kPath, (unsigned)k); continue; }
+    arr[n++] = c;
+  }
+  if (n == 0) { delete[] arr; defaults(); return save(); }
+  assign(arr, n);
+  LOGI("ADC registry: %d channels on %d chips", gN, gChipN);
+  return true;
+}
+
+bool save() {
+  JsonDocument doc;
+  JsonArray list = doc.createNestedArray("channels");
+  for (int i=0;i<gN;++i) {
+    JsonObject o = list.createNestedObject();
+    char a[8]; snprintf(a, sizeof(a), "0x%02X", g[i].addr);
+    o["id"]   = g[i].id;
+    o["addr"] = a;
+    o["ch"]   = g[i].input + 1;
+    o["A"]    = g[i].A;
+    o["B"]    = g[i].B;
+  }
+
+  File f = LittleFS.open(kPath, "w");
+  if (!f) return false;
+  bool ok = (serializeJsonPretty(doc, f) > 0);
+  f.close();
+  return ok;
+}
+
+int            count()     { return gN; }
+const Channel& at(int i)   { return (i >= 0 && i < gN) ? g[i] : gNone; }
+int            chipCount() { return gChipN; }
+uint8_t        chipAddr(int c) { return (c >= 0 && c < gChipN) ? gChips[c] : 0; }
+
+int find(const String& id) {
+  for (int i=0;i<gN;++i) if (id == g[i].id) return i;
+  return -1;
+}
+
+void setCal(int i, float A, float B) {
+  if (i < 0 || i >= gN) return;
+  g[i].A = A;
+  g[i].B = B;
+  gCal[i].write(Cal{ A, B });
+}
+
+Cal cal(int i) {
+  if (i < 0 || i >= gN) return Cal{ 1, 0 };
+  return gCal[i].read();
+}
+
+} // namespace AdcChannels
@@ -0,0 +1,45 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"
+
+// Rejestr kanałów analogowych (/adc_channels.json): identyfikator czujnika
+// (A001...) -> układ MCP3424 (0x68..0x6F) i wejście CH1..CH4 oraz kalibracja.
+// Profil akwizycji (adc_profiles) i progi alarmów (alarm_config) są
+// przypisane do identyfikatora. Rejestr czytany raz przy starcie – jego
+// rozmiar ustala bufory akwizycji, alarmów i WebUI; zmiana składu kanałów
+// wymaga restartu, kalibrację można zmieniać w locie.
+namespace AdcChannels {
+
+struct Channel {
+  char    id[8];   // nazwa czujnika w rekordach, alarmach i kluczach konfiguracji
+  uint8_t addr;    // adres I2C 0x68..0x6F
+  uint8_t input;   // 0..3 = CH1..CH4
+  float   A;       // calc = A*raw + B (domyślnie 1)
+  float   B;       // (domyślnie 0)
+};
+
+// para kalibracji publikowana razem (seqlock na kanał)
+struct Cal {
+  float A;
+  float B;
+};
+
+static const int kMaxChips = 8;
+
+bool load();       // z LittleFS, gdy brak/błąd -> A001..A008 na 0x68 i 0x6E, save()
+bool save();       // zapis (kalibracja)
+
+int            count();
+const Channel& at(int i);
+int            find(const String& id);   // indeks kanału albo -1
+
+// A/B w Channel czyta loop() (WebUI, CfgSync, save()); zadanie akwizycji
+// bierze spójną parę z cal() – setCal() publikuje obie wartości naraz
+void setCal(int i, float A, float B);
+Cal  cal(int i);
+
+// układy w kolejności pierwszego wystąpienia w rejestrze
+int     chipCount();
+uint8_t chipAddr(int c);
+
+} // namespace AdcChannels
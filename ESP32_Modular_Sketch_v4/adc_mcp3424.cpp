@@ -1,28 +1,52 @@
 #include <Wire.h>
 #include <MCP3424.h>
-#include <algorithm>
-#include "adc_values.h"
+#include "adc_mcp3424.h"
+#include "adc_channels.h"
+#include "trimmed_filter.h"
 #include "log.h"
-#include <esp_task_wdt.h>
+
+#include <atomic>
 
 #define I2C_SDA 3//33//12
 #define I2C_SCL 2//32//14
 
-MCP3424 adc1(0x68);
-MCP3424 adc2(0x6E);
+// Pamięć zakresu kanału z auto-gain: ostatnie PGA z konwersji właściwej.
+// Dopóki wynik mieści się w zapasie tego wzmocnienia, kanał startuje od razu
+// w rozdzielczości profilu (bez 12-bit próby i drugiej rekonfiguracji). Próba
+// wraca po przesterowaniu, timeoucie albo co RANGE_REPROBE_EVERY konwersji.
+#define RANGE_REPROBE_EVERY 64
+#define RANGE_HEADROOM      0.95f   // |v| >= 95% zakresu PGA = przesterowanie
+
+struct RangeCache {
+  Gain     pga;
+  bool     valid;
+  uint16_t age;      // konwersje od ostatniej próby 12-bit
+};
 
-#define NUM_SAMPLES 10
+// liczniki czytane z loop() (adcSchedStats) – każde pole osobno atomowe
+struct ChanCounters {
+  std::atomic<uint32_t> samples{0}, missed{0}, timeouts{0}, lateLastMs{0}, lateMaxMs{0};
+  void clear() { samples = 0; missed = 0; timeouts = 0; lateLastMs = 0; lateMaxMs = 0; }
+};
 
-struct ChannelData {
-  double   value;
-  _ConfReg config;
+// stan kanału: profil, filtr, termin EDF i ostatni wynik
+struct ChanState {
+  AdcProfiles::Profile          prof;
+  TrimmedMeanWindow<adc_real_t> filt;
+  RangeCache   range;
+  uint32_t     dueMs;      // termin startu następnej konwersji
+  adc_real_t   value;      // ostatnia wartość po filtrze
+  uint8_t      gain, bits; // PGA / rozdzielczość ostatniej konwersji
+  bool         fresh;      // zmierzony od poprzedniej migawki
+  ChanCounters st;
 };
 
-static double    samples[8][NUM_SAMPLES] = {{0}};
-static int       sampleIndex[8] = {0};
-static int       warmupLeft = NUM_SAMPLES-1;
-static bool      bufferFilled = false;
-static ChannelData data8[8];
+// Oba bufory alokowane w startMCP3424() wg rejestru AdcChannels
+static ChanState* chans  = nullptr;
+static int        nChans = 0;
+
+// wyniki adcSchedApply() dla loop() (maski kanałów, bit = indeks; do 32 kanałów)
+static std::atomic<uint32_t> gApplied{0}, gApplyNoMem{0};
 
 void i2c_recover(int scl, int sda){
   pinMode(scl, OUTPUT_OPEN_DRAIN);
@@ -37,138 +61,308 @@ void i2c_recover(int scl, int sda){
 // i2c_recover(I2C_SCL, I2C_SDA);
 // Wire.begin(I2C_SDA, I2C_SCL, 100000);
 
+static void buildChips();
+
 void startMCP3424() {
   i2c_recover(I2C_SDA, I2C_SCL);
   Wire.begin(I2C_SDA, I2C_SCL);
   //Wire.setClock(100000);   // 100 kHz
   //Wire.setTimeOut(150);      // ważne: skraca ewentualne zwisy
-  asm volatile ("nop"); asm volatile ("nop");
-  adc1.generalCall(GC_RESET);
-  asm volatile ("nop"); asm volatile ("nop");
-  adc2.generalCall(GC_RESET);
-  bufferFilled = false;
-  warmupLeft   = NUM_SAMPLES-1;
-  LOGI("MCP3424 init OK (0x68,0x6E) SDA=%d SCL=%d", I2C_SDA, I2C_SCL);
+  buildChips();
+  LOGI("MCP3424 init OK (%d chips, %d channels) SDA=%d SCL=%d",
+       AdcChannels::chipCount(), nChans, I2C_SDA, I2C_SCL);
 }
 
+// ================== Harmonogram EDF ==================
+// Każdy układ ma własny automat: kanał z najwcześniejszym terminem ->
+// (auto-gain bez ważnego zakresu: 12-bit próbny x1 -> PGA) -> konwersja
+// w rozdzielczości profilu -> filtr -> termin += okres. Krok automatu tylko
+// zleca konwersję albo raz sprawdza bit RDY i wraca – bez delay(). Bit RDY
+// odpytujemy dopiero po nominalnym czasie konwersji; budżety liczone są od
+// jej startu. Kanał, który nie wystartował w swoim okresie, ma ten termin
+// pominięty (missed) – siatka terminów zostaje, bez nadrabiania seriami.
+
+enum ChipPhase : uint8_t { PH_IDLE, PH_PROBE12, PH_FINE };
+
+struct ChipSeq {
+  MCP3424*  adc;
+  int       chan[4];     // kanały układu (indeksy chans[]) wg wejścia, -1 = nieużywane
+  int       idx;         // bieżący kanał (indeks chans[]), -1 = brak
+  ChipPhase phase;
+  uint32_t  startMs;     // start bieżącej konwersji
+  uint32_t  readyMs;     // wcześniej nie ma sensu pytać o RDY
+};
+
+static ChipSeq* seq   = nullptr;
+static int      nSeq  = 0;
+
+// układy i kanały z rejestru; reset każdego układu (general call)
+static void buildChips() {
+  if (!seq) {
+    nChans = AdcChannels::count();
+    chans  = new ChanState[nChans];
+    nSeq   = AdcChannels::chipCount();
+    seq    = new ChipSeq[nSeq];
+    for (int c=0;c<nSeq;++c) {
+      ChipSeq& s = seq[c];
+      s.adc = new MCP3424(AdcChannels::chipAddr(c));
+      for (int& k : s.chan) k = -1;
+      for (int i=0;i<nChans;++i) {
+        const AdcChannels::Channel& ch = AdcChannels::at(i);
+        if (ch.addr == AdcChannels::chipAddr(c)) s.chan[ch.input] = i;
+      }
+    }
+  }
+  for (int c=0;c<nSeq;++c) {
+    seq[c].idx   = -1;
+    seq[c].phase = PH_IDLE;
+    asm volatile ("nop"); asm volatile ("nop");
+    seq[c].adc->generalCall(GC_RESET);
+  }
+  for (int i=0;i<nChans;++i) chans[i].range.valid = false;
+}
 
+static const uint32_t kProbeBudgetMs = 80;
+static const uint32_t kIdleWaitMs    = 1000;   // żaden kanał nie jest aktywny
 
+static Resolution toRes(uint8_t bits) {
+  return bits <= 12 ? R12B : bits <= 14 ? R14B : bits <= 16 ? R16B : R18B;
+}
 
+static Gain toGain(uint8_t g) {
+  return g >= 8 ? GAINx8 : g >= 4 ? GAINx4 : g >= 2 ? GAINx2 : GAINx1;
+}
 
-static double trimmedMeanMedianFilter(double newSample, double sampleBuffer[], int& index) {
-  // cykliczny bufor
-  sampleBuffer[index] = newSample;
-  index = (index + 1) % NUM_SAMPLES;
-  if (index == 0 && warmupLeft>0) {
-    if (--warmupLeft == 0) bufferFilled = true;
+static uint32_t conversionMs(Resolution r) {
+  switch (r) {
+    case R12B: return 5;     // 240 SPS
+    case R14B: return 17;    // 60 SPS
+    case R16B: return 67;    // 15 SPS
+    default:   return 267;   // 3.75 SPS
   }
+}
+
+// budżet konwersji właściwej (18-bit: ~700 ms jak dawniej)
+static uint32_t fineBudgetMs(Resolution r) { return conversionMs(r) * 5 / 2 + 30; }
 
-  double sorted[NUM_SAMPLES];
-  memcpy(sorted, sampleBuffer, sizeof(sorted));
-  std::sort(sorted, sorted + NUM_SAMPLES);
+static Channel chOf(const ChipSeq& s) { return (Channel)((int)CH1 + AdcChannels::at(s.idx).input); }
 
-  // mediana (opcjonalnie do diagnostyki)
-  // double median = sorted[NUM_SAMPLES/2];
+// zapis konfiguracji = start konwersji one-shot (read() zwraca wtedy NOTRDY)
+static void startConversion(ChipSeq& s, Resolution res, Gain pga, ChipPhase ph) {
+  const Channel ch = chOf(s);
+  _ConfReg& c = s.adc->creg[ch];
+  c.bits = { pga, res, ONE_SHOT, ch, 1 };
+  double dummy = 0;
+  (void)s.adc->read(c.bits.ch, dummy);
+  s.phase   = ph;
+  s.startMs = millis();
+  s.readyMs = s.startMs + conversionMs(res);
+}
+
+// pełny zakres wejścia [V] dla PGA (Vref 2.048 V)
+static adc_real_t fullScale(Gain g) { return (adc_real_t)2.048 / (adc_real_t)(1 << (int)g); }
+
+static Gain gainFor(adc_real_t v) {   // jak MCP3424::findGain
+  const adc_real_t a = v < 0 ? -v : v;
+  return (a < (adc_real_t)0.256) ? GAINx8 : (a < (adc_real_t)0.512) ? GAINx4
+       : (a < (adc_real_t)1.024) ? GAINx2 : GAINx1;
+}
+
+// start kanału: stałe PGA albo z pamięci zakresu od razu właściwa
+// rozdzielczość, inaczej 12-bit próbny
+static void startChannel(ChipSeq& s) {
+  ChanState& c = chans[s.idx];
+  const Resolution res = toRes(c.prof.bits);
+  if (c.prof.gain) {
+    startConversion(s, res, toGain(c.prof.gain), PH_FINE);
+  } else if (c.range.valid && c.range.age < RANGE_REPROBE_EVERY) {
+    ++c.range.age;
+    startConversion(s, res, c.range.pga, PH_FINE);
+  } else {
+    startConversion(s, R12B, GAINx1, PH_PROBE12);
+  }
+}
 
-  // odrzuć 2 skrajne z dołu i góry
-  double sum = 0; int cnt = 0;
-  for (int i=2; i<NUM_SAMPLES-2; ++i) { sum += sorted[i]; ++cnt; }
-  return cnt ? (sum / cnt) : newSample;
+// po konwersji właściwej: zapamiętaj PGA albo (przesterowanie) wymuś próbę
+static void updateRange(RangeCache& r, Gain used, adc_real_t v) {
+  const adc_real_t a = v < 0 ? -v : v;
+  if (a >= RANGE_HEADROOM * fullScale(used)) { r.valid = false; return; }
+  const Gain g = gainFor(v);
+  if (!r.valid || r.pga != g) { r.pga = g; r.age = 0; }
+  r.valid = true;
 }
 
+// EDF: aktywny kanał układu z najwcześniejszym terminem; -1, gdy brak aktywnych
+static int earliest(const ChipSeq& s) {
+  int best = -1;
+  for (int i : s.chan) {
+    if (i < 0 || !chans[i].prof.periodMs) continue;
+    if (best < 0 || (int32_t)(chans[i].dueMs - chans[best].dueMs) < 0) best = i;
+  }
+  return best;
+}
 
+// termin nadszedł: policz spóźnienie, pomiń przegapione okresy i startuj
+static void dispatch(ChipSeq& s, int idx, uint32_t now) {
+  ChanState& c = chans[idx];
+  const uint32_t late = now - c.dueMs;
+  if (late >= c.prof.periodMs) {
+    const uint32_t skip = late / c.prof.periodMs;
+    c.st.missed += skip;
+    c.dueMs     += skip * c.prof.periodMs;
+  }
+  const uint32_t lateMs = now - c.dueMs;
+  c.st.lateLastMs = lateMs;
+  if (lateMs > c.st.lateMaxMs) c.st.lateMaxMs = lateMs;
+  c.dueMs += c.prof.periodMs;
+  s.idx = idx;
+  startChannel(s);
+}
 
-static ConvStatus readWithTimeout(MCP3424& adc, Channel ch, double& out, uint32_t budgetMs) {
-  unsigned long t0 = millis();
-  ConvStatus st;
-  do {
-    st = adc.read(ch, out);               // biblioteka zwraca R_STATUS_OK / R_STATUS_NOTRDY / ...
-    if (st == R_STATUS_OK) return st;
-    delay(5);
-    esp_task_wdt_reset();
-    yield();
-  } while ((millis() - t0) < budgetMs);
-  return st;                              // ostatni status (zwykle NOTRDY timeout)
+static void finish(ChipSeq& s) {
+  s.phase = PH_IDLE;
+  s.idx   = -1;
 }
 
-static void read_adc_channels(MCP3424& adc, ChannelData data[], int start_idx) {
-  for (int i = (int)CH1; i <= (int)CH4; ++i) {
-    const int idx = start_idx + (i - (int)CH1);
-    _ConfReg& c = adc.creg[(Channel)i];
+static void stepChip(ChipSeq& s, uint32_t now) {
+  if (s.phase == PH_IDLE) return;
+  if ((int32_t)(now - s.readyMs) < 0) return;
 
-    // 1) Szybki strzał 12-bit (krótki budżet)
-    c.bits = { GAINx1, R12B, ONE_SHOT, (Channel)i, 1 };
-    double raw = 0;
-    ConvStatus st = readWithTimeout(adc, c.bits.ch, raw, 80); // ~80ms budżetu zwykle wystarcza
+  ChanState& cs = chans[s.idx];
+  _ConfReg& c = s.adc->creg[chOf(s)];
+  double rd = 0;                                 // API biblioteki jest w double
+  ConvStatus st = s.adc->read(c.bits.ch, rd);    // R_STATUS_OK / R_STATUS_NOTRDY / ...
+  const adc_real_t raw = (adc_real_t)rd;
 
+  if (s.phase == PH_PROBE12) {
     if (st == R_STATUS_OK) {
-      double filtered = trimmedMeanMedianFilter(raw, samples[idx], sampleIndex[idx]);
-      data[idx].value = filtered;
-      data[idx].config = c;
-
-      // 2) Auto-gain na podstawie 12-bit
-      c.bits.pga = adc.findGain(filtered);
-
-      // 3) 18-bit precyzyjny – polluj gotowość bez wieszania pętli
-      c.bits.res = R18B;                  // 18 bit ≈ 267 ms
-      st = readWithTimeout(adc, c.bits.ch, raw, 700); // budżet 400 ms
-
-      if (st == R_STATUS_OK) {
-        filtered = trimmedMeanMedianFilter(raw, samples[idx], sampleIndex[idx]);
-        data[idx].value = filtered;
-        data[idx].config = c;
-        Serial.println("--18bits OK--"); // opcjonalnie
-      } else {
-        // Nie gotowe w czasie – zostaw wynik 12-bit jako „fallback”.
-         Serial.println("--18bits TIMEOUT--"); // opcjonalnie
-      }
-    } else {
-      // 12-bit też nie gotowy – nie truj logu, tylko zaznacz błąd dla kanału
-      data[idx].value = NAN;
-      data[idx].config = c;
-       Serial.println("--ADC NOT READY--"); // opcjonalnie
+      // Auto-gain na podstawie 12-bit, potem konwersja w rozdzielczości profilu
+      cs.range.age = 0;
+      startConversion(s, toRes(cs.prof.bits), gainFor(raw), PH_FINE);
+    } else if (now - s.startMs >= kProbeBudgetMs) {
+      // 12-bit nie gotowy – nie truj logu, kanał zostaje z poprzednią wartością
+      ++cs.st.timeouts;
+      Serial.println("--ADC NOT READY--"); // opcjonalnie
+      finish(s);
+    }
+    return;
+  }
+
+  // PH_FINE
+  if (st == R_STATUS_OK) {
+    if (!cs.prof.gain) updateRange(cs.range, c.bits.pga, raw);
+    cs.value = cs.filt.update(raw);
+    cs.gain  = (uint8_t)(1 << c.bits.pga);
+    cs.bits  = (uint8_t)(12 + c.bits.res * 2);
+    cs.fresh = true;
+    ++cs.st.samples;
+    finish(s);
+  } else if (now - s.startMs >= fineBudgetMs((Resolution)c.bits.res)) {
+    // Nie gotowe w czasie – zostaw poprzedni wynik jako „fallback”.
+    cs.range.valid = false;
+    ++cs.st.timeouts;
+    Serial.println("--CONV TIMEOUT--"); // opcjonalnie
+    finish(s);
+  }
+}
+
+static bool sameProfile(const AdcProfiles::Profile& a, const AdcProfiles::Profile& b) {
+  return a.bits == b.bits && a.gain == b.gain && a.periodMs == b.periodMs && a.depth == b.depth;
+}
+
+void adcSchedApply() {
+  const uint32_t now = millis();
+  for (int i=0;i<nChans;++i) {
+    ChanState& c = chans[i];
+    const AdcProfiles::Profile p = AdcProfiles::get(i);
+    // niezmieniony kanał zachowuje filtr, termin i liczniki
+    if (c.filt.depth() && sameProfile(c.prof, p)) continue;
+    for (int k=0;k<nSeq;++k) if (seq[k].idx == i) finish(seq[k]);   // konwersja w toku – wynik pominięty
+    c.prof = p;
+    const uint32_t bit = 1u << i;
+    if (!c.filt.resize(c.prof.depth)) {
+      c.prof.periodMs = 0;
+      gApplyNoMem.fetch_or(bit, std::memory_order_relaxed);
     }
+    c.range.valid = false;
+    c.dueMs  = now;
+    c.value  = 0;
+    c.fresh  = false;
+    c.st.clear();
+    gApplied.fetch_or(bit, std::memory_order_release);
   }
-  asm volatile ("nop"); asm volatile ("nop");
-}
-
-
-static void set_all_valuesADC(ChannelData data[]) {
-  if (!isnan(data[0].value)) weADC1 = data[0].value;
-  if (!isnan(data[1].value)) weADC2 = data[1].value;
-  if (!isnan(data[2].value)) weADC3 = data[2].value;
-  if (!isnan(data[3].value)) weADC4 = data[3].value;
-  if (!isnan(data[4].value)) weADC5 = data[4].value;
-  if (!isnan(data[5].value)) weADC6 = data[5].value;
-  if (!isnan(data[6].value)) weADC7 = data[6].value;
-  if (!isnan(data[7].value)) weADC8 = data[7].value;
-}
-
-static void show_all_values(ChannelData data[]) {
-  char v[24], buff[512] = {0};
-  char temp[64];
-  for (int i=0;i<8;++i) {
-    if (!isnan(data[i].value)) dtostrf(data[i].value, 8, 6, v);
-    else                       strcpy(v, "  ERROR  ");
-    sprintf(temp, "CH%d: g:%d b:%d val:%s ",
-      i+1, 1 << data[i].config.bits.pga, 12 + (data[i].config.bits.res * 2), v);
-    strcat(buff, temp);
+}
+
+void adcSchedTakeApplied(uint32_t& applied, uint32_t& noMem) {
+  // zwykle nic nowego – sam odczyt, bez zapisu do współdzielonej linii
+  applied = gApplied.load(std::memory_order_relaxed) ? gApplied.exchange(0, std::memory_order_acquire) : 0;
+  noMem   = gApplyNoMem.load(std::memory_order_relaxed) ? gApplyNoMem.exchange(0, std::memory_order_relaxed) : 0;
+}
+
+uint32_t adcSchedStep() {
+  const uint32_t now = millis();
+  uint32_t wait = kIdleWaitMs;
+  for (int k=0;k<nSeq;++k) {
+    ChipSeq& s = seq[k];
+    stepChip(s, now);
+    if (s.phase == PH_IDLE) {
+      const int idx = earliest(s);
+      if (idx >= 0 && (int32_t)(now - chans[idx].dueMs) >= 0) dispatch(s, idx, now);
+    }
+    uint32_t w;
+    if (s.phase != PH_IDLE) {
+      const int32_t dt = (int32_t)(s.readyMs - now);
+      w = dt > 1 ? (uint32_t)dt : 1;
+    } else {
+      const int idx = earliest(s);
+      if (idx < 0) continue;
+      const int32_t dt = (int32_t)(chans[idx].dueMs - now);
+      w = dt > 1 ? (uint32_t)dt : 1;
+    }
+    if (w < wait) wait = w;
   }
-  Serial.println(buff);
+  return wait;
 }
 
-void pomiarMCP3424() {
-  read_adc_channels(adc1, data8, 0);// Kanały 1-4
-  Serial.println("Pomiar wartości ANALOGOWYCH");
-  //read_adc_channels(adc1, data8, 0);// Kanały 1-4
-  read_adc_channels(adc2, data8, 4);// Kanały 5-8
+static void show_all_values() {
+  char v[24], temp[64];
+  for (int i=0;i<nChans;++i) {
+    const ChanState& c = chans[i];
+    if (!c.prof.periodMs)      strcpy(v, "   OFF   ");
+    else if (!c.filt.filled()) strcpy(v, "  WARMUP ");
+    else                       dtostrf(c.value, 8, 6, v);
+    snprintf(temp, sizeof(temp), "%s: g:%d b:%d val:%s ", AdcChannels::at(i).id, c.gain, c.bits, v);
+    Serial.print(temp);
+  }
+  Serial.println();
+}
 
-// Wyświetlamy wyniki tylko wtedy, gdy bufory są w pełni napełnione
-  if (bufferFilled) {
-    set_all_valuesADC(data8);
-    show_all_values(data8); // opcjonalnie: zostaw do diagnostyki
+void adcSchedFrame(AdcFrame& out) {
+  out.n     = (uint8_t)nChans;
+  out.fresh = 0;
+  out.valid = 0;
+  for (int i=0;i<nChans;++i) {
+    ChanState& c = chans[i];
+    // wartości dopiero z pełnego okna filtra (jak dawne bufferFilled)
+    if (!c.prof.periodMs || !c.filt.filled()) { out.value[i] = 0; out.gain[i] = 0; out.bits[i] = 0; continue; }
+    out.value[i] = c.value;
+    out.gain[i]  = c.gain;
+    out.bits[i]  = c.bits;
+    out.valid   |= 1u << i;
+    if (c.fresh) out.fresh |= 1u << i;
+    c.fresh = false;
   }
-  
-  // Placeholder sekcji binary:
-  Serial.println("Pomiar wartości BINARNYCH");
+  if (out.fresh) show_all_values(); // opcjonalnie: zostaw do diagnostyki
+}
+
+AdcChanStats adcSchedStats(int ch) {
+  AdcChanStats r = {};
+  if (ch < 0 || ch >= nChans) return r;
+  const ChanCounters& c = chans[ch].st;
+  r.samples    = c.samples.load(std::memory_order_relaxed);
+  r.missed     = c.missed.load(std::memory_order_relaxed);
+  r.timeouts   = c.timeouts.load(std::memory_order_relaxed);
+  r.lateLastMs = c.lateLastMs.load(std::memory_order_relaxed);
+  r.lateMaxMs  = c.lateMaxMs.load(std::memory_order_relaxed);
+  return r;
 }
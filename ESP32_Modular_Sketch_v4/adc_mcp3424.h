@@ -1,5 +1,30 @@
 #pragma once
 #include <Arduino.h>
+#include "adc_values.h"
+#include "adc_profiles.h"
 
-void startMCP3424();   // init I2C + reset układów
-void pomiarMCP3424();  // odczyt CH1..CH8 z filtrowaniem + auto-gain (ustawia weADC1..8)
+void startMCP3424();   // init I2C, układy i bufory wg rejestru AdcChannels, reset układów
+
+// Harmonogram konwersji wg rejestru kanałów (adc_channels.h) i ich profili
+// (adc_profiles.h). Każdy układ MCP3424 z rejestru (do 8, 0x68..0x6F)
+// konwertuje jeden kanał naraz; wolny układ bierze swój kanał z
+// najwcześniejszym terminem (EDF), układy pracują równolegle. Poza
+// startMCP3424() i adcSchedStats() wołane wyłącznie z zadania akwizycji.
+void     adcSchedApply();                 // (prze)ładuj profile: zmienione kanały od zera
+// Kanały przeładowane przez adcSchedApply() od poprzedniego wywołania (maska,
+// bit = indeks kanału) i te z nich wyłączone z braku pamięci na filtr. Zadanie
+// nie pisze logu (LittleFS, mały stos) – loguje loop() przez AdcTask::drain().
+void     adcSchedTakeApplied(uint32_t& applied, uint32_t& noMem);
+uint32_t adcSchedStep();                  // odbiór gotowych + start kolejnych; ms do następnego zdarzenia
+// Migawka wartości kanałów (value/gain/bits/fresh/valid; seq, czasy i calc
+// uzupełnia wołający). fresh = kanały zmierzone od poprzedniej migawki.
+void     adcSchedFrame(AdcFrame& out);
+
+struct AdcChanStats {
+  uint32_t samples;     // zakończone konwersje (wartości w filtrze)
+  uint32_t missed;      // okresy, w których kanał nie zdążył wystartować
+  uint32_t timeouts;    // konwersje bez RDY w budżecie
+  uint32_t lateLastMs;  // opóźnienie startu względem terminu (ostatnie)
+  uint32_t lateMaxMs;
+};
+AdcChanStats adcSchedStats(int ch);   // z dowolnego zadania (liczniki atomowe)
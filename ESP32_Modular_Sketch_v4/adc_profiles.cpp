@@ -0,0 +1,101 @@
+#include "adc_profiles.h"
+#include "adc_channels.h"
+#include "seqlock.h"
+#include <LittleFS.h>
+#include <ArduinoJson.h>
+
+#include <atomic>
+
+namespace AdcProfiles {
+
+static const char* kPath = "/adc_profiles.json";
+
+// pisze tylko loop() (load/set), czyta też zadanie akwizycji;
+// po jednym seqlocku na kanał rejestru (alokowane w load())
+static SeqLock<Profile>*     g  = nullptr;
+static int                   gN = 0;
+static std::atomic<uint32_t> gVersion{0};
+
+void normalize(Profile& p) {
+  if      (p.bits <= 12) p.bits = 12;
+  else if (p.bits <= 14) p.bits = 14;
+  else if (p.bits <= 16) p.bits = 16;
+  else                   p.bits = 18;
+  if (p.gain != 1 && p.gain != 2 && p.gain != 4 && p.gain != 8) p.gain = 0;
+  if (p.periodMs && p.periodMs < kMinPeriodMs) p.periodMs = kMinPeriodMs;
+  if (p.depth < 1) p.depth = 1;
+  if (p.depth > kMaxDepth) p.depth = kMaxDepth;
+}
+
+void defaults(Profile& p) {
+  // jak dawny stały przebieg: 18-bit, auto-gain, filtr 10 (obcięcie 2+2);
+  // 2 s mieści 4 kanały 18-bit na układ (4 x 267 ms) z zapasem
+  p.bits     = 18;
+  p.gain     = 0;
+  p.periodMs = 2000;
+  p.depth    = 10;
+}
+
+Profile get(int ch) {
+  if (ch < 0 || ch >= gN) { Profile p; defaults(p); p.periodMs = 0; return p; }
+  return g[ch].read();
+}
+
+uint32_t version() { return gVersion.load(std::memory_order_acquire); }
+
+void set(int ch, const Profile& p) {
+  if (ch < 0 || ch >= gN) return;
+  Profile n = p;
+  normalize(n);
+  g[ch].write(n);
+  gVersion.fetch_add(1, std::memory_order_release);
+}
+
+bool load() {
+  delete[] g;
+  gN = AdcChannels::count();
+  g  = new SeqLock<Profile>[gN];
+
+  JsonDocument doc;
+  bool have = false;
+  if (LittleFS.exists(kPath)) {
+    File f = LittleFS.open(kPath, "r");
+    if (f) { have = (deserializeJson(doc, f) == DeserializationError::Ok); f.close(); }
+  }
+
+  for (int i=0;i<gN;++i) {
+    Profile p;
+    defaults(p);
+    JsonObject a = doc[AdcChannels::at(i).id];
+    if (have && !a.isNull()) {
+      if (!a["bits"].isNull())     p.bits     = a["bits"].as<uint8_t>();
+      if (!a["gain"].isNull())     p.gain     = a["gain"].as<uint8_t>();
+      if (!a["periodMs"].isNull()) p.periodMs = a["periodMs"].as<uint32_t>();
+      if (!a["depth"].isNull())    p.depth    = a["depth"].as<uint8_t>();
+    }
+    normalize(p);
+    g[i].write(p);
+  }
+  gVersion.fetch_add(1, std::memory_order_release);
+  return have ? true : save();
+}
+
+bool save() {
+  JsonDocument doc;
+  for (int i=0;i<gN;++i) {
+    const Profile p = g[i].read();
+    JsonObject a = doc.createNestedObject(AdcChannels::at(i).id);
+    a["bits"]     = p.bits;
+    a["gain"]     = p.gain;
+    a["periodMs"] = p.periodMs;
+    a["depth"]    = p.depth;
+  }
+
+  File f = LittleFS.open(kPath, "w");
+  if (!f) return false;
+  bool ok = (serializeJsonPretty(doc, f) > 0);
+  f.close();
+  return ok;
+}
+
+} // namespace AdcProfiles
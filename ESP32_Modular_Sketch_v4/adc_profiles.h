@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"
+
+// Profile akwizycji kanałów MCP3424 (/adc_profiles.json, klucz = id kanału
+// z rejestru AdcChannels). Każdy kanał ma własną rozdzielczość, wzmocnienie
+// (stałe albo auto), okres próbkowania i głębokość filtra; harmonogram EDF
+// w adc_mcp3424.cpp układa według nich konwersje na wszystkich układach.
+namespace AdcProfiles {
+
+struct Profile {
+  uint8_t  bits;      // 12/14/16/18
+  uint8_t  gain;      // 0 = auto (próba 12-bit + pamięć zakresu), 1/2/4/8 = stałe PGA
+  uint32_t periodMs;  // okres próbkowania kanału; 0 = kanał wyłączony
+  uint8_t  depth;     // głębokość filtra (średnia obcięta), 1..64
+};
+
+static const uint32_t kMinPeriodMs = 10;
+static const uint8_t  kMaxDepth    = 64;
+
+Profile  get(int ch);                  // spójna kopia (seqlock) – także z zadania akwizycji
+void     set(int ch, const Profile& p); // normalizuje i ustawia w RAM (zapis: save())
+uint32_t version();          // rośnie przy każdym set()/load() – zadanie przeładowuje profile
+bool     load();             // po AdcChannels::load(); brak pliku/kanału -> defaults
+bool     save();
+
+void defaults(Profile& p);
+void normalize(Profile& p);  // wartości spoza zakresu -> najbliższe dozwolone
+
+} // namespace AdcProfiles
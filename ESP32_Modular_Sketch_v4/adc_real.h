@@ -0,0 +1,16 @@
+#pragma once
+
+// Typ liczbowy ścieżki próbka -> filtr -> kalibracja -> progi alarmów.
+// FPU ESP32-S3 liczy tylko pojedynczą precyzję: float idzie sprzętowo, double
+// programowo (soft-float). 24 bity mantysy float to ~0.1 uV przy 2 V, więc
+// 18-bitowy MCP3424 (LSB 15.6 uV) niczego nie traci.
+// ADC_USE_DOUBLE=1 (np. -DADC_USE_DOUBLE=1 w build_opt.h) wraca do double.
+#ifndef ADC_USE_DOUBLE
+  #define ADC_USE_DOUBLE 0
+#endif
+
+#if ADC_USE_DOUBLE
+  typedef double adc_real_t;
+#else
+  typedef float adc_real_t;
+#endif
@@ -0,0 +1,188 @@
+#include "adc_task.h"
+#include "adc_mcp3424.h"
+#include "adc_values.h"
+#include "adc_profiles.h"
+#include "adc_channels.h"
+#include "spsc_ring.h"
+#include "history.h"
+#include "rollup.h"
+#include "io_pins.h"
+#include "log.h"
+
+#include <atomic>
+#include <time.h>
+
+namespace AdcTask {
+
+static const uint32_t    kStackBytes = 4096;
+static const UBaseType_t kPriority   = 5;   // ponad loopTask (1) – wywłaszcza loop()
+static const BaseType_t  kCore       = 1;
+static const size_t      kRingFrames = 8;   // ~8 okresów zapasu, gdy loop() stoi
+
+static SpscRing<Frame, kRingFrames> gRing;
+static std::atomic<uint32_t>        gPeriodMs{1000};
+static TaskHandle_t                 gTask = nullptr;
+
+// --- stan konsumenta (tylko loop()) ---
+static Frame    gLast  = {};
+static Stats    gStats  = {};
+static uint64_t gJitterSumUs = 0;
+static uint32_t gJitterN     = 0;
+
+// ================== Producent (zadanie, rdzeń 1) ==================
+
+static void publish(uint32_t seq, uint32_t periodMs, uint32_t overruns, uint32_t& dropped) {
+  Frame f;
+  f.adc.seq     = seq;   // numer także dla odrzuconych – luka = zgubiona ramka
+  f.adc.startUs = micros();
+  f.adc.epoch   = time(nullptr);
+  adcSchedFrame(f.adc);
+  adcCalibrate(f.adc);
+  adcPublish(f.adc);
+  f.periodMs = periodMs;
+  f.overruns = overruns;
+  f.dropped  = dropped;
+  if (!gRing.push(f)) ++dropped;
+}
+
+static void taskMain(void*) {
+  uint32_t seq = 0, overruns = 0, dropped = 0;
+  uint32_t profVer = AdcProfiles::version();
+  adcSchedApply();
+  uint32_t nextFrameMs = millis() + gPeriodMs.load(std::memory_order_relaxed);
+  for (;;) {
+    // profile zmienione z WebUI/CfgSync – przeładuj między konwersjami
+    const uint32_t v = AdcProfiles::version();
+    if (v != profVer) { profVer = v; adcSchedApply(); }
+
+    uint32_t waitMs = adcSchedStep();   // konwersje wg terminów kanałów (EDF)
+
+    const uint32_t periodMs = gPeriodMs.load(std::memory_order_relaxed);
+    uint32_t now = millis();
+    if ((int32_t)(now - nextFrameMs) >= 0) {
+      publish(++seq, periodMs, overruns, dropped);
+      nextFrameMs += periodMs;
+      if ((int32_t)(now - nextFrameMs) >= 0) {
+        // klatka spóźniona o cały okres: nie nadrabiaj seriami, siatka od teraz
+        ++overruns;
+        nextFrameMs = now + periodMs;
+      }
+    }
+
+    const int32_t toFrame = (int32_t)(nextFrameMs - now);
+    if (toFrame < (int32_t)waitMs) waitMs = toFrame > 1 ? (uint32_t)toFrame : 1;
+    const TickType_t t = pdMS_TO_TICKS(waitMs);
+    vTaskDelay(t ? t : 1);
+  }
+}
+
+void begin(uint32_t periodMs) {
+  setPeriodMs(periodMs);
+  if (gTask) return;
+  if (xTaskCreatePinnedToCore(taskMain, "adc_acq", kStackBytes, nullptr, kPriority,
+                              &gTask, kCore) != pdPASS) {
+    gTask = nullptr;
+    LOGE("AdcTask: xTaskCreatePinnedToCore failed");
+    return;
+  }
+  LOGI("AdcTask started: core=%d prio=%u period=%lums", (int)kCore, (unsigned)kPriority,
+       (unsigned long)gPeriodMs.load());
+}
+
+void setPeriodMs(uint32_t ms) {
+  gPeriodMs.store(ms ? ms : 1, std::memory_order_relaxed);
+}
+
+// ================== Konsument (loop()) ==================
+
+static void noteJitter(const Frame& prev, const Frame& f) {
+  // okres rzeczywisty między startami kolejnych przebiegów vs nominalny
+  const int64_t actualUs = (int64_t)(uint32_t)(f.adc.startUs - prev.adc.startUs);
+  int64_t j = actualUs - (int64_t)f.periodMs * 1000;
+  if (j >  INT32_MAX) j = INT32_MAX;
+  if (j < -INT32_MAX) j = -INT32_MAX;
+  const uint32_t a = (uint32_t)(j < 0 ? -j : j);
+  if (gJitterN == 0 || j < gStats.jitterMinUs) gStats.jitterMinUs = (int32_t)j;
+  if (gJitterN == 0 || j > gStats.jitterMaxUs) gStats.jitterMaxUs = (int32_t)j;
+  gJitterSumUs += a;
+  ++gJitterN;
+  gStats.jitterLastUs = a;
+}
+
+// wyniki przeładowania profili z zadania – log (LittleFS) tylko z loop()
+static void logApplied() {
+  uint32_t applied, noMem;
+  adcSchedTakeApplied(applied, noMem);
+  for (int i = 0; i < AdcChannels::count() && (applied | noMem); ++i) {
+    const uint32_t bit = 1u << i;
+    if (noMem & bit) {
+      LOGE("ADC %s: brak pamięci na filtr %u", AdcChannels::at(i).id,
+           (unsigned)AdcProfiles::get(i).depth);
+    } else if (applied & bit) {
+      const AdcProfiles::Profile p = AdcProfiles::get(i);
+      LOGI("ADC %s profile: %u-bit gain=%u period=%lums depth=%u", AdcChannels::at(i).id,
+           (unsigned)p.bits, (unsigned)p.gain, (unsigned long)p.periodMs, (unsigned)p.depth);
+    }
+    applied &= ~bit;
+    noMem   &= ~bit;
+  }
+}
+
+uint32_t drain() {
+  logApplied();
+  uint32_t n = 0;
+  Frame f;
+  bool in[5];
+  while (gRing.pop(f)) {
+    if (n == 0) IO::readBinaryInputs(in);    // stan wejść raz na odbiór
+    History::push(f.adc, in);
+    Rollup::push(f.adc);
+    if (gLast.adc.seq != 0 && f.adc.seq == gLast.adc.seq + 1) noteJitter(gLast, f);
+    gLast = f;
+    ++n;
+  }
+  if (n == 0) return 0;
+
+  gStats.frames    += n;
+  gStats.dropped    = gLast.dropped;
+  gStats.overruns   = gLast.overruns;
+  return n;
+}
+
+Stats stats() {
+  Stats s = gStats;
+  s.periodMs    = gPeriodMs.load(std::memory_order_relaxed);
+  s.jitterAvgUs = gJitterN ? (uint32_t)(gJitterSumUs / gJitterN) : 0;
+  return s;
+}
+
+String statsJson() {
+  const Stats s = stats();
+  String js = "{";
+  js += "\"frames\":";        js += (unsigned)s.frames;
+  js += ",\"dropped\":";      js += (unsigned)s.dropped;
+  js += ",\"overruns\":";     js += (unsigned)s.overruns;
+  js += ",\"periodMs\":";     js += (unsigned)s.periodMs;
+  js += ",\"jitterMinUs\":";  js += (int)s.jitterMinUs;
+  js += ",\"jitterMaxUs\":";  js += (int)s.jitterMaxUs;
+  js += ",\"jitterAvgUs\":";  js += (unsigned)s.jitterAvgUs;
+  js += ",\"jitterLastUs\":"; js += (unsigned)s.jitterLastUs;
+  js += ",\"seq\":";          js += (unsigned)gLast.adc.seq;
+  js += ",\"channels\":[";
+  for (int i=0;i<AdcChannels::count();++i) {
+    const AdcChanStats c = adcSchedStats(i);
+    if (i) js += ",";
+    js += "{\"id\":\"";       js += AdcChannels::at(i).id;
+    js += "\",\"samples\":";     js += (unsigned)c.samples;
+    js += ",\"missed\":";      js += (unsigned)c.missed;
+    js += ",\"timeouts\":";    js += (unsigned)c.timeouts;
+    js += ",\"lateLastMs\":";  js += (unsigned)c.lateLastMs;
+    js += ",\"lateMaxMs\":";   js += (unsigned)c.lateMaxMs;
+    js += "}";
+  }
+  js += "]";
+  js += "}";
+  return js;
+}
+
+} // namespace AdcTask
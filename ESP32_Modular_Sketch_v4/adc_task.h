@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"
+#include "adc_mcp3424.h"
+
+// Akwizycja MCP3424 w osobnym zadaniu FreeRTOS (rdzeń 1): zadanie jest jedynym
+// właścicielem I2C i filtrów, prowadzi harmonogram konwersji wg profili
+// kanałów (adcSchedStep), a co okres klatki publikuje migawkę AdcFrame przez
+// seqlock (adcLatest() – Measure, Alarm, WebUI) i wstawia ramkę do
+// pierścienia SPSC, z którego loop() odbiera każdą klatkę przez drain()
+// (statystyki okresu, historia History, agregaty Rollup, log przeładowania
+// profili – zadanie samo nie loguje).
+namespace AdcTask {
+
+struct Frame {
+  AdcFrame adc;
+  uint32_t periodMs;   // okres klatki w chwili migawki
+  uint32_t overruns;   // licznik producenta: klatka spóźniona o cały okres
+  uint32_t dropped;    // licznik producenta: ramki odrzucone (pełny pierścień)
+};
+
+struct Stats {
+  uint32_t frames;       // odebrane ramki
+  uint32_t dropped;      // odrzucone przez pełny pierścień
+  uint32_t overruns;     // klatki spóźnione o cały okres
+  uint32_t periodMs;     // okres klatki
+  int32_t  jitterMinUs;  // odchyłka okresu klatki (rzeczywisty - nominalny)
+  int32_t  jitterMaxUs;
+  uint32_t jitterAvgUs;  // średnia |odchyłki|
+  uint32_t jitterLastUs; // |odchyłka| ostatniego okresu
+};                       // liczniki kanałów: adcSchedStats(i)
+
+void begin(uint32_t periodMs);   // startuje zadanie (po ::startMCP3424)
+void setPeriodMs(uint32_t ms);
+
+uint32_t drain();                // tylko loop(): odbiera ramki (statystyki), zwraca ich liczbę
+Stats    stats();
+String   statsJson();
+
+} // namespace AdcTask
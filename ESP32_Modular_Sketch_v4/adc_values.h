@@ -1,20 +1,33 @@
 #pragma once
 #include <Arduino.h>
+#include "adc_real.h"
 
-static const int NUM_ADC_CHANNELS = 8;
+// Pojemność klatki: 8 adresów MCP3424 (0x68..0x6F) x 4 wejścia – granica
+// magistrali. Klatka zostaje stałego rozmiaru (seqlock i pierścień SPSC
+// kopiują ją bajtowo); faktyczna liczba kanałów to n z rejestru AdcChannels.
+static const int ADC_MAX_CHANNELS = 32;
 
-// Surowe odczyty
-extern double weADC1, weADC2, weADC3, weADC4, weADC5, weADC6, weADC7, weADC8;
-// Przeliczone (A*x + B)
-extern double weADC1licz, weADC2licz, weADC3licz, weADC4licz, weADC5licz, weADC6licz, weADC7licz, weADC8licz;
-
-extern uint8_t mamADC; // 0/1 – sygnalizacja, że są świeże dane
-
-struct AdcCal {
-  float A[8];  // domyślnie 1
-  float B[8];  // domyślnie 0
+// Migawka kanałów z harmonogramu MCP3424 (co okres klatki AdcTask);
+// indeks i = pozycja kanału w rejestrze AdcChannels.
+struct AdcFrame {
+  uint32_t seq;                        // numer klatki od 1 (0 = jeszcze brak danych)
+  uint32_t startUs;                    // micros() migawki
+  time_t   epoch;                      // time(nullptr) migawki
+  uint8_t  n;                          // liczba kanałów (AdcChannels::count())
+  uint32_t fresh;                      // bit i = kanał i zmierzony od poprzedniej klatki
+  uint32_t valid;                      // bit i = kanał aktywny i z pełnym filtrem
+  uint8_t  gain[ADC_MAX_CHANNELS];     // PGA: 1/2/4/8
+  uint8_t  bits[ADC_MAX_CHANNELS];     // rozdzielczość: 12/14/16/18
+  adc_real_t value[ADC_MAX_CHANNELS];  // surowe [V] po filtrze (0, gdy bit valid zgaszony)
+  adc_real_t calc[ADC_MAX_CHANNELS];   // przeliczone A*x+B (kalibracja z rejestru)
 };
-extern AdcCal adcCal;
 
-// Przeliczenie: weADC?licz = A*weADC? + B
-void pomiarADClicz();
+// Przeliczenie: calc[i] = A*value[i] + B
+void       adcCalibrate(AdcFrame& f);
+adc_real_t adcCalc(int ch, adc_real_t raw);
+
+// Publikacja ostatniej klatki przez seqlock: jeden pisarz (zadanie akwizycji),
+// czytelnicy z dowolnego zadania/rdzenia dostają spójną kopię bez muteksu.
+void     adcPublish(const AdcFrame& f);
+AdcFrame adcLatest();
+uint32_t adcLatestSeq();   // tani test „czy jest nowa klatka” (bez kopiowania)
@@ -3,11 +3,14 @@
 #include "io_pins.h"
 #include "alarm_config.h"
 #include "adc_values.h"
+#include "adc_channels.h"
+#include "history.h"
 #include "data_files.h"
 #include "measurement.h"
 #include "ftp_queue.h"
 #include "config.h"
 #include "log.h"
+#include "file_writer.h"
 #include <LittleFS.h>
 #include "email_alert.h"
 #include <time.h>
@@ -34,10 +37,9 @@ const char* alarmBasePath() { return g_alarmBase.c_str(); }
 
 static String nowStamp() { return Measure::pomTimeStamp(); }
 
+// alarm od razu na flash (commit), nie czeka w buforze
 static void appendLine(const String& line) {
-  File f = LittleFS.open(g_alarmBase, "a");
-  if (!f) f = LittleFS.open(g_alarmBase, "w");
-  if (f) { f.print(line); f.close(); }
+  FileWriter::append(g_alarmBase, line, FileWriter::Sync);
 }
 
 static void ensureBase() {
@@ -53,11 +55,8 @@ static void logAlarm(const String& msg) {
 }
 
 static void maybeRotateAndEnqueue() {
-  size_t s = 0;
-  if (LittleFS.exists(g_alarmBase)) {
-    File f = LittleFS.open(g_alarmBase, "r"); if (f) { s = f.size(); f.close(); }
-  }
-  if (s < ALARM_FILE_LIMIT) return;
+  if (FileWriter::size(g_alarmBase.c_str()) < ALARM_FILE_LIMIT) return;
+  FileWriter::release(g_alarmBase.c_str());
 
   // rename -> epoch
   time_t t = time(nullptr);
@@ -75,6 +74,15 @@ static void maybeRotateAndEnqueue() {
   }
 }
 
+// kontekst alarmu z pierścienia History (RAM): przebieg kanału przed startem
+static String analogContext(int ch, uint32_t sec) {
+  if (sec < 60) sec = 60;
+  History::Window w;
+  if (!History::window(ch, sec, &w)) return String();
+  return String(" (ostatnie ") + sec + " s: min " + String(w.min, 6) + ", max " + String(w.max, 6) +
+         ", śr " + String(w.mean, 6) + ", n " + w.n + ")";
+}
+
 // ====== STANY WEWNĘTRZNE AUTOMATÓW ======
 
 struct AnaState {
@@ -98,18 +106,15 @@ struct BinState {
   uint16_t nNorm = 0;
 };
 
-static AnaState aS[8];
+static std::vector<AnaState> aS;   // po jednym na kanał rejestru (begin())
 static BinState bS[5];
 
 // ====== API ======
 
 bool rotateAndEnqueueNow() {
   ensureBase();
-  size_t s = 0;
-  if (LittleFS.exists(g_alarmBase)) {
-    File f = LittleFS.open(g_alarmBase, "r"); if (f) { s = f.size(); f.close(); }
-  }
-  if (s == 0) return false;
+  if (FileWriter::size(g_alarmBase.c_str()) == 0) return false;
+  FileWriter::release(g_alarmBase.c_str());
 
   time_t t = time(nullptr);
   char ep[16]; snprintf(ep, sizeof(ep), "%lu", (unsigned long)t);
@@ -124,20 +129,19 @@ void begin() {
   ensureBase();
   IO::begin();
   AlarmCfg::load();
+  aS.assign(AdcChannels::count(), AnaState());
 }
 
 // ====== DETEKCJA ANALOG ======
-static void processAnalog() {
-  using namespace AlarmCfg;
-  AlarmCfg::Config cfg = AlarmCfg::get();
-
-  double vals[8] = { weADC1licz, weADC2licz, weADC3licz, weADC4licz,
-                     weADC5licz, weADC6licz, weADC7licz, weADC8licz };
-  time_t now = time(nullptr);
-
-  for (int i=0;i<8;++i) {
-    double v = vals[i];
-    const auto& c = cfg.analog[i];
+// Raz na klatkę AdcFrame (countReq liczy pomiary, nie obiegi loop()).
+static void processAnalog(const AdcFrame& fr) {
+  time_t now = fr.epoch;
+
+  const int n = fr.n < (int)aS.size() ? fr.n : (int)aS.size();
+  for (int i=0;i<n;++i) {
+    if (!(fr.valid & (1u << i))) continue;   // kanał wyłączony albo filtr się napełnia
+    adc_real_t v = fr.calc[i];
+    const auto& c = AlarmCfg::analog(i);
     auto& st = aS[i];
 
     bool overHi  = (v > c.hi);
@@ -154,8 +158,9 @@ static void processAnalog() {
             st.side  = overHi ? +1 : -1;
             st.tStartNorm = 0; st.nNorm = 0;
 
-            char yyy[8]; snprintf(yyy, sizeof(yyy), "A%03d", i+1);
-            logAlarm(String("Alarm przekroczenie wartości ") + String(v,6) + " dla wejścia " + yyy);
+            const char* yyy = AdcChannels::at(i).id;
+            logAlarm(String("Alarm przekroczenie wartości ") + String(v,6) + " dla wejścia " + yyy +
+                     analogContext(i, c.timeSec));
 
             // --- e-mail: start alarmu ---
             st.epoch = (uint32_t)now;
@@ -178,7 +183,7 @@ static void processAnalog() {
         if ((uint32_t)(now - st.tStartNorm) >= c.timeSec) {
           if (st.nNorm < 0xFFFF) ++st.nNorm;
           if (st.nNorm >= c.countReq) {
-            char yyy[8]; snprintf(yyy, sizeof(yyy), "A%03d", i+1);
+            const char* yyy = AdcChannels::at(i).id;
             logAlarm(String("powrót sygnału do normy na wejściu ") + yyy);
 
             // --- e-mail: powrót do normy (z tym samym epoch co start) ---
@@ -284,12 +289,17 @@ static void processBinary() {
 
 void loopTick() {
   ensureBase();
-  processAnalog();
+  static uint32_t lastSeq = 0;
+  if (adcLatestSeq() != lastSeq) {
+    const AdcFrame fr = adcLatest();
+    lastSeq = fr.seq;
+    processAnalog(fr);
+  }
   processBinary();
 
   // globalny WykrytoAlarm
   bool any = false;
-  for (int i=0;i<8;++i) if (aS[i].alarm) { any = true; break; }
+  for (const AnaState& a : aS) if (a.alarm) { any = true; break; }
   if (!any) for (int i=0;i<5;++i) if (bS[i].alarm) { any = true; break; }
   WykrytoAlarm = any;
 }
@@ -299,10 +309,12 @@ void getStatus(Status& s) {
   IO::readBinaryInputs(s.binIn);
   for (int i=0;i<4;++i) s.relay[i] = IO::getRelay(i+1);
 
-  s.anaVal[0]=weADC1licz; s.anaVal[1]=weADC2licz; s.anaVal[2]=weADC3licz; s.anaVal[3]=weADC4licz;
-  s.anaVal[4]=weADC5licz; s.anaVal[5]=weADC6licz; s.anaVal[6]=weADC7licz; s.anaVal[7]=weADC8licz;
+  const AdcFrame fr = adcLatest();
+  const int n = (int)aS.size();
+  s.anaActive.resize(n); s.anaSide.resize(n); s.anaVal.resize(n);
+  for (int i=0;i<n;++i) s.anaVal[i] = i < fr.n ? fr.calc[i] : 0;
 
-  for (int i=0;i<8;++i) { s.anaActive[i] = aS[i].alarm; s.anaSide[i] = aS[i].side; }
+  for (int i=0;i<n;++i) { s.anaActive[i] = aS[i].alarm; s.anaSide[i] = aS[i].side; }
   for (int i=0;i<5;++i) { s.binActive[i] = bS[i].alarm; }
 
   s.any = WykrytoAlarm;
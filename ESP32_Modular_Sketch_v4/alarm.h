@@ -22,6 +22,8 @@ const char* alarmBasePath(); // "/alarmy_<MAC>.txt"
 // alarm.h
 #pragma once
 #include <Arduino.h>
+#include "adc_real.h"
+#include <vector>
 
 namespace Alarm {
 
@@ -36,9 +38,10 @@ const char* alarmBasePath();
 struct Status {
   bool     binIn[5];      // GPIO 13,15,21,22,23
   bool     relay[4];      // O1..O4 (GPIO 16..19)
-  bool     anaActive[8];  // A001..A008 – czy w alarmie
-  int8_t   anaSide[8];    // +1:HI, -1:LO, 0:OK
-  double   anaVal[8];     // ostatnie przeliczone wartości (weADC?licz)
+  // kanały analogowe w kolejności rejestru AdcChannels
+  std::vector<bool>       anaActive;  // czy w alarmie
+  std::vector<int8_t>     anaSide;    // +1:HI, -1:LO, 0:OK
+  std::vector<adc_real_t> anaVal;     // przeliczone wartości z ostatniej klatki (adcLatest)
   bool     binActive[5];  // B001..B005 – czy w alarmie
   bool     any;           // czy jakikolwiek alarm aktywny
 };
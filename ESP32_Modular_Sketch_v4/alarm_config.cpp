@@ -1,4 +1,5 @@
 #include "alarm_config.h"
+#include "adc_channels.h"
 #include <LittleFS.h>
 #include <ArduinoJson.h>
 
@@ -7,7 +8,8 @@ namespace AlarmCfg {
 static Config g;
 
 void defaults(Config& c) {
-  for (int i=0;i<8;++i) {
+  c.analog.resize(AdcChannels::count());
+  for (size_t i=0;i<c.analog.size();++i) {
     c.analog[i].hi = 1e9;
     c.analog[i].lo = -1e9;
     c.analog[i].hystP = 0.0;
@@ -25,8 +27,14 @@ void defaults(Config& c) {
 
 Config get() { return g; }
 
+const AnalogCfg& analog(int i) {
+  static const AnalogCfg none = { (adc_real_t)1e9, (adc_real_t)-1e9, 0, 0, 0, 0 };
+  return (i >= 0 && i < (int)g.analog.size()) ? g.analog[i] : none;
+}
+
 void set(const Config& c) {
   g = c;
+  g.analog.resize(AdcChannels::count());
   (void)save();
 }
 
@@ -38,16 +46,21 @@ bool load() {
   File f = LittleFS.open("/alarm_config.json", "r");
   if (!f) { defaults(g); return save(); }
 
-  StaticJsonDocument<4096> doc;
+  JsonDocument doc;
   DeserializationError e = deserializeJson(doc, f);
   f.close();
   if (e) { defaults(g); return save(); }
 
   defaults(g); // start od defaults – nadpisz tylko to, co jest
-  for (int i=0;i<8;++i) {
+  for (size_t i=0;i<g.analog.size();++i) {
+    // klucz = id kanału z rejestru; dawne pliki: analog_<n> (n = pozycja + 1)
     char k[32];
-    snprintf(k,sizeof(k),"analog_%d", i+1);
+    snprintf(k,sizeof(k),"analog_%s", AdcChannels::at((int)i).id);
     JsonObject a = doc[k];
+    if (a.isNull()) {
+      snprintf(k,sizeof(k),"analog_%u", (unsigned)(i+1));
+      a = doc[k];
+    }
     if (!a.isNull()) {
       if (a["hi"].is<float>())    g.analog[i].hi = a["hi"].as<float>();
       if (a["lo"].is<float>())    g.analog[i].lo = a["lo"].as<float>();
@@ -72,10 +85,10 @@ bool load() {
 }
 
 bool save() {
-  StaticJsonDocument<4096> doc;
-  for (int i=0;i<8;++i) {
+  JsonDocument doc;
+  for (size_t i=0;i<g.analog.size();++i) {
     char k[32];
-    snprintf(k,sizeof(k),"analog_%d", i+1);
+    snprintf(k,sizeof(k),"analog_%s", AdcChannels::at((int)i).id);
     JsonObject a = doc.createNestedObject(k);
     a["hi"] = g.analog[i].hi;
     a["lo"] = g.analog[i].lo;
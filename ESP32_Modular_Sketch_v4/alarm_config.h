@@ -1,13 +1,15 @@
 #pragma once
 #include <Arduino.h>
+#include "adc_real.h"
+#include <vector>
 
 namespace AlarmCfg {
 
 struct AnalogCfg {
-  double  hi;       // próg górny
-  double  lo;       // próg dolny
-  double  hystP;    // histereza dla powrotu z alarmu „HI”: v <= hi - hystP
-  double  hystN;    // histereza dla powrotu z alarmu „LO”: v >= lo + hystN
+  adc_real_t hi;    // próg górny
+  adc_real_t lo;    // próg dolny
+  adc_real_t hystP; // histereza dla powrotu z alarmu „HI”: v <= hi - hystP
+  adc_real_t hystN; // histereza dla powrotu z alarmu „LO”: v >= lo + hystN
   uint16_t timeSec; // czas kwalifikacji (sekundy)
   uint16_t countReq;// ile kolejnych pomiarów po czasie (0..256)
 };
@@ -20,7 +22,7 @@ struct BinaryCfg {
 };
 
 struct Config {
-  AnalogCfg analog[8];
+  std::vector<AnalogCfg> analog;   // po jednym na kanał rejestru AdcChannels
   BinaryCfg binary[5];
 };
 
@@ -29,6 +31,9 @@ void set(const Config&);   // ustaw w RAM (i zapisz)
 bool load();               // z LittleFS (/alarm_config.json), gdy brak -> defaults i save()
 bool save();               // do LittleFS
 
+// progi kanału i bez kopiowania całego Config (detekcja co klatkę)
+const AnalogCfg& analog(int i);
+
 // ułatwienia
 void defaults(Config& c);
 
@@ -0,0 +1,406 @@
+#include "bin_series.h"
+#include "record_fmt.h"
+#include <time.h>
+
+namespace BinSeries {
+
+// ================== Czas (kalendarz gregoriański, bez strefy) ==================
+
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+  y -= m <= 2;
+  const int32_t  era = (y >= 0 ? y : y - 399) / 400;
+  const uint32_t yoe = (uint32_t)(y - era * 400);
+  const uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+static void civilFromDays(int32_t z, int32_t& y, uint32_t& m, uint32_t& d) {
+  z += 719468;
+  const int32_t  era = (z >= 0 ? z : z - 146096) / 146097;
+  const uint32_t doe = (uint32_t)(z - era * 146097);
+  const uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp  = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = (int32_t)yoe + era * 400 + (m <= 2);
+}
+
+uint32_t localSeconds(const struct tm& t) {
+  const int32_t days = daysFromCivil(t.tm_year + 1900, (uint32_t)t.tm_mon + 1, (uint32_t)t.tm_mday);
+  return (uint32_t)days * 86400u + (uint32_t)(t.tm_hour * 3600 + t.tm_min * 60 + t.tm_sec);
+}
+
+// jak Measure::pomTimeStamp()
+size_t formatStamp(uint32_t s, char* out, size_t cap) {
+  int32_t y; uint32_t m, d;
+  civilFromDays((int32_t)(s / 86400u), y, m, d);
+  const uint32_t r = s % 86400u;
+  int n = snprintf(out, cap, "%02u:%02u:%02u:%02u:%02u:%02u",
+                   (unsigned)(y % 100), (unsigned)m, (unsigned)d,
+                   (unsigned)(r / 3600), (unsigned)(r / 60 % 60), (unsigned)(r % 60));
+  return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+}
+
+// ================== Bajty i bity ==================
+
+namespace {
+
+struct ByteW {
+  uint8_t* p; size_t cap, n; bool ok;
+  void u8(uint8_t v) { if (n < cap) p[n++] = v; else ok = false; }
+  void varint(uint32_t v) {
+    while (v >= 0x80) { u8((uint8_t)(v | 0x80)); v >>= 7; }
+    u8((uint8_t)v);
+  }
+  void str(const char* s, size_t max) {
+    const size_t l = s ? strlen(s) : 0;
+    if (l > max) { ok = false; return; }
+    u8((uint8_t)l);
+    for (size_t i = 0; i < l; ++i) u8((uint8_t)s[i]);
+  }
+};
+
+struct ByteR {
+  const uint8_t* p; size_t n, pos; bool ok;
+  uint8_t u8() { if (pos < n) return p[pos++]; ok = false; return 0; }
+  uint32_t varint() {
+    uint32_t v = 0;
+    for (int sh = 0; sh < 35; sh += 7) {
+      const uint8_t c = u8();
+      v |= (uint32_t)(c & 0x7F) << sh;
+      if (!(c & 0x80)) return v;
+    }
+    ok = false;
+    return 0;
+  }
+  void str(char* out, size_t cap) {
+    const uint8_t l = u8();
+    if (l >= cap || pos + l > n) { ok = false; out[0] = 0; return; }
+    memcpy(out, p + pos, l);
+    out[l] = 0;
+    pos += l;
+  }
+};
+
+// MSB-first
+struct BitW {
+  uint8_t* p; size_t cap, bits; bool ok;
+  void put(uint64_t v, int n) {
+    while (n-- > 0) {
+      const size_t byte = bits >> 3;
+      if (byte >= cap) { ok = false; return; }
+      if ((bits & 7) == 0) p[byte] = 0;
+      if ((v >> n) & 1) p[byte] |= (uint8_t)(0x80 >> (bits & 7));
+      ++bits;
+    }
+  }
+};
+
+struct BitR {
+  const uint8_t* p; size_t n, bits; bool ok;
+  uint64_t get(int k) {
+    uint64_t v = 0;
+    while (k-- > 0) {
+      const size_t byte = bits >> 3;
+      if (byte >= n) { ok = false; return 0; }
+      v = (v << 1) | ((p[byte] >> (7 - (bits & 7))) & 1);
+      ++bits;
+    }
+    return v;
+  }
+};
+
+const uint8_t kNoWindow = 0xFF;
+
+// XOR z poprzednią wartością: W = 32/64 bity, LB = bity pól okna (5/6)
+void putValue(BitW& w, uint64_t v, uint64_t& prev, uint8_t& lead, uint8_t& trail, int W, int LB) {
+  const uint64_t x = v ^ prev;
+  prev = v;
+  if (!x) { w.put(0, 1); return; }
+  const int lz = __builtin_clzll(x) - (64 - W);
+  const int tz = __builtin_ctzll(x);
+  if (lead != kNoWindow && lz >= lead && tz >= trail) {
+    w.put(2, 2);
+    w.put(x >> trail, W - lead - trail);
+    return;
+  }
+  const int len = W - lz - tz;
+  w.put(3, 2);
+  w.put((uint64_t)lz, LB);
+  w.put((uint64_t)(len - 1), LB);
+  w.put(x >> tz, len);
+  lead  = (uint8_t)lz;
+  trail = (uint8_t)tz;
+}
+
+uint64_t getValue(BitR& r, uint64_t& prev, uint8_t& lead, uint8_t& trail, int W, int LB) {
+  if (!r.get(1)) return prev;
+  if (!r.get(1)) {
+    if (lead == kNoWindow) { r.ok = false; return prev; }
+    prev ^= r.get(W - lead - trail) << trail;
+    return prev;
+  }
+  const int lz  = (int)r.get(LB);
+  const int len = (int)r.get(LB) + 1;
+  if (lz + len > W) { r.ok = false; return prev; }
+  lead  = (uint8_t)lz;
+  trail = (uint8_t)(W - lz - len);
+  prev ^= r.get(len) << trail;
+  return prev;
+}
+
+uint64_t realBits(adc_real_t v) {
+#if ADC_USE_DOUBLE
+  uint64_t b; memcpy(&b, &v, 8); return b;
+#else
+  uint32_t b; memcpy(&b, &v, 4); return b;
+#endif
+}
+
+}  // namespace
+
+// ================== Encoder ==================
+
+void Encoder::reset() {
+  key_      = true;
+  sinceKey_ = 0;
+  lastSec_  = 0;
+  layout_   = 0;
+  seq_      = 0;
+}
+
+uint16_t Encoder::layoutCrc(const Sample& s) const {
+  uint16_t c = 0xFFFF;
+  auto add = [&](const char* t) { c = RecordFmt::crc16Update(c, t ? t : "", (t ? strlen(t) : 0) + 1); };
+  add(s.imei);
+  add(s.outputs);
+  for (int i = 0; i < s.nRows; ++i) { add(s.rows[i].id); add(s.rows[i].raw); add(s.rows[i].calc); }
+  return c;
+}
+
+size_t Encoder::encode(const Sample& s, uint8_t* out, size_t cap) {
+  if (s.nRows < 0 || s.nRows > kMaxRows || cap < 16) return 0;
+  int nChan = 0;
+  for (int i = 0; i < s.nRows; ++i) if (!s.rows[i].raw) ++nChan;
+  if (nChan > ADC_MAX_CHANNELS) return 0;
+
+  const uint16_t lay = layoutCrc(s);
+  const bool key = key_ || lay != layout_ || sinceKey_ >= kKeyEvery - 1;
+  const bool f64 = sizeof(adc_real_t) == 8;
+  const int  W   = f64 ? 64 : 32;
+  const int  LB  = f64 ? 6 : 5;
+
+  // ciało od out[3]: magic + varint długości (<= 2 B dla kMaxBody)
+  const size_t bodyCap = cap - 5 < kMaxBody ? cap - 5 : kMaxBody;
+  ByteW b = { out + 3, bodyCap, 0, true };
+  b.u8((uint8_t)((key ? FLAG_KEY : 0) | (f64 ? FLAG_F64 : 0)));
+  b.u8((uint8_t)(seq_ + 1));
+  if (key) {
+    b.varint(s.localSec);
+  } else {
+    const int32_t dt = (int32_t)(s.localSec - lastSec_);
+    b.varint(((uint32_t)dt << 1) ^ (uint32_t)(dt >> 31));   // zigzag
+  }
+  b.u8(s.xyz);
+  b.u8(s.gsm);
+  if (key) {
+    b.str(s.imei, 23);
+    b.str(s.outputs, 15);
+    b.u8((uint8_t)s.nRows);
+    for (int i = 0; i < s.nRows; ++i) {
+      const Row& r = s.rows[i];
+      b.u8(r.raw ? 1 : 0);
+      b.str(r.id, 7);
+      if (r.raw) { b.str(r.raw, 15); b.str(r.calc, 15); }
+    }
+    for (int i = 0; i < 2 * ADC_MAX_CHANNELS; ++i) { prev_[i] = 0; lead_[i] = kNoWindow; trail_[i] = 0; }
+  }
+  if (!b.ok) { key_ = true; return 0; }
+
+  BitW w = { b.p + b.n, b.cap - b.n, 0, true };
+  for (int j = 0; j < nChan; ++j) {
+    putValue(w, realBits(s.raw[j]),  prev_[2*j],   lead_[2*j],   trail_[2*j],   W, LB);
+    putValue(w, realBits(s.calc[j]), prev_[2*j+1], lead_[2*j+1], trail_[2*j+1], W, LB);
+  }
+  if (!w.ok) { key_ = true; return 0; }   // stan XOR rozjechany – następna ramka KEY
+
+  size_t len = b.n + (w.bits + 7) / 8;
+  size_t h = 0;
+  out[h++] = kMagic;
+  if (len < 0x80) {
+    out[h++] = (uint8_t)len;
+    memmove(out + 2, out + 3, len);
+  } else {
+    out[h++] = (uint8_t)(len | 0x80);
+    out[h++] = (uint8_t)(len >> 7);
+  }
+  const uint16_t crc = RecordFmt::crc16Update(0xFFFF, out + h, len);
+  out[h + len]     = (uint8_t)(crc & 0xFF);
+  out[h + len + 1] = (uint8_t)(crc >> 8);
+
+  key_      = false;
+  layout_   = lay;
+  lastSec_  = s.localSec;
+  sinceKey_ = key ? 0 : sinceKey_ + 1;
+  ++seq_;
+  return h + len + 2;
+}
+
+// ================== Decoder ==================
+
+void Decoder::reset() {
+  st_      = Stats();
+  len_     = 0;
+  haveKey_ = false;
+  resync_  = false;
+}
+
+void Decoder::consume(size_t k) {
+  memmove(buf_, buf_ + k, len_ - k);
+  len_ -= k;
+}
+
+void Decoder::reject(size_t k) {
+  if (!resync_) ++st_.badFrames;
+  else st_.skipped += k;
+  resync_  = true;
+  haveKey_ = false;
+  consume(k);
+}
+
+void Decoder::feed(const uint8_t* data, size_t n) {
+  while (n) {
+    size_t take = kMaxFrame - len_;
+    if (take > n) take = n;
+    memcpy(buf_ + len_, data, take);
+    len_ += take; data += take; n -= take;
+    while (parse()) {}
+  }
+}
+
+void Decoder::finish() {
+  while (parse()) {}
+  if (len_) {                       // przerwany zapis ostatniej ramki
+    if (!resync_) ++st_.badFrames;
+    else st_.skipped += len_;
+    len_ = 0;
+  }
+}
+
+long frameSize(const uint8_t* b, size_t n) {
+  if (!n) return 0;
+  if (b[0] != kMagic) return -1;
+  uint32_t blen = 0;
+  size_t p = 1;
+  for (int sh = 0;; sh += 7) {
+    if (p >= n) return 0;
+    const uint8_t c = b[p++];
+    blen |= (uint32_t)(c & 0x7F) << sh;
+    if (!(c & 0x80)) break;
+    if (sh >= 7) return -1;
+  }
+  if (blen == 0 || blen > kMaxBody) return -1;
+  if (n < p + blen + 2) return 0;
+  const uint16_t crc = RecordFmt::crc16Update(0xFFFF, b + p, blen);
+  if (crc != (uint16_t)(b[p + blen] | (b[p + blen + 1] << 8))) return -1;
+  return (long)(p + blen + 2);
+}
+
+bool Decoder::parse() {
+  size_t i = 0;
+  while (i < len_ && buf_[i] != kMagic) ++i;
+  if (i) { st_.skipped += i; consume(i); }
+
+  const long fl = frameSize(buf_, len_);
+  if (fl == 0) return false;
+  if (fl < 0) { reject(1); return true; }
+  size_t p = 2;                        // nagłówek: magic + varint (1-2 B)
+  if (buf_[1] & 0x80) p = 3;
+  const int rc = decodeBody(buf_ + p, fl - p - 2);
+  if (rc < 0) { reject(fl); return true; }
+  if (rc > 0) ++st_.frames;
+  else        ++st_.dropped;
+  resync_ = false;
+  consume(fl);
+  return true;
+}
+
+int Decoder::decodeBody(const uint8_t* body, size_t n) {
+  ByteR r = { body, n, 0, true };
+  const uint8_t flags = r.u8();
+  const uint8_t seq   = r.u8();
+  const bool key = flags & FLAG_KEY;
+  if (!key && (!haveKey_ || seq != (uint8_t)(seq_ + 1) || (bool)(flags & FLAG_F64) != f64_)) {
+    haveKey_ = false;   // łańcuch XOR przerwany – czekaj na KEY
+    return 0;
+  }
+
+  uint32_t sec;
+  if (key) {
+    sec = r.varint();
+  } else {
+    const uint32_t z = r.varint();
+    sec = lastSec_ + (uint32_t)((int32_t)(z >> 1) ^ -(int32_t)(z & 1));
+  }
+  const uint8_t xyz = r.u8();
+  const uint8_t gsm = r.u8();
+
+  if (key) {
+    haveKey_ = false;
+    r.str(imei_, sizeof(imei_));
+    r.str(outputs_, sizeof(outputs_));
+    nRows_ = r.u8();
+    nChan_ = 0;
+    if (nRows_ > kMaxRows) return -1;
+    for (int i = 0; i < nRows_ && r.ok; ++i) {
+      isLit_[i] = r.u8() != 0;
+      r.str(ids_[i], sizeof(ids_[i]));
+      if (isLit_[i]) { r.str(lit_[i][0], sizeof(lit_[i][0])); r.str(lit_[i][1], sizeof(lit_[i][1])); }
+      else ++nChan_;
+    }
+    if (!r.ok || nChan_ > ADC_MAX_CHANNELS) return -1;
+    f64_ = flags & FLAG_F64;
+    for (int i = 0; i < 2 * ADC_MAX_CHANNELS; ++i) { prev_[i] = 0; lead_[i] = kNoWindow; trail_[i] = 0; }
+  }
+  if (!r.ok) return -1;
+
+  const int W  = f64_ ? 64 : 32;
+  const int LB = f64_ ? 6 : 5;
+  double v[2 * ADC_MAX_CHANNELS];
+  BitR br = { body + r.pos, n - r.pos, 0, true };
+  for (int j = 0; j < 2 * nChan_; ++j) {
+    const uint64_t bits = getValue(br, prev_[j], lead_[j], trail_[j], W, LB);
+    if (f64_) { double d; memcpy(&d, &bits, 8); v[j] = d; }
+    else      { float f; const uint32_t b32 = (uint32_t)bits; memcpy(&f, &b32, 4); v[j] = f; }
+  }
+  if (!br.ok) return -1;
+
+  haveKey_ = true;
+  seq_     = seq;
+  lastSec_ = sec;
+
+  char stamp[24], xyzS[4], gsmS[4];
+  const size_t stampLen = formatStamp(sec, stamp, sizeof(stamp));
+  snprintf(xyzS, sizeof(xyzS), "%03u", (unsigned)(xyz % 1000));
+  snprintf(gsmS, sizeof(gsmS), "%u", (unsigned)gsm);
+
+  RecordFmt::Line line;
+  line.field(imei_);
+  line.mark();
+  int ch = 0;
+  for (int i = 0; i < nRows_; ++i) {
+    line.rewind();
+    line.field(ids_[i]).field(stamp, stampLen).field(xyzS);
+    if (isLit_[i]) line.field(lit_[i][0]).field(lit_[i][1]);
+    else { line.fixed6(v[2*ch]).fixed6(v[2*ch+1]); ++ch; }
+    line.field(gsmS).field(outputs_);
+    size_t ln = 0;
+    const char* l = line.finish(&ln);
+    if (l) { emit_(ctx_, l, ln); ++st_.lines; }
+  }
+  return 1;
+}
+
+} // namespace BinSeries
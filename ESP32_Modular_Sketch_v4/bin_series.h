@@ -0,0 +1,129 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"   // adc_real_t, ADC_MAX_CHANNELS
+
+// Binarny zapis pomiarów (D_<MAC>.bin) zamiast 11 linii CSV na pomiar.
+// Plik to ciąg ramek, jedna na wywołanie myTestPomiar():
+//
+//   0xB5 | varint len | body[len] | CRC16 Modbus(body), LE
+//
+//   body: u8 flags (KEY, F64) | u8 seq | czas | u8 xyz | u8 poziom_GSM
+//         [KEY: str IMEI | str stan_wyjsc | u8 wiersze | wiersz...]
+//         | bity wartości raw/calc kanałów (XOR jak w Gorilla)
+//   czas: KEY – varint czasu lokalnego [s], dalej – zigzag varint różnicy
+//   wiersz: u8 rodzaj (0 = kanał, 1 = stały rekord) | str id
+//           [stały: str raw | str calc]       (str = u8 długość + bajty)
+//
+// Wartość kanału koduje się jako XOR z poprzednią wartością tego kanału:
+// '0' gdy bez zmian, '10' + bity znaczące w oknie poprzedniej wartości,
+// '11' + zera wiodące + długość + bity znaczące (nowe okno). Ramka KEY
+// zaczyna od zera i powtarza układ wierszy – dekodowanie może ruszyć od
+// każdej ramki KEY. seq rośnie o 1 na ramkę: po uszkodzonej albo brakującej
+// ramce dekoder szuka kolejnego 0xB5 i pomija ramki do najbliższej KEY.
+//
+// Decoder odtwarza dokładnie dzisiejsze linie CSV (razem z CRC16) –
+// przy wysyłce na FTP i w narzędziu hosta esp_sim_bin2csv.
+namespace BinSeries {
+
+static const uint8_t kMagic     = 0xB5;
+static const size_t  kMaxBody   = 2048;
+static const size_t  kMaxFrame  = kMaxBody + 8;
+static const int     kMaxRows   = ADC_MAX_CHANNELS + 8;
+static const int     kKeyEvery  = 64;    // co ile ramek ramka KEY
+
+enum : uint8_t { FLAG_KEY = 0x01, FLAG_F64 = 0x02 };
+
+// wiersz rekordu: kanał (raw == nullptr, wartość z tablic) albo stały rekord
+struct Row {
+  const char* id;
+  const char* raw;
+  const char* calc;
+};
+
+struct Sample {
+  uint32_t          localSec;  // czas lokalny jako sekundy od 1970 (localtime + strefa)
+  uint8_t           xyz;       // 0..100
+  uint8_t           gsm;       // 0..99
+  const char*       imei;
+  const char*       outputs;   // stan_wyjsc
+  const Row*        rows;
+  int               nRows;
+  const adc_real_t* raw;       // po jednej wartości na wiersz-kanał, w kolejności
+  const adc_real_t* calc;
+};
+
+// struct tm (lokalny) <-> sekundy bez strefy czasowej
+uint32_t localSeconds(const struct tm& t);
+size_t   formatStamp(uint32_t localSec, char* out, size_t cap);   // RR:MM:DD:GG:NN:SS
+
+// Ramka od b[0]: długość całej ramki (poprawne magic, długość i CRC),
+// 0 = za mało danych, -1 = to nie jest poprawna ramka
+long     frameSize(const uint8_t* b, size_t n);
+
+class Encoder {
+ public:
+  Encoder() { reset(); }
+  void   reset();   // następna ramka będzie KEY (nowy plik, po restarcie)
+  // ramka gotowa do dopisania; długość albo 0 (za dużo wierszy/za długa)
+  size_t encode(const Sample& s, uint8_t* out, size_t cap);
+
+ private:
+  uint16_t layoutCrc(const Sample& s) const;
+
+  uint32_t lastSec_;
+  uint16_t layout_;
+  int      sinceKey_;
+  uint8_t  seq_;
+  bool     key_;
+  uint64_t prev_[2 * ADC_MAX_CHANNELS];
+  uint8_t  lead_[2 * ADC_MAX_CHANNELS], trail_[2 * ADC_MAX_CHANNELS];
+};
+
+// Dekoder strumieniowy: feed() przyjmuje dowolne kawałki pliku, emit()
+// dostaje kolejne linie CSV ("...;CRC16;\r\n").
+class Decoder {
+ public:
+  typedef void (*Emit)(void* ctx, const char* line, size_t n);
+
+  struct Stats {
+    uint32_t frames;     // poprawnie zdekodowane
+    uint32_t lines;
+    uint32_t badFrames;  // błąd CRC/struktury (kolejne przy szukaniu ramki – w skipped)
+    uint32_t dropped;    // poprawne ramki pominięte do najbliższej KEY
+    uint32_t skipped;    // bajty pominięte przy szukaniu 0xB5
+  };
+
+  Decoder(Emit emit, void* ctx) : emit_(emit), ctx_(ctx) { reset(); }
+  void  reset();
+  void  feed(const uint8_t* data, size_t n);
+  // koniec danych; niepełna ramka na końcu (przerwany zapis) -> badFrames
+  void  finish();
+  const Stats& stats() const { return st_; }
+
+ private:
+  bool parse();                                    // jedna ramka z buf_, false = brak danych
+  int  decodeBody(const uint8_t* b, size_t n);     // 1 = linie wysłane, 0 = pominięta, -1 = błąd
+  void consume(size_t k);
+  void reject(size_t k);
+
+  Emit     emit_;
+  void*    ctx_;
+  Stats    st_;
+  uint8_t  buf_[kMaxFrame];
+  size_t   len_;
+  bool     resync_;
+
+  bool     haveKey_;
+  uint8_t  seq_;
+  bool     f64_;
+  uint32_t lastSec_;
+  char     imei_[24], outputs_[16];
+  int      nRows_, nChan_;
+  char     ids_[kMaxRows][8];
+  char     lit_[kMaxRows][2][16];
+  bool     isLit_[kMaxRows];
+  uint64_t prev_[2 * ADC_MAX_CHANNELS];
+  uint8_t  lead_[2 * ADC_MAX_CHANNELS], trail_[2 * ADC_MAX_CHANNELS];
+};
+
+} // namespace BinSeries
@@ -1,13 +1,16 @@
 #include "cfg_sync.h"
 #include "config.h"
 #include "alarm_config.h"
+#include "adc_channels.h"
+#include "adc_profiles.h"
 #include "email_config.h"
 #include "ftp_upload.h"
+#include "ftp_session.h"
+#include "ftp_utils.h"
 #include "gsm_wifi.h"
 #include "log.h"
 
 #include <LittleFS.h>
-#include <WiFiClient.h>
 #include <vector>
 #include "measurement.h"
 
@@ -25,139 +28,33 @@ namespace {
     return String((unsigned long)time(nullptr));
   }
 
-  // Prosty FTP klient „ad hoc” (minimum do: CWD, SIZE/LIST, RETR, RNFR/RNTO)
-  // Używamy Net::client() z Twojej warstwy sieci
-  class FtpClient {
-  public:
-    bool connected = false;
-    WiFiClient ctrl;
-    WiFiClient data;
-
-    bool connectCtrl(const String& host, uint16_t port){
-      if (connected) return true;
-      if (!ctrl.connect(host.c_str(), port)) return false;
-      if (!expect2xx()) { ctrl.stop(); return false; }
-      connected = true;
-      return true;
+  // RETR do lokalnego pliku na wspólnej sesji (ftp_session.h); DATA na host
+  // kontrolny jak przy wysyłce
+  bool retrToFile(Client& ctrl, const String& remote, const String& localPath){
+    uint16_t port = 0;
+    if (!ftpEnterPassive(ctrl, port)) return false;
+    Client* data = Net::newClient();
+    if (!data) return false;
+    if (!data->connect(FtpSession::host().c_str(), port)) { Net::disposeClient(data); return false; }
+    ftpSend(ctrl, "RETR " + remote);
+    int code = ftpReadCode(ctrl, nullptr, 8000);
+    if (code != 150 && code != 125) { data->stop(); Net::disposeClient(data); return false; }
+
+    File f = LittleFS.open(localPath, "w");
+    if (!f) { data->stop(); Net::disposeClient(data); (void)ftpReadCode(ctrl); return false; }
+
+    uint8_t buf[1024];
+    unsigned long t0 = millis();
+    while (data->connected() || data->available()) {
+      int n = data->read(buf, sizeof(buf));
+      if (n>0) { f.write(buf, n); t0 = millis(); }
+      else { delay(2); if (millis()-t0>3000) break; }
     }
-
-    void quit(){
-      if (!connected) return;
-      send("QUIT");
-      ctrl.stop();
-      connected = false;
-    }
-
-    bool login(const String& user, const String& pass){
-      if (!send("USER " + user)) return false;
-      if (!expect3xx() && !expect2xxPeek()) return false;
-      if (!send("PASS " + pass)) return false;
-      if (!expect2xx()) return false;
-      return true;
-    }
-
-    bool cwd(const String& dir){
-      if (dir.length()==0) return true; // bieżący
-      if (!send("CWD " + dir)) return false;
-      return expect2xx();
-    }
-
-    // Sprawdza czy plik istnieje (SIZE)
-    bool exists(const String& name){
-      if (!send("SIZE " + name)) return false;
-      // 213 size - istnieje; 550 - brak
-      int code = readCode();
-      return code == 213;
-    }
-
-    // Tryb pasywny -> ustawia data socket
-    bool pasv(){
-      if (!send("PASV")) return false;
-      String line = readLine(5000);
-      if (!line.startsWith("227")) return false;
-      int l = line.indexOf('('), r = line.indexOf(')');
-      if (l<0 || r<0 || r<=l+1) return false;
-      String p = line.substring(l+1, r);
-      int a1,a2,a3,a4,p1,p2;
-      if (sscanf(p.c_str(), "%d,%d,%d,%d,%d,%d",&a1,&a2,&a3,&a4,&p1,&p2) != 6) return false;
-      uint16_t port = (p1<<8) | p2;
-      char host[32]; snprintf(host,sizeof(host), "%d.%d.%d.%d", a1,a2,a3,a4);
-      if (!data.connect(host, port)) return false;
-      return true;
-    }
-
-    // RETR do lokalnego pliku
-    bool retrToFile(const String& remote, const String& localPath){
-      if (!pasv()) return false;
-      if (!send("RETR " + remote)) { data.stop(); return false; }
-      int code = readCode();
-      if (code != 150 && code != 125) { data.stop(); return false; }
-
-      File f = LittleFS.open(localPath, "w");
-      if (!f) { data.stop(); (void)readCode(); return false; }
-
-      uint8_t buf[1024];
-      unsigned long t0 = millis();
-      while (data.connected() || data.available()) {
-        int n = data.read(buf, sizeof(buf));
-        if (n>0) { f.write(buf, n); t0 = millis(); }
-        else { delay(2); if (millis()-t0>3000) break; }
-      }
-      f.close();
-      data.stop();
-      return expect2xx();
-    }
-
-    bool rename(const String& from, const String& to){
-      if (!send("RNFR " + from)) return false;
-      if (!expect3xx()) return false;
-      if (!send("RNTO " + to)) return false;
-      return expect2xx();
-    }
-
-  private:
-    bool send(const String& cmd){
-      String c = cmd + "\r\n";
-      // LOGD("FTP >> %s", cmd.c_str());
-      return ctrl.print(c) == (int)c.length();
-    }
-    int readCode(){
-      String line = readLine(5000);
-      if (line.length() < 3) return 0;
-      int code = line.substring(0,3).toInt();
-      // LOGD("FTP << %s", line.c_str());
-      // Jeśli są linie wielowierszowe (format 123- ... 123 ...), czytamy do końca:
-      if (line.length()>=4 && line[3]=='-') {
-        while (true) {
-          String l2 = readLine(5000);
-          // LOGD("FTP << %s", l2.c_str());
-          if (l2.length()>=4 && l2.startsWith(String(code)) && l2[3]==' ') break;
-        }
-      }
-      return code;
-    }
-    bool expect2xx(){
-      int c = readCode();
-      return c>=200 && c<300;
-    }
-    bool expect2xxPeek(){
-      ctrl.setTimeout(5000);
-      String line = ctrl.readStringUntil('\n'); // pojedyncza
-      if (line.length()<3) return false;
-      int code = line.substring(0,3).toInt();
-      return code>=200 && code<300;
-    }
-    bool expect3xx(){
-      int c = readCode();
-      return c>=300 && c<400;
-    }
-    String readLine(uint32_t to=3000){
-      ctrl.setTimeout(to);
-      String s = ctrl.readStringUntil('\n');
-      s.trim();
-      return s;
-    }
-  };
+    f.close();
+    data->stop(); Net::disposeClient(data);
+    code = ftpReadCode(ctrl, nullptr, 8000);
+    return code>=200 && code<300;
+  }
 
   // ------------------ GENERATOR FULL CONFIG (key=value) ------------------
 
@@ -184,19 +81,28 @@ namespace {
     out += "cfg.ftp_user="      + c.ftp_user      + "\n";
     out += "cfg.ftp_pass="      + c.ftp_pass      + "\n";
     out += "cfg.ftp_dir="       + c.ftp_dir       + "\n";
+    out += "cfg.ftp_gzip="      + String(c.ftp_gzip ? 1 : 0) + "\n";
     out += "cfg.http_user="     + c.http_user     + "\n";
     out += "cfg.http_pass="     + c.http_pass     + "\n";
     out += "cfg.sendFTPInterval_sec=" + String(c.sendFTPInterval_sec) + "\n";
+    out += "cfg.data_bin="      + String(c.data_bin ? 1 : 0) + "\n";
+    out += "cfg.hist_hours="    + String(c.hist_hours) + "\n";
+    out += "cfg.hist_ram_min="  + String(c.hist_ram_min) + "\n";
+    out += "cfg.roll_1m_days="  + String(c.roll_1m_days) + "\n";
+    out += "cfg.roll_1h_months="+ String(c.roll_1h_months) + "\n";
+    out += "cfg.ftpq_drain_ms=" + String(c.ftpq_drain_ms) + "\n";
+    out += "cfg.ftpq_drain_kb=" + String(c.ftpq_drain_kb) + "\n";
 
     out += "\n# ====== ALARM ======\n";
     auto ac = AlarmCfg::get();
-    for (int i=0;i<8;++i){
-      out += "alarm.ana[" + String(i) + "].hi="      + String(ac.analog[i].hi,6) + "\n";
-      out += "alarm.ana[" + String(i) + "].lo="      + String(ac.analog[i].lo,6) + "\n";
-      out += "alarm.ana[" + String(i) + "].hystP="   + String(ac.analog[i].hystP,6) + "\n";
-      out += "alarm.ana[" + String(i) + "].hystN="   + String(ac.analog[i].hystN,6) + "\n";
-      out += "alarm.ana[" + String(i) + "].timeSec=" + String(ac.analog[i].timeSec) + "\n";
-      out += "alarm.ana[" + String(i) + "].countReq="+ String(ac.analog[i].countReq) + "\n";
+    for (int i=0;i<(int)ac.analog.size();++i){
+      const String id = AdcChannels::at(i).id;   // klucze wg rejestru (przyjmowany też indeks)
+      out += "alarm.ana[" + id + "].hi="      + String(ac.analog[i].hi,6) + "\n";
+      out += "alarm.ana[" + id + "].lo="      + String(ac.analog[i].lo,6) + "\n";
+      out += "alarm.ana[" + id + "].hystP="   + String(ac.analog[i].hystP,6) + "\n";
+      out += "alarm.ana[" + id + "].hystN="   + String(ac.analog[i].hystN,6) + "\n";
+      out += "alarm.ana[" + id + "].timeSec=" + String(ac.analog[i].timeSec) + "\n";
+      out += "alarm.ana[" + id + "].countReq="+ String(ac.analog[i].countReq) + "\n";
     }
     for (int i=0;i<5;++i){
       out += "alarm.bin[" + String(i) + "].mode="     + String(ac.binary[i].mode) + "\n";
@@ -205,6 +111,21 @@ namespace {
       out += "alarm.bin[" + String(i) + "].countReq=" + String(ac.binary[i].countReq) + "\n";
     }
 
+    out += "\n# ====== ADC (rejestr kanałów: profil + kalibracja) ======\n";
+    for (int i=0;i<AdcChannels::count();++i){
+      const AdcChannels::Channel& rc = AdcChannels::at(i);
+      const AdcProfiles::Profile p = AdcProfiles::get(i);
+      const String id = rc.id;
+      char hw[24]; snprintf(hw, sizeof(hw), "# %s: 0x%02X CH%u\n", rc.id, rc.addr, (unsigned)rc.input + 1);
+      out += hw;
+      out += "adc[" + id + "].bits="     + String(p.bits) + "\n";
+      out += "adc[" + id + "].gain="     + String(p.gain) + "\n";
+      out += "adc[" + id + "].periodMs=" + String((unsigned long)p.periodMs) + "\n";
+      out += "adc[" + id + "].depth="    + String(p.depth) + "\n";
+      out += "adc[" + id + "].A="        + String(rc.A,6) + "\n";
+      out += "adc[" + id + "].B="        + String(rc.B,6) + "\n";
+    }
+
     out += "\n# ====== EMAIL ======\n";
     EmailCfg::Settings es; EmailCfg::load(es);
     out += "mail.enabled="  + String(es.enabled?1:0) + "\n";
@@ -242,6 +163,12 @@ namespace {
   static bool toU32(const String& s, uint32_t& out){ char* e=nullptr; unsigned long v=strtoul(s.c_str(), &e, 10); if(e && *e==0){ out=(uint32_t)v; return true;} return false; }
   static bool toF64(const String& s, double& out){ char* e=nullptr; double v=strtod(s.c_str(), &e); if(e && *e==0){ out=v; return true;} return false; }
 
+  // "A003" -> indeks w rejestrze AdcChannels; liczba -> indeks wprost
+  static int channelIndex(const String& s){
+    int i; if (toInt(s, i)) return (i>=0 && i<AdcChannels::count()) ? i : -1;
+    return AdcChannels::find(s);
+  }
+
   // Zastosuj jedną parę key=value
   static void applyKV(const String& k, const String& v,
                       ConfigData& cfg,
@@ -267,15 +194,23 @@ namespace {
     else if (k=="cfg.ftp_user") cfg.ftp_user = v;
     else if (k=="cfg.ftp_pass") cfg.ftp_pass = v;
     else if (k=="cfg.ftp_dir")  cfg.ftp_dir = v;
+    else if (k=="cfg.ftp_gzip"){ int t; if(toInt(v,t)) cfg.ftp_gzip=(t!=0); }
     else if (k=="cfg.http_user") cfg.http_user = v;
     else if (k=="cfg.http_pass") cfg.http_pass = v;
     else if (k=="cfg.sendFTPInterval_sec"){ uint32_t t; if(toU32(v,t)) cfg.sendFTPInterval_sec=t; }
     else if (k=="cfg.cfgSyncInterval_sec"){ uint32_t t; if(toU32(v,t)) cfg.cfgSyncInterval_sec=t; }
-
-    // ---- alarm.ana[i].*
+    else if (k=="cfg.data_bin"){ int t; if(toInt(v,t)) cfg.data_bin=(t!=0); }
+    else if (k=="cfg.hist_hours"){ uint32_t t; if(toU32(v,t)) cfg.hist_hours=t; }
+    else if (k=="cfg.hist_ram_min"){ uint32_t t; if(toU32(v,t)) cfg.hist_ram_min=t; }
+    else if (k=="cfg.roll_1m_days"){ uint32_t t; if(toU32(v,t)) cfg.roll_1m_days=t; }
+    else if (k=="cfg.roll_1h_months"){ uint32_t t; if(toU32(v,t)) cfg.roll_1h_months=t; }
+    else if (k=="cfg.ftpq_drain_ms"){ uint32_t t; if(toU32(v,t)) cfg.ftpq_drain_ms=t; }
+    else if (k=="cfg.ftpq_drain_kb"){ uint32_t t; if(toU32(v,t)) cfg.ftpq_drain_kb=t; }
+
+    // ---- alarm.ana[i].* (i = id kanału albo indeks w rejestrze)
     else if (k.startsWith("alarm.ana[")) {
-      int idx = k.substring(10, k.indexOf(']')).toInt();
-      if (idx>=0 && idx<8) {
+      int idx = channelIndex(k.substring(10, k.indexOf(']')));
+      if (idx>=0 && idx<(int)ac.analog.size()) {
         if (k.endsWith("].hi"))      { double d; if(toF64(v,d)) ac.analog[idx].hi=d; }
         else if (k.endsWith("].lo")) { double d; if(toF64(v,d)) ac.analog[idx].lo=d; }
         else if (k.endsWith("].hystP")){ double d; if(toF64(v,d)) ac.analog[idx].hystP=d; }
@@ -284,6 +219,22 @@ namespace {
         else if (k.endsWith("].countReq")){ int t; if(toInt(v,t)) ac.analog[idx].countReq=t; }
       }
     }
+    // ---- adc[id].* – profil akwizycji i kalibracja kanału
+    else if (k.startsWith("adc[")) {
+      int idx = channelIndex(k.substring(4, k.indexOf(']')));
+      if (idx>=0) {
+        AdcProfiles::Profile p = AdcProfiles::get(idx);
+        const AdcChannels::Channel& rc = AdcChannels::at(idx);
+        int t; uint32_t u; double d;
+        if      (k.endsWith("].bits"))     { if(toInt(v,t)) p.bits=t; }
+        else if (k.endsWith("].gain"))     { if(toInt(v,t)) p.gain=t; }
+        else if (k.endsWith("].periodMs")) { if(toU32(v,u)) p.periodMs=u; }
+        else if (k.endsWith("].depth"))    { if(toInt(v,t)) p.depth=(uint8_t)(t<1?1:t>AdcProfiles::kMaxDepth?AdcProfiles::kMaxDepth:t); }
+        else if (k.endsWith("].A"))        { if(toF64(v,d)) AdcChannels::setCal(idx, (float)d, rc.B); }
+        else if (k.endsWith("].B"))        { if(toF64(v,d)) AdcChannels::setCal(idx, rc.A, (float)d); }
+        AdcProfiles::set(idx, p);
+      }
+    }
     // ---- alarm.bin[i].*
     else if (k.startsWith("alarm.bin[")) {
       int idx = k.substring(10, k.indexOf(']')).toInt();
@@ -336,6 +287,8 @@ namespace {
     // Zapisz wszystkie sekcje
     Config::save(cfg);
     AlarmCfg::set(ac);
+    AdcProfiles::save();
+    AdcChannels::save();
     EmailCfg::save(es);
     //Dzięki temu interwały „żyją” od razu po zdalnej zmianie:
     Measure::setSendFTPInterval(cfg.sendFTPInterval_sec);
@@ -363,59 +316,59 @@ static bool processOnce(){
   auto& cfg = Config::get();
   if (cfg.ftp_host.length()==0) return false;
 
-  FtpClient ftp;
-  if (!ftp.connectCtrl(cfg.ftp_host, cfg.ftp_port)) { LOGW("CfgSync: ctrl connect fail"); return false; }
-  if (!ftp.login(cfg.ftp_user, cfg.ftp_pass))       { LOGW("CfgSync: login fail"); ftp.quit(); return false; }
-  if (!ftp.cwd(cfg.ftp_dir))                        { LOGW("CfgSync: CWD fail"); ftp.quit(); return false; }
+  // sesja wspólna z FTPQ: zwykle już zalogowana i w ftp_dir
+  Client* ctrl = FtpSession::acquire(cfg.ftp_dir.c_str(), true);
+  if (!ctrl) { LOGW("CfgSync: no FTP session"); return false; }
 
   // 1) Jeżeli istnieje configZ.txt -> najpierw wyślij pełny config jako configU_<epoch>.txt
-  if (ftp.exists(REMOTE_IN)) {
-    String epoch = nowEpochStr();
-
-    // a) utwórz lokalny pełny config
-    String localU = "/configU_" + epoch + ".txt";
-    {
-      File f = LittleFS.open(localU, "w");
-      if (!f) { LOGE("CfgSync: create %s failed", localU.c_str()); ftp.quit(); return false; }
-      String txt = fullConfigText();
-      f.print(txt);
-      f.close();
-    }
-    // b) wyślij (zachowaj nazwę bazową)
-    if (!FTP::uploadFile(localU.c_str(), cfg.ftp_dir.c_str())) {
-      LOGE("CfgSync: upload %s failed", localU.c_str());
-      LittleFS.remove(localU);
-      ftp.quit();
-      return false;
-    }
-    LittleFS.remove(localU); // nie musimy trzymać lokalnej kopii
-
-    // 2) pobierz configZ.txt do /configZ.txt
-    String localZ = "/configZ.txt";
-    if (!ftp.retrToFile(REMOTE_IN, localZ)) {
-      LOGE("CfgSync: RETR %s failed", REMOTE_IN);
-      ftp.quit();
-      return false;
-    }
+  ftpSend(*ctrl, String("SIZE ") + REMOTE_IN);
+  const int code = ftpReadCode(*ctrl, nullptr, 6000);
+  FtpSession::release(code != 0);   // sesję bierze teraz FTP::uploadFile
+  if (code != 213) return false;    // brak pliku -> koniec
 
-    // 3) zmień nazwę zdalnego pliku na configZ_<epoch>.txt
-    String newRemote = String("configZ_") + epoch + ".txt";
-    if (!ftp.rename(REMOTE_IN, newRemote)) {
-      LOGW("CfgSync: RNFR/RNTO failed (will still apply local delta)");
-    }
+  String epoch = nowEpochStr();
 
-    ftp.quit();
+  // a) utwórz lokalny pełny config
+  String localU = "/configU_" + epoch + ".txt";
+  {
+    File f = LittleFS.open(localU, "w");
+    if (!f) { LOGE("CfgSync: create %s failed", localU.c_str()); return false; }
+    String txt = fullConfigText();
+    f.print(txt);
+    f.close();
+  }
+  // b) wyślij (zachowaj nazwę bazową)
+  if (!FTP::uploadFile(localU.c_str(), cfg.ftp_dir.c_str())) {
+    LOGE("CfgSync: upload %s failed", localU.c_str());
+    LittleFS.remove(localU);
+    return false;
+  }
+  LittleFS.remove(localU); // nie musimy trzymać lokalnej kopii
+
+  // 2) pobierz configZ.txt do /configZ.txt
+  ctrl = FtpSession::acquire(cfg.ftp_dir.c_str(), true);
+  if (!ctrl) { LOGW("CfgSync: no FTP session"); return false; }
+  String localZ = "/configZ.txt";
+  if (!retrToFile(*ctrl, REMOTE_IN, localZ)) {
+    LOGE("CfgSync: RETR %s failed", REMOTE_IN);
+    FtpSession::release(false);
+    return false;
+  }
 
-    // 4) zastosuj delty
-    bool ok = applyDeltaFile(localZ);
-    LittleFS.remove(localZ);
-    LOGI("CfgSync: delta %s", ok?"APPLIED":"FAILED");
-    return ok;
+  // 3) zmień nazwę zdalnego pliku na configZ_<epoch>.txt
+  String newRemote = String("configZ_") + epoch + ".txt";
+  if (!ftpRename(*ctrl, REMOTE_IN, newRemote)) {
+    LOGW("CfgSync: RNFR/RNTO failed (will still apply local delta)");
   } else {
-    // brak pliku -> koniec
-    ftp.quit();
-    return false;
+    FtpSession::noteRenamed(REMOTE_IN, newRemote);
   }
+  FtpSession::release();
+
+  // 4) zastosuj delty
+  bool ok = applyDeltaFile(localZ);
+  LittleFS.remove(localZ);
+  LOGI("CfgSync: delta %s", ok?"APPLIED":"FAILED");
+  return ok;
 }
 
 bool CfgSync::runOnceNow(){
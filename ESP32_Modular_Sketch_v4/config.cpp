@@ -39,12 +39,20 @@ bool Config::save(const ConfigData& d) {
   doc["ftp_user"] = d.ftp_user;
   doc["ftp_pass"] = d.ftp_pass;
   doc["ftp_dir"] = d.ftp_dir;
+  doc["ftp_gzip"] = d.ftp_gzip;
   doc["http_user"] = d.http_user;
   doc["http_pass"] = d.http_pass;
   doc["sendFTPInterval"] = d.sendFTPInterval_sec;
   doc["cfgSyncInterval_sec"] = d.cfgSyncInterval_sec; 
   doc["email_pop3_enabled"]   = d.email_pop3_enabled;
   doc["pop3CheckInterval_sec"]= d.pop3CheckInterval_sec;
+  doc["data_bin"]             = d.data_bin;
+  doc["hist_hours"]           = d.hist_hours;
+  doc["hist_ram_min"]         = d.hist_ram_min;
+  doc["roll_1m_days"]         = d.roll_1m_days;
+  doc["roll_1h_months"]       = d.roll_1h_months;
+  doc["ftpq_drain_ms"]        = d.ftpq_drain_ms;
+  doc["ftpq_drain_kb"]        = d.ftpq_drain_kb;
   File f = LittleFS.open(CFG_PATH, "w");
   if (!f) { LOGE("Config save: open failed"); return false; }
   if (serializeJson(doc, f) == 0) { f.close(); return false; }
@@ -119,12 +127,20 @@ bool Config::load() {
   setStr(doc, "ftp_user", g_cfg.ftp_user);
   setStr(doc, "ftp_pass", g_cfg.ftp_pass);
   setStr(doc, "ftp_dir", g_cfg.ftp_dir);
+  setBool  (doc, "ftp_gzip", g_cfg.ftp_gzip);
   setStr(doc, "http_user", g_cfg.http_user);
   setStr(doc, "http_pass", g_cfg.http_pass);
   setUInt32(doc, "sendFTPInterval", g_cfg.sendFTPInterval_sec);
   setUInt32(doc, "cfgSyncInterval_sec", g_cfg.cfgSyncInterval_sec);
   setBool  (doc, "email_pop3_enabled", g_cfg.email_pop3_enabled);
   setUInt32(doc, "pop3CheckInterval_sec", g_cfg.pop3CheckInterval_sec);
+  setBool  (doc, "data_bin", g_cfg.data_bin);
+  setUInt32(doc, "hist_hours", g_cfg.hist_hours);
+  setUInt32(doc, "hist_ram_min", g_cfg.hist_ram_min);
+  setUInt32(doc, "roll_1m_days", g_cfg.roll_1m_days);
+  setUInt32(doc, "roll_1h_months", g_cfg.roll_1h_months);
+  setUInt32(doc, "ftpq_drain_ms", g_cfg.ftpq_drain_ms);
+  setUInt32(doc, "ftpq_drain_kb", g_cfg.ftpq_drain_kb);
   LOGI("Config loaded from FS.");
   return true;
 }
@@ -57,6 +57,7 @@ struct ConfigData {
   String ftp_user = "terminal100.jpalio";
   String ftp_pass = "term100";
   String ftp_dir = "/Dane";
+  bool   ftp_gzip = false;    // wysyłki z kolejki FTPQ jako .gz (kompresja w locie)
   // Web UI auth
   String http_user = "admin";
   String http_pass = "admin123";
@@ -65,6 +66,13 @@ struct ConfigData {
   uint32_t cfgSyncInterval_sec = 900;   // interwał sprawdzania zdalnej konfiguracji (sek)
   bool     email_pop3_enabled   = true;   // włączony auto-check POP3
   uint32_t pop3CheckInterval_sec = 360;   // co ile sekund sprawdzać POP3
+  bool     data_bin = false;   // pomiary w D_<MAC>.bin (BinSeries), na FTP nadal CSV; od restartu
+  uint32_t hist_hours   = 6;   // historia klatek w PSRAM [h] (History); od restartu
+  uint32_t hist_ram_min = 10;  // j.w. bez PSRAM, w RAM wewnętrznej [min]
+  uint32_t roll_1m_days   = 7;   // retencja agregatów 1 min (Rollup) [doby]
+  uint32_t roll_1h_months = 24;  // retencja agregatów 1 h [miesiące]
+  uint32_t ftpq_drain_ms = 5000;   // budżet czasu opróżniania FTPQ na tick [ms] (0 = 1 zadanie; < zapas pierścienia AdcTask)
+  uint32_t ftpq_drain_kb = 1024;   // budżet bajtów plików na tick [kB]
 };
 
 class Config {
@@ -3,6 +3,11 @@
 #include <WiFi.h>
 #include <time.h>
 #include "log.h"
+#include "file_writer.h"
+#include "bin_series.h"
+#include "fs_recovery.h"
+#include <new>
+#include <algorithm>
 
 namespace DataFiles {
 
@@ -28,101 +33,313 @@ String baseName()    { return "D_" + macNoSep(); }
 String pathCurrent() { return "/" + baseName() + ".txt"; }
 String path1()       { return "/" + baseName() + "_1.txt"; }
 String path2()       { return "/" + baseName() + "_2.txt"; }
+String pathCurrentBin() { return "/" + baseName() + ".bin"; }
+String pathCurrentIdx() { return "/" + baseName() + ".idx"; }
+
+static bool g_binary = false;
+void setBinary(bool on) { g_binary = on; }
+bool binary()           { return g_binary; }
 
 // ===== Narzędzia plikowe =====
+// razem z niezapisanym buforem FileWriter
 size_t fileSize(const String& p) {
-  if (!LittleFS.exists(p)) return 0;
-  File f = LittleFS.open(p, "r");
-  if (!f) return 0;
-  size_t s = f.size();
-  f.close();
-  return s;
+  return FileWriter::size(p.c_str());
+}
+
+// ścieżka bieżącego pliku w stałym buforze – dopisywanie rekordów bez sterty;
+// rekordy idą przez bufor FileWriter (na flash pełnymi blokami / po maxAge)
+static const char* pathCurrentC() {
+  static char p[24];
+  if (!p[0]) snprintf(p, sizeof(p), "/D_%s.txt", macNoSep().c_str());
+  return p;
+}
+
+bool appendToCurrent(const char* data, size_t n) {
+  if (!FileWriter::append(pathCurrentC(), data, n, FileWriter::Batch)) {
+    LOGE("appendToCurrent: write '%s' failed", pathCurrentC());
+    return false;
+  }
+  return true;
+}
+
+bool appendBinToCurrent(const uint8_t* data, size_t n) {
+  static char p[24];
+  if (!p[0]) snprintf(p, sizeof(p), "/D_%s.bin", macNoSep().c_str());
+  if (!FileWriter::append(p, data, n, FileWriter::Batch)) {
+    LOGE("appendBinToCurrent: write '%s' failed", p);
+    return false;
+  }
+  return true;
 }
 
 bool appendLineToCurrent(const String& l) {
-  const String p = pathCurrent();
-  File f = LittleFS.open(p, "a");
-  if (!f) {
-    f = LittleFS.open(p, "w");
-    if (!f) {
-      LOGE("appendLineToCurrent: open '%s' failed", p.c_str());
-      return false;
-    }
+  return appendToCurrent(l.c_str(), l.length());
+}
+
+// src -> dst od bieżących pozycji; false = błąd odczytu/zapisu
+static bool copyInto(File& src, File& dst) {
+  uint8_t buf[1024];
+  while (true) {
+    int n = src.read(buf, sizeof(buf));
+    if (n < 0) { LOGE("copyFile: read err"); return false; }
+    if (n == 0) return true;
+    if (dst.write(buf, n) != (size_t)n) { LOGE("copyFile: write err"); return false; }
   }
-  int n = f.print(l);
-  f.close();
-  return n == (int)l.length();
 }
 
 // Kopia pliku 1:1 (używane do tworzenia snapshota wysyłki)
 bool copyFile(const String& from, const String& to) {
+  FileWriter::sync(from.c_str());
   File src = LittleFS.open(from, "r");
   if (!src) { LOGE("copyFile: open src '%s' failed", from.c_str()); return false; }
 
   File dst = LittleFS.open(to, "w");
   if (!dst) { LOGE("copyFile: open dst '%s' failed", to.c_str()); src.close(); return false; }
 
-  uint8_t buf[1024];
-  while (true) {
-    int n = src.read(buf, sizeof(buf));
-    if (n < 0) { LOGE("copyFile: read err"); dst.close(); src.close(); LittleFS.remove(to); return false; }
-    if (n == 0) break;
-    if (dst.write(buf, n) != n) { LOGE("copyFile: write err"); dst.close(); src.close(); LittleFS.remove(to); return false; }
-  }
+  const bool ok = copyInto(src, dst);
   dst.close();
   src.close();
-  return true;
+  if (!ok) LittleFS.remove(to);
+  return ok;
+}
+
+// ===== Indeks czasu bieżącego CSV =====
+static uint32_t g_idxNext = 0;        // offset danych, od którego należy się kolejny wpis
+
+static const char* pathIdxC() {
+  static char p[24];
+  if (!p[0]) snprintf(p, sizeof(p), "/D_%s.idx", macNoSep().c_str());
+  return p;
 }
 
-// Rotacja po UDANEJ wysyłce bieżącego pliku:
-//   D_<MAC>_1.txt -> D_<MAC>_2.txt
-//   D_<MAC>.txt   -> D_<MAC>_1.txt
-//   + założenie pustego D_<MAC>.txt
-bool rotateAfterSend() {
+// bieżący plik zamknięty w segment / usunięty – indeks od zera
+static void dropIndex() {
+  if (LittleFS.exists(pathIdxC())) LittleFS.remove(pathIdxC());
+  g_idxNext = 0;
+}
+
+void noteRecordTime(uint32_t localSec) {
+  const uint32_t off = (uint32_t)FileWriter::size(pathCurrentC());
+  if (!localSec || off < g_idxNext) return;
+  const TimeIndex::Entry e = { localSec, off };
+  if (!TimeIndex::append(pathIdxC(), e)) { LOGW("noteRecordTime: write '%s' failed", pathIdxC()); return; }
+  g_idxNext = (off / TimeIndex::kStride + 1) * TimeIndex::kStride;
+}
+
+void checkIndex() {
+  const char*  p0   = pathCurrentC();
+  const size_t size = fileSize(pathCurrent());
+  TimeIndex::Entry e;
+  const bool have = TimeIndex::last(pathIdxC(), &e);
+  if (!size) { dropIndex(); return; }
+  if (have && e.off < size) {
+    g_idxNext = (e.off / TimeIndex::kStride + 1) * TimeIndex::kStride;
+    return;
+  }
+  FileWriter::sync(p0);
+  g_idxNext = TimeIndex::rebuild(p0, pathIdxC());
+  LOGI("Time index rebuilt: %s (%lu B of data)", pathIdxC(), (unsigned long)size);
+}
+
+// linie z dekodera .bin przez filtr zapytania
+struct QuerySink {
+  const TimeIndex::Query* q;
+  TimeIndex::Emit         emit;
+  void*                   ctx;
+  TimeIndex::Stats*       st;
+};
+
+static void emitMatching(void* c, const char* l, size_t n) {
+  QuerySink* s = (QuerySink*)c;
+  if (s->st) ++s->st->lines;
+  if (!TimeIndex::match(*s->q, l, n)) return;
+  if (s->st) ++s->st->matched;
+  s->emit(s->ctx, l, n);
+}
+
+bool queryCurrent(const TimeIndex::Query& q, TimeIndex::Emit emit, void* ctx, TimeIndex::Stats* st) {
+  const char* p0 = pathCurrentC();
+  if (LittleFS.exists(p0)) {
+    FileWriter::sync(p0);
+    const TimeIndex::Span sp = TimeIndex::find(pathIdxC(), q, st);
+    File f = LittleFS.open(p0, "r");
+    if (!f) { LOGE("queryCurrent: open '%s' failed", p0); return false; }
+    const bool ok = TimeIndex::scan(f, sp, q, emit, ctx, st);
+    f.close();
+    if (!ok) return false;
+  }
+
+  // .bin bez indeksu: ramki różnicowe dekodowalne tylko od KEY, więc od
+  // początku pliku (~kBinCsvRatio razy mniej bajtów niż CSV)
+  const String b0 = pathCurrentBin();
+  if (!LittleFS.exists(b0)) return true;
+  FileWriter::sync(b0.c_str());
+  File in = LittleFS.open(b0, "r");
+  if (!in) { LOGE("queryCurrent: open '%s' failed", b0.c_str()); return false; }
+  QuerySink sink = { &q, emit, ctx, st };
+  BinSeries::Decoder* d = new (std::nothrow) BinSeries::Decoder(emitMatching, &sink);
+  if (!d) { LOGE("queryCurrent: no memory"); in.close(); return false; }
+  uint8_t buf[512];
+  int n;
+  while ((n = in.read(buf, sizeof(buf))) > 0) {
+    if (st) st->bytesRead += n;
+    d->feed(buf, n);
+  }
+  d->finish();
+  delete d;
+  in.close();
+  return n == 0;
+}
+
+// ===== .bin -> CSV =====
+struct CsvSink { File* f; bool ok; };
+
+static void emitToFile(void* ctx, const char* l, size_t n) {
+  CsvSink* s = (CsvSink*)ctx;
+  if (s->ok && s->f->write((const uint8_t*)l, n) != n) s->ok = false;
+}
+
+// linie CSV z pliku .bin dopisane do out; false = błąd odczytu/zapisu/pamięci
+static bool binToCsv(const String& binPath, File& out) {
+  FileWriter::sync(binPath.c_str());
+  File in = LittleFS.open(binPath, "r");
+  if (!in) { LOGE("binToCsv: open '%s' failed", binPath.c_str()); return false; }
+
+  // stan dekodera (~4.5 kB) tylko na czas konwersji
+  CsvSink sink = { &out, true };
+  BinSeries::Decoder* d = new (std::nothrow) BinSeries::Decoder(emitToFile, &sink);
+  if (!d) { LOGE("binToCsv: no memory"); in.close(); return false; }
+
+  uint8_t buf[512];
+  int n;
+  while ((n = in.read(buf, sizeof(buf))) > 0 && sink.ok) d->feed(buf, n);
+  d->finish();
+  const BinSeries::Decoder::Stats st = d->stats();
+  delete d;
+  in.close();
+
+  if (st.badFrames || st.dropped) {
+    LOGW("binToCsv '%s': %lu frames, %lu bad, %lu dropped, %lu B skipped", binPath.c_str(),
+         (unsigned long)st.frames, (unsigned long)st.badFrames,
+         (unsigned long)st.dropped, (unsigned long)st.skipped);
+  }
+  if (!sink.ok) LOGE("binToCsv: write err");
+  return sink.ok && n == 0;
+}
+
+bool currentFull() {
+  const size_t n = fileSize(pathCurrent()) + fileSize(pathCurrentBin()) * kBinCsvRatio;
+  return n >= FILE_SIZE_LIMIT;
+}
+
+void foldBinIntoCsv() {
+  const String b0 = pathCurrentBin();
+  if (!LittleFS.exists(b0)) return;
+
   const String p0 = pathCurrent();
-  const String p1 = path1();
-  const String p2 = path2();
+  FileWriter::release(p0.c_str());
+  File out = LittleFS.open(p0, "a");
+  if (!out) { LOGE("foldBinIntoCsv: open '%s' failed", p0.c_str()); return; }
+  const bool ok = binToCsv(b0, out);
+  out.close();
+
+  if (!ok) { LOGE("foldBinIntoCsv: '%s' kept", b0.c_str()); return; }
+  FileWriter::release(b0.c_str());
+  LittleFS.remove(b0);
+  dropIndex();                         // dopisane linie bez wpisów – checkIndex() przebuduje
+  LOGI("Binary data %s appended to %s", b0.c_str(), p0.c_str());
+}
+
+// _1 -> _2, p0 -> _1 (same rename – bez kopiowania); rm usuwany na początku.
+// Znacznik Recovery: po zaniku zasilania w trakcie start dokańcza przesunięcie.
+static bool shift3(const String& p0, const String& p1, const String& p2, const String& rm = String()) {
+  FileWriter::release(p0.c_str());
+  Recovery::mark(Recovery::OP_SHIFT, p0, p1, p2, rm);
+  if (rm.length()) {
+    FileWriter::release(rm.c_str());
+    if (LittleFS.exists(rm)) LittleFS.remove(rm);
+  }
 
   if (LittleFS.exists(p2)) {
     if (!LittleFS.remove(p2)) {
-      LOGW("rotateAfterSend: remove '%s' failed", p2.c_str());
+      LOGW("rotate: remove '%s' failed", p2.c_str());
     }
   }
   if (LittleFS.exists(p1)) {
     if (!LittleFS.rename(p1, p2)) {
-      LOGE("rotateAfterSend: rename '%s'->'%s' failed", p1.c_str(), p2.c_str());
+      LOGE("rotate: rename '%s'->'%s' failed", p1.c_str(), p2.c_str());
       return false;
     }
   }
   if (LittleFS.exists(p0)) {
     if (!LittleFS.rename(p0, p1)) {
-      LOGE("rotateAfterSend: rename '%s'->'%s' failed", p0.c_str(), p1.c_str());
+      LOGE("rotate: rename '%s'->'%s' failed", p0.c_str(), p1.c_str());
       return false;
     }
   }
-  // utwórz pusty bieżący plik
-  File f = LittleFS.open(p0, "w");
-  if (!f) {
-    LOGE("rotateAfterSend: create '%s' failed", p0.c_str());
-    return false;
+  Recovery::clear();
+  return true;
+}
+
+String sealCurrent() {
+  // binarnie segmentem jest sam .bin – CSV dla serwera powstaje w locie przy
+  // wysyłce (dekoder w FTP::uploadFile). CSV sprzed włączenia trybu binarnego
+  // zamykany osobno, .bin przy następnym wywołaniu.
+  const String p0 = pathCurrent();
+  FileWriter::release(p0.c_str());
+  const bool csv = !binary() || LittleFS.exists(p0);
+  const String cur = csv ? p0 : pathCurrentBin();
+  FileWriter::release(cur.c_str());
+  if (!LittleFS.exists(cur)) return String();
+
+  // bieżący plik staje się segmentem; nowy założy pierwszy zapis
+  const String seg = makeUploadSnapshotPath(csv ? ".txt" : ".bin");
+  if (!LittleFS.rename(cur, seg)) {
+    LOGE("sealCurrent: rename '%s'->'%s' failed", cur.c_str(), seg.c_str());
+    return String();
   }
-  f.close();
+  if (csv) dropIndex();
+  return seg;
+}
 
-  LOGI("Rotation done: %s -> %s -> %s", p0.c_str(), p1.c_str(), p2.c_str());
-  return true;
+bool isBinSegment(const String& path) {
+  return path.endsWith(".bin") && path.indexOf(baseName() + "_UP_") >= 0;
 }
 
-// Zachowujemy zgodność z wcześniejszym API
-bool rotate3() {
-  return rotateAfterSend();
+void retireSegment(const String& seg) {
+  if (!LittleFS.exists(seg)) return;
+  const bool bin = isBinSegment(seg);
+  const String p1 = bin ? "/" + baseName() + "_1.bin" : path1();
+  const String p2 = bin ? "/" + baseName() + "_2.bin" : path2();
+  if (shift3(seg, p1, p2)) {
+    LOGI("Segment retired: %s -> %s -> %s", seg.c_str(), p1.c_str(), p2.c_str());
+  }
 }
 
-// Ścieżka snapshota do wysyłki (unikalna nazwa dzięki epoch)
-String makeUploadSnapshotPath() {
+std::vector<String> sealedSegments() {
+  std::vector<String> out;
+  const String prefix = baseName() + "_UP_";
+  File root = LittleFS.open("/");
+  if (!root) return out;
+  for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+    String name = String(f.name());
+    if (name.startsWith("/")) name = name.substring(1);
+    if (name.startsWith(prefix)) out.push_back("/" + name);
+  }
+  std::sort(out.begin(), out.end(), [](const String& a, const String& b){ return a < b; });
+  return out;
+}
+
+// Ścieżka segmentu do wysyłki (unikalna nazwa dzięki epoch)
+String makeUploadSnapshotPath(const char* ext) {
   time_t t = time(nullptr);
   char ep[16];
   snprintf(ep, sizeof(ep), "%lu", (unsigned long)t);
-  return String("/") + baseName() + "_UP_" + ep + ".txt";
+  String p = String("/") + baseName() + "_UP_" + ep + ext;
+  for (int i = 2; LittleFS.exists(p); ++i) {       // dwa segmenty w tej samej sekundzie
+    p = String("/") + baseName() + "_UP_" + ep + "_" + String(i) + ext;
+  }
+  return p;
 }
 
 } // namespace DataFiles
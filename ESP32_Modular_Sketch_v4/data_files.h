@@ -1,10 +1,15 @@
 #pragma once
 #include <Arduino.h>
+#include "adc_real.h"
+#include "time_index.h"
+#include <vector>
 
 namespace DataFiles {
 
 // Ustal limit jako constexpr w nagłówku (NIE używaj #define o tej samej nazwie nigdzie indziej!)
 constexpr size_t FILE_SIZE_LIMIT = 100UL * 1024UL; // 100 kB
+// szacunek bajtów CSV na bajt .bin (esp_sim_series_bench: float ~12x, double ~6x)
+constexpr size_t kBinCsvRatio    = sizeof(adc_real_t) == 8 ? 6 : 12;
 
 // Identyfikacja plików wg MAC (bez separatorów)
 const String& macNoSep();                // "AABBCCDDEEFF" (cache wewnątrz)
@@ -12,20 +17,50 @@ String        baseName();                // "D_<MAC>"
 String        pathCurrent();             // "/D_<MAC>.txt"
 String        path1();                   // "/D_<MAC>_1.txt"
 String        path2();                   // "/D_<MAC>_2.txt"
+String        pathCurrentBin();          // "/D_<MAC>.bin" (tryb binarny, BinSeries)
+String        pathCurrentIdx();          // "/D_<MAC>.idx" (TimeIndex dla D_<MAC>.txt)
+
+// Tryb binarny (Config data_bin) – ustalany raz przy starcie
+void   setBinary(bool on);
+bool   binary();
 
 // Operacje plikowe
 size_t fileSize(const String& path);
 bool   appendLineToCurrent(const String& line);
+bool   appendToCurrent(const char* data, size_t n);   // bez alokacji (rekordy pomiarów)
+bool   appendBinToCurrent(const uint8_t* data, size_t n);
 bool   copyFile(const String& from, const String& to);
 
-// Rotacja po UDANEJ wysyłce bieżącego pliku:
-//   _1 -> _2, current -> _1, a następnie zakładamy pusty current
-bool   rotateAfterSend();
+// Limit bieżących danych: CSV >= FILE_SIZE_LIMIT (.bin liczony jako CSV po
+// konwersji, ~kBinCsvRatio razy więcej)
+bool   currentFull();
+// Po powrocie do CSV: pozostały D_<MAC>.bin dopisany do D_<MAC>.txt i usunięty
+void   foldBinIntoCsv();
+
+// Indeks czasu bieżącego CSV (time_index.h):
+//   noteRecordTime() – przed blokiem rekordów o czasie localSec (wpis co kStride)
+//   checkIndex()     – przy starcie: indeks niezgodny z plikiem budowany od nowa
+//   queryCurrent()   – pasujące linie bieżących danych (CSV przez indeks,
+//                      .bin dekodowany w całości), bez pliku tymczasowego
+void   noteRecordTime(uint32_t localSec);
+void   checkIndex();
+bool   queryCurrent(const TimeIndex::Query& q, TimeIndex::Emit emit, void* ctx,
+                    TimeIndex::Stats* st = nullptr);
 
-// Dla zgodności z wcześniejszym kodem:
-bool   rotate3();                        // alias do rotateAfterSend()
+// Segmenty wysyłki (bez kopiowania bieżącego pliku):
+//   sealCurrent()   – bieżące dane zamykane w segment (rename):
+//                     "/D_<MAC>_UP_<epoch>.txt", binarnie "..._UP_<epoch>.bin"
+//                     (na serwer jako CSV), "" gdy brak danych albo błąd
+//   isBinSegment()  – segment .bin (FTP::uploadFile dekoduje go w locie)
+//   retireSegment() – po udanej wysyłce: _1 -> _2, segment -> _1 (retencja
+//                     dwóch ostatnich wysłanych; .bin -> _1.bin/_2.bin)
+//   sealedSegments()– segmenty na FS (np. po restarcie), od najstarszego
+String sealCurrent();
+bool   isBinSegment(const String& path);
+void   retireSegment(const String& seg);
+std::vector<String> sealedSegments();
 
-// Nazwa pliku-snapshota do uploadu: "/D_<MAC>_UP_<epoch>.txt"
-String makeUploadSnapshotPath();
+// Nazwa segmentu do uploadu: "/D_<MAC>_UP_<epoch><ext>" (unikalna)
+String makeUploadSnapshotPath(const char* ext = ".txt");
 
 } // namespace DataFiles
@@ -5,6 +5,7 @@
 #include "data_files.h"
 #include "measurement.h"   // Measure::pomTimeStamp()
 #include "log.h"
+#include "file_writer.h"
 #include <LittleFS.h>
 #include <vector>
 #include <WiFi.h>
@@ -51,12 +52,8 @@ inline void grow_backoff() {
 
 // Mini log (opcjonalnie)
 void appendToLog(const String& line) {
-  File f = LittleFS.open("/log0.txt", "a");
-  if (f) {
-    f.print(String(millis())); f.print(" [INFO] ");
-    f.print(line); f.print("\r\n");
-    f.close();
-  }
+  String l = String(millis()) + " [INFO] " + line + "\r\n";
+  FileWriter::append("/log0.txt", l.c_str(), l.length());
 }
 
 // CSV → lista e-maili (separatory: przecinek, średnik, spacja)
@@ -0,0 +1,57 @@
+#include "file_tail.h"
+#include "file_writer.h"
+#include <LittleFS.h>
+
+namespace FileTail {
+
+size_t startOffset(File& f, size_t maxLines, Stats* st) {
+  const size_t size = f.size();
+  if (!maxLines || !size) return size;
+  char buf[kBlock];
+  size_t end = size;
+  size_t nl = 0;
+  bool last = true;                    // ostatni znak pliku jeszcze nie sprawdzony
+  while (end > 0) {
+    const size_t n = end >= kBlock ? kBlock : end;
+    const size_t pos = end - n;
+    if (!f.seek(pos) || f.read((uint8_t*)buf, n) != (int)n) return size;   // błąd – nic
+    if (st) st->bytesRead += n;
+    for (size_t i = n; i-- > 0;) {
+      if (buf[i] != '\n') { last = false; continue; }
+      if (last) { last = false; continue; }   // '\n' kończący plik
+      if (++nl == maxLines) return pos + i + 1;
+    }
+    end = pos;
+  }
+  return 0;
+}
+
+bool stream(const String& path, size_t maxLines, Emit emit, void* ctx, Stats* st) {
+  Stats local = {};
+  if (!st) st = &local;
+  *st = Stats();
+  FileWriter::sync(path.c_str());      // bufor FileWriter na flash
+  if (!LittleFS.exists(path)) return false;
+  File f = LittleFS.open(path, "r");
+  if (!f) return false;
+  st->size  = f.size();
+  st->start = startOffset(f, maxLines, st);
+
+  char buf[kBlock];
+  char prev = '\n';
+  bool ok = f.seek(st->start);
+  for (size_t left = st->size - st->start; ok && left;) {
+    const int n = f.read((uint8_t*)buf, left < kBlock ? left : kBlock);
+    if (n <= 0) { ok = false; break; }
+    st->bytesRead += n;
+    for (int i = 0; i < n; ++i) if (buf[i] == '\n') ++st->lines;
+    prev = buf[n - 1];
+    emit(ctx, buf, n);
+    left -= n;
+  }
+  f.close();
+  if (prev != '\n') ++st->lines;        // ostatnia linia bez '\n'
+  return ok;
+}
+
+} // namespace FileTail
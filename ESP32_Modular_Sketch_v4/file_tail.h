@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+// Ostatnie N linii pliku tekstowego (D_<MAC>.txt, log0.txt, alarmy_<MAC>.txt)
+// bez składania wyniku w pamięci: początek N-tej linii od końca szukany
+// blokami od końca pliku (tylko liczenie '\n'), potem plik od tego offsetu
+// przekazywany dalej porcjami bufora o stałym rozmiarze. Pamięć nie zależy
+// od N; odczyt z flash to wycinek plus najwyżej jeden blok.
+namespace FileTail {
+
+static const size_t kBlock = 512;
+
+struct Stats {
+  uint32_t start;       // offset pierwszej wysłanej linii
+  uint32_t size;        // rozmiar pliku
+  uint32_t lines;       // linie wysłane (<= N)
+  uint32_t bytesRead;   // przeszukanie wstecz + wysyłka
+};
+
+typedef void (*Emit)(void* ctx, const char* p, size_t n);
+
+// offset początku N-tej linii od końca (końcowy '\n' nie zaczyna linii)
+size_t startOffset(File& f, size_t maxLines, Stats* st = nullptr);
+// N ostatnich linii porcjami <= kBlock; false = brak pliku / błąd odczytu
+bool   stream(const String& path, size_t maxLines, Emit emit, void* ctx, Stats* st = nullptr);
+
+} // namespace FileTail
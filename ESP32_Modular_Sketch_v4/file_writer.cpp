@@ -0,0 +1,149 @@
+#include "file_writer.h"
+#include <LittleFS.h>
+#include <new>
+
+namespace FileWriter {
+
+struct Slot {
+  char     path[40];   // "" = wolny
+  File     f;
+  char*    buf;        // kBlock, alokowany przy pierwszym użyciu slotu
+  size_t   used;
+  size_t   flashed;    // rozmiar pliku na flash
+  uint32_t firstMs;    // czas najstarszego bajtu w buforze (gdy used > 0)
+  uint32_t lastUse;
+};
+
+static Slot              gSlots[kMaxFiles];
+static uint32_t          gUse      = 0;
+static uint32_t          gMaxAgeMs = kDefMaxAgeMs;
+static Stats             gStats    = {};
+static SemaphoreHandle_t gMtx      = nullptr;
+
+struct Lock {
+  Lock()  { if (gMtx) xSemaphoreTake(gMtx, portMAX_DELAY); }
+  ~Lock() { if (gMtx) xSemaphoreGive(gMtx); }
+};
+
+static Slot* findSlot(const char* path) {
+  for (Slot& s : gSlots) if (s.path[0] && !strcmp(s.path, path)) return &s;
+  return nullptr;
+}
+
+// bufor -> flash (+ commit); false = krótki zapis (reszta bufora porzucona)
+static bool flushSlot(Slot& s, bool commit = true) {
+  if (!s.used) return true;
+  const size_t w = s.f ? s.f.write((const uint8_t*)s.buf, s.used) : 0;
+  if (w && commit) s.f.flush();
+  s.flashed    += w;
+  gStats.bytes += w;
+  ++gStats.flushes;
+  const bool ok = (w == s.used);
+  if (!ok) ++gStats.errors;
+  s.used = 0;
+  return ok;
+}
+
+static void closeSlot(Slot& s) {
+  flushSlot(s);
+  s.f.close();
+  s.path[0] = 0;
+}
+
+static Slot* openSlot(const char* path) {
+  if (strlen(path) >= sizeof(gSlots[0].path)) { ++gStats.errors; return nullptr; }
+
+  Slot* s = nullptr;
+  for (Slot& x : gSlots) if (!x.path[0]) { s = &x; break; }
+  if (!s) {                              // najdawniej używany ustępuje
+    s = &gSlots[0];
+    for (Slot& x : gSlots) if (x.lastUse < s->lastUse) s = &x;
+    closeSlot(*s);
+    ++gStats.evictions;
+  }
+  if (!s->buf) s->buf = new (std::nothrow) char[kBlock];
+  if (!s->buf) { ++gStats.errors; return nullptr; }
+
+  s->f = LittleFS.open(path, "a");
+  if (!s->f) s->f = LittleFS.open(path, "w");
+  if (!s->f) { ++gStats.errors; return nullptr; }
+  ++gStats.opens;
+
+  snprintf(s->path, sizeof(s->path), "%s", path);
+  s->used    = 0;
+  s->flashed = s->f.size();
+  return s;
+}
+
+void begin() {
+  if (!gMtx) gMtx = xSemaphoreCreateMutex();
+}
+
+bool append(const char* path, const void* data, size_t n, Durability d) {
+  Lock lock;
+  ++gStats.appends;
+  Slot* s = findSlot(path);
+  if (!s) s = openSlot(path);
+  if (!s) return false;
+  s->lastUse = ++gUse;
+
+  const char* p = (const char*)data;
+  while (n) {
+    // bufor kończy się na granicy bloku: pełny bufor = plik równo do bloku
+    const size_t room = kBlock - (s->flashed % kBlock);
+    size_t take = room - s->used;
+    if (take > n) take = n;
+    if (!s->used) s->firstMs = millis();
+    memcpy(s->buf + s->used, p, take);
+    s->used += take;
+    p += take;
+    n -= take;
+    // przy Sync całość linii zamyka jeden commit poniżej
+    if (s->used == room && !flushSlot(*s, d == Batch)) { closeSlot(*s); return false; }
+  }
+  if (d == Sync && !flushSlot(*s)) { closeSlot(*s); return false; }
+  return true;
+}
+
+size_t size(const char* path) {
+  Lock lock;
+  if (Slot* s = findSlot(path)) return s->flashed + s->used;
+  if (!LittleFS.exists(path)) return 0;
+  File f = LittleFS.open(path, "r");
+  if (!f) return 0;
+  const size_t n = f.size();
+  f.close();
+  return n;
+}
+
+void sync(const char* path) {
+  Lock lock;
+  if (Slot* s = findSlot(path)) flushSlot(*s);
+}
+
+void release(const char* path) {
+  Lock lock;
+  if (Slot* s = findSlot(path)) closeSlot(*s);
+}
+
+void syncAll() {
+  Lock lock;
+  for (Slot& s : gSlots) if (s.path[0]) flushSlot(s);
+}
+
+void tick() {
+  Lock lock;
+  const uint32_t now = millis();
+  for (Slot& s : gSlots) {
+    if (s.path[0] && s.used && now - s.firstMs >= gMaxAgeMs) flushSlot(s);
+  }
+}
+
+void setMaxAgeMs(uint32_t ms) { gMaxAgeMs = ms; }
+
+Stats stats() {
+  Lock lock;
+  return gStats;
+}
+
+} // namespace FileWriter
@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+
+// Wspólny zapis dopisywanych plików (dane D_<MAC>.txt, alarmy, log0.txt).
+// Każdy plik ma bufor RAM jednego bloku flash i otwarty uchwyt LittleFS;
+// na flash trafia:
+//  - porcja domykająca plik do granicy bloku 4 kB (pełny blok, bez
+//    przepisywania niepełnego ostatniego bloku przy każdej linii),
+//  - bufor starszy niż maxAge (tick() z loop()),
+//  - od razu przy append(..., Sync) albo sync()/release()/syncAll().
+// Każdy zapis na flash kończy commit (File::flush) – dane w buforze giną przy
+// zaniku zasilania, dane po commicie nie.
+//
+// Pliki obsługiwane tu czytać dopiero po sync(path), a przed rename/remove
+// wołać release(path). Bezpieczne z wielu zadań (mutex); moduł nie loguje
+// (Log::printf sam pisze przez FileWriter).
+namespace FileWriter {
+
+enum Durability : uint8_t {
+  Batch,   // do bufora RAM – dane masowe i log
+  Sync,    // bufor + ta linia od razu na flash z commitem – alarmy
+};
+
+static const size_t   kBlock       = 4096;   // blok kasowania flash / LittleFS
+static const int      kMaxFiles    = 4;      // jednocześnie otwartych plików
+static const uint32_t kDefMaxAgeMs = 5000;
+
+void   begin();                      // po LittleFS.begin(), przed Log::begin()
+
+bool   append(const char* path, const void* data, size_t n, Durability d = Batch);
+inline bool append(const String& path, const String& s, Durability d = Batch) {
+  return append(path.c_str(), s.c_str(), s.length(), d);
+}
+
+size_t size(const char* path);       // rozmiar pliku razem z niezapisanym buforem
+void   sync(const char* path);       // bufor -> flash + commit; uchwyt zostaje
+void   release(const char* path);    // sync + zamknięcie uchwytu
+void   syncAll();                    // np. przed ESP.restart()
+void   tick();                       // z loop(): bufory starsze niż maxAge
+void   setMaxAgeMs(uint32_t ms);
+
+struct Stats {
+  uint32_t appends;    // wywołania append()
+  uint32_t flushes;    // zapisy bufora na flash (każdy z commitem)
+  uint32_t opens;      // otwarcia uchwytów
+  uint32_t evictions;  // zamknięcia z braku wolnego slotu
+  uint32_t errors;     // nieudane open/zapis (dane z bufora porzucone)
+  uint64_t bytes;      // bajty zapisane na flash
+};
+Stats  stats();
+
+} // namespace FileWriter
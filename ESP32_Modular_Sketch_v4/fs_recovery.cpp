@@ -0,0 +1,240 @@
+#include "fs_recovery.h"
+#include <LittleFS.h>
+#include <new>
+#include <vector>
+#include "log.h"
+#include "config.h"
+#include "data_files.h"
+#include "file_writer.h"
+#include "bin_series.h"
+#include "record_fmt.h"
+#include "ftp_queue.h"
+
+#ifdef ARDUINO_ARCH_ESP32
+  #include <unistd.h>
+#endif
+
+namespace Recovery {
+
+static const char kWal[]    = "/fs_wal.txt";
+static const char kWalTmp[] = "/fs_wal.tmp";
+static const char kCutTmp[] = "/fs_cut.tmp";
+
+static Stats gStats = {};
+
+bool mark(Op op, const String& a, const String& b, const String& c, const String& d) {
+  File f = LittleFS.open(kWalTmp, "w");
+  if (!f) { LOGE("Recovery: marker open failed"); return false; }
+  const String l = String((char)op) + "|" + a + "|" + b + "|" + c + "|" + d + "\n";
+  const bool ok = f.print(l) == l.length();
+  f.close();
+  if (!ok || !LittleFS.rename(kWalTmp, kWal)) {
+    LOGE("Recovery: marker write failed");
+    LittleFS.remove(kWalTmp);
+    return false;
+  }
+  return true;
+}
+
+void clear() {
+  if (LittleFS.exists(kWal)) LittleFS.remove(kWal);
+}
+
+// ===== znacznik operacji =====
+
+static void finishShift(const String& p0, const String& p1, const String& p2, const String& rm) {
+  if (rm.length() && LittleFS.exists(rm)) LittleFS.remove(rm);
+  if (!LittleFS.exists(p0)) return;            // ostatni krok (p0 -> p1) już był
+  if (LittleFS.exists(p1)) {
+    if (LittleFS.exists(p2)) LittleFS.remove(p2);
+    LittleFS.rename(p1, p2);
+  }
+  LittleFS.rename(p0, p1);
+}
+
+static void replayWal() {
+  if (LittleFS.exists(kWalTmp)) LittleFS.remove(kWalTmp);   // znacznik niezapisany – operacja nie ruszyła
+  if (!LittleFS.exists(kWal)) return;
+
+  File f = LittleFS.open(kWal, "r");
+  String l = f ? f.readStringUntil('\n') : String();
+  if (f) f.close();
+
+  String part[5];
+  int from = 0;
+  for (int i = 0; i < 5; ++i) {
+    const int bar = l.indexOf('|', from);
+    part[i] = bar < 0 ? l.substring(from) : l.substring(from, bar);
+    if (bar < 0) break;
+    from = bar + 1;
+  }
+
+  if (part[0] == "S" && part[1].length() && part[2].length() && part[3].length()) {
+    finishShift(part[1], part[2], part[3], part[4]);
+    LOGW("Recovery: rotation %s -> %s -> %s finished", part[1].c_str(), part[2].c_str(), part[3].c_str());
+  } else if (part[0] == "E" && part[1].length()) {
+    if (LittleFS.exists(part[1])) LittleFS.remove(part[1]);
+    LOGW("Recovery: incomplete %s removed", part[1].c_str());
+  } else {
+    LOGW("Recovery: unknown marker '%s' ignored", l.c_str());
+  }
+  ++gStats.walOps;
+  clear();
+}
+
+// ===== ogony plików =====
+
+// "...;stan_wyjsc;<crc16 hex>;\r\n" – CRC16 Modbus z części przed ";<crc>"
+static bool lineCrcOk(const char* l, size_t n) {
+  while (n && (l[n - 1] == '\n' || l[n - 1] == '\r')) --n;
+  if (!n || l[n - 1] != ';') return false;
+  size_t k = n - 1;
+  while (k && l[k - 1] != ';') --k;
+  if (!k || n - 1 - k < 1 || n - 1 - k > 4) return false;
+  uint16_t want = 0;
+  for (size_t i = k; i < n - 1; ++i) {
+    const char c = l[i];
+    const int v = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+    if (v < 0) return false;
+    want = (uint16_t)(want << 4 | v);
+  }
+  return RecordFmt::crc16Update(0xFFFF, l, k - 1) == want;
+}
+
+// długość bez niepełnej ostatniej linii (i, przy crc, bez końcowych linii
+// z błędnym CRC16); patrzy tylko w ostatnie kTailBytes
+static size_t csvGoodLength(File& f, size_t size, bool crc) {
+  static char buf[kTailBytes];                 // tylko z setup()
+  const size_t win = size < kTailBytes ? size : kTailBytes;
+  if (!f.seek(size - win) || f.read((uint8_t*)buf, win) != (int)win) return size;
+
+  size_t end = win;
+  while (end && buf[end - 1] != '\n') --end;
+  if (!end && win < size) return size;         // brak końca linii w oknie – nie ruszamy
+  while (crc && end) {
+    size_t b = end - 1;
+    while (b && buf[b - 1] != '\n') --b;
+    if (!b && win < size) break;               // początek linii poza oknem
+    if (lineCrcOk(buf + b, end - b)) break;
+    end = b;
+  }
+  return size - win + end;
+}
+
+// długość do końca ostatniej poprawnej ramki BinSeries; obcina tylko urwaną
+// końcówkę (krótszą niż ramka) – uszkodzenie w środku zostawia dekoderowi.
+// Ramki mają zmienną długość, więc czytany jest cały plik – mały, bo bieżące
+// dane są zamykane w segment przy FILE_SIZE_LIMIT (currentFull())
+static size_t binGoodLength(File& f, size_t size) {
+  uint8_t* buf = new (std::nothrow) uint8_t[BinSeries::kMaxFrame];
+  if (!buf) return size;
+  size_t good = 0, have = 0;
+  while (true) {
+    const int r = f.read(buf + have, BinSeries::kMaxFrame - have);
+    if (r > 0) have += r;
+    const long fl = BinSeries::frameSize(buf, have);
+    if (fl <= 0) break;
+    good += fl;
+    have -= fl;
+    memmove(buf, buf + fl, have);
+  }
+  delete[] buf;
+  return size - good < BinSeries::kMaxFrame ? good : size;
+}
+
+// obcięcie w miejscu: esp_littlefs obsługuje truncate() przez VFS (LittleFS
+// montowany w "/littlefs"), symulator – File::truncate; zmiana rozmiaru to
+// jeden commit metadanych, więc po zaniku zasilania stary albo obcięty plik
+static bool truncateInPlace(const String& path, size_t len) {
+#ifdef ARDUINO_ARCH_ESP32
+  return ::truncate((String("/littlefs") + path).c_str(), (off_t)len) == 0;
+#else
+  File f = LittleFS.open(path, "a");
+  const bool ok = f && f.truncate(len);
+  if (f) f.close();
+  return ok;
+#endif
+}
+
+// w miejscu, a gdy się nie uda – kopia [0, len) i rename na miejsce oryginału
+bool truncate(const String& path, size_t len) {
+  if (truncateInPlace(path, len)) return true;
+  File src = LittleFS.open(path, "r");
+  File dst = LittleFS.open(kCutTmp, "w");
+  bool ok = src && dst;
+  uint8_t buf[512];
+  while (ok && len) {
+    const size_t want = len < sizeof(buf) ? len : sizeof(buf);
+    const int r = src.read(buf, want);
+    ok = r == (int)want && dst.write(buf, want) == want;
+    len -= want;
+  }
+  if (src) src.close();
+  if (dst) dst.close();
+  ok = ok && LittleFS.rename(kCutTmp, path);
+  if (!ok) LittleFS.remove(kCutTmp);
+  return ok;
+}
+
+enum Kind { TAIL_CSV_CRC, TAIL_LINES, TAIL_BIN };
+
+static void repair(const String& path, Kind kind) {
+  if (!LittleFS.exists(path)) return;
+  FileWriter::release(path.c_str());
+  File f = LittleFS.open(path, "r");
+  if (!f) return;
+  ++gStats.files;
+  const size_t size = f.size();
+  const size_t good = !size ? 0 : kind == TAIL_BIN ? binGoodLength(f, size) : csvGoodLength(f, size, kind == TAIL_CSV_CRC);
+  f.close();
+  if (good >= size) return;
+
+  if (!truncate(path, good)) { LOGE("Recovery: truncate %s failed", path.c_str()); return; }
+  ++gStats.truncated;
+  gStats.bytesCut += size - good;
+  LOGW("Recovery: %s torn tail cut (%lu -> %lu B)", path.c_str(), (unsigned long)size, (unsigned long)good);
+}
+
+Stats run() {
+  const uint32_t t0 = millis();
+  gStats = Stats();
+
+  replayWal();
+  if (LittleFS.exists(kCutTmp)) LittleFS.remove(kCutTmp);
+
+  const String view = "/" + DataFiles::baseName() + "_VIEW.txt";   // podgląd /measure starszych wersji
+  if (LittleFS.exists(view)) LittleFS.remove(view);
+
+  repair(DataFiles::pathCurrent(), TAIL_CSV_CRC);
+  repair(DataFiles::pathCurrentBin(), TAIL_BIN);
+  repair("/alarmy_" + DataFiles::macNoSep() + ".txt", TAIL_LINES);
+
+  gStats.ms = millis() - t0;
+  LOGI("Recovery: %u files, %u truncated (%lu B), %u marker ops, %lu ms",
+       (unsigned)gStats.files, (unsigned)gStats.truncated, (unsigned long)gStats.bytesCut,
+       (unsigned)gStats.walOps, (unsigned long)gStats.ms);
+  return gStats;
+}
+
+Stats stats() { return gStats; }
+
+void requeueOrphans() {
+  const String prefix = "alarmy_" + DataFiles::macNoSep() + "_";
+  std::vector<String> found;               // enqueue zapisuje w katalogu – najpierw lista
+  File root = LittleFS.open("/");
+  if (!root) return;
+  for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+    String name = String(f.name());
+    if (name.startsWith("/")) name = name.substring(1);
+    if (name.startsWith(prefix)) found.push_back("/" + name);
+  }
+  root.close();
+
+  const String dir = Config::get().ftp_dir;
+  for (const String& p : found) {
+    if (FTPQ::contains(p.c_str())) continue;
+    if (FTPQ::enqueue(p.c_str(), dir.c_str())) LOGW("Recovery: %s re-enqueued", p.c_str());
+  }
+}
+
+} // namespace Recovery
@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+
+// Porządki po zaniku zasilania (LittleFS commituje atomowo, ale operacja
+// złożona z kilku kroków albo linia przecięta granicą bloku FileWriter może
+// zostać w połowie).
+//
+// Znacznik operacji ("/fs_wal.txt", zapis tmp + rename – jest cały albo go
+// nie ma) stawiany przed pierwszym krokiem, zdejmowany po ostatnim:
+//   SHIFT  p0 p1 p2 [rm] – rm usunięty, p2 usunięty, p1 -> p2, p0 -> p1;
+//                          przy starcie dokańczany (kroki idempotentne)
+//   EXPORT dst           – plik budowany z innych (dawniej segment CSV z
+//                          .bin); przy starcie usuwany, źródła nietknięte
+//
+// run() w setup() tuż po LittleFS.begin(): znacznik, potem ogony plików
+// dopisywanych (D_<MAC>.txt: ostatnie linie z CRC16, D_<MAC>.bin: ramki
+// BinSeries, alarmy: pełne linie) obcinane do ostatniego poprawnego rekordu.
+// Czyta tylko końcówki (kTailBytes) i mały .bin (bieżące dane zamykane w
+// segment przy FILE_SIZE_LIMIT), obcina w miejscu – czas nie zależy od
+// zapełnienia partycji ani od przerwy w wysyłce FTP. Kolejkę FTP odbudowują FTPQ::begin() (zadania bez
+// pliku odpadają), Measure::startMCP3424() (segmenty) i requeueOrphans().
+namespace Recovery {
+
+enum Op : char { OP_SHIFT = 'S', OP_EXPORT = 'E' };
+
+static const size_t kTailBytes = 1024;   // końcówka sprawdzana w plikach CSV
+
+bool mark(Op op, const String& a, const String& b = String(),
+          const String& c = String(), const String& d = String());
+void clear();
+// obcięcie pliku do len B w miejscu (truncate() z VFS); gdy się nie uda –
+// kopia prefiksu i rename na miejsce oryginału. Po zaniku zasilania stary
+// albo obcięty plik
+bool truncate(const String& path, size_t len);
+
+struct Stats {
+  uint16_t files;        // sprawdzone pliki
+  uint16_t truncated;    // obcięte
+  uint32_t bytesCut;
+  uint8_t  walOps;       // dokończone/wycofane operacje ze znacznika
+  uint32_t ms;
+};
+
+Stats run();
+Stats stats();
+// obrócone alarmy (alarmy_<MAC>_<epoch>.txt) bez zadania w kolejce – po FTPQ::begin()
+void  requeueOrphans();
+
+} // namespace Recovery
@@ -2,6 +2,8 @@
 #include <LittleFS.h>
 #include "log.h"
 #include "ftp_upload.h"   // FTP::uploadFile(local_path, remote_dir)
+#include "ftp_session.h"
+#include "config.h"       // ftpq_drain_ms / ftpq_drain_kb
 #include <WiFi.h>
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -15,6 +17,7 @@ namespace {
 
 // Plik z kolejką (trwałość)
 constexpr const char* kQueueFile = "/ftp_queue.txt";
+constexpr const char* kQueueTmp  = "/ftp_queue.tmp";   // zapis + rename: stara albo nowa kolejka
 // Pojemność kolejki w pamięci
 constexpr size_t kMaxTasks = 128;
 
@@ -23,6 +26,7 @@ constexpr uint32_t kInitialBackoffMs = 5000;    // 5s
 constexpr uint32_t kMaxBackoffMs     = 120000;  // 120s
 static uint8_t  gMaxRetries = 5;
 static bool     gDeleteLocalOnSuccess = true;
+static void   (*gRetireHook)(const String&) = nullptr;
 
 // Zadanie w kolejce
 struct Task {
@@ -31,12 +35,33 @@ struct Task {
   uint8_t tries = 0;
   uint32_t backoffMs = kInitialBackoffMs;
   uint32_t nextAtMs  = 0; // millis() kiedy najwcześniej próbować
+  FTP::Codec codec   = FTP::CODEC_NONE;   // ustalany przy enqueue (także po restarcie)
+  bool     keep      = false;             // po sukcesie: hak retire zamiast kasowania
+  FTP::Resume resume;                     // częściowy plik na serwerze (nazwa + potwierdzone bajty)
 };
 
 // Prosta „baza” kolejki w RAM
 static Task gQueue[kMaxTasks];
 static size_t gSize = 0;
 
+// Liczniki od startu (do /ftpq/stats i podsumowań)
+static uint32_t gUploadsOk = 0;
+static uint32_t gFailures  = 0;
+static uint32_t gRetries   = 0;
+static uint32_t gDropped   = 0;
+
+// Opróżnianie: zadania due wysyłane jedno po drugim na wspólnej sesji
+struct Drain {
+  uint32_t runs;        // ticki z co najmniej jedną wysyłką
+  uint32_t files;
+  uint64_t bytes;       // rozmiary plików lokalnych
+  uint64_t ms;
+  uint32_t budgetStops; // przerwane przez budżet czasu/bajtów
+  uint32_t lastFiles, lastBytes, lastMs;
+};
+static Drain gDrain = {};
+static bool  gNetWasOk = false;
+
 // --- NARZĘDZIA: serializacja CSV z percent-encodingiem ---
 
 static char hexDigit(uint8_t v){ return v<10 ? ('0'+v) : ('A'+(v-10)); }
@@ -105,24 +130,31 @@ static String jsonEscape(const String& s) {
 
 
 static bool saveQueue() {
-  File f = LittleFS.open(kQueueFile, "w");
+  File f = LittleFS.open(kQueueTmp, "w");
   if (!f) { LOGE("[FTPQ] save open fail"); return false; }
   for (size_t i=0;i<gSize;++i) {
     const Task& t = gQueue[i];
-    // CSV: tries,backoffMs,nextAtMs,remoteDir(local-encoded),localPath
+    // CSV: tries,backoffMs,nextAtMs,remoteDir(local-encoded),localPath[,codec[,keep[,rname,offset]]]
     String line = String((unsigned)t.tries) + "," +
                   String((unsigned)t.backoffMs) + "," +
                   String((unsigned)t.nextAtMs) + "," +
                   pctEncode(t.remoteDir) + "," +
-                  pctEncode(t.localPath) + "\n";
-    if (f.print(line) != (int)line.length()) { f.close(); return false; }
+                  pctEncode(t.localPath);
+    const bool part = t.resume.name.length() > 0;
+    if (t.codec != FTP::CODEC_NONE || t.keep || part) { line += ","; line += FTP::codecName(t.codec); }
+    if (t.keep || part) line += t.keep ? ",keep" : ",";
+    if (part) { line += ","; line += pctEncode(t.resume.name); line += ","; line += String((unsigned long)t.resume.offset); }
+    line += "\n";
+    if (f.print(line) != line.length()) { f.close(); LittleFS.remove(kQueueTmp); return false; }
   }
   f.close();
+  if (!LittleFS.rename(kQueueTmp, kQueueFile)) { LOGE("[FTPQ] save rename fail"); return false; }
   return true;
 }
 
 static bool loadQueue() {
   gSize = 0;
+  if (LittleFS.exists(kQueueTmp)) LittleFS.remove(kQueueTmp);   // zapis przerwany przed rename
   if (!LittleFS.exists(kQueueFile)) {
     File nf = LittleFS.open(kQueueFile, "w");
     if (!nf) { LOGE("[FTPQ] create file fail"); return false; }
@@ -131,6 +163,7 @@ static bool loadQueue() {
   }
   File f = LittleFS.open(kQueueFile, "r");
   if (!f) { LOGE("[FTPQ] open file fail"); return false; }
+  unsigned dropped = 0;
 
   while (f.available() && gSize < kMaxTasks) {
     String line = f.readStringUntil('\n');
@@ -142,25 +175,43 @@ static bool loadQueue() {
     int p3 = (p2>=0) ? line.indexOf(',', p2+1) : -1;
     int p4 = (p3>=0) ? line.indexOf(',', p3+1) : -1;
     if (p1<0 || p2<0 || p3<0 || p4<0) continue;
+    int p5 = line.indexOf(',', p4+1);     // opcjonalny kodek (starsze wpisy bez)
+    int p6 = (p5>=0) ? line.indexOf(',', p5+1) : -1;
+    int p7 = (p6>=0) ? line.indexOf(',', p6+1) : -1;   // opcjonalne wznowienie
+    int p8 = (p7>=0) ? line.indexOf(',', p7+1) : -1;
 
     Task t;
     t.tries     = (uint8_t) line.substring(0, p1).toInt();
     t.backoffMs = (uint32_t)line.substring(p1+1, p2).toInt();
     t.nextAtMs  = (uint32_t)line.substring(p2+1, p3).toInt();
     t.remoteDir = pctDecode(line.substring(p3+1, p4));
-    t.localPath = pctDecode(line.substring(p4+1));
+    t.localPath = pctDecode(p5 < 0 ? line.substring(p4+1) : line.substring(p4+1, p5));
+    t.codec     = p5 < 0 ? FTP::CODEC_NONE
+                         : FTP::codecFromName(p6 < 0 ? line.substring(p5+1) : line.substring(p5+1, p6));
+    t.keep      = p6 >= 0 && (p7 < 0 ? line.substring(p6+1) : line.substring(p6+1, p7)) == "keep";
+    if (p8 >= 0) {
+      t.resume.name   = pctDecode(line.substring(p7+1, p8));
+      t.resume.offset = (uint32_t)strtoul(line.substring(p8+1).c_str(), nullptr, 10);
+    }
     if (t.backoffMs==0) t.backoffMs = kInitialBackoffMs;
 
+    // plik wysłany/usunięty tuż przed zanikiem zasilania (kolejka niezapisana)
+    if (!LittleFS.exists(t.localPath)) {
+      LOGW("[FTPQ] task dropped, no local file: %s", t.localPath.c_str());
+      ++dropped;
+      continue;
+    }
     gQueue[gSize++] = t;
   }
   f.close();
+  if (dropped) saveQueue();
   return true;
 }
 
-// usunięcie elementu 0 (po przetworzeniu) – przesuwa ogon
-static void popFront() {
-  if (gSize==0) return;
-  for (size_t i=1;i<gSize;++i) gQueue[i-1] = gQueue[i];
+// usunięcie elementu i (po przetworzeniu) – przesuwa ogon
+static void removeAt(size_t i) {
+  if (i >= gSize) return;
+  for (size_t k=i+1;k<gSize;++k) gQueue[k-1] = gQueue[k];
   --gSize;
 }
 
@@ -176,8 +227,13 @@ bool begin() {
 
 void setDeleteLocalOnSuccess(bool enable){ gDeleteLocalOnSuccess = enable; }
 void setMaxRetries(uint8_t maxRetries){ gMaxRetries = maxRetries; }
+void setRetireHook(void (*fn)(const String&)){ gRetireHook = fn; }
 
 bool enqueue(const char* local_path, const char* remote_dir) {
+  return enqueue(local_path, remote_dir, FTP::defaultCodec());
+}
+
+bool enqueue(const char* local_path, const char* remote_dir, FTP::Codec codec, bool keepLocal) {
   if (!local_path || !*local_path) return false;
   if (gSize >= kMaxTasks) { LOGE("[FTPQ] queue full"); return false; }
 
@@ -187,13 +243,30 @@ bool enqueue(const char* local_path, const char* remote_dir) {
   t.tries     = 0;
   t.backoffMs = kInitialBackoffMs;
   t.nextAtMs  = 0;  // od razu „due”
+  t.codec     = codec;
+  t.keep      = keepLocal;
 
   gQueue[gSize++] = t;
   bool ok = saveQueue();
-  LOGI("[FTPQ] enqueued: local=%s, dir=%s, size=%u", t.localPath.c_str(), t.remoteDir.c_str(), (unsigned)gSize);
+  LOGI("[FTPQ] enqueued: local=%s, dir=%s, codec=%s, size=%u", t.localPath.c_str(), t.remoteDir.c_str(),
+       codec == FTP::CODEC_NONE ? "none" : FTP::codecName(codec), (unsigned)gSize);
   return ok;
 }
 
+bool contains(const char* local_path) {
+  for (size_t i=0;i<gSize;++i) if (gQueue[i].localPath == local_path) return true;
+  return false;
+}
+
+bool remove(const char* local_path) {
+  size_t w = 0;
+  for (size_t i=0;i<gSize;++i) if (gQueue[i].localPath != local_path) gQueue[w++] = gQueue[i];
+  if (w == gSize) return false;
+  gSize = w;
+  saveQueue();
+  return true;
+}
+
 bool clear() {
   gSize = 0;
   return saveQueue();
@@ -202,7 +275,7 @@ bool clear() {
 size_t size() { return gSize; }
 
 Stats stats() {
-  Stats s{gSize, 0};
+  Stats s{gSize, 0, gUploadsOk, gFailures, gRetries, gDropped};
   if (gSize==0) return s;
   uint32_t now = millis();
   int32_t dt = (int32_t)(gQueue[0].nextAtMs - now);
@@ -215,37 +288,41 @@ static bool isNetworkOk() {
   return WiFi.status() == WL_CONNECTED;
 }
 
-bool tick() {
-  if (gSize == 0) return false;
-
-  // tylko pierwszy element (FIFO)
-  Task &t = gQueue[0];
-
-  uint32_t now = millis();
-  if ((int32_t)(t.nextAtMs - now) > 0) {
-    // jeszcze nie pora
-    return false;
-  }
-
-  if (!isNetworkOk()) {
-    // odłóż na później (nie zwiększaj tries)
-    t.nextAtMs = now + 3000; // 3s
-    saveQueue();
-    return false;
-  }
+static uint32_t localSize(const String& path) {
+  File f = LittleFS.open(path, "r");
+  const uint32_t n = f ? (uint32_t)f.size() : 0;
+  if (f) f.close();
+  return n;
+}
 
-  // Wysyłka
+// Wysyłka zadania i: sukces -> zadanie usunięte (plik skasowany albo hak
+// retire), błąd -> backoff albo porzucenie po gMaxRetries. true = sukces.
+static bool runTask(size_t i) {
+  Task &t = gQueue[i];
+  const uint32_t now = millis();
   LOGI("[FTPQ] start upload: local=%s, dir=%s, try=%u/%u",
        t.localPath.c_str(), t.remoteDir.c_str(), (unsigned)(t.tries+1), (unsigned)gMaxRetries);
 
+  if (t.tries > 0) gRetries++;
+  const uint32_t before = t.resume.offset;
   bool ok = FTP::uploadFile(t.localPath.c_str(),
-                            t.remoteDir.length() ? t.remoteDir.c_str() : nullptr);
+                            t.remoteDir.length() ? t.remoteDir.c_str() : nullptr, t.codec, &t.resume);
 
   FEED_WDT();
 
   if (ok) {
-    LOGI("[FTPQ] upload OK: %s", t.localPath.c_str());
-    // po sukcesie – opcjonalnie usuń lokalny plik
+    gUploadsOk++;
+    LOGI("[FTPQ] upload OK: %s (%lu ms)", t.localPath.c_str(), (unsigned long)(millis() - now));
+    // po sukcesie – segment do retencji albo (opcjonalnie) usuń lokalny plik
+    const String done = t.localPath;
+    if (t.keep) {
+      // retencja przed zapisem kolejki: zanik zasilania pomiędzy zostawia
+      // zadanie bez pliku (odpada przy starcie) zamiast drugiej wysyłki
+      if (gRetireHook) gRetireHook(done);
+      removeAt(i);
+      saveQueue();
+      return true;
+    }
     if (gDeleteLocalOnSuccess && LittleFS.exists(t.localPath)) {
       if (LittleFS.remove(t.localPath)) {
         LOGI("[FTPQ] local deleted: %s", t.localPath.c_str());
@@ -253,18 +330,29 @@ bool tick() {
         LOGW("[FTPQ] local delete failed: %s", t.localPath.c_str());
       }
     }
-    popFront();
+    removeAt(i);
     saveQueue();
     return true;
   }
 
   // Niepowodzenie: backoff / retry
+  gFailures++;
+  if (t.resume.offset > before) {
+    // postęp na serwerze (wznowienie) – próba nie liczy się do limitu
+    t.backoffMs = kInitialBackoffMs;
+    t.nextAtMs  = now + t.backoffMs;
+    LOGW("[FTPQ] partial upload, %lu B on server, resume in %u ms", (unsigned long)t.resume.offset,
+         (unsigned)t.backoffMs);
+    saveQueue();
+    return false;
+  }
   t.tries++;
   if (t.tries >= gMaxRetries) {
+    gDropped++;
     LOGE("[FTPQ] giving up after %u tries: %s", (unsigned)t.tries, t.localPath.c_str());
-    popFront();
+    removeAt(i);
     saveQueue();
-    return true;
+    return false;
   }
 
   // backoff z eksponentą i sufitem
@@ -272,6 +360,60 @@ bool tick() {
   t.nextAtMs  = now + t.backoffMs;
   LOGW("[FTPQ] retry scheduled in %u ms (try %u/%u)", (unsigned)t.backoffMs, (unsigned)t.tries+1, (unsigned)gMaxRetries);
   saveQueue();
+  return false;
+}
+
+bool tick() {
+  if (gSize == 0) return false;
+
+  uint32_t now = millis();
+  if (!isNetworkOk()) {
+    gNetWasOk = false;
+    Task &t = gQueue[0];
+    if ((int32_t)(t.nextAtMs - now) > 0) return false;   // jeszcze nie pora
+    // odłóż na później (nie zwiększaj tries)
+    t.nextAtMs = now + 3000; // 3s
+    saveQueue();
+    return false;
+  }
+  if (!gNetWasOk) {
+    // sieć wróciła (albo start): cała zaległa kolejka od razu due
+    gNetWasOk = true;
+    for (size_t i=0;i<gSize;++i) gQueue[i].nextAtMs = now;
+    LOGI("[FTPQ] network up, draining %u tasks", (unsigned)gSize);
+  }
+
+  // Zadania due po kolei (FIFO, zadania w backoffie pomijane) na jednej
+  // sesji FTP, aż do budżetu czasu/bajtów z Config albo pierwszego błędu
+  const ConfigData& c = Config::get();
+  const uint64_t maxBytes = (uint64_t)c.ftpq_drain_kb * 1024ULL;
+  uint32_t files = 0, bytes = 0;
+  bool did = false, budget = false;
+  size_t i = 0;
+  while (i < gSize) {
+    if ((int32_t)(gQueue[i].nextAtMs - millis()) > 0) { ++i; continue; }
+    if (did && (millis() - now >= c.ftpq_drain_ms || bytes >= maxBytes)) { budget = true; break; }
+    did = true;
+    const uint32_t size = localSize(gQueue[i].localPath);
+    if (!runTask(i)) break;                 // serwer/łącze – reszta po backoffie
+    ++files;
+    bytes += size;
+  }
+  if (!did) return false;
+
+  if (files) {
+    const uint32_t ms = millis() - now;
+    ++gDrain.runs;
+    gDrain.files += files;
+    gDrain.bytes += bytes;
+    gDrain.ms    += ms;
+    gDrain.lastFiles = files; gDrain.lastBytes = bytes; gDrain.lastMs = ms;
+    if (budget) ++gDrain.budgetStops;
+    if (files > 1) {
+      LOGI("[FTPQ] drained %u files, %lu B in %lu ms%s", (unsigned)files, (unsigned long)bytes,
+           (unsigned long)ms, budget ? " (budget, rest next tick)" : "");
+    }
+  }
   return true;
 }
 
@@ -286,6 +428,41 @@ String toJson() {
     int32_t dt = (int32_t)(gQueue[0].nextAtMs - now);
     js += (dt > 0) ? String((uint32_t)dt) : "0";
   }
+  js += ",\"uploadsOk\":"; js += (unsigned)gUploadsOk;
+  js += ",\"failures\":";  js += (unsigned)gFailures;
+  js += ",\"retries\":";   js += (unsigned)gRetries;
+  js += ",\"dropped\":";   js += (unsigned)gDropped;
+  js += ",\"drain\":{\"runs\":"; js += (unsigned)gDrain.runs;
+  js += ",\"files\":";       js += (unsigned)gDrain.files;
+  js += ",\"bytes\":";       js += String((unsigned long)gDrain.bytes);
+  js += ",\"ms\":";          js += String((unsigned long)gDrain.ms);
+  js += ",\"Bps\":";         js += String((unsigned long)(gDrain.ms ? gDrain.bytes * 1000ULL / gDrain.ms : 0));
+  js += ",\"budgetStops\":"; js += (unsigned)gDrain.budgetStops;
+  js += ",\"last\":{\"files\":"; js += (unsigned)gDrain.lastFiles;
+  js += ",\"bytes\":";       js += (unsigned)gDrain.lastBytes;
+  js += ",\"ms\":";          js += (unsigned)gDrain.lastMs;
+  js += "}}";
+  {
+    const FTP::Stats fs = FTP::stats();
+    js += ",\"upload\":{\"bytesSent\":"; js += String((unsigned long)fs.bytesSent);
+    js += ",\"resumes\":";      js += (unsigned)fs.resumes;
+    js += ",\"bytesResumed\":"; js += String((unsigned long)fs.bytesResumed);
+    js += "}";
+  }
+  {
+    const FtpSession::Stats ss = FtpSession::stats();
+    js += ",\"session\":{\"active\":"; js += FtpSession::active() ? "true" : "false";
+    js += ",\"logins\":";     js += (unsigned)ss.logins;
+    js += ",\"reuses\":";     js += (unsigned)ss.reuses;
+    js += ",\"reconnects\":"; js += (unsigned)ss.reconnects;
+    js += ",\"noops\":";      js += (unsigned)ss.noops;
+    js += ",\"idleCloses\":"; js += (unsigned)ss.idleCloses;
+    js += ",\"lists\":";      js += (unsigned)ss.lists;
+    js += ",\"listNames\":";  js += (unsigned)ss.listNames;
+    js += ",\"nameHits\":";   js += (unsigned)ss.nameHits;
+    js += ",\"nameProbes\":"; js += (unsigned)ss.nameProbes;
+    js += "}";
+  }
   js += ",\"items\":[";
   for (size_t i=0;i<gSize;++i) {
     if (i) js += ",";
@@ -294,7 +471,10 @@ String toJson() {
     js += "{";
       js += "\"local\":\"";    js += jsonEscape(t.localPath); js += "\"";
       js += ",\"dir\":\"";      js += jsonEscape(t.remoteDir); js += "\"";
+      js += ",\"codec\":\"";    js += FTP::codecName(t.codec); js += "\"";
+      js += ",\"keep\":";       js += t.keep ? "true" : "false";
       js += ",\"tries\":";      js += (unsigned)t.tries;
+      js += ",\"offset\":";     js += (unsigned)t.resume.offset;
       js += ",\"backoffMs\":";  js += (unsigned)t.backoffMs;
       js += ",\"nextAtMs\":";   js += (unsigned)t.nextAtMs;
       js += ",\"dueInMs\":";    js += (due>0) ? String((uint32_t)due) : "0";
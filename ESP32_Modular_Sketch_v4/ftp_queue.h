@@ -1,34 +1,48 @@
 #pragma once
 #include <Arduino.h>
+#include "ftp_upload.h"   // FTP::Codec
 
 // Prosta trwała kolejka z backoffem do wysyłek FTP.
 // Użycie:
 //   FTPQ::begin();
 //   FTPQ::enqueue("/logs/dump1.txt", "inbox");     // zapisze do /inbox na FTP (CWD inbox)
 //   FTPQ::enqueue("/logs/dump2.txt", "");          // bieżący katalog FTP
-//   W loop(): FTPQ::tick();  // przetwarza 1 zadanie, gdy pora
+//   W loop(): FTPQ::tick();  // wysyła zadania due (drain), gdy pora
 
 namespace FTPQ {
 
 struct Stats {
   size_t size;         // ile zadań w kolejce
   uint32_t nextDueMs;  // za ile ms najbliższe zadanie jest „due” (0 gdy już due lub brak)
+  // liczniki od startu (RAM, nie są zapisywane)
+  uint32_t uploadsOk;  // udane wysyłki
+  uint32_t failures;   // nieudane próby (każda)
+  uint32_t retries;    // próby powtórne (tries > 0)
+  uint32_t dropped;    // zadania porzucone po gMaxRetries
 };
 
 bool begin();  // ładuje kolejkę z LittleFS, tworzy plik jeśli brak
-bool enqueue(const char* local_path, const char* remote_dir); // dodaje zadanie
+bool enqueue(const char* local_path, const char* remote_dir); // dodaje zadanie (kodek wg Config ftp_gzip)
+// keepLocal: po sukcesie plik zostaje i trafia do haka setRetireHook (np.
+// zamknięty segment danych -> retencja _1/_2) zamiast kasowania
+bool enqueue(const char* local_path, const char* remote_dir, FTP::Codec codec, bool keepLocal = false);
+bool contains(const char* local_path);   // czy plik czeka w kolejce
+bool remove(const char* local_path);     // usuwa zadania pliku (np. plik usunięty przez Quota)
 bool clear();  // kasuje całą kolejkę
 size_t size(); // liczba zadań
 Stats stats();
 // --- JSON snapshot kolejki (do WebUI) ---
 String toJson();
 
-// Przetwarza co najwyżej 1 zadanie: jeśli warunki spełnione (czas, sieć itp.).
+// Wysyła po kolei zadania due na jednej sesji FTP (FtpSession), aż do budżetu
+// ftpq_drain_ms / ftpq_drain_kb z Config (ftpq_drain_ms=0: 1 zadanie) albo
+// pierwszego błędu. Po powrocie sieci cała zaległa kolejka jest od razu due.
 // Wywołuj często w loop(). Zwraca true, jeśli coś zrobiła (sukces lub próba).
 bool tick();
 
 // (opcjonalnie) ustawienia
 void setDeleteLocalOnSuccess(bool enable); // domyślnie true
 void setMaxRetries(uint8_t maxRetries);    // domyślnie 5
+void setRetireHook(void (*fn)(const String& localPath));   // dla zadań keepLocal
 
 } // namespace FTPQ
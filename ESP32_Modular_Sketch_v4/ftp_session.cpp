@@ -0,0 +1,254 @@
+#include "ftp_session.h"
+#include "config.h"
+#include "gsm_wifi.h"
+#include "ftp_utils.h"
+#include "log.h"
+#include <algorithm>
+#include <vector>
+
+namespace FtpSession {
+
+static Client*  g_ctrl = nullptr;
+static String   g_host;
+static String   g_home;               // katalog po zalogowaniu (PWD), "" = nieznany
+static String   g_dir;                // katalog, w którym jest sesja
+static String   g_want;               // katalog ostatniego acquire() – dla reconnect()
+static bool     g_busy = false;
+static uint32_t g_lastUseMs = 0;      // ostatnie release()
+static uint32_t g_lastIoMs  = 0;      // ostatnia komenda (także NOOP)
+static Stats    g_stats = {};
+
+enum ListState : uint8_t { LS_NONE, LS_OK, LS_PROBE };   // LS_PROBE: bez listy do końca sesji
+static std::vector<uint32_t> g_names;  // posortowane skróty nazw katalogu g_dir
+static uint8_t  g_list = LS_NONE;
+
+static void forgetList() {
+  g_list = LS_NONE;
+  g_names.clear();
+  g_names.shrink_to_fit();
+  g_stats.listNames = 0;
+}
+
+static void drop() {
+  if (g_ctrl) { g_ctrl->stop(); Net::disposeClient(g_ctrl); g_ctrl = nullptr; }
+  g_home = g_dir = "";
+  forgetList();
+}
+
+// 257 "<ścieżka>" ...
+static String quoted(const String& line) {
+  const int l = line.indexOf('"'), r = line.indexOf('"', l + 1);
+  return (l >= 0 && r > l) ? line.substring(l + 1, r) : String();
+}
+
+// katalog bezwzględny dla dir (względny – od katalogu logowania)
+static String target(const char* dir) {
+  const String d = dir ? String(dir) : String();
+  if (!d.length()) return g_home;
+  if (d.startsWith("/") || !g_home.length()) return d;
+  return g_home.endsWith("/") ? g_home + d : g_home + "/" + d;
+}
+
+static bool login() {
+  const auto& cfg = Config::get();
+  g_ctrl = Net::newClient();
+  if (!g_ctrl) { LOGE("[FTPS] no ctrl client"); return false; }
+  if (!g_ctrl->connect(cfg.ftp_host.c_str(), cfg.ftp_port)) { LOGE("FTP ctrl connect fail"); drop(); return false; }
+  if (ftpReadCode(*g_ctrl, nullptr, 12000) != 220) { LOGE("FTP 220 fail"); drop(); return false; }
+  ftpSend(*g_ctrl, "USER " + cfg.ftp_user);
+  int code = ftpReadCode(*g_ctrl);
+  if (code == 0 || code >= 400) { LOGE("FTP USER fail"); drop(); return false; }
+  if (code == 331) {
+    ftpSend(*g_ctrl, "PASS " + cfg.ftp_pass);
+    code = ftpReadCode(*g_ctrl);
+    if (code == 0 || code >= 400) { LOGE("FTP PASS fail"); drop(); return false; }
+  }
+  ftpSend(*g_ctrl, "TYPE I");
+  code = ftpReadCode(*g_ctrl);
+  if (code == 0 || code >= 400) { LOGE("FTP TYPE fail"); drop(); return false; }
+  String line;
+  ftpSend(*g_ctrl, "PWD");
+  if (ftpReadCode(*g_ctrl, &line) == 257) g_home = quoted(line);
+  g_dir  = g_home;
+  g_host = cfg.ftp_host;
+  g_lastIoMs = g_lastUseMs = millis();
+  ++g_stats.logins;
+  LOGI("[FTPS] session open %s:%u, home '%s'", cfg.ftp_host.c_str(), (unsigned)cfg.ftp_port, g_home.c_str());
+  return true;
+}
+
+// CWD tylko przy zmianie katalogu; false = brak odpowiedzi albo (strict) odmowa
+static bool changeDir(const char* dir, bool strict) {
+  const String t = target(dir);
+  if (!t.length() || t == g_dir) return true;
+  ftpSend(*g_ctrl, "CWD " + t);
+  ++g_stats.cwds;
+  const int code = ftpReadCode(*g_ctrl);
+  g_lastIoMs = millis();
+  if (code == 0) return false;
+  if (code >= 400) {
+    LOGW("FTP CWD %s fail (%d)%s", t.c_str(), code, strict ? "" : ", continue in current dir");
+    return !strict;
+  }
+  g_dir = t;
+  forgetList();
+  return true;
+}
+
+static bool noop() {
+  ++g_stats.noops;
+  ftpSend(*g_ctrl, "NOOP");
+  const int code = ftpReadCode(*g_ctrl, nullptr, 5000);
+  g_lastIoMs = millis();
+  return code >= 200 && code < 300;
+}
+
+// sesja nadal zalogowana: połączenie, brak zaległego 421, NOOP po dłuższej ciszy
+static bool alive() {
+  if (!g_ctrl->connected()) return false;
+  if (g_ctrl->available()) {
+    String line;
+    const int code = ftpReadCode(*g_ctrl, &line, 500);
+    LOGW("[FTPS] unsolicited reply: %s", line.c_str());
+    if (code == 0 || code == 421) return false;
+  }
+  return millis() - g_lastIoMs < kProbeMs || noop();
+}
+
+Client* acquire(const char* dir, bool strictDir) {
+  if (g_busy) { LOGW("[FTPS] session busy"); return nullptr; }
+  if (!Net::connected()) { drop(); return nullptr; }
+  if (g_ctrl && g_host != Config::get().ftp_host) close();   // zmiana serwera w configu
+  if (g_ctrl && !alive()) {
+    ++g_stats.reconnects;
+    LOGW("[FTPS] session lost, relogin");
+    drop();
+  }
+  if (g_ctrl) ++g_stats.reuses;
+  else if (!login()) return nullptr;
+
+  g_want = dir ? dir : "";
+  if (!changeDir(dir, strictDir)) {
+    if (g_ctrl && g_ctrl->connected()) return nullptr;   // odmowa CWD (strict) – sesja zostaje
+    drop();
+    return nullptr;
+  }
+  g_busy = true;
+  return g_ctrl;
+}
+
+void release(bool healthy) {
+  g_busy = false;
+  g_lastIoMs = g_lastUseMs = millis();
+  if (!healthy) drop();
+}
+
+Client* reconnect() {
+  drop();
+  ++g_stats.reconnects;
+  if (!Net::connected() || !login()) return nullptr;
+  if (!changeDir(g_want.c_str(), false)) { drop(); return nullptr; }
+  return g_ctrl;
+}
+
+void close() {
+  if (!g_ctrl || g_busy) return;
+  ftpSend(*g_ctrl, "QUIT");
+  (void)ftpReadCode(*g_ctrl, nullptr, 2000);
+  drop();
+}
+
+void tick() {
+  if (!g_ctrl || g_busy) return;
+  if (!Net::connected() || !g_ctrl->connected()) { drop(); return; }
+  const uint32_t now = millis();
+  if (now - g_lastUseMs >= kIdleTimeoutMs) {
+    ++g_stats.idleCloses;
+    LOGI("[FTPS] idle %lu s, closing", (unsigned long)((now - g_lastUseMs) / 1000));
+    close();
+    return;
+  }
+  if (now - g_lastIoMs >= kKeepaliveMs && !noop()) {
+    LOGW("[FTPS] keepalive failed, session dropped");
+    drop();
+  }
+}
+
+// FNV-1a: kolizja skrótów daje tylko niepotrzebny wariant +N
+static uint32_t hashName(const String& name) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < name.length(); ++i) { h ^= (uint8_t)name[i]; h *= 16777619u; }
+  return h;
+}
+
+static bool taken(const String& name) {
+  return std::binary_search(g_names.begin(), g_names.end(), hashName(name));
+}
+
+static bool collect(void*, const String& name) {
+  if (g_names.size() >= kMaxNames) return false;
+  g_names.push_back(hashName(name));
+  return true;
+}
+
+static void fetchList() {
+  g_names.clear();
+  const uint32_t t0 = millis();
+  const bool ok = ftpListDir(*g_ctrl, g_host, collect, nullptr);
+  g_lastIoMs = millis();
+  if (!ok || g_names.size() >= kMaxNames) {
+    LOGW("[FTPS] no listing of '%s' (%s), probing names one by one", g_dir.c_str(),
+         ok ? "too many files" : "refused");
+    forgetList();
+    g_list = LS_PROBE;
+    return;
+  }
+  std::sort(g_names.begin(), g_names.end());
+  g_list = LS_OK;
+  ++g_stats.lists;
+  g_stats.listNames = g_names.size();
+  LOGI("[FTPS] listing of '%s': %u names, %lu ms", g_dir.c_str(), (unsigned)g_names.size(),
+       (unsigned long)(millis() - t0));
+}
+
+String uniqueName(const String& name) {
+  if (!g_ctrl) return name;
+  if (g_list == LS_NONE) fetchList();
+  if (g_list != LS_OK) { ++g_stats.nameProbes; return ftpUniqueName(*g_ctrl, name, g_host); }
+  ++g_stats.nameHits;
+  if (!taken(name)) return name;
+
+  const int dot = name.lastIndexOf('.');
+  const String base = dot > 0 ? name.substring(0, dot) : name;
+  const String ext  = dot > 0 ? name.substring(dot) : String();
+  for (int i = 1; i <= 999; ++i) {
+    const String cand = base + "+" + String(i) + ext;
+    if (!taken(cand)) {
+      LOGW("[FTP] Remote name already exists: %s, using %s", name.c_str(), cand.c_str());
+      return cand;
+    }
+  }
+  const String fallback = base + "+" + String((uint32_t)esp_random()) + ext;
+  LOGW("[FTP] Many candidates taken; fallback unique name: %s", fallback.c_str());
+  return fallback;
+}
+
+void noteStored(const String& name) {
+  if (g_list != LS_OK) return;
+  const uint32_t h = hashName(name);
+  g_names.insert(std::upper_bound(g_names.begin(), g_names.end(), h), h);
+  g_stats.listNames = g_names.size();
+}
+
+void noteRenamed(const String& from, const String& to) {
+  if (g_list != LS_OK) return;
+  auto it = std::lower_bound(g_names.begin(), g_names.end(), hashName(from));
+  if (it != g_names.end() && *it == hashName(from)) g_names.erase(it);
+  noteStored(to);
+}
+
+const String& host() { return g_host; }
+bool active() { return g_ctrl != nullptr; }
+Stats stats() { return g_stats; }
+
+} // namespace FtpSession
@@ -0,0 +1,59 @@
+#pragma once
+#include <Arduino.h>
+#include <Client.h>
+
+// Jedna zalogowana sesja sterująca FTP współdzielona przez FTP::uploadFile
+// (zadania FTPQ) i CfgSync. Dawniej każda wysyłka robiła pełny cykl
+// connect/220/USER/PASS/TYPE I/CWD/.../QUIT, a CfgSync otwierał drugą sesję
+// własnym klientem – na GSM każde logowanie to kilka RTT plus TCP.
+//
+// acquire() oddaje sesję gotową do komend w katalogu dir (CWD tylko przy
+// zmianie katalogu), po pracy release(). Sesja bezczynna dostaje NOOP co
+// kKeepaliveMs, po kIdleTimeoutMs bez użycia jest zamykana (QUIT). Zerwana
+// sesja (serwer zamknął, 421, brak odpowiedzi na NOOP) jest odtwarzana przy
+// następnym acquire(). Wywołania tylko z loop() – sesja naraz u jednego
+// użytkownika (busy).
+//
+// Nazwy w katalogu sesji: lista (MLSD/NLST) pobierana raz, przy pierwszym
+// uniqueName(), jako posortowane skróty FNV-1a (4 B na nazwę, do
+// kMaxNames). STOR/RNTO dopisują zmiany (noteStored/noteRenamed), zmiana
+// katalogu i każde nowe logowanie listę unieważniają. Bez listy (serwer
+// odmawia, katalog za duży) – dawne sprawdzanie nazwa po nazwie.
+namespace FtpSession {
+
+static const uint32_t kKeepaliveMs   = 30000;
+static const uint32_t kIdleTimeoutMs = 120000;
+static const uint32_t kProbeMs       = 10000;   // dłużej bez ruchu – NOOP przed oddaniem
+static const uint16_t kMaxNames      = 4096;    // więcej nazw w katalogu – bez listy
+
+struct Stats {
+  uint32_t logins;       // nowe sesje (connect + USER/PASS)
+  uint32_t reuses;       // acquire() bez logowania
+  uint32_t reconnects;   // sesja zerwana wykryta przy acquire()
+  uint32_t noops;        // keepalive i sondy
+  uint32_t idleCloses;   // zamknięcia po kIdleTimeoutMs
+  uint32_t cwds;         // wysłane CWD
+  uint32_t lists;        // pobrane listy katalogu
+  uint32_t listNames;    // nazwy w bieżącej liście
+  uint32_t nameHits;     // uniqueName() rozstrzygnięte z listy
+  uint32_t nameProbes;   // uniqueName() przez SIZE/MLST/NLST (brak listy)
+};
+
+// nullptr = brak sieci / logowanie nieudane / sesja zajęta; strictDir – odmowa
+// CWD też daje nullptr (inaczej praca w bieżącym katalogu, jak dawniej)
+Client*       acquire(const char* dir, bool strictDir = false);
+// healthy=false: stan protokołu niepewny (ABOR, brak kodu) – sesja zamykana
+void          release(bool healthy = true);
+// zerwanie w trakcie pracy: zamknięcie i nowe logowanie w tym samym katalogu
+Client*       reconnect();
+void          close();                       // QUIT i zamknięcie
+void          tick();                        // z loop(): keepalive / idle timeout
+const String& host();                        // host kontrolny (dla połączeń DATA)
+// wolna nazwa w katalogu sesji: name, name+1.ext, ... (sesja wzięta przez acquire())
+String        uniqueName(const String& name);
+void          noteStored(const String& name);                       // po STOR
+void          noteRenamed(const String& from, const String& to);    // po RNTO
+bool          active();
+Stats         stats();
+
+} // namespace FtpSession
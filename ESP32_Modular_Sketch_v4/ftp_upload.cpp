@@ -3,7 +3,12 @@
 #include "gsm_wifi.h"
 #include "log.h"
 #include "ftp_utils.h"     // <--- DODANE
+#include "ftp_session.h"
+#include "gzip_stream.h"
+#include "bin_series.h"
+#include "data_files.h"
 #include <LittleFS.h>
+#include <new>
 
 #ifdef ARDUINO_ARCH_ESP32
   #include <esp_task_wdt.h>
@@ -101,33 +106,105 @@ static String basenameOnly(const char* local_path) {
   return lp;
 }
 
+// ---- kodeki ----
+const char* FTP::codecName(Codec c) {
+  return c == CODEC_GZIP ? "gz" : "";
+}
+
+FTP::Codec FTP::codecFromName(const String& s) {
+  return s == "gz" ? CODEC_GZIP : CODEC_NONE;
+}
+
+FTP::Codec FTP::defaultCodec() {
+  return Config::get().ftp_gzip ? CODEC_GZIP : CODEC_NONE;
+}
+
+static FTP::Stats g_stats = {};
+
+FTP::Stats FTP::stats() { return g_stats; }
+
+// Strumień DATA: zapis całej porcji z kontrolą zerwania i zastoju (8 s);
+// pierwsze skip bajtów (już na serwerze) jest pomijane
+struct DataOut {
+  Client*       c;
+  size_t        sent;
+  size_t        skip;
+  unsigned long lastProgress;
+  bool          failed;
+};
+
+static bool dataWrite(void* ctx, const uint8_t* buf, size_t n) {
+  DataOut& o = *(DataOut*)ctx;
+  if (o.skip) {
+    const size_t k = n < o.skip ? n : o.skip;
+    o.skip -= k; buf += k; n -= k;
+  }
+  size_t off = 0;
+  while (off < n && !o.failed) {
+    if (!o.c->connected()) { LOGE("DATA closed"); o.failed = true; break; }
+    int w = o.c->write(buf + off, n - off);
+    if (w > 0) { off += (size_t)w; o.sent += (size_t)w; o.lastProgress = millis(); }
+    else       { delay(5); }
+    FEED_WDT(); delay(0);
+    if (millis() - o.lastProgress > 8000) { LOGE("DATA stalled"); o.failed = true; }
+  }
+  return !o.failed;
+}
+
+// linie CSV z dekodera BinSeries: do gzip albo prosto do DATA
+struct CsvOut {
+  Gzip::Encoder* gz;
+  DataOut*       out;
+};
+
+static void csvEmit(void* ctx, const char* line, size_t n) {
+  CsvOut& o = *(CsvOut*)ctx;
+  if (o.out->failed) return;
+  if (o.gz) o.gz->write(line, n);
+  else      dataWrite(o.out, (const uint8_t*)line, n);
+}
+
+// SIZE nazwy tymczasowej: 213 -> bajty na serwerze; 0 = brak odpowiedzi
+static int remoteSize(Client& c, const String& name, uint32_t& size) {
+  sendCmd(c, "SIZE " + name);
+  String line;
+  const int code = readResp(c, &line, 10000);
+  size = code == 213 ? (uint32_t)strtoul(line.c_str() + 4, nullptr, 10) : 0;
+  return code;
+}
+
 // ---- main ----
-bool FTP::uploadFile(const char* local_path, const char* remote_dir) {
+bool FTP::uploadFile(const char* local_path, const char* remote_dir, Codec codec, Resume* resume) {
   if (!ensureFile(local_path)) return false;
   const auto& cfg = Config::get();
 
-  auto openAndLogin = [&](Client*& ctrl)->bool {
-    // Otwórz kontrolny i zaloguj
-    ctrl = Net::newClient();
-    if (!ctrl) { LOGE("no ctrl client"); return false; }
-    if (!ctrl->connect(cfg.ftp_host.c_str(), cfg.ftp_port)) {
-      LOGE("FTP ctrl connect fail");
-      Net::disposeClient(ctrl); ctrl = nullptr; return false;
-    }
-    if (readResp(*ctrl) != 220) { LOGE("FTP 220 fail"); ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; return false; }
-    sendCmd(*ctrl, String("USER ") + cfg.ftp_user);
-    if (readResp(*ctrl) >= 400) { LOGE("FTP USER fail"); ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; return false; }
-    sendCmd(*ctrl, String("PASS ") + cfg.ftp_pass);
-    if (readResp(*ctrl) >= 400) { LOGE("FTP PASS fail"); ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; return false; }
-    sendCmd(*ctrl, "TYPE I");
-    if (readResp(*ctrl) >= 400) { LOGE("FTP TYPE fail"); ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; return false; }
-    if (remote_dir && strlen(remote_dir)) {
-      sendCmd(*ctrl, String("CWD ") + remote_dir);
-      int code = readResp(*ctrl);
-      if (code >= 400) LOGW("FTP CWD fail (%d), continue in current dir", code);
+  // kompresja w locie (~12.5 kB na czas wysyłki); bez pamięci – wysyłka bez kompresji
+  DataOut out = {};
+  Gzip::Encoder* gz = nullptr;
+  if (codec == CODEC_GZIP) {
+    gz = new (std::nothrow) Gzip::Encoder(dataWrite, &out);
+    if (!gz) {
+      // nazwa i offset wznowienia należą do strumienia gzip – bez kodera czekają
+      if (resume && resume->name.length()) {
+        LOGW("[FTP] no memory for gzip, resume of %s postponed", resume->name.c_str());
+        return false;
+      }
+      // wysyłka bez kompresji; jej stan nie trafia do zadania (kodek zadania to gzip)
+      LOGW("[FTP] no memory for gzip, sending plain");
+      codec = CODEC_NONE;
+      resume = nullptr;
     }
-    return true;
-  };
+  }
+  const char* suffix = codec == CODEC_GZIP ? ".gz" : "";
+
+  // segment .bin: serwer dostaje CSV, dekodowany w locie przed gzip (~4.5 kB);
+  // wynik jest powtarzalny, więc wznowienie pomija bajty jak przy gzip
+  CsvOut csv = { gz, &out };
+  BinSeries::Decoder* dec = nullptr;
+  if (DataFiles::isBinSegment(local_path)) {
+    dec = new (std::nothrow) BinSeries::Decoder(csvEmit, &csv);
+    if (!dec) { LOGW("[FTP] no memory for decoder, %s postponed", local_path); delete gz; return false; }
+  }
 
   auto drainCtrl = [&](Client& c, uint32_t ms=200)->void {
     // wyczyść zaległe odpowiedzi
@@ -142,40 +219,73 @@ bool FTP::uploadFile(const char* local_path, const char* remote_dir) {
   // Zadbanie o czas (dla EPOCH w końcowej nazwie)
   (void)ensureTimeSynced(1700000000UL, 15000);
 
-  Client* ctrl = nullptr;
-  if (!openAndLogin(ctrl)) return false;
+  // wspólna sesja (ftp_session.h): logowanie tylko, gdy nie ma żywej
+  Client* ctrl = FtpSession::acquire(remote_dir);
+  if (!ctrl) { delete dec; delete gz; return false; }
 
-  // Nazwa „pożądana” to sama nazwa pliku z lokalnej ścieżki:
+  // Nazwa „pożądana” to sama nazwa pliku z lokalnej ścieżki (+ sufiks kodeka):
   String desiredName = basenameOnly(local_path);
+  if (dec) desiredName = desiredName.substring(0, desiredName.length() - 4) + ".txt";
+  desiredName += suffix;
 
   const String ctrlHost = cfg.ftp_host; // zawsze używamy hosta kontrolnego (IP z PASV ignorujemy)
-  size_t totalSent = 0;
+  size_t totalSent = 0, totalRead = 0;
   bool ok = false;
 
-  // Wyznacz unikalną nazwę (sprawdza istniejące pliki: SIZE/MLST/NLST)
-  String uploadName = ftpUniqueName(*ctrl, desiredName, ctrlHost);
-// DODAJ od razu po ftpUniqueName:
-if (uploadName != desiredName) {
-  LOGW("[FTP] File with desired name already exists on server: %s -> will use: %s",
-       desiredName.c_str(), uploadName.c_str());
-} else {
-  LOGI("[FTP] Will use desired remote name: %s", desiredName.c_str());
-}
+  Resume once;
+  Resume& rs = resume ? *resume : once;
+  size_t localSize = 0;
+  { File lf = LittleFS.open(local_path, "r"); if (lf) { localSize = lf.size(); lf.close(); } }
+  // z zapisanego stanu: ile bajtów naprawdę jest na serwerze – SIZE przed próbą
+  bool needSize = rs.name.length() > 0;
+  String uploadName;
+  if (needSize) {
+    uploadName = rs.name;
+    LOGI("[FTP] Resuming %s as %s (%lu B confirmed before)", local_path, uploadName.c_str(),
+         (unsigned long)rs.offset);
+  } else {
+    // Wyznacz unikalną nazwę (lista katalogu sesji, bez listy SIZE/MLST/NLST)
+    uploadName = FtpSession::uniqueName(desiredName);
+    rs.name = uploadName;
+    rs.offset = 0;
+    if (uploadName != desiredName) {
+      LOGW("[FTP] File with desired name already exists on server: %s -> will use: %s",
+           desiredName.c_str(), uploadName.c_str());
+    } else {
+      LOGI("[FTP] Will use desired remote name: %s", desiredName.c_str());
+    }
+  }
 
   for (int attempt = 0; attempt < 3 && !ok; ++attempt) {
 
-    // Jeżeli kontrolny padł po poprzednim ABOR – odtwórz sesję
+    // Jeżeli kontrolny padł po poprzednim ABOR – odtwórz sesję; nazwa
+    // zostaje (częściowy plik na serwerze jest wznawiany)
     if (!ctrl || !ctrl->connected()) {
-      if (ctrl) { ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; }
-      if (!openAndLogin(ctrl)) { LOGE("Relogin fail"); break; }
-      // Po reloginie CWD ponownie (jeśli było ustawiane)
-      if (remote_dir && strlen(remote_dir)) {
-        sendCmd(*ctrl, String("CWD ") + remote_dir);
-        (void)readResp(*ctrl);
-      }
+      ctrl = FtpSession::reconnect();   // logowanie + CWD jak przy acquire()
+      if (!ctrl) { LOGE("Relogin fail"); break; }
       drainCtrl(*ctrl);
-      // po reloginie uploadName może już istnieć; wyznacz ponownie
-      uploadName = ftpUniqueName(*ctrl, desiredName, ctrlHost);
+    }
+
+    // potwierdzone bajty: po zerwaniu serwer mógł zapisać mniej, niż wysłaliśmy
+    if (needSize) {
+      uint32_t have = 0;
+      const int code = remoteSize(*ctrl, uploadName, have);
+      if (code == 0) { ctrl = nullptr; continue; }
+      // brak pliku / SIZE nieobsługiwane / plik dłuższy niż lokalny (gzip, .bin: nie do sprawdzenia)
+      if (code != 213 || (!gz && !dec && have > localSize)) have = 0;
+      if (have != rs.offset) LOGI("[FTP] %s: %lu B on server", uploadName.c_str(), (unsigned long)have);
+      rs.offset = have;
+      needSize = false;
+    }
+
+    // plik lokalny przewijany przed REST: błąd seek nie może wysłać danych
+    // od bajtu 0 do pliku dopisywanego od offsetu
+    File f = LittleFS.open(local_path, "r");
+    if (!f) { LOGE("open local failed"); break; }
+    if (!gz && !dec && rs.offset && !f.seek(rs.offset)) {
+      LOGE("seek local failed (%lu B), upload aborted", (unsigned long)rs.offset);
+      f.close();
+      break;
     }
 
     // Najpierw EPSV (229), potem PASV (227) – ale do data łączymy się na ctrlHost
@@ -204,7 +314,7 @@ if (uploadName != desiredName) {
       String pasvLine; code = readResp(*ctrl, &pasvLine, 15000);
       if (code != 227) {
         LOGE("PASV fail (%d)", code);
-        if (code == 0) { ctrl->stop(); Net::disposeClient(ctrl); ctrl=nullptr; }
+        if (code == 0) ctrl = nullptr;   // brak odpowiedzi – nowa sesja w następnej próbie
         continue; // następna próba
       }
       String dummyHost; uint16_t pasvPort=0;
@@ -215,23 +325,37 @@ if (uploadName != desiredName) {
       dataPort = pasvPort;
     }
 
+    // wznowienie: REST tuż przed STOR (połączenie DATA to nie komenda); odmowa REST – APPE
+    bool appe = false;
+    if (rs.offset) {
+      sendCmd(*ctrl, "REST " + String((unsigned long)rs.offset));
+      code = readResp(*ctrl, nullptr, 10000);
+      if (code == 0) { ctrl = nullptr; needSize = true; continue; }
+      appe = code != 350;
+    }
+    const String storCmd = String(appe ? "APPE " : "STOR ") + uploadName;
+
     // DATA→STOR lub STOR→DATA (elastycznie)
     Client* data = Net::newClient();
     if (!data) { LOGE("no data client"); break; }
 
     bool dataUp = connectWithTimeout(*data, ctrlHost.c_str(), dataPort, 8000);
     if (dataUp) {
-      sendCmd(*ctrl, String("STOR ") + uploadName);
+      sendCmd(*ctrl, storCmd);
     } else {
-      sendCmd(*ctrl, String("STOR ") + uploadName);
+      sendCmd(*ctrl, storCmd);
       dataUp = connectWithTimeout(*data, ctrlHost.c_str(), dataPort, 8000);
     }
 
+    // od STOR nazwa może być na serwerze (także częściowy plik po błędzie)
+    FtpSession::noteStored(uploadName);
+
     if (!dataUp) {
       LOGW("DATA connect fail %s:%u (try %d)", ctrlHost.c_str(), (unsigned)dataPort, attempt+1);
       sendCmd(*ctrl, "ABOR"); readResp(*ctrl, nullptr, 5000);
       Net::disposeClient(data);
       drainCtrl(*ctrl);
+      needSize = true;
       continue;
     }
 
@@ -242,34 +366,42 @@ if (uploadName != desiredName) {
     }
 
     // Transfer w chunkach + WDT
-    File f = LittleFS.open(local_path, "r");
-    if (!f) { LOGE("open local failed"); data->stop(); Net::disposeClient(data); break; }
-
     const size_t CHUNK = 512;
     uint8_t buf[CHUNK];
-    unsigned long lastProgress = millis();
+    out = { data, 0, 0, millis(), false };
+    if (gz)  gz->reset();
+    if (dec) dec->reset();
+    if (gz || dec) out.skip = rs.offset;
+    if (rs.offset) {
+      ++g_stats.resumes;
+      g_stats.bytesResumed += rs.offset;
+      LOGI("[FTP] %s %s from %lu B", appe ? "APPE" : "REST+STOR", uploadName.c_str(), (unsigned long)rs.offset);
+    }
+    totalRead = 0;
 
-    bool failed = false;
-    while (!failed) {
+    while (!out.failed) {
       size_t n = f.read(buf, sizeof(buf));
       if (n == 0) break;
-      size_t off = 0;
-      while (off < n) {
-        if (!data->connected()) { LOGE("DATA closed"); failed = true; break; }
-        int w = data->write(buf + off, n - off);
-        if (w > 0) { off += (size_t)w; totalSent += (size_t)w; lastProgress = millis(); }
-        else       { delay(5); }
-        FEED_WDT(); delay(0);
-        if (millis() - lastProgress > 8000) { LOGE("DATA stalled"); failed = true; break; }
-      }
+      totalRead += n;
+      if (dec)     dec->feed(buf, n);
+      else if (gz) gz->write(buf, n);
+      else         dataWrite(&out, buf, n);
     }
+    if (dec && !out.failed) dec->finish();
+    if (gz && !out.failed) gz->finish();
     f.close();
+    totalSent += out.sent;
+    g_stats.bytesSent += out.sent;
+    const bool failed = out.failed;
 
     data->stop(); Net::disposeClient(data);
 
+    // zerwany przesył: serwer zwykle sam kończy (426, albo 226 z częścią
+    // pliku); ABOR tylko bez odpowiedzi. Następna próba od bajtów z SIZE
     if (failed) {
-      sendCmd(*ctrl, "ABOR"); readResp(*ctrl, nullptr, 5000);
+      if (readResp(*ctrl, nullptr, 3000) == 0) { sendCmd(*ctrl, "ABOR"); readResp(*ctrl, nullptr, 5000); }
       drainCtrl(*ctrl);
+      needSize = true;
       continue;
     }
 
@@ -277,8 +409,9 @@ if (uploadName != desiredName) {
     int endCode = readResp(*ctrl, nullptr, 30000);
     if (endCode != 226 && endCode != 250) {
       LOGE("End code=%d", endCode);
-      sendCmd(*ctrl, "ABOR"); readResp(*ctrl, nullptr, 5000);
+      if (endCode == 0) { sendCmd(*ctrl, "ABOR"); readResp(*ctrl, nullptr, 5000); }
       drainCtrl(*ctrl);
+      needSize = true;
       continue;
     }
 
@@ -288,23 +421,33 @@ if (uploadName != desiredName) {
 
   // Jeśli upload się powiódł – spróbuj zmienić nazwę na D_MAC_EPOCH.txt
   if (ok) {
-    String target = finalDataName();
+    String target = finalDataName(suffix);
+    rs = Resume();
     if (!ftpRename(*ctrl, uploadName, target)) {
       LOGW("Rename failed: %s -> %s (file remains under interim name)", uploadName.c_str(), target.c_str());
     } else {
+      FtpSession::noteRenamed(uploadName, target);
       LOGI("[FTP] Final rename OK: %s --> %s", uploadName.c_str(), target.c_str());
     }
   }
 
-  // zamykanie sesji
-  if (ctrl) {
-    sendCmd(*ctrl, "QUIT");
-    readResp(*ctrl);
-    ctrl->stop(); Net::disposeClient(ctrl);
-    ctrl = nullptr;
-  }
+  // sesja zostaje otwarta dla kolejnych zadań; po błędzie – zamykana
+  FtpSession::release(ok);
 
+  if (dec && ok) {
+    const BinSeries::Decoder::Stats& st = dec->stats();
+    if (st.badFrames || st.dropped) {
+      LOGW("[FTP] %s: %lu frames, %lu bad, %lu dropped", local_path, (unsigned long)st.frames,
+           (unsigned long)st.badFrames, (unsigned long)st.dropped);
+    }
+  }
+  delete dec;
+  delete gz;
   if (!ok) return false;
-  LOGI("FTP upload OK: %s (%u bytes)", local_path, (unsigned)totalSent);
+  if (codec == CODEC_GZIP) {
+    LOGI("FTP upload OK: %s (%u bytes, gzip of %u)", local_path, (unsigned)totalSent, (unsigned)totalRead);
+  } else {
+    LOGI("FTP upload OK: %s (%u bytes)", local_path, (unsigned)totalSent);
+  }
   return true;
 }
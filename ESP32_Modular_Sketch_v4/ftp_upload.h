@@ -1,5 +1,33 @@
 #pragma once
 #include <Arduino.h>
 namespace FTP {
-  bool uploadFile(const char* local_path, const char* remote_dir);
+  // kodowanie treści przy wysyłce (zapisywane w zadaniu FTPQ)
+  enum Codec : uint8_t {
+    CODEC_NONE = 0,
+    CODEC_GZIP = 1,    // gzip_stream.h w locie, nazwa zdalna z sufiksem ".gz"
+  };
+  const char* codecName(Codec c);              // "" / "gz"
+  Codec       codecFromName(const String& s);  // nieznana -> CODEC_NONE
+  Codec       defaultCodec();                  // wg Config ftp_gzip
+
+  // Wznowienie po zerwaniu DATA (zapisywane w zadaniu FTPQ): nazwa tymczasowa
+  // na serwerze i bajty tam potwierdzone przez SIZE. Kolejna próba wysyła od
+  // offset przez REST+STOR (odmowa REST: APPE); gzip jest deterministyczny,
+  // więc strumień liczony od początku, a pierwsze offset bajtów pomijane.
+  // Pusta nazwa = wysyłka od zera pod nową unikalną nazwą.
+  struct Resume {
+    String   name;
+    uint32_t offset = 0;
+  };
+
+  struct Stats {
+    uint32_t resumes;        // przesyły od offset > 0
+    uint64_t bytesSent;      // bajty wypchnięte do DATA (także utracone)
+    uint64_t bytesResumed;   // bajty niewysłane ponownie dzięki wznowieniu
+  };
+
+  // resume: stan z/do zadania FTPQ (nullptr – wznowienia tylko w tym wywołaniu)
+  bool uploadFile(const char* local_path, const char* remote_dir, Codec codec = CODEC_NONE,
+                  Resume* resume = nullptr);
+  Stats stats();
 }
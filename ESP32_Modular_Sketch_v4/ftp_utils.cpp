@@ -2,6 +2,7 @@
 #include <WiFi.h>         // dla MAC (Wi-Fi tryb)
 #include <time.h>         // time(nullptr)
 #include "gsm_wifi.h"     // Net::newClient / disposeClient
+#include "ftp_utils.h"
 #include "log.h"
 
 #ifdef ARDUINO_ARCH_ESP32
@@ -171,6 +172,68 @@ bool ftpListNamesContains(Client &ctrl, const String &ctrlHost, const String &di
   return found;
 }
 
+// MLSD "fakty; nazwa" (katalogi . i .. pomijane), NLST "nazwa" albo "kat/nazwa"
+static bool listEntryName(const String& line, bool mlsd, String& name) {
+  if (!line.length()) return false;
+  if (mlsd) {
+    const int sp = line.indexOf("; ");
+    if (sp < 0) return false;
+    if (line.indexOf("type=cdir") >= 0 || line.indexOf("type=pdir") >= 0) return false;
+    name = line.substring(sp + 2);
+  } else {
+    const int slash = line.lastIndexOf('/');
+    name = slash >= 0 ? line.substring(slash + 1) : line;
+  }
+  return name.length() > 0 && name != "." && name != "..";
+}
+
+bool ftpListDir(Client &ctrl, const String &ctrlHost, FtpNameFn fn, void* ctx, uint32_t timeoutMs) {
+  for (int pass = 0; pass < 2; ++pass) {
+    const bool mlsd = pass == 0;
+    uint16_t dataPort = 0;
+    if (!ftpEnterPassive(ctrl, dataPort)) return false;
+    Client* data = Net::newClient();
+    if (!data) return false;
+    if (!data->connect(ctrlHost.c_str(), dataPort)) { Net::disposeClient(data); return false; }
+
+    ftpSend(ctrl, mlsd ? "MLSD" : "NLST");
+    const int pre = ftpReadCode(ctrl, nullptr, 6000);
+    if (pre >= 500 && mlsd) {             // MLSD nieobsługiwane – NLST
+      data->stop(); Net::disposeClient(data);
+      continue;
+    }
+    if (pre != 150 && pre != 125) {
+      data->stop(); Net::disposeClient(data);
+      LOGW("[FTP] %s fail (%d)", mlsd ? "MLSD" : "NLST", pre);
+      return false;
+    }
+
+    unsigned long t0 = millis();
+    String buf, name;
+    bool stop = false;
+    while (!stop && millis() - t0 < timeoutMs) {
+      while (data->available()) {
+        char c = (char)data->read();
+        if (c == '\r') continue;
+        if (c != '\n') { buf += c; continue; }
+        if (listEntryName(buf, mlsd, name) && !fn(ctx, name)) { stop = true; break; }
+        buf = "";
+      }
+      if (!data->connected() && !data->available()) break;
+      delay(0);
+      FEED_WDT();
+    }
+    if (!stop && listEntryName(buf, mlsd, name)) fn(ctx, name);   // ostatnia linia bez \n
+    data->stop();
+    Net::disposeClient(data);
+
+    // 226 (przerwany odczyt: zwykle 426)
+    const int end = ftpReadCode(ctrl, nullptr, 4000);
+    return stop || end == 226 || end == 250;
+  }
+  return false;
+}
+
 // ==================== Sekcja: sprawdzanie pliku i nazwy ====================
 
 static void splitNameExt(const String &name, String &base, String &ext) {
@@ -264,8 +327,14 @@ bool ensureTimeSynced(uint32_t minEpoch /*=1700000000*/, uint32_t waitMs /*=1500
   return false;
 }
 
-String finalDataName() {
-  return "D_" + macNoSep() + "_" + String((uint32_t)time(nullptr)) + ".txt";
+// EPOCH rośnie ściśle: segmenty wysyłane jeden po drugim w tej samej sekundzie
+// nie nadpisują się na serwerze (RNTO na istniejącą nazwę)
+String finalDataName(const char* suffix) {
+  static uint32_t last = 0;
+  uint32_t t = (uint32_t)time(nullptr);
+  if (t <= last) t = last + 1;
+  last = t;
+  return "D_" + macNoSep() + "_" + String(t) + ".txt" + suffix;
 }
 
 bool ftpRename(Client &ctrl, const String &from, const String &to) {
@@ -295,7 +364,7 @@ bool ftpUploadWithUniqueThenRename(
     return false;
   }
 
-  String target = finalDataName();
+  String target = finalDataName("");
   if (!ftpRename(ctrl, uniqueName, target)) {
     LOGW("Rename failed: %s -> %s (file remains under interim name)", uniqueName.c_str(), target.c_str());
     return true; // plik wgrany, brak finalnego RNTO
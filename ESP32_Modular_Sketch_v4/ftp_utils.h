@@ -3,10 +3,14 @@ int    ftpReadCode(Client&, String* = nullptr, uint32_t = 8000);
 bool   ftpExpect(Client&, int, uint32_t = 8000);
 bool   ftpEnterPassive(Client&, uint16_t &dataPort);
 bool   ftpListNamesContains(Client&, const String& ctrlHost, const String& dir, const String& fileNameOnly, uint32_t timeoutMs=8000);
+// Lista bieżącego katalogu (MLSD, przy odmowie NLST): fn dostaje same nazwy,
+// false z fn przerywa odczyt. Zwraca false, gdy listy nie udało się pobrać
+typedef bool (*FtpNameFn)(void* ctx, const String& name);
+bool   ftpListDir(Client&, const String& ctrlHost, FtpNameFn fn, void* ctx, uint32_t timeoutMs=8000);
 bool   ftpFileExists(Client&, const String& remotePath, const String& ctrlHost);
 String ftpUniqueName(Client&, const String& name, const String& ctrlHost);
 bool   ensureTimeSynced(uint32_t minEpoch=1700000000UL, uint32_t waitMs=15000);
 String macNoSep();
-String finalDataName();
+String finalDataName(const char* suffix = "");   // D_<MAC>_<EPOCH>.txt[suffix]
 bool   ftpRename(Client&, const String& from, const String& to);
 bool   ftpUploadWithUniqueThenRename(Client&, const String& ctrlHost, const char* localPath, const String& desiredRemoteName, bool (*storUploadFn)(Client&, const String&, const char*));
@@ -0,0 +1,217 @@
+#include "gzip_stream.h"
+
+namespace Gzip {
+
+static const uint16_t kNil      = 0xFFFF;
+static const int      kMinMatch = 3;
+static const int      kMaxMatch = 258;
+static const int      kMaxChain = 32;     // kandydatów na pozycję
+static const int      kGoodLen  = 32;     // dłuższe dopasowanie kończy szukanie
+
+// CRC32 (IEEE, odbity 0xEDB88320) – po 4 bity, 64 B tablicy
+static const uint32_t kCrcNibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32Update(uint32_t crc, const uint8_t* p, size_t n) {
+  while (n--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ kCrcNibble[crc & 15];
+    crc = (crc >> 4) ^ kCrcNibble[crc & 15];
+  }
+  return crc;
+}
+
+// RFC 1951 3.2.5: kody długości 257..285 i odległości 0..29
+static const uint16_t kLenBase[29] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+  35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258,
+};
+static const uint8_t kLenExtra[29] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0,
+};
+static const uint16_t kDistBase[30] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+  257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+};
+static const uint8_t kDistExtra[30] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+};
+
+static inline uint32_t hash3(const uint8_t* p) {
+  const uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+  return (v * 2654435761u) >> (32 - Encoder::kHashBits);
+}
+
+void Encoder::reset() {
+  ok_ = true;
+  crc_ = 0xFFFFFFFF;
+  in_ = out_ = 0;
+  pos_ = end_ = 0;
+  bitBuf_ = 0;
+  bitCnt_ = 0;
+  outLen_ = 0;
+  for (uint16_t& h : head_) h = kNil;
+
+  // nagłówek gzip: ID1 ID2 CM=8 FLG=0 MTIME=0 XFL=0 OS=255
+  static const uint8_t kHdr[10] = { 0x1F, 0x8B, 8, 0, 0, 0, 0, 0, 0, 0xFF };
+  for (uint8_t b : kHdr) putByte(b);
+  putBits(1, 1);     // BFINAL – cały strumień to jeden blok
+  putBits(1, 2);     // BTYPE=01: stałe kody Huffmana
+}
+
+bool Encoder::write(const void* data, size_t n) {
+  const uint8_t* p = (const uint8_t*)data;
+  crc_ = crc32Update(crc_, p, n);
+  in_ += n;
+  while (n && ok_) {
+    if (end_ == 2 * kWindow) slide();
+    size_t take = 2 * kWindow - end_;
+    if (take > n) take = n;
+    memcpy(win_ + end_, p, take);
+    end_ += take;
+    p += take;
+    n -= take;
+    compress(false);
+  }
+  return ok_;
+}
+
+bool Encoder::finish() {
+  compress(true);
+  putCode(0, 7);                          // 256 = koniec bloku
+  if (bitCnt_) putBits(0, 8 - bitCnt_);   // do pełnego bajtu
+  const uint32_t crc = ~crc_;
+  for (int i = 0; i < 4; ++i) putByte((uint8_t)(crc >> (8 * i)));
+  for (int i = 0; i < 4; ++i) putByte((uint8_t)(in_ >> (8 * i)));
+  return drain() && ok_;
+}
+
+// drugą połowę okna na początek; pozycje < kWindow wypadają z łańcuchów
+void Encoder::slide() {
+  memmove(win_, win_ + kWindow, kWindow);
+  pos_ -= kWindow;
+  end_ -= kWindow;
+  for (uint16_t& h : head_) h = (h == kNil || h < kWindow) ? kNil : (uint16_t)(h - kWindow);
+  for (uint16_t& h : prev_) h = (h == kNil || h < kWindow) ? kNil : (uint16_t)(h - kWindow);
+}
+
+void Encoder::insert(uint32_t p) {
+  if (p + kMinMatch > end_) return;
+  const uint32_t h = hash3(win_ + p);
+  prev_[p & (kWindow - 1)] = head_[h];
+  head_[h] = (uint16_t)p;
+}
+
+int Encoder::longestMatch(uint32_t p, uint32_t avail, uint32_t* dist) const {
+  if (avail < (uint32_t)kMinMatch) return 0;
+  const int maxLen = avail < (uint32_t)kMaxMatch ? (int)avail : kMaxMatch;
+  const uint8_t* s = win_ + p;
+  int best = kMinMatch - 1;
+  uint16_t c = head_[hash3(s)];
+  for (int chain = kMaxChain; c != kNil && chain--; c = prev_[c & (kWindow - 1)]) {
+    if (c >= p || p - c >= kWindow) break;            // poza oknem (stary wpis łańcucha)
+    const uint8_t* m = win_ + c;
+    if (m[best] != s[best] || m[0] != s[0]) continue;
+    int len = 0;
+    while (len < maxLen && m[len] == s[len]) ++len;
+    if (len > best) {
+      best  = len;
+      *dist = p - c;
+      if (len >= kGoodLen || len == maxLen) break;
+    }
+  }
+  return best >= kMinMatch ? best : 0;
+}
+
+// Zachłannie z jednym krokiem leniwego dopasowania (jak zlib -1..-3 w
+// uproszczeniu). Bez flush zostawia kMaxMatch bajtów zapasu na dopasowanie.
+void Encoder::compress(bool flush) {
+  while (ok_) {
+    const uint32_t avail = end_ - pos_;
+    if (!avail || (!flush && avail < (uint32_t)kMaxMatch)) return;
+
+    uint32_t dist = 0;
+    int len = longestMatch(pos_, avail, &dist);
+    if (len && len < kGoodLen && avail > (uint32_t)len) {
+      uint32_t d2 = 0;
+      insert(pos_);
+      const int len2 = longestMatch(pos_ + 1, avail - 1, &d2);
+      if (len2 > len) {                 // lepsze o bajt dalej: bieżący jako literał
+        literal(win_[pos_]);
+        ++pos_;
+        len = len2; dist = d2;
+      } else {
+        match(len, dist);
+        for (int i = 1; i < len; ++i) insert(pos_ + i);
+        pos_ += len;
+        continue;
+      }
+    }
+    if (len) {
+      insert(pos_);
+      match(len, dist);
+      for (int i = 1; i < len; ++i) insert(pos_ + i);
+      pos_ += len;
+    } else {
+      insert(pos_);
+      literal(win_[pos_]);
+      ++pos_;
+    }
+  }
+}
+
+// stałe kody: 0..143 -> 8 b od 0x30, 144..255 -> 9 b od 0x190,
+//             256..279 -> 7 b od 0, 280..287 -> 8 b od 0xC0
+void Encoder::literal(uint8_t c) {
+  if (c < 144) putCode(0x30 + c, 8);
+  else         putCode(0x190 + (c - 144), 9);
+}
+
+void Encoder::match(int len, uint32_t dist) {
+  int li = 28;
+  while (kLenBase[li] > len) --li;
+  const int sym = 257 + li;
+  if (sym < 280) putCode(sym - 256, 7);
+  else           putCode(0xC0 + (sym - 280), 8);
+  if (kLenExtra[li]) putBits(len - kLenBase[li], kLenExtra[li]);
+
+  int di = 29;
+  while (kDistBase[di] > dist) --di;
+  putCode(di, 5);
+  if (kDistExtra[di]) putBits(dist - kDistBase[di], kDistExtra[di]);
+}
+
+// bity danych LSB pierwszy
+void Encoder::putBits(uint32_t v, int n) {
+  bitBuf_ |= v << bitCnt_;
+  bitCnt_ += n;
+  while (bitCnt_ >= 8) {
+    putByte((uint8_t)bitBuf_);
+    bitBuf_ >>= 8;
+    bitCnt_ -= 8;
+  }
+}
+
+void Encoder::putCode(uint32_t code, int len) {
+  uint32_t r = 0;
+  for (int i = 0; i < len; ++i) { r = (r << 1) | (code & 1); code >>= 1; }
+  putBits(r, len);
+}
+
+void Encoder::putByte(uint8_t b) {
+  outBuf_[outLen_++] = b;
+  if (outLen_ == kOut) drain();
+}
+
+bool Encoder::drain() {
+  if (outLen_ && ok_) {
+    ok_ = sink_(ctx_, outBuf_, outLen_);
+    out_ += outLen_;
+  }
+  outLen_ = 0;
+  return ok_;
+}
+
+} // namespace Gzip
@@ -0,0 +1,58 @@
+#pragma once
+#include <Arduino.h>
+
+// Strumieniowa kompresja gzip (RFC 1952/1951) do wysyłki FTP po GSM.
+// LZ77 w oknie kWindow bajtów (łańcuchy haszy) + stałe kody Huffmana
+// (BTYPE=01) w jednym bloku – bez drzew dynamicznych. Stała pamięć:
+// okno 2*kWindow + łańcuchy 2*kWindow + hasze 4 kB (~12.5 kB, na stercie).
+// Wynik rozpakuje każdy gunzip/zlib po stronie serwera.
+//
+//   Gzip::Encoder* z = new Gzip::Encoder(sink, ctx);
+//   z->write(buf, n) ... z->finish();     // sink dostaje porcje <= kOut
+namespace Gzip {
+
+class Encoder {
+ public:
+  // false = błąd wyjścia (kompresja przerwana)
+  typedef bool (*Sink)(void* ctx, const uint8_t* data, size_t n);
+
+  static const size_t kWindow = 2048;   // maks. odległość dopasowania (deflate: <= 32768)
+  static const int    kHashBits = 11;
+  static const size_t kOut = 512;       // porcja wyjścia (jak CHUNK uploadu)
+
+  Encoder(Sink sink, void* ctx) : sink_(sink), ctx_(ctx) { reset(); }
+  void reset();
+
+  bool write(const void* data, size_t n);
+  bool finish();                        // koniec bloku + CRC32/ISIZE
+
+  uint32_t inBytes()  const { return in_; }
+  uint32_t outBytes() const { return out_; }
+
+ private:
+  void compress(bool flush);            // przetwarza bufor (flush: do końca danych)
+  int  longestMatch(uint32_t p, uint32_t avail, uint32_t* dist) const;
+  void insert(uint32_t p);
+  void slide();
+  void literal(uint8_t c);
+  void match(int len, uint32_t dist);
+  void putBits(uint32_t v, int n);
+  void putCode(uint32_t code, int len); // kod Huffmana (MSB pierwszy)
+  void putByte(uint8_t b);
+  bool drain();
+
+  Sink     sink_;
+  void*    ctx_;
+  bool     ok_;
+  uint32_t crc_, in_, out_;
+  uint32_t pos_, end_;                  // bieżąca pozycja / koniec danych w win_
+  uint32_t bitBuf_;
+  int      bitCnt_;
+  size_t   outLen_;
+  uint16_t head_[1 << kHashBits];
+  uint16_t prev_[kWindow];
+  uint8_t  win_[2 * kWindow];
+  uint8_t  outBuf_[kOut];
+};
+
+} // namespace Gzip
@@ -0,0 +1,186 @@
+#include "history.h"
+#include "adc_channels.h"
+#include "config.h"
+#include "log.h"
+
+namespace History {
+
+static const uint32_t kMinSamples = 60;
+
+// nagłówek rekordu; za nim raw[g_ch], calc[g_ch]
+struct Head {
+  uint32_t epoch;
+  uint32_t seq;
+  uint32_t valid;
+  uint8_t  n;
+  uint8_t  binIn;
+  uint8_t  rsv[2];
+};                                      // 16 B
+
+static uint8_t* g_buf      = nullptr;
+static uint32_t g_cap      = 0;
+static uint32_t g_stride   = sizeof(Head);   // bajtów na rekord
+static uint8_t  g_ch       = 0;              // kanałów na rekord
+static uint32_t g_head     = 0;        // następny zapis
+static uint32_t g_count    = 0;
+static uint32_t g_pushed   = 0;
+static uint32_t g_clamped  = 0;
+static uint32_t g_periodMs = 1000;
+static bool     g_psram    = false;
+
+// pojemność [próbek] dla głębokości depthSec przy okresie klatki periodMs
+static uint32_t samplesFor(uint32_t depthSec, uint32_t periodMs) {
+  const uint64_t n = (uint64_t)depthSec * 1000ULL / (periodMs ? periodMs : 1);
+  if (n < kMinSamples) return kMinSamples;
+  return n > 0x00FFFFFFu ? 0x00FFFFFFu : (uint32_t)n;
+}
+
+// alokacja z połowieniem przy braku pamięci (najmniej kMinSamples)
+static uint8_t* alloc(uint32_t& cap, bool psram) {
+  while (cap >= kMinSamples) {
+    const size_t bytes = (size_t)cap * g_stride;
+    void* p = psram ? ps_malloc(bytes) : malloc(bytes);
+    if (p) return (uint8_t*)p;
+    cap /= 2;
+  }
+  cap = 0;
+  return nullptr;
+}
+
+bool begin(uint32_t periodMs) {
+  if (g_buf) return true;
+  const ConfigData& c = Config::get();
+  g_periodMs = periodMs ? periodMs : 1;
+
+  // stride z rejestru kanałów (po AdcChannels::load())
+  const int ch = AdcChannels::count();
+  g_ch     = (uint8_t)(ch < 0 ? 0 : ch > kMaxChannels ? kMaxChannels : ch);
+  g_stride = sizeof(Head) + 2u * g_ch * sizeof(float);
+
+  if (psramFound()) {
+    g_cap = samplesFor(c.hist_hours * 3600UL, g_periodMs);
+    g_buf = alloc(g_cap, true);
+    g_psram = g_buf != nullptr;
+  }
+  if (!g_buf) {
+    g_cap = samplesFor(c.hist_ram_min * 60UL, g_periodMs);
+    g_buf = alloc(g_cap, false);
+  }
+  g_head = g_count = 0;
+  if (!g_buf) { LOGE("History: no memory for ring"); return false; }
+
+  const Info i = info();
+  LOGI("History: %s ring %lu samples x %u ch (%lu B, ~%lu s)", g_psram ? "PSRAM" : "internal RAM",
+       (unsigned long)i.capacity, (unsigned)g_ch, (unsigned long)i.bytes, (unsigned long)i.depthSec);
+  return true;
+}
+
+static Head*  headAt(uint32_t slot) { return (Head*)(g_buf + (size_t)slot * g_stride); }
+static float* rawOf(Head* h)        { return (float*)(h + 1); }
+static float* calcOf(Head* h)       { return rawOf(h) + g_ch; }
+
+void push(const AdcFrame& f, const bool binIn[5]) {
+  if (!g_buf) return;
+  if (f.n > g_ch) {
+    if (!g_clamped) LOGW("History: frame has %u channels, ring keeps %u (restart to resize)",
+                         (unsigned)f.n, (unsigned)g_ch);
+    ++g_clamped;
+  }
+  Head* h  = headAt(g_head);
+  h->epoch = (uint32_t)f.epoch;
+  h->seq   = f.seq;
+  h->n     = f.n < g_ch ? f.n : g_ch;
+  h->valid = h->n < 32 ? f.valid & ((1u << h->n) - 1) : f.valid;
+  h->binIn = 0;
+  for (int i = 0; i < 5; ++i) if (binIn[i]) h->binIn |= (uint8_t)(1u << i);
+  h->rsv[0] = h->rsv[1] = 0;
+  float* raw  = rawOf(h);
+  float* calc = calcOf(h);
+  for (int i = 0; i < g_ch; ++i) {
+    raw[i]  = i < h->n ? (float)f.value[i] : 0.0f;
+    calc[i] = i < h->n ? (float)f.calc[i]  : 0.0f;
+  }
+  g_head = (g_head + 1) % g_cap;
+  if (g_count < g_cap) ++g_count;
+  ++g_pushed;
+}
+
+// k-ty rekord od najstarszego (k < g_count)
+static Head* nth(uint32_t k) {
+  return headAt((g_head + g_cap - g_count + k) % g_cap);
+}
+
+static void unpack(Head* h, Sample* s) {
+  s->epoch = h->epoch;
+  s->seq   = h->seq;
+  s->valid = h->valid;
+  s->n     = h->n;
+  s->binIn = h->binIn;
+  const float* raw  = rawOf(h);
+  const float* calc = calcOf(h);
+  for (int i = 0; i < kMaxChannels; ++i) {
+    s->raw[i]  = i < h->n ? raw[i]  : 0.0f;
+    s->calc[i] = i < h->n ? calc[i] : 0.0f;
+  }
+}
+
+bool latest(Sample* s) {
+  if (!g_count) return false;
+  unpack(nth(g_count - 1), s);
+  return true;
+}
+
+uint32_t forEach(uint32_t from, uint32_t to, Visit fn, void* ctx) {
+  if (!g_count) return 0;
+  // próbki rosną w czasie: wyszukiwanie binarne pierwszej z epoch >= from
+  uint32_t lo = 0, hi = g_count;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    if (nth(mid)->epoch < from) lo = mid + 1; else hi = mid;
+  }
+  uint32_t n = 0;
+  Sample s;
+  for (uint32_t k = lo; k < g_count; ++k) {
+    Head* h = nth(k);
+    if (h->epoch > to) break;
+    unpack(h, &s);
+    fn(ctx, s);
+    ++n;
+  }
+  return n;
+}
+
+bool window(int ch, uint32_t sec, Window* w) {
+  *w = Window();
+  if (!g_count || ch < 0 || ch >= g_ch) return false;
+  const uint32_t newest = nth(g_count - 1)->epoch;
+  double sum = 0;
+  for (uint32_t k = g_count; k-- > 0;) {
+    Head* h = nth(k);
+    if (newest - h->epoch > sec) break;
+    if (ch >= h->n || !(h->valid & (1u << ch))) continue;
+    const float v = calcOf(h)[ch];
+    if (!w->n) { w->min = w->max = w->last = v; }
+    if (v < w->min) w->min = v;
+    if (v > w->max) w->max = v;
+    sum += v;
+    ++w->n;
+  }
+  if (w->n) w->mean = (float)(sum / w->n);
+  return w->n > 0;
+}
+
+Info info() {
+  Info i;
+  i.capacity = g_cap;
+  i.channels = g_ch;
+  i.clamped  = g_clamped;
+  i.count    = g_count;
+  i.bytes    = g_cap * g_stride;
+  i.depthSec = (uint32_t)((uint64_t)g_cap * g_periodMs / 1000ULL);
+  i.pushed   = g_pushed;
+  i.psram    = g_psram;
+  return i;
+}
+
+} // namespace History
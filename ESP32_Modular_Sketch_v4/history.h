@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"
+
+// Historia ostatnich klatek AdcTask w RAM: pierścień próbek (czas, kanały
+// raw/calc, wejścia binarne) z każdej klatki odebranej w AdcTask::drain().
+// WebUI (ostatnie wartości, /measure/history) i kontekst alarmu czytają stąd
+// zamiast z D_<MAC>.txt na flash.
+//
+// Pierścień w PSRAM (ps_malloc) na hist_hours godzin; bez PSRAM (psramFound()
+// == false) mniejszy w RAM wewnętrznej na hist_ram_min minut. Pojemność w
+// próbkach liczona z okresu klatki przy begin() – późniejsza zmiana okresu
+// zmienia głębokość w czasie, nie w próbkach. Tylko z loop() (bez blokad).
+//
+// Rekord w pierścieniu: 16 B nagłówka + raw/calc (float) tylu kanałów, ile
+// AdcChannels::count() przy begin() (8 kanałów: 80 B). Kanały dopisane do
+// rejestru później są w próbkach obcinane (Info::clamped, log przy pierwszej).
+namespace History {
+
+static const int kMaxChannels = ADC_MAX_CHANNELS;
+
+// próbka rozpakowana z rekordu (latest(), forEach())
+struct Sample {
+  uint32_t epoch;                          // time(nullptr) klatki
+  uint32_t seq;                            // numer klatki AdcTask
+  uint32_t valid;                          // bit i = kanał i ważny
+  uint8_t  n;                              // kanałów w próbce (<= Info::channels)
+  uint8_t  binIn;                          // bit i = wejście B00(i+1) w stanie wysokim
+  float    raw[kMaxChannels];              // [V] po filtrze
+  float    calc[kMaxChannels];             // A*x+B
+};
+
+struct Window {
+  uint32_t n;                              // próbki z ważnym kanałem
+  float    min, max, mean, last;
+};
+
+struct Info {
+  uint32_t capacity;                       // próbek
+  uint8_t  channels;                       // kanałów na rekord (z begin())
+  uint32_t clamped;                        // klatek z obciętymi kanałami
+  uint32_t count;                          // próbek w pierścieniu
+  uint32_t bytes;                          // zajęta pamięć
+  uint32_t depthSec;                       // głębokość przy okresie z begin()
+  uint32_t pushed;                         // próbek od startu
+  bool     psram;
+};
+
+typedef void (*Visit)(void* ctx, const Sample& s);
+
+bool     begin(uint32_t periodMs);          // po Config::begin(), przed AdcTask::begin()
+void     push(const AdcFrame& f, const bool binIn[5]);
+
+bool     latest(Sample* s);
+// próbki z czasem w [from, to], od najstarszej; zwraca ich liczbę
+uint32_t forEach(uint32_t from, uint32_t to, Visit fn, void* ctx);
+// min/max/średnia kanału z ostatnich sec sekund (względem najnowszej próbki)
+bool     window(int ch, uint32_t sec, Window* w);
+Info     info();
+
+} // namespace History
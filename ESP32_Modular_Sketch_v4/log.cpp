@@ -1,6 +1,7 @@
 #include "log.h"
 #include <Arduino.h>
 #include <LittleFS.h>
+#include "file_writer.h"
 #include <stdarg.h>
 
 static size_t s_max_bytes = 50 * 1024;  // 50 KiB na plik
@@ -12,11 +13,9 @@ static const char* LOG0_PATH = "/log0.txt";
 ///  log3 -> log4, log2 -> log3, log1 -> log2, log0 -> log1,
 ///  a nowy log0 będzie tworzony „od zera”.
 static void rotate_if_needed() {
-  File f = LittleFS.open(LOG0_PATH, "r");
-  if (!f) return;
-  size_t sz = f.size();
-  f.close();
-  if (sz < s_max_bytes) return;
+  // rozmiar z FileWriter (bez otwierania pliku przy każdej linii)
+  if (FileWriter::size(LOG0_PATH) < s_max_bytes) return;
+  FileWriter::release(LOG0_PATH);
 
   // 1) Usuń najstarszy (log{s_max_files-1}.txt), jeśli istnieje
   if (s_max_files < 2) s_max_files = 2; // sanity
@@ -69,15 +68,12 @@ void Log::printf(const char* level, const char* fmt, ...) {
   Serial.print("] ");
   Serial.println(buf);
 
-  // --- Plik (open-append-close + rotacja)
+  // --- Plik (bufor FileWriter + rotacja)
   rotate_if_needed();
-  File f = LittleFS.open(LOG0_PATH, "a");
-  if (f) {
-    // dopisz millis, poziom i treść; CRLF dla czytelności w Windows
-    char line[320];
-    unsigned long ms = millis();
-    snprintf(line, sizeof(line), "%lu [%s] %s\r\n", ms, level, buf);
-    f.print(line);
-    f.close();
-  }
+  // dopisz millis, poziom i treść; CRLF dla czytelności w Windows
+  char line[320];
+  unsigned long ms = millis();
+  int n = snprintf(line, sizeof(line), "%lu [%s] %s\r\n", ms, level, buf);
+  if (n > (int)sizeof(line) - 1) n = sizeof(line) - 1;
+  if (n > 0) FileWriter::append(LOG0_PATH, line, (size_t)n);
 }
@@ -1,6 +1,8 @@
 #include <Arduino.h>
 #include "config.h"
 #include "log.h"
+#include "file_writer.h"
+#include "fs_recovery.h"
 #include "led.h"
 #include "gsm_wifi.h"
 #include "mqtt_client.h"
@@ -11,11 +13,18 @@
 #include "esp_task_wdt.h"
 // #include "ftp_queue.h" // duplikat – usunięty
 #include "adc_mcp3424.h"
+#include "adc_channels.h"
 #include "measurement.h"
+#include "adc_task.h"
+#include "history.h"
+#include "rollup.h"
+#include "quota.h"
+#include "ftp_session.h"
 #include "io_pins.h"
 #include "alarm.h"
 #include "email_alert.h"
 #include "cfg_sync.h"
+#include "prof.h"
 
 
 static const int WDT_TIMEOUT_SEC = 60;
@@ -31,23 +40,12 @@ Serial.printf("Flash: %lu MB, PSRAM: %lu MB\n",
               (unsigned long)(flash / 1024UL / 1024UL),
               (unsigned long)(ps    / 1024UL / 1024UL));
 
-if (ps > 0 && psramFound()) {
-  Serial.println("PSRAM OK");
-  // próba alokacji 2 MB w PSRAM
-  uint8_t* buf = (uint8_t*) ps_malloc(2 * 1024 * 1024);
-  if (buf) {
-    memset(buf, 0xAA, 2 * 1024 * 1024);
-    free(buf);
-    Serial.println("PSRAM alloc OK");
-  } else {
-    Serial.println("PSRAM alloc FAIL");
-  }
-} else {
-  Serial.println("PSRAM not present / failed");
-}
+// PSRAM zajmuje pierścień History (Measure: History::begin())
+Serial.println(ps > 0 && psramFound() ? "PSRAM OK" : "PSRAM not present / failed");
 //-------------
 
 
+  FileWriter::begin();   // bufory zapisu data/alarm/log – przed pierwszym LOG*
   Log::begin();
   LOGI("Booting...");
 
@@ -63,6 +61,8 @@ if (ps > 0 && psramFound()) {
     LOGI("LittleFS OK: total=%u used=%u",
          (unsigned)LittleFS.totalBytes(),
          (unsigned)LittleFS.usedBytes());
+    // Porządki po zaniku zasilania: przerwane rotacje, urwane ogony plików
+    Recovery::run();
     // Zapewnienie minimalnego index.html (fallback)
     if (!LittleFS.exists("/index.html")) {
       File f = LittleFS.open("/index.html", "w");
@@ -74,6 +74,8 @@ if (ps > 0 && psramFound()) {
   Config::begin();
   Led::begin();
   Measure::setSendFTPInterval(Config::get().sendFTPInterval_sec);
+  // Rejestr kanałów analogowych – przed alarmami i pomiarami (ustala rozmiary buforów)
+  AdcChannels::load();
   // 3) Watchdog
 // Watchdog (bez podwójnej inicjalizacji)
 
@@ -112,14 +114,18 @@ if (ps > 0 && psramFound()) {
   // 8) FTP Queue (po FS)
   FTPQ::begin();
   FTPQ::setDeleteLocalOnSuccess(true); // po sukcesie usuń snapshot lokalny
+  Recovery::requeueOrphans();          // obrócone alarmy bez zadania (segmenty: startMCP3424)
+  Quota::begin();                      // budżety plików (po kolejce: usuwane pliki wypadają z FTPQ)
 
   // 9) E-mail alerty
   EmailAlert::begin();
 delay(100);
   // 10) Pomiary
-  // Ustaw interwały (sekundy); pilnuj: 8 * pomiarMCPInterval < pomiarADCInterval
+  // Ustaw interwały (sekundy); okresy próbkowania kanałów – /adc_profiles.json
   Measure::pomiarADCInterval = 600;  // np. 10 min
-  Measure::pomiarMCPInterval = 1;    // np. 5 s  => 8*5=40 < 600  (warunek spełniony)
+  Measure::pomiarMCPInterval = 1;    // okres klatki (migawki) AdcTask
+  History::begin(Measure::pomiarMCPInterval * 1000UL);   // pierścień klatek (PSRAM albo RAM)
+  Rollup::begin();                                        // agregaty 1 min / 1 h z każdej klatki
   Measure::startMCP3424();           // start I2C + reset MCP3424
 
   // Plik testowy do szybkiej próby FTP/UI
@@ -135,22 +141,33 @@ delay(100);
 
 void loop() {
   Led::loop();
-  // FTP kolejka – lekki tick (1 zadanie / iteracja jeśli warunki sprzyjają)
-  (void)FTPQ::tick();
+  // FTP kolejka – zadania due na jednej sesji, w budżecie ftpq_drain_ms/_kb
+  { PROF_SCOPE("FTPQ"); (void)FTPQ::tick(); }
+  // wspólna sesja FTP: NOOP co 30 s, zamknięcie po 2 min bez użycia
+  { PROF_SCOPE("FtpSession"); FtpSession::tick(); }
 
-  Net::loop();
-  Mqtt::loop();
-  WebUI::loop();
-  CfgSync::loopTick();
+  { PROF_SCOPE("Net"); Net::loop(); }
+  { PROF_SCOPE("Mqtt"); Mqtt::loop(); }
+  { PROF_SCOPE("WebUI"); WebUI::loop(); }
+  { PROF_SCOPE("CfgSync"); CfgSync::loopTick(); }
+
+  // Ramki z zadania akwizycji (rdzeń 1): odbiór + statystyki okresu
+  { PROF_SCOPE("AdcTask"); AdcTask::drain(); }
 
   // Pomiary / zapisy / wysyłka wg interwałów opisanych w Measure
-  Measure::loopTick();
+  { PROF_SCOPE("Measure"); Measure::loopTick(); }
 
   // Alarmy: detekcja i log/akcje
-  Alarm::loopTick();
+  { PROF_SCOPE("Alarm"); Alarm::loopTick(); }
 
   // E-mail alerty: sekwencer (wysyłka/odbiór/eskalacja)
-  EmailAlert::loopTick();
+  { PROF_SCOPE("EmailAlert"); EmailAlert::loopTick(); }
+
+  // Budżety LittleFS: przegląd co minutę, usuwanie wg priorytetu klas
+  { PROF_SCOPE("Quota"); Quota::tick(); }
+
+  // Bufory zapisu plików: na flash po maxAge
+  { PROF_SCOPE("FileWriter"); FileWriter::tick(); }
 
   // Przykładowy publish co ~10 s
   static unsigned long lastPub = 0;
@@ -1,8 +1,14 @@
 #include <Arduino.h>
 #include "measurement.h"
 #include "adc_mcp3424.h"
+#include "adc_task.h"
+#include "adc_profiles.h"
+#include "adc_channels.h"
 #include "adc_values.h"
 #include "data_files.h"
+#include "record_fmt.h"
+#include "bin_series.h"
+#include "time_index.h"
 #include "ftp_queue.h"
 #include "config.h"
 #include "log.h"
@@ -17,7 +23,7 @@ static time_t alignToNoonEdge(time_t now, uint32_t intervalSec);  // fwd decl
 namespace Measure {
   // interwały [s]
   uint32_t pomiarADCInterval = 600; // domyślnie 600 s
-  uint32_t pomiarMCPInterval = 1;   // domyślnie 1 s (próbkowanie MCP)
+  uint32_t pomiarMCPInterval = 1;   // domyślnie 1 s (okres klatki AdcTask)
 
   // ostatnia „krawędź” do zapisu wg ADC
   time_t   lastPomiarUploadTime = 0;
@@ -27,7 +33,6 @@ namespace Measure {
 namespace Measure {
   uint32_t sendFTPInterval = 3600;   // [s] domyślnie 1h
   static time_t lastSendEdge = 0;    // ostatnia krawędź wysyłki od 12:00
-  static String pendingSnap;         // ścieżka snapshota czekającego na sukces FTP
 }
 
 namespace Measure {
@@ -44,37 +49,29 @@ namespace Measure {
 
 // ================== Helpers (internal) ==================
 
-static String two(uint32_t v){
-  char b[3]; snprintf(b, sizeof(b), "%02u", (unsigned)(v % 100));
-  return String(b);
-}
-
 // RR:MM:DD:GG:NN:SS (rok 2-cyfrowo)
 namespace Measure {
-  String pomTimeStamp() {
+  size_t pomTimeStamp(char* out, size_t cap) {
     time_t t = time(nullptr);
     struct tm tmv; localtime_r(&t, &tmv);
-    String yy = two((tmv.tm_year + 1900) % 100);
-    String mo = two(tmv.tm_mon + 1);
-    String dd = two(tmv.tm_mday);
-    String hh = two(tmv.tm_hour);
-    String mi = two(tmv.tm_min);
-    String ss = two(tmv.tm_sec);
-    return yy + ":" + mo + ":" + dd + ":" + hh + ":" + mi + ":" + ss;
+    int n = snprintf(out, cap, "%02u:%02u:%02u:%02u:%02u:%02u",
+                     (unsigned)((tmv.tm_year + 1900) % 100), (unsigned)((tmv.tm_mon + 1) % 100),
+                     (unsigned)(tmv.tm_mday % 100), (unsigned)(tmv.tm_hour % 100),
+                     (unsigned)(tmv.tm_min % 100), (unsigned)(tmv.tm_sec % 100));
+    return (n < 0 || (size_t)n >= cap) ? 0 : (size_t)n;
+  }
+
+  String pomTimeStamp() {
+    char b[24];
+    pomTimeStamp(b, sizeof(b));
+    return String(b);
   }
 } // namespace Measure
 
-// CRC16 Modbus (poly 0xA001, init 0xFFFF)
+// CRC16 Modbus (poly 0xA001, init 0xFFFF) – tablicowo, record_fmt.cpp
 namespace Measure {
   String calculateCRC16(const String& data) {
-    uint16_t crc = 0xFFFF;
-    for (uint16_t i = 0; i < data.length(); ++i) {
-      crc ^= (uint8_t)data[i];
-      for (uint8_t b = 0; b < 8; ++b) {
-        if (crc & 1) crc = (crc >> 1) ^ 0xA001;
-        else         crc = (crc >> 1);
-      }
-    }
+    const uint16_t crc = RecordFmt::crc16Update(0xFFFF, data.c_str(), data.length());
     String s = String(crc, HEX);
     s.toLowerCase();
     return s;
@@ -92,10 +89,8 @@ static uint8_t wifiPercent0_99() {
 }
 
 // losowe "xyz" 000..100
-static String xyz000_100() {
-  long v = random(101);
-  char b[4]; snprintf(b, sizeof(b), "%03ld", v);
-  return String(b);
+static uint8_t xyz000_100() {
+  return (uint8_t)random(101);
 }
 
 // zwraca ostatnią „krawędź” k*interval od lokalnej 12:00 (w przeszłości)
@@ -109,24 +104,18 @@ static time_t alignToNoonEdge(time_t now, uint32_t intervalSec) {
   return base + (delta / intervalSec) * intervalSec;
 }
 
-// egzekwowanie warunku 8*MCP < ADC
-static void enforceMcpVsAdc() {
-  using namespace Measure;
-  if (pomiarADCInterval == 0) pomiarADCInterval = 1;
-  if (pomiarMCPInterval == 0) pomiarMCPInterval = 1;
-
-  if (8ULL * pomiarMCPInterval >= pomiarADCInterval) {
-    uint32_t allowed = (pomiarADCInterval > 1) ? (uint32_t)((pomiarADCInterval - 1) / 8) : 0;
-    uint32_t old = pomiarMCPInterval;
-    if (allowed < 1) {
-      pomiarMCPInterval = 1;
-      LOGW("MCP interval adjusted to 1s; increase pomiarADCInterval to >8s to satisfy 8*MCP<ADC (ADC=%lus).",
-           (unsigned long)pomiarADCInterval);
-    } else {
-      pomiarMCPInterval = allowed;
-      LOGW("Adjusted pomiarMCPInterval from %lus to %lus to satisfy 8*MCP<ADC (ADC=%lus).",
-           (unsigned long)old, (unsigned long)pomiarMCPInterval, (unsigned long)pomiarADCInterval);
-    }
+// segment do kolejki (po sukcesie FTPQ woła DataFiles::retireSegment)
+static bool enqueueSegment(const String& seg) {
+  const String dir = Config::get().ftp_dir;
+  return FTPQ::enqueue(seg.c_str(), dir.c_str(), FTP::defaultCodec(), /*keepLocal=*/true);
+}
+
+// segmenty na FS spoza kolejki (restart, porzucone po limicie prób) – z powrotem do niej
+static void requeueSealed() {
+  for (const String& seg : DataFiles::sealedSegments()) {
+    if (FTPQ::contains(seg.c_str())) continue;
+    if (enqueueSegment(seg)) LOGW("Segment re-enqueued: %s", seg.c_str());
+    else                     LOGE("Segment not enqueued: %s", seg.c_str());
   }
 }
 
@@ -136,98 +125,152 @@ namespace Measure {
 
 void setPomiarInterval(uint32_t sec) {
   pomiarADCInterval = (sec == 0 ? 1 : sec);
-  enforceMcpVsAdc();
   time_t now = time(nullptr);
   lastPomiarUploadTime = alignToNoonEdge(now, pomiarADCInterval);
 }
 
 void setMCPInterval(uint32_t sec) {
   pomiarMCPInterval = (sec == 0 ? 1 : sec);
-  enforceMcpVsAdc();
+  AdcTask::setPeriodMs(pomiarMCPInterval * 1000UL);
 }
 
 void startMCP3424() {
   ::startMCP3424();                  // driver MCP3424
   randomSeed((uint32_t)esp_random());
 
-  enforceMcpVsAdc();
+  // tryb zapisu ustalany raz: zmiana data_bin działa od restartu
+  DataFiles::setBinary(Config::get().data_bin);
+  if (!DataFiles::binary()) DataFiles::foldBinIntoCsv();
+  DataFiles::checkIndex();           // indeks czasu /measure/range zgodny z D_<MAC>.txt
+
+  // segmenty po restarcie: brakujące w kolejce wracają do niej; po sukcesie -> _1/_2
+  FTPQ::setRetireHook(DataFiles::retireSegment);
+  requeueSealed();
+
+  AdcProfiles::load();               // profile kanałów – przed startem zadania
+  AdcTask::begin(pomiarMCPInterval * 1000UL);   // od teraz I2C należy do zadania
 
   time_t now = time(nullptr);
   lastPomiarUploadTime = alignToNoonEdge(now, pomiarADCInterval);
   LOGI("Measurement started: ADC int=%lus, MCP int=%lus, current file=%s",
        (unsigned long)pomiarADCInterval, (unsigned long)pomiarMCPInterval,
-       DataFiles::pathCurrent().c_str());
+       (DataFiles::binary() ? DataFiles::pathCurrentBin() : DataFiles::pathCurrent()).c_str());
 }
 
-void pomiarMCP3424() {
-  ::pomiarMCP3424();                 // szybki odczyt MCP3424
+// stałe rekordy bloku (po czwartym kanale)
+static const BinSeries::Row kExtras[] = {
+  { "AKU",  "1071", "6.9912345" },
+  { "B001", "1",    "1.0" },
+  { "UAZS", "1",    "1.0" },
+};
+static const int  kExtrasAfter = 4;
+static const char stan_wyjsc[] = "0000";
+
+// Tryb binarny: cały blok jako jedna ramka BinSeries w D_<MAC>.bin
+static void appendBinFrame(const AdcFrame& fr) {
+  static BinSeries::Encoder enc;
+  static uint8_t frame[BinSeries::kMaxFrame];   // tylko z loop()
+
+  BinSeries::Row rows[BinSeries::kMaxRows];
+  int nr = 0;
+  auto extras = [&](){ for (const BinSeries::Row& r : kExtras) rows[nr++] = r; };
+  const int n = fr.n ? fr.n : AdcChannels::count();
+  for (int i = 0; i < n; ++i) {
+    if (i == kExtrasAfter) extras();
+    rows[nr++] = { AdcChannels::at(i).id, nullptr, nullptr };
+  }
+  if (n <= kExtrasAfter) extras();
+
+  time_t t = time(nullptr);
+  struct tm tmv; localtime_r(&t, &tmv);
+  BinSeries::Sample s;
+  s.localSec = BinSeries::localSeconds(tmv);
+  s.xyz      = xyz000_100();
+  s.gsm      = wifiPercent0_99();
+  s.imei     = DataFiles::macNoSep().c_str();   // MAC zamiast IMEI
+  s.outputs  = stan_wyjsc;
+  s.rows     = rows;
+  s.nRows    = nr;
+  s.raw      = fr.value;
+  s.calc     = fr.calc;
+
+  // nowy/pusty plik (po rotacji) musi zacząć się ramką KEY
+  if (DataFiles::fileSize(DataFiles::pathCurrentBin()) == 0) enc.reset();
+  const size_t len = enc.encode(s, frame, sizeof(frame));
+  if (!len) { LOGE("myTestPomiar: frame too large"); return; }
+  if (!DataFiles::appendBinToCurrent(frame, len)) {
+    enc.reset();                     // ramka mogła nie dojść – od nowa od KEY
+    LOGE("appendBinToCurrent failed");
+  }
 }
 
-// Buduje 12 rekordów: A001..A004, AKU, B001, UAZS, A005..A008
+// Buduje rekordy kanałów z rejestru AdcChannels (dla 8 kanałów jak dawniej:
+// A001..A004, AKU, B001, UAZS, A005..A008 – dodatki po czwartym kanale).
+// Rekordy składane w RecordFmt::Line na stosie – bez alokacji na rekord.
 void myTestPomiar() {
-  // 1) przeliczenie A*x+B
-  pomiarADClicz();
+  // 1) ostatnia klatka z zadania akwizycji (już z przeliczeniem A*x+B)
+  const AdcFrame fr = adcLatest();
+  if (DataFiles::binary()) { appendBinFrame(fr); return; }
 
   // 2) stałe dla całego bloku wpisów
-  const String IMEI  = DataFiles::macNoSep();   // MAC zamiast IMEI
-  const String Rczas = pomTimeStamp();          // RR:MM:DD:GG:NN:SS
-  const String xyz   = xyz000_100();            // wspólny xyz
-  const String poziom_GSM = String((unsigned)wifiPercent0_99());
-  const String stan_wyjsc = "0000";
-
-  auto appendRecord = [&](const String& Czujnik, const String& raw, const String& calc){
-    const String crcBase = IMEI + ";" + Czujnik + ";" + Rczas + ";" + xyz + ";" +
-                           raw + ";" + calc + ";" + poziom_GSM + ";" + stan_wyjsc;
-    const String CRC16 = calculateCRC16(crcBase);
-
-    String line; line.reserve(128);
-    line += IMEI; line+=';'; line+=Czujnik; line+=';'; line+=Rczas; line+=';';
-    line+=xyz; line+=';'; line+=raw; line+=';'; line+=calc; line+=';';
-    line+=poziom_GSM; line+=';'; line+=stan_wyjsc; line+=';'; line+=CRC16; line+=";\r\n";
-
-    if (!DataFiles::appendLineToCurrent(line)) {
-      LOGE("appendLineToCurrent failed");
-    }
+  const String& IMEI = DataFiles::macNoSep();    // MAC zamiast IMEI
+  char Rczas[24];                                 // RR:MM:DD:GG:NN:SS
+  const size_t RczasLen = pomTimeStamp(Rczas, sizeof(Rczas));
+  char xyz[4];                                    // wspólny xyz
+  snprintf(xyz, sizeof(xyz), "%03u", (unsigned)xyz000_100());
+  char poziom_GSM[4];
+  snprintf(poziom_GSM, sizeof(poziom_GSM), "%u", (unsigned)wifiPercent0_99());
+
+  DataFiles::noteRecordTime(TimeIndex::parseStamp(Rczas, RczasLen));
+
+  RecordFmt::Line line;
+  line.field(IMEI);
+  line.mark();
+
+  // Czujnik;Rczas;xyz; + raw;calc + ;poziom_GSM;stan_wyjsc;CRC16;\r\n
+  auto commit = [&](){
+    line.field(poziom_GSM).field(stan_wyjsc, sizeof(stan_wyjsc) - 1);
+    size_t n = 0;
+    const char* l = line.finish(&n);
+    if (!l) LOGE("myTestPomiar: record too long");
+    else if (!DataFiles::appendToCurrent(l, n)) LOGE("appendToCurrent failed");
+  };
+  auto begin = [&](const char* Czujnik){
+    line.rewind();
+    line.field(Czujnik).field(Rczas, RczasLen).field(xyz, 3);
+  };
+  auto appendRecord = [&](const char* Czujnik, const char* raw, const char* calc){
+    begin(Czujnik);
+    line.field(raw).field(calc);
+    commit();
+  };
+  auto appendChannel = [&](int i){
+    begin(AdcChannels::at(i).id);
+    line.fixed6(fr.value[i]).fixed6(fr.calc[i]);
+    commit();
+  };
+
+  auto appendExtras = [&](){
+    for (const BinSeries::Row& r : kExtras) appendRecord(r.id, r.raw, r.calc);
   };
 
-  // A001..A004
-  appendRecord("A001", String(weADC1,6), String(weADC1licz,6));
-  appendRecord("A002", String(weADC2,6), String(weADC2licz,6));
-  appendRecord("A003", String(weADC3,6), String(weADC3licz,6));
-  appendRecord("A004", String(weADC4,6), String(weADC4licz,6));
-  // dodatki
-  appendRecord("AKU",  "1071",  "6.9912345");
-  appendRecord("B001", "1",     "1.0");
-  appendRecord("UAZS", "1",     "1.0");
-  // A005..A008
-  appendRecord("A005", String(weADC5,6), String(weADC5licz,6));
-  appendRecord("A006", String(weADC6,6), String(weADC6licz,6));
-  appendRecord("A007", String(weADC7,6), String(weADC7licz,6));
-  appendRecord("A008", String(weADC8,6), String(weADC8licz,6));
+  const int n = fr.n ? fr.n : AdcChannels::count();
+  for (int i = 0; i < n; ++i) {
+    if (i == kExtrasAfter) appendExtras();
+    appendChannel(i);
+  }
+  if (n <= kExtrasAfter) appendExtras();
 }
 
 // Jeśli (a) plik osiągnął limit 100 kB LUB (b) minął kolejny „tik” interwału od 12:00,
-// to rotacja i enqueue bieżącego _1 (przez snapshot, oczekując na sukces FTP).
+// to bieżący plik zamykany w segment (rename) i segment do kolejki FTP.
+// Niewysłane segmenty czekają w kolejce obok siebie (każdy <= ~100 kB); przy
+// długiej awarii najstarsze usuwa Quota (klasa segment), bieżący plik nie rośnie.
 void WyslijDaneNaFTP() {
   using namespace DataFiles;
 
-  // jeżeli czekamy na zakończenie poprzedniej wysyłki (snapshot jeszcze istnieje), nic nie rób
-  if (pendingSnap.length() > 0) {
-    if (!LittleFS.exists(pendingSnap)) {
-      // snapshot zniknął -> kolejka zakończyła sukcesem -> ROTACJA
-      if (rotateAfterSend()) {
-        LOGI("Rotation after send done.");
-      } else {
-        LOGE("Rotation after send FAILED.");
-      }
-      pendingSnap = "";
-    }
-    // kiedy snapshot istnieje – upload w toku, wstrzymaj nowe wysyłki
-    if (pendingSnap.length() > 0) return;
-  }
-
   // a) rozmiar
-  bool dueBySize = (fileSize(pathCurrent()) >= FILE_SIZE_LIMIT);
+  bool dueBySize = currentFull();
 
   // b) czas wg sendFTPInterval (kotwica 12:00)
   time_t now = time(nullptr);
@@ -235,25 +278,22 @@ void WyslijDaneNaFTP() {
   bool dueByTime = (edge > lastSendEdge);
 
   if (!(dueBySize || dueByTime)) return;
+  if (dueByTime) lastSendEdge = edge;
 
-  // Przygotuj snapshot aktualnego D_<MAC>.txt
-  String src = pathCurrent();
-  String snap = makeUploadSnapshotPath();
+  requeueSealed();
 
-  if (!copyFile(src, snap)) {
-    LOGE("Snapshot copy failed: %s -> %s", src.c_str(), snap.c_str());
+  // Zamknij bieżący segment (rename, bez kopii; w trybie binarnym sam .bin)
+  const String seg = sealCurrent();
+  if (!seg.length()) {
+    LOGW("Nothing to send (trigger=%s)", dueBySize ? "SIZE" : "TIME");
     return;
   }
 
-  // Enqueue snap – na serwerze i tak nazwa końcowa będzie D_<MAC>_<EPOCH>.txt
-  String dir = Config::get().ftp_dir;
-  if (FTPQ::enqueue(snap.c_str(), dir.c_str())) {
-    pendingSnap = snap;
-    LOGI("Enqueued snapshot: %s (trigger=%s)", snap.c_str(), dueBySize ? "SIZE" : "TIME");
-    if (dueByTime) lastSendEdge = edge;
+  // na serwerze i tak nazwa końcowa będzie D_<MAC>_<EPOCH>.txt
+  if (enqueueSegment(seg)) {
+    LOGI("Enqueued segment: %s (trigger=%s)", seg.c_str(), dueBySize ? "SIZE" : "TIME");
   } else {
-    LOGE("FTP enqueue failed for %s", snap.c_str());
-    LittleFS.remove(snap); // sprzątanie
+    LOGE("FTP enqueue failed for %s (retry on next trigger)", seg.c_str());
   }
 }
 
@@ -266,13 +306,7 @@ void loopTick() {
 
   time_t now = time(nullptr);
 
-  // 1) Harmonogram MCP: niezależny interwał (też „siatka” od 12:00)
-  static time_t lastMcpEdge = 0;
-  time_t mcpEdge = alignToNoonEdge(now, pomiarMCPInterval);
-  if (mcpEdge > lastMcpEdge) {
-    lastMcpEdge = mcpEdge;
-    pomiarMCP3424();
-  }
+  // 1) Próbkowanie MCP: zadanie AdcTask (rdzeń 1) wg profili kanałów
 
   // 2) Harmonogram zapisu rekordu: wg pomiarADCInterval (jak było)
   static time_t lastAdcEdge = 0;
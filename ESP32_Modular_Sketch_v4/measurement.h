@@ -4,13 +4,12 @@
 namespace Measure {
   // interwał (sekundy) i ostatnia krawędź od 12:00 (czas unix)
   extern uint32_t pomiarADCInterval;   // sekundy (kotwica 12:00)
-  extern uint32_t pomiarMCPInterval;   // sekundy (niezależny, patrz warunek)
+  extern uint32_t pomiarMCPInterval;   // sekundy: okres klatki AdcTask (próbkowanie kanałów – profile)
   extern time_t   lastPomiarUploadTime;
 
   // API
-  void startMCP3424();   // deleguje do drivera
-  void pomiarMCP3424();  // deleguje do drivera
-  void myTestPomiar();   // liczy A*x+B i zapisuje 8 rekordów A001..A008
+  void startMCP3424();   // driver + start zadania akwizycji AdcTask
+  void myTestPomiar();   // z ostatniej ramki AdcTask liczy A*x+B i zapisuje rekordy A001..A008
   void WyslijDaneNaFTP();// jeśli rozmiar >= 100kB lub „tik” interwału – rotacja i enqueue
 
 // measurement.h
@@ -26,5 +25,6 @@ namespace Measure {
   void setMCPInterval(uint32_t sec);
   // Wspólne narzędzia wymagane przez opis:
   String pomTimeStamp();                           // RR:MM:DD:GG:NN:SS
+  size_t pomTimeStamp(char* out, size_t cap);      // j.w. do bufora; długość albo 0
   String calculateCRC16(const String& payload);    // jak w Twoim kodzie
 }
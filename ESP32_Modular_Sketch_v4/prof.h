@@ -0,0 +1,14 @@
+#pragma once
+// Pomiar czasu CPU modułów wołanych z loop().
+// Na płytce makro jest puste; w esp_sim (ESP_SIM) zlicza wywołania, czas CPU
+// wątku i czas zegara symulacji danego bloku – tabela na koniec przebiegu.
+//   { PROF_SCOPE("Measure"); Measure::loopTick(); }
+
+#ifdef ESP_SIM
+  #include "sim.h"
+  #define PROF_SCOPE(name) \
+    static Sim::ProfSlot& _profSlot = Sim::profSlot(name); \
+    Sim::ProfScope _profScope(_profSlot)
+#else
+  #define PROF_SCOPE(name) do{}while(0)
+#endif
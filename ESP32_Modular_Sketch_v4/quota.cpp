@@ -0,0 +1,197 @@
+#include "quota.h"
+#include "log.h"
+#include "data_files.h"
+#include "file_writer.h"
+#include "ftp_queue.h"
+#include <LittleFS.h>
+#include <algorithm>
+#include <vector>
+
+namespace Quota {
+
+static const uint32_t kBlock = 4096;
+
+// budżety klas (partycja ~12 MB, partitions.csv)
+static const uint32_t kBudget[CL_COUNT] = {
+  0,                   // CL_LEFTOVER
+  512UL * 1024UL,      // CL_RETAINED
+  256UL * 1024UL,      // CL_LOG
+  3UL * 1024UL * 1024UL,   // CL_ROLLUP
+  6UL * 1024UL * 1024UL,   // CL_SEGMENT
+  1UL * 1024UL * 1024UL,   // CL_ALARM_ROT
+  kNoLimit,            // CL_CURRENT
+  kNoLimit,            // CL_OTHER
+};
+
+static const char* const kNames[CL_COUNT] = {
+  "leftover", "retained", "log", "rollup", "segment", "alarm_rot", "current", "other"
+};
+
+struct Entry {
+  String   path;
+  String   age;        // rosnąco = od najstarszego
+  uint32_t bytes;      // zaokrąglone do bloku
+  uint8_t  cls;
+};
+
+static Stats    g_stats = {};
+static bool     g_dirty = true;
+static uint32_t g_lastScanMs = 0;
+static uint32_t g_lastErrors = 0;
+static std::vector<Entry> g_files;   // z ostatniego przeglądu, posortowane (klasa, wiek)
+
+const char* className(Class c) { return c < CL_COUNT ? kNames[c] : "?"; }
+
+// dane jeszcze nie na serwerze – budżet liczy się tylko ponad high-water
+static bool unsent(uint8_t cls) { return cls == CL_SEGMENT || cls == CL_ALARM_ROT; }
+
+static uint32_t rounded(size_t size) {
+  return (uint32_t)((size + kBlock - 1) / kBlock * kBlock);
+}
+
+// klasa i klucz wieku wg nazwy (bez '/')
+static uint8_t classify(const String& name, String& age) {
+  const String data  = DataFiles::baseName();                // D_<MAC>
+  const String alarm = "alarmy_" + DataFiles::macNoSep();
+  age = name;
+  if (name.startsWith("configU_") || name.endsWith(".tmp") || name.endsWith("_VIEW.txt")) return CL_LEFTOVER;
+  if (name.startsWith(data + "_UP_")) return CL_SEGMENT;
+  if (name.startsWith(data + "_1.") || name.startsWith(data + "_2.")) {
+    age = name.charAt(data.length() + 1) == '2' ? "0" : "1";  // _2 starszy niż _1
+    return CL_RETAINED;
+  }
+  if (name.startsWith(data + ".")) return CL_CURRENT;
+  if (name == alarm + ".txt") return CL_CURRENT;
+  if (name.startsWith(alarm + "_")) return CL_ALARM_ROT;
+  if (name.startsWith("log") && name.endsWith(".txt") && name.length() == 8) {
+    const char d = name.charAt(3);
+    if (d == '0') return CL_CURRENT;
+    if (d >= '1' && d <= '9') { age = String((char)('9' - d + '0')); return CL_LOG; }   // log4 najstarszy
+  }
+  if (name.startsWith("roll_1m_") || name.startsWith("roll_1h_")) return CL_ROLLUP;
+  return CL_OTHER;
+}
+
+static void scan() {
+  const uint32_t t0 = millis();
+  g_files.clear();
+  for (int c = 0; c < CL_COUNT; ++c) { g_stats.cls[c].bytes = 0; g_stats.cls[c].files = 0; }
+  uint32_t sum = 0;
+
+  File root = LittleFS.open("/");
+  if (root) {
+    for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+      if (f.isDirectory()) continue;
+      String name = String(f.name());
+      if (name.startsWith("/")) name = name.substring(1);
+      Entry e;
+      e.path  = "/" + name;
+      e.bytes = rounded(f.size());
+      e.cls   = classify(name, e.age);
+      sum += e.bytes;
+      g_files.push_back(e);
+    }
+    root.close();
+  }
+  std::sort(g_files.begin(), g_files.end(), [](const Entry& a, const Entry& b) {
+    return a.cls != b.cls ? a.cls < b.cls : a.age < b.age;
+  });
+
+  // najnowszy plik agregatów każdego poziomu jest dopisywany – bieżący
+  for (const char* pfx : { "/roll_1m_", "/roll_1h_" }) {
+    for (auto it = g_files.rbegin(); it != g_files.rend(); ++it) {
+      if (it->cls == CL_ROLLUP && it->path.startsWith(pfx)) { it->cls = CL_CURRENT; break; }
+    }
+  }
+  for (const Entry& e : g_files) { g_stats.cls[e.cls].bytes += e.bytes; ++g_stats.cls[e.cls].files; }
+
+  g_stats.used = sum + g_stats.overhead;
+  ++g_stats.scans;
+  g_stats.scanMs = millis() - t0;
+  g_lastScanMs = millis();
+  g_dirty = false;
+}
+
+// najstarszy plik klasy: zadanie FTP, bufor FileWriter i plik usuwane
+static bool evictOldest(uint8_t cls) {
+  for (auto it = g_files.begin(); it != g_files.end(); ++it) {
+    if (it->cls != cls) continue;
+    const Entry e = *it;
+    g_files.erase(it);
+    FileWriter::release(e.path.c_str());
+    if (FTPQ::remove(e.path.c_str())) LOGW("Quota: %s dropped from FTP queue", e.path.c_str());
+    if (!LittleFS.remove(e.path)) { LOGE("Quota: remove %s failed", e.path.c_str()); return true; }
+    g_stats.cls[cls].bytes -= e.bytes;
+    --g_stats.cls[cls].files;
+    g_stats.used = g_stats.used > e.bytes ? g_stats.used - e.bytes : 0;
+    ++g_stats.evictedFiles;
+    g_stats.evictedBytes += e.bytes;
+    if (unsent(cls)) {
+      ++g_stats.evictedUnsentFiles;
+      g_stats.evictedUnsentBytes += e.bytes;
+      LOGE("Quota: unsent %s removed (%s, %lu B, used %lu/%lu B)", e.path.c_str(), kNames[cls],
+           (unsigned long)e.bytes, (unsigned long)g_stats.used, (unsigned long)g_stats.total);
+    } else {
+      LOGW("Quota: %s removed (%s, %lu B, used %lu/%lu B)", e.path.c_str(), kNames[cls],
+           (unsigned long)e.bytes, (unsigned long)g_stats.used, (unsigned long)g_stats.total);
+    }
+    return true;
+  }
+  return false;
+}
+
+static void enforce() {
+  for (uint8_t c = 0; c < CL_COUNT; ++c) {
+    if (unsent(c)) continue;
+    while (g_stats.cls[c].bytes > kBudget[c] && evictOldest(c)) {}
+  }
+  const uint64_t high = (uint64_t)g_stats.total * kHighWaterPct / 100;
+  const uint64_t low  = (uint64_t)g_stats.total * kLowWaterPct / 100;
+  if (g_stats.used <= high) return;
+  LOGW("Quota: used %lu B above high-water %lu B", (unsigned long)g_stats.used, (unsigned long)high);
+  // wysłane i odtwarzalne wg kolejności klas, potem niewysłane: najpierw
+  // klasa ponad swoim budżetem, na końcu reszta wg kolejności
+  for (uint8_t c = 0; c < CL_CURRENT && g_stats.used > low; ++c) {
+    if (unsent(c)) continue;
+    while (g_stats.used > low && evictOldest(c)) {}
+  }
+  for (uint8_t c = 0; c < CL_CURRENT && g_stats.used > low; ++c) {
+    if (!unsent(c)) continue;
+    while (g_stats.used > low && g_stats.cls[c].bytes > kBudget[c] && evictOldest(c)) {}
+  }
+  for (uint8_t c = 0; c < CL_CURRENT && g_stats.used > low; ++c) {
+    if (!unsent(c)) continue;
+    while (g_stats.used > low && evictOldest(c)) {}
+  }
+  if (g_stats.used > low) LOGE("Quota: still %lu B used, nothing left to evict", (unsigned long)g_stats.used);
+}
+
+void begin() {
+  for (int c = 0; c < CL_COUNT; ++c) g_stats.cls[c].budget = kBudget[c];
+  g_stats.total    = LittleFS.totalBytes();
+  g_stats.overhead = 0;
+  scan();
+  const uint32_t real = LittleFS.usedBytes();   // jedyny odczyt – kalibracja narzutu
+  g_stats.overhead = real > g_stats.used ? real - g_stats.used : 0;
+  g_stats.used += g_stats.overhead;
+  g_lastErrors = FileWriter::stats().errors;
+  LOGI("Quota: %u files, used %lu/%lu B (metadata %lu B), scan %lu ms", (unsigned)g_files.size(),
+       (unsigned long)g_stats.used, (unsigned long)g_stats.total, (unsigned long)g_stats.overhead,
+       (unsigned long)g_stats.scanMs);
+  enforce();
+}
+
+void tick() {
+  // błąd zapisu FileWriter (np. pełna partycja) – przegląd od razu
+  const uint32_t errors = FileWriter::stats().errors;
+  if (errors != g_lastErrors) { g_lastErrors = errors; g_dirty = true; }
+  if (!g_dirty && millis() - g_lastScanMs < kRescanMs) return;
+  scan();
+  enforce();
+}
+
+void invalidate() { g_dirty = true; }
+
+Stats stats() { return g_stats; }
+
+} // namespace Quota
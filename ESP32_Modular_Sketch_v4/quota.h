@@ -0,0 +1,69 @@
+#pragma once
+#include <Arduino.h>
+
+// Wspólny budżet LittleFS dla plików wszystkich modułów. Każdy moduł pilnuje
+// swojego limitu (FILE_SIZE_LIMIT, ALARM_FILE_LIMIT, log 5 x 50 kB), ale przy
+// FTP niedostępnym przez dni segmenty i obrócone alarmy rosną bez końca, aż
+// zapis na flash zacznie się nie udawać.
+//
+// Pliki w katalogu głównym dzielone na klasy wg nazwy. Klasa ma budżet [B]
+// (kNoLimit = bez limitu, 0 = usuwane zawsze); ponad budżet usuwane są jej
+// najstarsze pliki. Ponad kHighWaterPct partycji usuwane są pliki wg
+// priorytetu klas (kolejność Class: najpierw resztki i wysłane kopie,
+// niewysłane dane i alarmy na końcu), w klasie od najstarszego, aż do
+// kLowWaterPct. Pliki bieżące (D_<MAC>.*, alarmy_<MAC>.txt, log0.txt, najnowsze agregaty) i
+// pozostałe (config, strony) nie są ruszane.
+//
+// Niewysłane (segment, alarm_rot) poniżej high-water nie są usuwane nigdy –
+// ich budżet decyduje tylko w przebiegu high-water (najpierw klasa ponad
+// budżetem). Takie usunięcie to utrata danych: LOGE i osobne liczniki.
+//
+// Zajętość liczona z rozmiarów plików (zaokrąglonych do bloku) przy
+// przeglądzie katalogu co kRescanMs albo po invalidate(), nie przez
+// LittleFS.usedBytes() (przejście po wszystkich blokach); narzut metadanych
+// kalibrowany raz w begin().
+namespace Quota {
+
+enum Class : uint8_t {
+  CL_LEFTOVER = 0,   // configU_*, *.tmp, *_VIEW.txt – resztki po przerwanych operacjach
+  CL_RETAINED,       // D_<MAC>_1/_2 – kopie już wysłanych segmentów
+  CL_LOG,            // log1..log4.txt (log0 bieżący)
+  CL_ROLLUP,         // roll_1m_*/roll_1h_* (oprócz najnowszego)
+  CL_SEGMENT,        // D_<MAC>_UP_* – niewysłane segmenty danych
+  CL_ALARM_ROT,      // alarmy_<MAC>_<epoch>.txt – czekają na FTP (małe, zdarzenia)
+  CL_CURRENT,        // pliki dopisywane teraz – bez usuwania
+  CL_OTHER,          // config, strony, kolejka – bez usuwania
+  CL_COUNT
+};
+
+static const uint32_t kNoLimit      = 0xFFFFFFFFu;
+static const uint32_t kRescanMs     = 60000;
+static const uint8_t  kHighWaterPct = 85;
+static const uint8_t  kLowWaterPct  = 75;
+
+struct ClassStats {
+  uint32_t bytes;          // zaokrąglone do bloku
+  uint16_t files;
+  uint32_t budget;
+};
+
+struct Stats {
+  uint32_t   total;        // LittleFS.totalBytes()
+  uint32_t   used;         // szacunek z ostatniego przeglądu
+  uint32_t   overhead;     // metadane (kalibracja w begin())
+  ClassStats cls[CL_COUNT];
+  uint32_t   scans;
+  uint32_t   scanMs;       // czas ostatniego przeglądu
+  uint32_t   evictedFiles;
+  uint32_t   evictedBytes;
+  uint32_t   evictedUnsentFiles;   // z tego niewysłane (segment, alarm_rot)
+  uint32_t   evictedUnsentBytes;
+};
+
+void        begin();                 // po LittleFS.begin()
+void        tick();                  // z loop(): przegląd co kRescanMs, egzekwowanie budżetów
+void        invalidate();            // przegląd przy najbliższym tick()
+Stats       stats();
+const char* className(Class c);
+
+} // namespace Quota
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+// Składanie rekordu D_<MAC>.txt bez sterty:
+//   IMEI;Czujnik;Rczas;xyz;raw;calc;poziom_GSM;stan_wyjsc;CRC16;\r\n
+// Pola trafiają wprost do bufora linii, CRC16 Modbus liczony tablicowo w
+// trakcie dopisywania (bez osobnego crcBase). Wynik bajt w bajt jak dawne
+// sklejanie Stringów: raw/calc jak String(x, 6), CRC jak String(crc, HEX)
+// małymi literami, bez zer wiodących.
+namespace RecordFmt {
+
+// CRC16 Modbus (poly 0xA001, init 0xFFFF) – kontynuacja od crc
+uint16_t crc16Update(uint16_t crc, const void* data, size_t n);
+
+// x z 6 miejscami po przecinku jak "%.6f" (zaokrąglenie do najbliższej,
+// remis do parzystej). Zwraca długość, 0 gdy nie mieści się w cap.
+size_t fixed6(char* out, size_t cap, double x);
+
+class Line {
+ public:
+  static const size_t kCap = 192;   // rekord ma ~80 B; id kanału max 7 znaków
+
+  Line() { clear(); }
+  void clear();
+
+  // kolejne pole (separator ';' przed każdym poza pierwszym)
+  Line& field(const char* s, size_t n);
+  Line& field(const char* s) { return field(s, strlen(s)); }
+  Line& field(const String& s) { return field(s.c_str(), s.length()); }
+  Line& fixed6(double x);
+
+  // wspólny początek rekordów bloku (IMEI) – formatowany i liczony raz
+  void mark();
+  void rewind();
+
+  // domyka ";<crc>;\r\n"; nullptr, gdy linia nie zmieściła się w buforze
+  const char* finish(size_t* len);
+
+ private:
+  void put(const char* s, size_t n);
+
+  char     buf_[kCap];
+  size_t   len_, markLen_;
+  uint16_t crc_, markCrc_;
+  bool     ok_, markOk_;
+};
+
+} // namespace RecordFmt
@@ -0,0 +1,222 @@
+#include "rollup.h"
+#include "config.h"
+#include "log.h"
+#include "file_writer.h"
+#include "fs_recovery.h"
+#include <LittleFS.h>
+#include <time.h>
+#include <vector>
+
+namespace Rollup {
+
+static_assert(sizeof(Record) == 152, "Record: 8 B nagłówka + 8 x (2 + 4 x 4) B");
+
+static const uint32_t kMinEpoch = 1700000000UL;   // zegar jeszcze nie ustawiony
+static const char* const kPrefix[2] = { "roll_1m_", "roll_1h_" };
+static const uint32_t kBucket[2] = { 60, 3600 };
+
+struct Acc {
+  bool   open;
+  Record r;
+  double sum[kChannels];
+};
+
+static Acc    g_acc[2];
+static String g_cur[2];                // plik, do którego ostatnio dopisano
+static Stats  g_stats = {};
+
+uint32_t bucketSec(Level lv) { return kBucket[lv]; }
+
+static String key(Level lv, uint32_t epoch) {
+  const time_t t = (time_t)epoch;
+  struct tm tmv; localtime_r(&t, &tmv);
+  char b[8];
+  if (lv == LV_1M) snprintf(b, sizeof(b), "%02u%02u%02u", (unsigned)(tmv.tm_year % 100),
+                            (unsigned)(tmv.tm_mon + 1), (unsigned)tmv.tm_mday);
+  else             snprintf(b, sizeof(b), "%02u%02u", (unsigned)(tmv.tm_year % 100),
+                            (unsigned)(tmv.tm_mon + 1));
+  return String(b);
+}
+
+String path(Level lv, uint32_t epoch) {
+  return String("/") + kPrefix[lv] + key(lv, epoch) + ".bin";
+}
+
+// klucz najstarszego pliku, który zostaje
+static String cutoffKey(Level lv, uint32_t now) {
+  const ConfigData& c = Config::get();
+  if (lv == LV_1M) return key(lv, now - c.roll_1m_days * 86400UL);
+  const time_t t = (time_t)now;
+  struct tm tmv; localtime_r(&t, &tmv);
+  int m = tmv.tm_year * 12 + tmv.tm_mon - (int)c.roll_1h_months;
+  char b[8];
+  snprintf(b, sizeof(b), "%02u%02u", (unsigned)((m / 12) % 100), (unsigned)(m % 12 + 1));
+  return String(b);
+}
+
+// retencja: pliki poziomu z kluczem starszym niż cutoffKey
+static void prune(Level lv, uint32_t now) {
+  const String prefix = kPrefix[lv];
+  const String cut = cutoffKey(lv, now);
+  std::vector<String> old;             // usuwanie po zamknięciu katalogu
+  File root = LittleFS.open("/");
+  if (!root) return;
+  for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+    String name = String(f.name());
+    if (name.startsWith("/")) name = name.substring(1);
+    if (!name.startsWith(prefix) || !name.endsWith(".bin")) continue;
+    const String k = name.substring(prefix.length(), name.length() - 4);
+    if (k < cut) old.push_back("/" + name);
+  }
+  root.close();
+  for (const String& p : old) {
+    FileWriter::release(p.c_str());
+    if (LittleFS.remove(p)) { ++g_stats.pruned; LOGI("Rollup: %s removed (retention)", p.c_str()); }
+  }
+}
+
+static size_t fileSize(Level lv, const String& p) {
+  if (lv == LV_1M) return FileWriter::size(p.c_str());
+  if (!LittleFS.exists(p)) return 0;
+  File f = LittleFS.open(p, "r");
+  const size_t n = f ? f.size() : 0;
+  if (f) f.close();
+  return n;
+}
+
+// pierwsze dopisanie do pliku: poprzedni zwolniony, urwany rekord obcięty,
+// retencja (raz na dobę / miesiąc)
+static void switchFile(Level lv, const String& p, uint32_t now) {
+  if (lv == LV_1M && g_cur[lv].length()) FileWriter::release(g_cur[lv].c_str());
+  g_cur[lv] = p;
+  const size_t size = fileSize(lv, p);
+  if (size % sizeof(Record)) {
+    FileWriter::release(p.c_str());
+    const size_t good = size - size % sizeof(Record);
+    LOGW("Rollup: %s torn record cut (%lu -> %lu B)", p.c_str(), (unsigned long)size, (unsigned long)good);
+    if (!Recovery::truncate(p, good)) LOGE("Rollup: truncate %s failed", p.c_str());
+  }
+  prune(lv, now);
+}
+
+static void writeRecord(Level lv, const Record& r) {
+  const String p = path(lv, r.start);
+  if (p != g_cur[lv]) switchFile(lv, p, r.start);
+  bool ok;
+  if (lv == LV_1M) {
+    ok = FileWriter::append(p.c_str(), &r, sizeof(r), FileWriter::Batch);
+  } else {
+    File f = LittleFS.open(p, "a");    // rekord na godzinę – bez slotu FileWriter
+    if (!f) f = LittleFS.open(p, "w");
+    ok = f && f.write((const uint8_t*)&r, sizeof(r)) == sizeof(r);
+    if (f) f.close();
+  }
+  if (ok) ++g_stats.records[lv];
+  else    LOGE("Rollup: write %s failed", p.c_str());
+}
+
+static void closeBucket(Level lv) {
+  Acc& a = g_acc[lv];
+  if (!a.open) return;
+  a.open = false;
+  bool any = false;
+  for (int i = 0; i < a.r.n; ++i) {
+    if (!a.r.count[i]) continue;
+    a.r.mean[i] = (float)(a.sum[i] / a.r.count[i]);
+    any = true;
+  }
+  if (any) writeRecord(lv, a.r);
+}
+
+void begin() {
+  g_acc[LV_1M].open = g_acc[LV_1H].open = false;
+  const uint32_t now = (uint32_t)time(nullptr);
+  if (now >= kMinEpoch) { prune(LV_1M, now); prune(LV_1H, now); }
+  LOGI("Rollup: 1m %lu d, 1h %lu mo", (unsigned long)Config::get().roll_1m_days,
+       (unsigned long)Config::get().roll_1h_months);
+}
+
+void push(const AdcFrame& f) {
+  const uint32_t epoch = (uint32_t)f.epoch;
+  if (epoch < kMinEpoch) return;
+  ++g_stats.samples;
+  const int n = f.n < kChannels ? f.n : kChannels;
+  for (int lv = 0; lv < 2; ++lv) {
+    Acc& a = g_acc[lv];
+    const uint32_t start = epoch - epoch % kBucket[lv];
+    if (a.open && a.r.start != start) closeBucket((Level)lv);   // także skok zegara wstecz
+    if (!a.open) {
+      memset(&a.r, 0, sizeof(a.r));
+      a.r.start = start;
+      a.r.level = (uint8_t)lv;
+      for (int i = 0; i < kChannels; ++i) a.sum[i] = 0;
+      a.open = true;
+    }
+    if (n > a.r.n) a.r.n = (uint8_t)n;
+    for (int i = 0; i < n; ++i) {
+      if (!(f.valid & (1u << i))) continue;
+      const float v = (float)f.calc[i];
+      uint16_t& c = a.r.count[i];
+      if (!c || v < a.r.min[i]) a.r.min[i] = v;
+      if (!c || v > a.r.max[i]) a.r.max[i] = v;
+      a.r.last[i] = v;
+      a.sum[i] += v;
+      if (c < 0xFFFF) ++c;
+    }
+  }
+}
+
+// indeks pierwszego rekordu z start >= from (rekordy w pliku rosną)
+static uint32_t lowerBound(File& f, uint32_t nrec, uint32_t from, uint32_t* bytes) {
+  uint32_t lo = 0, hi = nrec;
+  while (lo < hi) {
+    const uint32_t mid = lo + (hi - lo) / 2;
+    uint32_t s = 0;
+    if (!f.seek(mid * sizeof(Record)) || f.read((uint8_t*)&s, sizeof(s)) != (int)sizeof(s)) return lo;
+    *bytes += sizeof(s);
+    if (s < from) lo = mid + 1; else hi = mid;
+  }
+  return lo;
+}
+
+uint32_t read(Level lv, uint32_t from, uint32_t to, Visit fn, void* ctx, uint32_t* bytesRead) {
+  uint32_t bytes = 0, n = 0;
+  const uint32_t now = (uint32_t)time(nullptr);
+  if (to > now) to = now;
+  if (from < kMinEpoch) from = kMinEpoch;
+  if (from > to) { if (bytesRead) *bytesRead = 0; return 0; }
+
+  // kolejne pliki zakresu: klucz co dobę (plik 1 h obejmuje miesiąc)
+  String prev;
+  for (uint64_t t = from - from % 86400; t <= (uint64_t)to + 86400; t += 86400) {
+    const uint32_t e = t < from ? from : (t > to ? to : (uint32_t)t);
+    const String p = path(lv, e);
+    if (p == prev) continue;
+    prev = p;
+    if (!LittleFS.exists(p)) continue;
+    if (lv == LV_1M) FileWriter::sync(p.c_str());
+    File f = LittleFS.open(p, "r");
+    if (!f) continue;
+    const uint32_t nrec = f.size() / sizeof(Record);
+    uint32_t k = lowerBound(f, nrec, from, &bytes);
+    Record r;
+    bool done = false;
+    if (f.seek(k * sizeof(Record))) {
+      for (; k < nrec; ++k) {
+        if (f.read((uint8_t*)&r, sizeof(r)) != (int)sizeof(r)) break;
+        bytes += sizeof(r);
+        if (r.start > to) { done = true; break; }
+        fn(ctx, r);
+        ++n;
+      }
+    }
+    f.close();
+    if (done) break;
+  }
+  if (bytesRead) *bytesRead = bytes;
+  return n;
+}
+
+Stats stats() { return g_stats; }
+
+} // namespace Rollup
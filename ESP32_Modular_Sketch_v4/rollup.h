@@ -0,0 +1,49 @@
+#pragma once
+#include <Arduino.h>
+#include "adc_values.h"
+
+// Agregaty kanałów z każdej klatki AdcTask (nie tylko z zapisu co
+// pomiarADCInterval): min/max/średnia/liczba/ostatnia w kubełkach 1 min i
+// 1 h, zapisywane jako rekordy Record (152 B) w plikach z własną retencją:
+//   /roll_1m_RRMMDD.bin – plik na dobę (~219 kB), roll_1m_days dób
+//   /roll_1h_RRMM.bin   – plik na miesiąc (~113 kB), roll_1h_months miesięcy
+// Kubełki wyrównane do epoch, klucz pliku wg czasu lokalnego początku
+// kubełka. Rekord 1 min idzie przez FileWriter (pełne bloki), 1 h –
+// otwarcie na rekord. Niedomknięty kubełek ginie przy restarcie; urwany
+// rekord na końcu pliku jest obcinany przy pierwszym dopisaniu.
+namespace Rollup {
+
+enum Level : uint8_t { LV_1M = 0, LV_1H = 1 };
+
+static const int kChannels = 8;            // jak History::kChannels
+
+struct Record {
+  uint32_t start;                          // początek kubełka (epoch)
+  uint8_t  n;                              // kanałów
+  uint8_t  level;                          // Level
+  uint16_t rsv;
+  uint16_t count[kChannels];               // próbki z ważnym kanałem (0 = brak)
+  float    min[kChannels];
+  float    max[kChannels];
+  float    mean[kChannels];
+  float    last[kChannels];
+};
+
+struct Stats {
+  uint32_t records[2];                     // zapisane rekordy wg Level
+  uint32_t pruned;                         // pliki usunięte przez retencję
+  uint32_t samples;                        // klatki przyjęte
+};
+
+typedef void (*Visit)(void* ctx, const Record& r);
+
+void     begin();                          // po Config::begin()
+void     push(const AdcFrame& f);          // z AdcTask::drain(), każda klatka
+
+uint32_t bucketSec(Level lv);
+String   path(Level lv, uint32_t epoch);   // plik z kubełkiem zaczynającym się w epoch
+// rekordy z początkiem w [from, to], od najstarszego; bytesRead – odczyt z flash
+uint32_t read(Level lv, uint32_t from, uint32_t to, Visit fn, void* ctx, uint32_t* bytesRead = nullptr);
+Stats    stats();
+
+} // namespace Rollup
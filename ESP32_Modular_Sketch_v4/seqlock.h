@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Seqlock dla jednego pisarza: czytelnicy (inne zadania / drugi rdzeń) dostają
+// spójną kopię T bez muteksu i bez blokowania pisarza. Licznik nieparzysty =
+// zapis w toku; czytelnik powtarza kopię, jeśli licznik się zmienił.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock: T musi być trivially copyable");
+
+ public:
+  SeqLock() { memset((void*)&data_, 0, sizeof(T)); }
+
+  // tylko jeden pisarz
+  void write(const T& v) {
+    const uint32_t s = seq_.load(std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy((void*)&data_, &v, sizeof(T));
+    seq_.store(s + 2, std::memory_order_release);
+  }
+
+  T read() const {
+    T out;
+    uint32_t s0, s1;
+    do {
+      s0 = seq_.load(std::memory_order_acquire);
+      if (s0 & 1) continue;   // pisarz w trakcie
+      memcpy(&out, (const void*)&data_, sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      s1 = seq_.load(std::memory_order_relaxed);
+      if (s0 == s1) break;
+    } while (true);
+    return out;
+  }
+
+  // liczba zakończonych zapisów
+  uint32_t writes() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+ private:
+  std::atomic<uint32_t> seq_{0};
+  T data_;
+};
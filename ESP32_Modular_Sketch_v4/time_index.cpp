@@ -0,0 +1,177 @@
+#include "time_index.h"
+#include "bin_series.h"   // BinSeries::localSeconds
+#include <LittleFS.h>
+#include <time.h>
+
+namespace TimeIndex {
+
+static_assert(sizeof(Entry) == 8, "Entry: 2 x uint32_t bez wypełnienia");
+
+static const size_t kLineCap = 256;   // rekord ~80 B (RecordFmt::Line::kCap 192)
+
+static bool two(const char* p, int* v) {
+  if (p[0] < '0' || p[0] > '9' || p[1] < '0' || p[1] > '9') return false;
+  *v = (p[0] - '0') * 10 + (p[1] - '0');
+  return true;
+}
+
+uint32_t parseStamp(const char* s, size_t n) {
+  if (n != 17) return 0;
+  int f[6];
+  for (int i = 0; i < 6; ++i) {
+    if (!two(s + 3 * i, &f[i])) return 0;
+    if (i < 5 && s[3 * i + 2] != ':') return 0;
+  }
+  if (f[1] < 1 || f[1] > 12 || f[2] < 1 || f[2] > 31) return 0;
+  struct tm t = {};
+  t.tm_year = 100 + f[0];
+  t.tm_mon  = f[1] - 1;
+  t.tm_mday = f[2];
+  t.tm_hour = f[3];
+  t.tm_min  = f[4];
+  t.tm_sec  = f[5];
+  return BinSeries::localSeconds(t);
+}
+
+// IMEI;Czujnik;Rczas;...
+bool match(const Query& q, const char* line, size_t n) {
+  const char* end = line + n;
+  const char* id  = (const char*)memchr(line, ';', n);
+  if (!id) return false;
+  ++id;
+  const char* ts = (const char*)memchr(id, ';', end - id);
+  if (!ts) return false;
+  const size_t idLen = ts - id;
+  ++ts;
+  const char* te = (const char*)memchr(ts, ';', end - ts);
+  if (!te) return false;
+
+  if (q.channel && q.channel[0] &&
+      (strlen(q.channel) != idLen || memcmp(q.channel, id, idLen) != 0)) return false;
+  const uint32_t sec = parseStamp(ts, te - ts);
+  return sec && sec >= q.from && sec <= q.to;
+}
+
+// wpis dopisywany raz na kStride danych (~co 1.3 bloku pomiarów) – otwarcie
+// na wpis zamiast slotu FileWriter z buforem 4 kB
+bool append(const char* idxPath, const Entry& e) {
+  File f = LittleFS.open(idxPath, "a");
+  if (!f) f = LittleFS.open(idxPath, "w");
+  if (!f) return false;
+  const bool ok = f.write((const uint8_t*)&e, sizeof(e)) == sizeof(e);
+  f.close();
+  return ok;
+}
+
+bool last(const char* idxPath, Entry* e) {
+  if (!LittleFS.exists(idxPath)) return false;
+  File f = LittleFS.open(idxPath, "r");
+  if (!f) return false;
+  // urwany wpis (rozmiar nie jest wielokrotnością 8 B) = indeks do przebudowy
+  const size_t n = f.size() / sizeof(Entry);
+  bool ok = n > 0 && f.size() % sizeof(Entry) == 0 &&
+            f.seek((n - 1) * sizeof(Entry)) &&
+            f.read((uint8_t*)e, sizeof(Entry)) == (int)sizeof(Entry);
+  f.close();
+  return ok;
+}
+
+Span find(const char* idxPath, const Query& q, Stats* st) {
+  Span sp = { 0, kTimeMax };
+  if (!LittleFS.exists(idxPath)) return sp;
+  File f = LittleFS.open(idxPath, "r");
+  if (!f) return sp;
+
+  // początek: wpis przed pierwszym z czasem >= from (późniejszy skok zegara
+  // wstecz nie przesuwa już początku); koniec: pierwszy dalszy wpis > to
+  Entry buf[32];
+  int r;
+  bool started = false, done = false;
+  while (!done && (r = f.read((uint8_t*)buf, sizeof(buf))) > 0) {
+    if (st) st->bytesRead += r;
+    for (int i = 0; i < r / (int)sizeof(Entry); ++i) {
+      const Entry& e = buf[i];
+      if (!started) {
+        if (e.sec < q.from) { sp.begin = e.off; continue; }
+        started = true;
+      }
+      if (e.sec > q.to) { sp.end = e.off; done = true; break; }
+    }
+  }
+  f.close();
+  if (sp.end < sp.begin) sp.end = kTimeMax;   // indeks niezgodny z plikiem
+  return sp;
+}
+
+bool scan(File& data, const Span& sp, const Query& q, Emit emit, void* ctx, Stats* st) {
+  if (!data.seek(sp.begin)) return false;
+  uint8_t buf[512];
+  char    line[kLineCap];
+  size_t  ln = 0;
+  bool    over = false;               // za długa linia – pomijana
+  uint32_t pos = sp.begin;
+
+  while (pos < sp.end) {
+    size_t want = sizeof(buf);
+    if (sp.end != kTimeMax && sp.end - pos < want) want = sp.end - pos;
+    const int r = data.read(buf, want);
+    if (r < 0) return false;
+    if (r == 0) break;
+    pos += r;
+    if (st) st->bytesRead += r;
+    for (int i = 0; i < r; ++i) {
+      const char c = (char)buf[i];
+      if (ln < sizeof(line)) line[ln++] = c;
+      else over = true;
+      if (c != '\n') continue;
+      if (st) ++st->lines;
+      if (!over && match(q, line, ln)) {
+        emit(ctx, line, ln);
+        if (st) ++st->matched;
+      }
+      ln = 0;
+      over = false;
+    }
+  }
+  return true;                        // niepełna ostatnia linia (zapis w toku) pominięta
+}
+
+uint32_t rebuild(const char* dataPath, const char* idxPath) {
+  LittleFS.remove(idxPath);
+  if (!LittleFS.exists(dataPath)) return 0;
+  File in = LittleFS.open(dataPath, "r");
+  if (!in) return 0;
+  File out = LittleFS.open(idxPath, "w");
+  if (!out) { in.close(); return 0; }
+
+  uint8_t  buf[512];
+  char     stamp[24];
+  size_t   field = 0, sl = 0;         // numer pola w linii, długość Rczas
+  uint32_t pos = 0, lineOff = 0, next = 0, prevSec = 0;
+  int r;
+  // wpis na początku bloku (zmiana Rczas) – jak noteRecordTime() przy zapisie
+  while ((r = in.read(buf, sizeof(buf))) > 0) {
+    for (int i = 0; i < r; ++i, ++pos) {
+      const char c = (char)buf[i];
+      if (c == '\n') { field = 0; sl = 0; lineOff = pos + 1; continue; }
+      if (c == ';') {
+        if (field == 2) {                         // koniec Rczas
+          const Entry e = { parseStamp(stamp, sl), lineOff };
+          if (e.sec && e.sec != prevSec && lineOff >= next) {
+            out.write((const uint8_t*)&e, sizeof(e));
+            next = (lineOff / kStride + 1) * kStride;
+          }
+          if (e.sec) prevSec = e.sec;
+        }
+        ++field;
+        continue;
+      }
+      if (field == 2 && sl < sizeof(stamp)) stamp[sl++] = c;
+    }
+  }
+  out.close();
+  in.close();
+  return next;
+}
+
+} // namespace TimeIndex
@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+#include <FS.h>
+
+// Rzadki indeks czas -> offset dla pliku rekordów CSV (D_<MAC>.txt).
+// Plik indeksu (D_<MAC>.idx) to ciąg wpisów Entry (8 B, LE jak na ESP32):
+// wpis dostaje pierwszy blok rekordów zaczynający się w kolejnym kStride
+// pliku danych, więc 100 kB danych to ~100 wpisów (800 B).
+//
+// Zapytanie o zakres [from, to] czyta indeks, skacze na wpis przed pierwszym
+// z czasem >= from i kończy na pierwszym dalszym wpisie z czasem > to –
+// zamiast całego pliku czyta się zakres plus najwyżej ~2*kStride. Zakłada,
+// że czas rekordów rośnie: rekordy z zakresu zapisane po skoku zegara wstecz
+// (za końcem wycinka) są pominięte.
+namespace TimeIndex {
+
+static const uint32_t kStride  = 1024;
+static const uint32_t kTimeMax = 0xFFFFFFFFu;
+
+struct Entry {
+  uint32_t sec;   // czas lokalny rekordu (BinSeries::localSeconds)
+  uint32_t off;   // offset początku linii w pliku danych
+};
+
+// wycinek pliku danych do przejrzenia: [begin, end)
+struct Span {
+  uint32_t begin;
+  uint32_t end;   // kTimeMax = do końca pliku
+};
+
+struct Query {
+  uint32_t    from;      // czas lokalny [s], włącznie
+  uint32_t    to;        // włącznie
+  const char* channel;   // id czujnika (np. "A001"); nullptr/"" = wszystkie
+};
+
+struct Stats {
+  uint32_t bytesRead;    // dane + indeks
+  uint32_t lines;        // linie przejrzane
+  uint32_t matched;      // linie wysłane
+};
+
+typedef void (*Emit)(void* ctx, const char* line, size_t n);
+
+// Rczas "RR:MM:DD:GG:NN:SS" (rok 20RR) -> czas lokalny; 0 = błędny format
+uint32_t parseStamp(const char* s, size_t n);
+// linia rekordu IMEI;Czujnik;Rczas;... pasuje do zapytania
+bool     match(const Query& q, const char* line, size_t n);
+
+bool     append(const char* idxPath, const Entry& e);
+// ostatni wpis; false = brak indeksu / pusty
+bool     last(const char* idxPath, Entry* e);
+// zakres pliku danych dla zapytania (bez indeksu: cały plik)
+Span     find(const char* idxPath, const Query& q, Stats* st = nullptr);
+// pasujące linie z wycinka pliku danych
+bool     scan(File& data, const Span& sp, const Query& q, Emit emit, void* ctx, Stats* st = nullptr);
+// indeks od nowa z pliku danych (po restarcie bez indeksu, po dopisaniu bez
+// indeksowania); zwraca offset, od którego należy się kolejny wpis
+uint32_t rebuild(const char* dataPath, const char* idxPath);
+
+} // namespace TimeIndex
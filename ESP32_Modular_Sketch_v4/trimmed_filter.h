@@ -0,0 +1,135 @@
+#pragma once
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+namespace trimmed_detail {
+// Wspólny krok obu filtrów: wstawia x w miejsce najstarszej próbki okna n
+// (ring – kolejność przyjścia, sorted – ta sama zawartość posortowana) i
+// poprawia sumę środkowej części [lo..hi]. Zwraca nową średnią obciętą.
+template <typename T>
+T step(T* ring, T* sorted, size_t n, size_t lo, size_t hi, size_t& head, T& sum, T x) {
+  const T old = ring[head];
+  ring[head] = x;
+  head = (head + 1) % n;
+
+  auto inBand = [&](size_t i) { return i >= lo && i <= hi; };
+
+  // p – pozycja usuwanej wartości, q – docelowa pozycja nowej (po usunięciu p)
+  const size_t p = (size_t)(std::lower_bound(sorted, sorted + n, old) - sorted);
+  size_t q = (size_t)(std::lower_bound(sorted, sorted + n, x) - sorted);
+  if (q > p) --q;
+
+  T d = 0;
+  if (inBand(p)) d -= old;
+  if (inBand(q)) d += x;
+  if (q >= p) {
+    // sorted[p+1..q] przesuwa się w lewo: [hi+1] wchodzi do środka, [lo] wypada
+    if (p <= hi && hi + 1 <= q) d += sorted[hi + 1];
+    if (p < lo && lo <= q)      d -= sorted[lo];
+    memmove(&sorted[p], &sorted[p + 1], (q - p) * sizeof(T));
+  } else {
+    // sorted[q..p-1] przesuwa się w prawo: [lo-1] wchodzi do środka, [hi] wypada
+    if (lo > 0 && q <= lo - 1 && lo - 1 < p) d += sorted[lo - 1];
+    if (q <= hi && hi < p)                   d -= sorted[hi];
+    memmove(&sorted[q + 1], &sorted[q], (p - q) * sizeof(T));
+  }
+  sorted[q] = x;
+
+  // co pełny obieg okna suma liczona od nowa – ogranicza dryf zaokrągleń
+  if (head == 0) {
+    sum = 0;
+    for (size_t i = lo; i <= hi; ++i) sum += sorted[i];
+  } else {
+    sum += d;
+  }
+  return sum / (T)(hi - lo + 1);
+}
+}  // namespace trimmed_detail
+
+// Średnia obcięta z okna N ostatnich próbek (odrzuca Trim najmniejszych i Trim
+// największych). Obok bufora cyklicznego trzyma posortowaną kopię okna: nowa
+// próbka zastępuje najstarszą jednym przesunięciem (memmove) zamiast kopii
+// i std::sort, a suma środkowej części okna jest poprawiana o elementy, które
+// przeszły przez granice obcięcia – O(N) na próbkę, bez alokacji.
+// Okno startuje wypełnione zerami (jak dawne samples[][] = {{0}}).
+template <size_t N, size_t Trim, typename T = double>
+class TrimmedMeanFilter {
+  static_assert(N > 2 * Trim, "TrimmedMeanFilter: okno musi być większe niż 2*Trim");
+
+ public:
+  static constexpr size_t kLo = Trim;          // pierwszy indeks środkowej części
+  static constexpr size_t kHi = N - Trim - 1;  // ostatni indeks środkowej części
+
+  TrimmedMeanFilter() { reset(); }
+
+  void reset() {
+    for (size_t i = 0; i < N; ++i) { ring_[i] = 0; sorted_[i] = 0; }
+    head_ = 0;
+    sum_ = 0;
+  }
+
+  // Dodaje próbkę (zastępuje najstarszą) i zwraca średnią obciętą okna.
+  T update(T x) { return trimmed_detail::step(ring_, sorted_, N, kLo, kHi, head_, sum_, x); }
+
+  T median() const { return sorted_[N / 2]; }
+  // pozycja zapisu w buforze cyklicznym (0 = okno właśnie się zawinęło)
+  size_t index() const { return head_; }
+
+ private:
+  T ring_[N];
+  T sorted_[N];
+  size_t head_;
+  T sum_;
+};
+
+// Ten sam filtr z głębokością ustalaną w czasie pracy (profil kanału).
+// Bufory alokowane jednorazowo w resize() – poza nim update() nie alokuje.
+// Obcięcie: depth/5 z każdej strony (dla 10 – 2, jak stały filtr pomiarowy).
+template <typename T = double>
+class TrimmedMeanWindow {
+ public:
+  TrimmedMeanWindow() = default;
+  TrimmedMeanWindow(const TrimmedMeanWindow&) = delete;
+  TrimmedMeanWindow& operator=(const TrimmedMeanWindow&) = delete;
+  ~TrimmedMeanWindow() { delete[] buf_; }
+
+  // Zmienia głębokość okna (1..) i zeruje je. false – brak pamięci.
+  bool resize(size_t depth) {
+    if (depth == 0) depth = 1;
+    if (depth != n_) {
+      T* nb = new (std::nothrow) T[2 * depth];
+      if (!nb) return false;
+      delete[] buf_;
+      buf_ = nb;
+      n_ = depth;
+    }
+    const size_t trim = n_ / 5;
+    lo_ = trim;
+    hi_ = n_ - trim - 1;
+    reset();
+    return true;
+  }
+
+  void reset() {
+    for (size_t i = 0; i < 2 * n_; ++i) buf_[i] = 0;
+    head_ = 0;
+    sum_ = 0;
+    count_ = 0;
+  }
+
+  T update(T x) {
+    if (count_ < n_) ++count_;
+    return trimmed_detail::step(buf_, buf_ + n_, n_, lo_, hi_, head_, sum_, x);
+  }
+
+  size_t depth() const { return n_; }
+  // okno w całości wypełnione prawdziwymi próbkami (koniec rozgrzewania)
+  bool filled() const { return n_ && count_ >= n_; }
+
+ private:
+  T* buf_ = nullptr;   // [0..n) – bufor cykliczny, [n..2n) – kopia posortowana
+  size_t n_ = 0, lo_ = 0, hi_ = 0, head_ = 0, count_ = 0;
+  T sum_ = 0;
+};
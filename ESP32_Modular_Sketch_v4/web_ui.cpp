@@ -11,13 +11,25 @@
 #include <ArduinoJson.h>
 
 #include "measurement.h"
+#include "adc_task.h"
+#include "adc_profiles.h"
+#include "adc_channels.h"
+#include "adc_bench.h"
 #include "data_files.h"
+#include "file_writer.h"
+#include "time_index.h"
+#include "file_tail.h"
+#include "history.h"
+#include "rollup.h"
+#include "quota.h"
+#include "bin_series.h"     // BinSeries::localSeconds
 #include "alarm.h"
 #include "alarm_config.h"
 #include "io_pins.h"
 
 #include <vector>
 #include <algorithm>
+#include <time.h>
 
 #include "email_config.h"
 #include "email_client.h"   // Email::Ack, Email::pop3CheckForEpoch, Email::sendSMTP
@@ -50,54 +62,49 @@ static void handleCfgSyncRun(){
 // (stary alias – już nieużywany, ale zostawiony dla zgodności)
 //static void handleRoot() { sendIndex(); }
 
-// --- tail ostatnich N linii z pliku (czyta od końca) ---
-static String tailLastLines(const String& path, size_t maxLines) {
-  if (maxLines == 0) return "";
-  if (!LittleFS.exists(path)) return "";
+// --- ogon pliku (FileTail) porcjami chunked, bez Stringa na wynik ---
+static void emitTail(void*, const char* p, size_t n) { server.sendContent(p, n); }
 
-  File f = LittleFS.open(path, "r");
-  if (!f) return "";
-  size_t size = f.size();
-  if (size == 0) { f.close(); return ""; }
-
-  const size_t CHUNK = 1024;
-  size_t pos = size;
-  String acc;
-  size_t linesFound = 0;
-
-  while (pos > 0 && linesFound <= maxLines) {
-    size_t toRead = (pos >= CHUNK) ? CHUNK : pos;
-    pos -= toRead;
-    f.seek(pos, SeekSet);
-
-    static char buf[CHUNK + 1];
-    size_t r = f.readBytes(buf, toRead);
-    buf[r] = '\0';
-
-    for (size_t i = 0; i < r; ++i) if (buf[i] == '\n') ++linesFound;
-
-    String chunk(buf);
-    acc = chunk + acc;
-  }
-  f.close();
+// liczba linii z argumentu n (1..2000)
+static size_t tailArg(size_t def) {
+  if (!server.hasArg("n")) return def;
+  long v = server.arg("n").toInt();
+  if (v < 1) v = 1;
+  if (v > 2000) v = 2000;
+  return (size_t)v;
+}
 
-  int need = (int)maxLines;
-  int i = acc.length() - 1, nl = 0;
-  for (; i >= 0; --i) {
-    if (acc[i] == '\n') { ++nl; if (nl == need) { ++i; break; } }
-  }
-  int start = (i < 0) ? 0 : i;
-  return acc.substring(start);
+// odpowiedź text/plain z N ostatnimi liniami pliku
+static void sendTail(const String& path, size_t n) {
+  if (!LittleFS.exists(path)) { server.send(404, "text/plain", "not found"); return; }
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain; charset=utf-8", "");
+  FileTail::Stats st;
+  if (!FileTail::stream(path, n, emitTail, nullptr, &st)) LOGW("tail %s: read failed", path.c_str());
+  server.sendContent("");
+  LOGI("tail %s: %lu lines from %lu/%lu B, %lu B read", path.c_str(), (unsigned long)st.lines,
+       (unsigned long)st.start, (unsigned long)st.size, (unsigned long)st.bytesRead);
 }
 
 // --- LittleFS podgląd ---
 static void handleFS() {
   if (!auth()) { return server.requestAuthentication(); }
-  size_t total = LittleFS.totalBytes();
-  size_t used  = LittleFS.usedBytes();
+  const Quota::Stats q = Quota::stats();   // zajętość z przeglądu Quota (bez usedBytes())
   String html = "<!doctype html><meta charset='utf-8'><title>FS</title>";
   html += "<h1>LittleFS</h1>";
-  html += "<p>Total: " + String((unsigned long)total) + " B, Used: " + String((unsigned long)used) + " B</p><ul>";
+  html += "<p>Total: " + String((unsigned long)q.total) + " B, Used: " + String((unsigned long)q.used) + " B";
+  if (q.evictedUnsentFiles)
+    html += ", usunięte niewysłane: " + String((unsigned long)q.evictedUnsentFiles) + " (" +
+            String((unsigned long)q.evictedUnsentBytes) + " B)";
+  html += "</p>";
+  html += "<table><tr><th>Klasa</th><th>Pliki</th><th>B</th><th>Budżet</th></tr>";
+  for (int c = 0; c < Quota::CL_COUNT; ++c) {
+    const Quota::ClassStats& cs = q.cls[c];
+    html += "<tr><td>" + String(Quota::className((Quota::Class)c)) + "</td><td>" + String((unsigned)cs.files) +
+            "</td><td>" + String((unsigned long)cs.bytes) + "</td><td>" +
+            (cs.budget == Quota::kNoLimit ? String("-") : String((unsigned long)cs.budget)) + "</td></tr>";
+  }
+  html += "</table><ul>";
   File root = LittleFS.open("/");
   if (root) {
     File f = root.openNextFile();
@@ -134,16 +141,60 @@ static void handleStatus() {
   cfgObj["ftp_user"] = cfg.ftp_user;
   cfgObj["ftp_pass"] = cfg.ftp_pass;
   cfgObj["ftp_dir"] = cfg.ftp_dir;
+  cfgObj["ftp_gzip"] = cfg.ftp_gzip;
   cfgObj["http_user"] = cfg.http_user;
   cfgObj["http_pass"] = cfg.http_pass;
 
   // info o wysyłce
   cfgObj["sendFTPInterval"] = (int)cfg.sendFTPInterval_sec;
   cfgObj["cfgSyncInterval_sec"] = cfg.cfgSyncInterval_sec;
+  cfgObj["data_bin"] = cfg.data_bin;
+  cfgObj["hist_hours"] = cfg.hist_hours;
+  cfgObj["hist_ram_min"] = cfg.hist_ram_min;
+  cfgObj["roll_1m_days"] = cfg.roll_1m_days;
+  cfgObj["roll_1h_months"] = cfg.roll_1h_months;
+  cfgObj["ftpq_drain_ms"] = cfg.ftpq_drain_ms;
+  cfgObj["ftpq_drain_kb"] = cfg.ftpq_drain_kb;
   doc["online"] = Net::connected();
   doc["ip"] = Net::wifiIpStr();
   doc["queue_size"] = (int)FTPQ::size();
   doc["sendFTPInterval_sec"] = (int)Measure::getSendFTPInterval();
+  {
+    const History::Info hi = History::info();
+    JsonObject h = doc["history"].to<JsonObject>();
+    h["psram"]    = hi.psram;
+    h["capacity"] = hi.capacity;
+    h["count"]    = hi.count;
+    h["bytes"]    = hi.bytes;
+    h["depthSec"] = hi.depthSec;
+    h["channels"] = hi.channels;
+    h["clamped"]  = hi.clamped;
+    const Rollup::Stats rs = Rollup::stats();
+    JsonObject r = doc["rollup"].to<JsonObject>();
+    r["records1m"] = rs.records[Rollup::LV_1M];
+    r["records1h"] = rs.records[Rollup::LV_1H];
+    r["pruned"]    = rs.pruned;
+  }
+  {
+    const Quota::Stats qs = Quota::stats();
+    JsonObject q = doc["quota"].to<JsonObject>();
+    q["total"]        = qs.total;
+    q["used"]         = qs.used;
+    q["highWater"]    = (uint32_t)((uint64_t)qs.total * Quota::kHighWaterPct / 100);
+    q["evictedFiles"] = qs.evictedFiles;
+    q["evictedBytes"] = qs.evictedBytes;
+    q["evictedUnsentFiles"] = qs.evictedUnsentFiles;   // utracone dane (segment, alarm_rot)
+    q["evictedUnsentBytes"] = qs.evictedUnsentBytes;
+    q["scans"]        = qs.scans;
+    q["scanMs"]       = qs.scanMs;
+    JsonObject cl = q["classes"].to<JsonObject>();
+    for (int c = 0; c < Quota::CL_COUNT; ++c) {
+      JsonObject o = cl[Quota::className((Quota::Class)c)].to<JsonObject>();
+      o["files"] = qs.cls[c].files;
+      o["bytes"] = qs.cls[c].bytes;
+      if (qs.cls[c].budget != Quota::kNoLimit) o["budget"] = qs.cls[c].budget;
+    }
+  }
 
   String out; serializeJson(doc, out);
   server.send(200, "application/json", out);
@@ -175,6 +226,7 @@ static void handleConfigPost() {
   if (server.hasArg("ftp_user")) d.ftp_user = server.arg("ftp_user");
   if (server.hasArg("ftp_pass")) d.ftp_pass = server.arg("ftp_pass");
   if (server.hasArg("ftp_dir")) d.ftp_dir = server.arg("ftp_dir");
+  if (server.hasArg("ftp_gzip")) d.ftp_gzip = (server.arg("ftp_gzip").toInt() != 0);
 
   if (server.hasArg("http_user")) d.http_user = server.arg("http_user");
   if (server.hasArg("http_pass")) d.http_pass = server.arg("http_pass");
@@ -192,6 +244,13 @@ static void handleConfigPost() {
   if (v > 24UL*3600UL) v = 24UL*3600UL;
   d.cfgSyncInterval_sec = v;
 }
+  if (server.hasArg("data_bin")) d.data_bin = (server.arg("data_bin").toInt() != 0);
+  if (server.hasArg("hist_hours")) d.hist_hours = strtoul(server.arg("hist_hours").c_str(), nullptr, 10);
+  if (server.hasArg("hist_ram_min")) d.hist_ram_min = strtoul(server.arg("hist_ram_min").c_str(), nullptr, 10);
+  if (server.hasArg("roll_1m_days")) d.roll_1m_days = strtoul(server.arg("roll_1m_days").c_str(), nullptr, 10);
+  if (server.hasArg("roll_1h_months")) d.roll_1h_months = strtoul(server.arg("roll_1h_months").c_str(), nullptr, 10);
+  if (server.hasArg("ftpq_drain_ms")) d.ftpq_drain_ms = strtoul(server.arg("ftpq_drain_ms").c_str(), nullptr, 10);
+  if (server.hasArg("ftpq_drain_kb")) d.ftpq_drain_kb = strtoul(server.arg("ftpq_drain_kb").c_str(), nullptr, 10);
 
   Config::save(d);
   // natychmiast w życie:
@@ -201,6 +260,7 @@ static void handleConfigPost() {
   server.sendHeader("Location", "/");
   server.send(302, "text/plain", "Saved");
   delay(100);
+  FileWriter::syncAll();
   ESP.restart();
 }
 
@@ -209,6 +269,7 @@ static void handleReboot() {
   if (!auth()) { return server.requestAuthentication(); }
   server.send(200, "text/plain", "Rebooting...");
   delay(100);
+  FileWriter::syncAll();
   ESP.restart();
 }
 //
@@ -313,6 +374,7 @@ static void pruneLogs(size_t keep = 5) {
   size_t toDelete = names.size() - keep;
   for (size_t i = 0; i < toDelete; ++i) {
     String path = "/" + names[i];
+    FileWriter::release(path.c_str());
     if (!LittleFS.remove(path)) {
       LOGW("pruneLogs: remove failed: %s", path.c_str());
     } else {
@@ -324,6 +386,7 @@ static void pruneLogs(size_t keep = 5) {
 static void handleLogsIndex() {
   if (!auth()) { return server.requestAuthentication(); }
   pruneLogs(5);
+  FileWriter::syncAll();   // rozmiary z flash
   String html = "<!doctype html><html><head><meta charset='utf-8'><title>Logs</title>"
                 "<style>body{font-family:sans-serif;margin:20px} li{margin:4px 0}</style>"
                 "</head><body>";
@@ -343,6 +406,7 @@ static void handleLogsIndex() {
     unsigned long sz = f ? (unsigned long)f.size() : 0;
     if (f) f.close();
     html += "<li><a href='/download?file=" + name + "'>" + name + "</a> (" + String(sz) + " B)"
+            " &nbsp; <a href='/logs/tail?file=" + name + "&n=200'>[ostatnie 200]</a>"
             " &nbsp; <a href='/log_delete?file=" + name + "' onclick='return confirm(\"Skasować " + name + "?\");'>[usuń]</a></li>";
   }
   html += "</ul><p><a href='/'>← powrót</a></p></body></html>";
@@ -356,13 +420,23 @@ static void handleLogDelete() {
   if (!isAllowedLogFile(name)) { server.send(403, "text/plain", "forbidden"); return; }
   String path = "/" + name;
   if (!LittleFS.exists(path)) { server.send(404, "text/plain", "not found"); return; }
+  FileWriter::release(path.c_str());
   bool ok = LittleFS.remove(path);
   if (!ok) { server.send(500, "text/plain", "delete failed"); return; }
   pruneLogs(5);
+  Quota::invalidate();
   server.sendHeader("Location", "/logs");
   server.send(302, "text/plain", "deleted");
 }
 
+// GET /logs/tail?file=log0.txt&n=200 – ostatnie linie logu
+static void handleLogTail() {
+  if (!auth()) { return server.requestAuthentication(); }
+  const String name = server.hasArg("file") ? server.arg("file") : String("log0.txt");
+  if (!isAllowedLogFile(name)) { server.send(403, "text/plain", "forbidden"); return; }
+  sendTail("/" + name, tailArg(200));
+}
+
 static void handleDownload() {
   if (!auth()) { return server.requestAuthentication(); }
   if (!server.hasArg("file")) { server.send(400, "text/plain", "missing file"); return; }
@@ -370,6 +444,7 @@ static void handleDownload() {
   if (!isAllowedLogFile(name)) { server.send(403, "text/plain", "forbidden"); return; }
   String path = "/" + name;
   if (!LittleFS.exists(path)) { server.send(404, "text/plain", "not found"); return; }
+  FileWriter::sync(path.c_str());
   File f = LittleFS.open(path, "r");
   if (!f) { server.send(500, "text/plain", "open failed"); return; }
   server.streamFile(f, "text/plain"); f.close();
@@ -737,23 +812,64 @@ static void handleCfgSyncInterval(){
 
 /* ===== MEASURE panel ===== */
 
+// linie zakresu sklejane w porcje chunked (bez Stringa na całą odpowiedź)
+struct RangeOut {
+  char   buf[1024];
+  size_t n;
+};
+
+static void emitRange(void* ctx, const char* l, size_t n) {
+  RangeOut* o = (RangeOut*)ctx;
+  if (o->n + n > sizeof(o->buf)) { server.sendContent(o->buf, o->n); o->n = 0; }
+  memcpy(o->buf + o->n, l, n);       // linia <= 560 B (/measure/history, 32 kanały)
+  o->n += n;
+}
+
+// Podgląd bieżących danych: CSV prosto z pliku, w trybie binarnym linie z
+// dekodera (DataFiles::queryCurrent, pełny zakres) – bez pliku tymczasowego
+static const TimeIndex::Query kAllRecords = { 0, TimeIndex::kTimeMax, nullptr };
+
+struct BinTail {
+  RangeOut out;
+  uint32_t skip;       // linie przed ostatnimi n
+};
+
+static void countLine(void* ctx, const char*, size_t) { ++*(uint32_t*)ctx; }
+
+static void emitBinTail(void* ctx, const char* l, size_t n) {
+  BinTail* t = (BinTail*)ctx;
+  if (t->skip) { --t->skip; return; }
+  emitRange(&t->out, l, n);
+}
+
+// ostatnie n linii: CSV przez FileTail, binarnie dwa przebiegi dekodera
+// (liczenie, potem wysyłka końcówki) – .bin jest mały (currentFull())
+static void streamMeasureTail(size_t n) {
+  if (!DataFiles::binary()) {
+    const String p = DataFiles::pathCurrent();
+    FileWriter::sync(p.c_str());
+    FileTail::stream(p, n, emitTail, nullptr);
+    return;
+  }
+  uint32_t total = 0;
+  if (!DataFiles::queryCurrent(kAllRecords, countLine, &total)) return;
+  BinTail t;
+  t.out.n = 0;
+  t.skip  = total > n ? total - n : 0;
+  DataFiles::queryCurrent(kAllRecords, emitBinTail, &t);
+  if (t.out.n) server.sendContent(t.out.buf, t.out.n);
+}
+
 static void handleMeasurePage() {
   if (!auth()) { return server.requestAuthentication(); }
 
-  const String curPath  = DataFiles::pathCurrent();
+  const String curPath  = DataFiles::binary() ? DataFiles::pathCurrentBin() : DataFiles::pathCurrent();
   const size_t curSize  = DataFiles::fileSize(curPath);
   const uint32_t interval = Measure::pomiarADCInterval;
 
-  size_t n = 50;
-  if (server.hasArg("n")) {
-    long v = server.arg("n").toInt();
-    if (v < 1) v = 1;
-    if (v > 2000) v = 2000;
-    n = (size_t)v;
-  }
+  const size_t n = tailArg(50);
 
   String qjson = FTPQ::toJson();
-  String preview = tailLastLines(curPath, n);
   String pretty = qjson;
     // Spróbuj sformatować JSON, a jak się nie uda – pokaż surowy
   JsonDocument tmp;
@@ -778,11 +894,40 @@ static void handleMeasurePage() {
 
   html += "<p>";
   html += "<form method='POST' action='/measure/rotate_send' style='display:inline-block;margin-right:8px'>";
-  html += "<button type='submit'>Rotuj i dodaj do kolejki FTP (teraz)</button>";
+  html += "<button type='submit'>Zamknij segment i dodaj do kolejki FTP (teraz)</button>";
   html += "</form>";
   html += "<a href='/measure/view' target='_blank'>Pełny podgląd pliku</a>";
   html += "</p>";
 
+  // ostatnie wartości z pierścienia History (RAM) – bez czytania pliku
+  html += "<h2>Ostatnie wartości</h2>";
+  {
+    History::Sample s;
+    const History::Info hi = History::info();
+    if (History::latest(&s)) {
+      html += "<table><tr><th>Kanał</th><th>Raw [V]</th><th>Calc</th><th>Min 60 s</th><th>Max 60 s</th></tr>";
+      for (int i = 0; i < s.n && i < AdcChannels::count(); ++i) {
+        History::Window w;
+        const bool hasW = History::window(i, 60, &w);
+        html += "<tr><td>" + String(AdcChannels::at(i).id) + "</td><td>" + String(s.raw[i], 6) +
+                "</td><td>" + String(s.calc[i], 6) + "</td><td>" + (hasW ? String(w.min, 6) : String("-")) +
+                "</td><td>" + (hasW ? String(w.max, 6) : String("-")) + "</td></tr>";
+      }
+      html += "</table><p>Wejścia B001..B005: ";
+      for (int i = 0; i < 5; ++i) html += ((s.binIn >> i) & 1) ? "1" : "0";
+      html += ", klatka " + String((unsigned long)s.seq) + "</p>";
+    } else {
+      html += "<p>Brak klatek.</p>";
+    }
+    html += "<p>Historia w " + String(hi.psram ? "PSRAM" : "RAM") + ": " + String((unsigned long)hi.count) + "/" +
+            String((unsigned long)hi.capacity) + " klatek (~" + String((unsigned long)(hi.depthSec / 60)) + " min) – "
+            "<a href='/measure/latest' target='_blank'>/measure/latest</a>, "
+            "<a href='/measure/history?sec=3600' target='_blank'>/measure/history</a></p>";
+    html += "<p>Agregaty min/max/średnia: "
+            "<a href='/measure/rollup?level=1m&from=-3600' target='_blank'>1 min (ostatnia godzina)</a>, "
+            "<a href='/measure/rollup?level=1h&from=-604800' target='_blank'>1 h (ostatni tydzień)</a></p>";
+  }
+
   html += "<h2>Mini-podgląd ostatnich N linii</h2>";
   html += "<div style='margin:6px 0'>";
   html += "<a class='btn' href='/measure?n=100'>Pokaż ostatnie 100</a>";
@@ -795,7 +940,27 @@ static void handleMeasurePage() {
   html += "<button type='submit'>Odśwież</button>";
   html += "</form>";
 
-  html += "<pre>" + preview + "</pre>";
+  html += "<pre>";
+
+  // strona wysyłana w częściach: podgląd idzie prosto z pliku (FileTail)
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/html", "");
+  server.sendContent(html);
+  html = "";
+  streamMeasureTail(n);
+  html += "</pre>";
+
+  html += "<h2>Zakres czasu</h2>";
+  html += "<div style='margin:6px 0'>";
+  html += "<a class='btn' href='/measure/range?from=-3600' target='_blank'>Ostatnia godzina</a>";
+  html += "<a class='btn' href='/measure/range?from=-86400' target='_blank'>Ostatnia doba</a>";
+  html += "</div>";
+  html += "<form method='GET' action='/measure/range' target='_blank' style='margin:6px 0'>";
+  html += "Od <input name='from' placeholder='RR:MM:DD:GG:NN:SS' size='17'> ";
+  html += "do <input name='to' placeholder='RR:MM:DD:GG:NN:SS' size='17'> ";
+  html += "kanał <input name='channel' placeholder='np. A001' size='6'> ";
+  html += "<button type='submit'>Pokaż</button>";
+  html += "</form>";
 
   html += "<h2>Interwał pomiaru</h2>";
   html += "<form method='POST' action='/measure/interval'>";
@@ -803,11 +968,48 @@ static void handleMeasurePage() {
   html += " <button type='submit'>Zapisz</button>";
   html += "</form>";
 
-  html += "<h2>Interwał próbkowania MCP</h2>";
+  html += "<h2>Okres klatki akwizycji (MCP)</h2>";
   html += "<form method='POST' action='/measure/mcp_interval'>";
-  html += "MCP (sekundy): <input type='number' name='sec' min='1' value='" + String(Measure::pomiarMCPInterval) + "'>";
+  html += "Klatka (sekundy): <input type='number' name='sec' min='1' value='" + String(Measure::pomiarMCPInterval) + "'>";
   html += " <button type='submit'>Zapisz</button>";
   html += "</form>";
+  {
+    const AdcTask::Stats as = AdcTask::stats();
+    html += "<p>Akwizycja: ramek " + String((unsigned long)as.frames) +
+            ", jitter min/max/śr " + String((long)as.jitterMinUs) + "/" + String((long)as.jitterMaxUs) +
+            "/" + String((unsigned long)as.jitterAvgUs) + " us" +
+            ", przekroczenia " + String((unsigned long)as.overruns) +
+            ", zgubione " + String((unsigned long)as.dropped) +
+            " (<a href='/adc/stats' target='_blank'>/adc/stats</a>)</p>";
+
+    // rejestr kanałów: profil, kalibracja i liczniki harmonogramu EDF
+    html += "<h2>Kanały analogowe</h2>";
+    html += "<form method='POST' action='/measure/adc_profiles'>";
+    html += "<table><tr><th>Kanał</th><th>Układ</th><th>Bity</th><th>PGA (0=auto)</th><th>Okres [ms] (0=wył.)</th><th>Filtr</th>"
+            "<th>A</th><th>B</th><th>Próbki</th><th>Pominięte</th><th>Timeouty</th><th>Spóźn. max [ms]</th></tr>";
+    for (int i=0;i<AdcChannels::count();++i) {
+      const AdcChannels::Channel& rc = AdcChannels::at(i);
+      const AdcProfiles::Profile p = AdcProfiles::get(i);
+      const AdcChanStats c = adcSchedStats(i);
+      const String pfx = "p" + String(i) + "_";
+      char chip[16]; snprintf(chip, sizeof(chip), "0x%02X/CH%u", rc.addr, (unsigned)rc.input + 1);
+      html += "<tr><td>" + String(rc.id) + "</td><td>" + chip + "</td>";
+      html += "<td><select name='" + pfx + "b'>";
+      for (int b = 12; b <= 18; b += 2) {
+        html += "<option value='" + String(b) + "'"; if (p.bits == b) html += " selected";
+        html += ">" + String(b) + "</option>";
+      }
+      html += "</select></td>";
+      html += "<td><input name='" + pfx + "g' value='" + String((unsigned)p.gain) + "' size='3'></td>";
+      html += "<td><input name='" + pfx + "t' value='" + String((unsigned long)p.periodMs) + "' size='7'></td>";
+      html += "<td><input name='" + pfx + "d' value='" + String((unsigned)p.depth) + "' size='3'></td>";
+      html += "<td><input name='" + pfx + "ca' value='" + String(rc.A, 6) + "' size='8'></td>";
+      html += "<td><input name='" + pfx + "cb' value='" + String(rc.B, 6) + "' size='8'></td>";
+      html += "<td>" + String((unsigned long)c.samples) + "</td><td>" + String((unsigned long)c.missed) +
+              "</td><td>" + String((unsigned long)c.timeouts) + "</td><td>" + String((unsigned long)c.lateMaxMs) + "</td></tr>";
+    }
+    html += "</table><p><button type='submit'>Zapisz profile</button></p></form>";
+  }
 
   html += "<h2>Kolejka FTP</h2>";
   html += "<pre>" + pretty + "</pre>";
@@ -816,29 +1018,235 @@ static void handleMeasurePage() {
   html += "<p><a href='/'>← powrót</a></p>";
   html += "</body></html>";
 
-  server.send(200, "text/html", html);
+  server.sendContent(html);
+  server.sendContent("");
 }
 
 static void handleMeasureView() {
   if (!auth()) { return server.requestAuthentication(); }
-  String path = DataFiles::pathCurrent();
+  if (DataFiles::binary()) {
+    if (!LittleFS.exists(DataFiles::pathCurrentBin()) && !LittleFS.exists(DataFiles::pathCurrent())) {
+      server.send(404, "text/plain", "no data"); return;
+    }
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain", "");
+    RangeOut out;
+    out.n = 0;
+    if (!DataFiles::queryCurrent(kAllRecords, emitRange, &out)) LOGW("/measure/view: decode failed");
+    if (out.n) server.sendContent(out.buf, out.n);
+    server.sendContent("");
+    return;
+  }
+  const String path = DataFiles::pathCurrent();
+  FileWriter::sync(path.c_str());
   if (!LittleFS.exists(path)) { server.send(404, "text/plain", "no data"); return; }
   File f = LittleFS.open(path, "r");
   if (!f) { server.send(500, "text/plain", "open failed"); return; }
   server.streamFile(f, "text/plain"); f.close();
 }
 
+// czas zakresu: "RR:MM:DD:GG:NN:SS" (jak Rczas), liczba >= 0 = epoch UNIX,
+// liczba < 0 = tyle sekund przed teraz; brak argumentu = def
+static bool rangeArg(const char* name, uint32_t def, uint32_t* out) {
+  const String v = server.hasArg(name) ? server.arg(name) : String();
+  if (!v.length()) { *out = def; return true; }
+  if (v.indexOf(':') >= 0) {
+    *out = TimeIndex::parseStamp(v.c_str(), v.length());
+    return *out != 0;
+  }
+  const long x = v.toInt();
+  const time_t t = x < 0 ? time(nullptr) + x : (time_t)x;
+  struct tm tmv; localtime_r(&t, &tmv);
+  *out = BinSeries::localSeconds(tmv);
+  return true;
+}
+
+// GET /measure/range?from=&to=&channel= – rekordy bieżących danych z zakresu
+// czasu; skok przez indeks czasu (time_index.h), wynik strumieniowo
+static void handleMeasureRange() {
+  if (!auth()) { return server.requestAuthentication(); }
+  TimeIndex::Query q;
+  if (!rangeArg("from", 0, &q.from)) { server.send(400, "text/plain", "bad 'from'"); return; }
+  if (!rangeArg("to", TimeIndex::kTimeMax, &q.to)) { server.send(400, "text/plain", "bad 'to'"); return; }
+  if (q.from > q.to) { server.send(400, "text/plain", "'from' after 'to'"); return; }
+  const String channel = server.arg("channel");
+  q.channel = channel.c_str();
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", "");
+  RangeOut out;
+  out.n = 0;
+  TimeIndex::Stats st = {};
+  const uint32_t t0 = millis();
+  if (!DataFiles::queryCurrent(q, emitRange, &out, &st)) LOGW("/measure/range: query failed");
+  if (out.n) server.sendContent(out.buf, out.n);
+  server.sendContent("");
+  LOGI("/measure/range: %lu/%lu lines, %lu B read, %lu ms", (unsigned long)st.matched,
+       (unsigned long)st.lines, (unsigned long)st.bytesRead, (unsigned long)(millis() - t0));
+}
+
+// GET /measure/latest?sec=60 – ostatnia klatka z pierścienia History (RAM)
+// i min/max/średnia kanałów z ostatnich sec sekund; bez odczytu z flash
+static void handleMeasureLatest() {
+  if (!auth()) { return server.requestAuthentication(); }
+  History::Sample s;
+  if (!History::latest(&s)) { server.send(404, "application/json", "{\"error\":\"no data\"}"); return; }
+  uint32_t sec = server.hasArg("sec") ? strtoul(server.arg("sec").c_str(), nullptr, 10) : 60;
+  if (sec < 1) sec = 1;
+
+  JsonDocument doc;
+  doc["epoch"] = s.epoch;
+  doc["seq"]   = s.seq;
+  doc["sec"]   = sec;
+  JsonArray ch = doc["channels"].to<JsonArray>();
+  for (int i = 0; i < s.n && i < AdcChannels::count(); ++i) {
+    JsonObject o = ch.createNestedObject();
+    o["id"]    = AdcChannels::at(i).id;
+    o["valid"] = (s.valid & (1u << i)) != 0;
+    o["raw"]   = s.raw[i];
+    o["calc"]  = s.calc[i];
+    History::Window w;
+    if (History::window(i, sec, &w)) {
+      o["min"]  = w.min;
+      o["max"]  = w.max;
+      o["mean"] = w.mean;
+      o["n"]    = w.n;
+    }
+  }
+  JsonArray bin = doc["bin"].to<JsonArray>();
+  for (int i = 0; i < 5; ++i) bin.add((s.binIn >> i) & 1);
+  const History::Info hi = History::info();
+  JsonObject h = doc["history"].to<JsonObject>();
+  h["psram"]    = hi.psram;
+  h["count"]    = hi.count;
+  h["capacity"] = hi.capacity;
+
+  String out; serializeJson(doc, out);
+  server.send(200, "application/json", out);
+}
+
+struct HistOut {
+  RangeOut out;
+  int      ch;                       // -1 = wszystkie kanały
+};
+
+static void emitHistory(void* ctx, const History::Sample& s) {
+  HistOut* h = (HistOut*)ctx;
+  char l[16 * History::kMaxChannels + 48];
+  int n = snprintf(l, sizeof(l), "%lu;%lu", (unsigned long)s.epoch, (unsigned long)s.seq);
+  for (int i = 0; i < s.n; ++i) {
+    if (h->ch >= 0 && i != h->ch) continue;
+    n += snprintf(l + n, sizeof(l) - 24 - n, ";%.6f", (double)s.calc[i]);   // 24 B na B001..B005
+    if (n >= (int)sizeof(l) - 24) { n = sizeof(l) - 25; break; }
+  }
+  n += snprintf(l + n, sizeof(l) - n, ";%u%u%u%u%u\r\n", s.binIn & 1, (s.binIn >> 1) & 1,
+                (s.binIn >> 2) & 1, (s.binIn >> 3) & 1, (s.binIn >> 4) & 1);
+  emitRange(&h->out, l, (size_t)n);
+}
+
+// GET /measure/history?sec=600&channel= (albo from=&to= jako epoch) – klatki
+// z pierścienia History jako CSV: epoch;seq;<calc kanałów>;B001..B005
+static void handleMeasureHistory() {
+  if (!auth()) { return server.requestAuthentication(); }
+  History::Sample last;
+  if (!History::latest(&last)) { server.send(404, "text/plain", "no data"); return; }
+  uint32_t from = 0, to = 0xFFFFFFFFu;
+  if (server.hasArg("from")) from = strtoul(server.arg("from").c_str(), nullptr, 10);
+  if (server.hasArg("to"))   to   = strtoul(server.arg("to").c_str(), nullptr, 10);
+  if (!server.hasArg("from")) {
+    const uint32_t sec = server.hasArg("sec") ? strtoul(server.arg("sec").c_str(), nullptr, 10) : 600;
+    from = last.epoch > sec ? last.epoch - sec : 0;
+  }
+  HistOut h;
+  h.out.n = 0;
+  h.ch = -1;
+  const String channel = server.arg("channel");
+  if (channel.length() && (h.ch = AdcChannels::find(channel)) < 0) {
+    server.send(400, "text/plain", "unknown channel"); return;
+  }
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", "");
+  String head = "epoch;seq";
+  for (int i = 0; i < last.n; ++i) {
+    if (h.ch >= 0 && i != h.ch) continue;
+    head += ";"; head += AdcChannels::at(i).id;
+  }
+  head += ";B001-B005\r\n";
+  emitRange(&h.out, head.c_str(), head.length());
+  const uint32_t n = History::forEach(from, to, emitHistory, &h);
+  if (h.out.n) server.sendContent(h.out.buf, h.out.n);
+  server.sendContent("");
+  LOGI("/measure/history: %lu samples", (unsigned long)n);
+}
+
+struct RollOut {
+  RangeOut out;
+  int      ch;                       // -1 = wszystkie kanały
+};
+
+static void emitRollup(void* ctx, const Rollup::Record& r) {
+  RollOut* o = (RollOut*)ctx;
+  for (int i = 0; i < r.n && i < AdcChannels::count(); ++i) {
+    if ((o->ch >= 0 && i != o->ch) || !r.count[i]) continue;
+    char l[160];
+    const int n = snprintf(l, sizeof(l), "%lu;%s;%u;%.6f;%.6f;%.6f;%.6f\r\n", (unsigned long)r.start,
+                           AdcChannels::at(i).id, (unsigned)r.count[i], (double)r.min[i],
+                           (double)r.max[i], (double)r.mean[i], (double)r.last[i]);
+    emitRange(&o->out, l, (size_t)n);
+  }
+}
+
+// epoch: liczba >= 0 wprost, < 0 = tyle sekund przed teraz; brak = def
+static uint32_t epochArg(const char* name, uint32_t def) {
+  if (!server.hasArg(name) || !server.arg(name).length()) return def;
+  const long x = server.arg(name).toInt();
+  return x < 0 ? (uint32_t)(time(nullptr) + x) : (uint32_t)x;
+}
+
+// GET /measure/rollup?level=1m|1h&from=&to=&channel= – agregaty kanałów
+// (rollup.h) jako CSV start;kanał;liczba;min;max;średnia;ostatnia, chunked
+static void handleMeasureRollup() {
+  if (!auth()) { return server.requestAuthentication(); }
+  const String lvArg = server.arg("level");
+  const Rollup::Level lv = lvArg == "1m" ? Rollup::LV_1M : Rollup::LV_1H;
+  if (lvArg.length() && lvArg != "1m" && lvArg != "1h") { server.send(400, "text/plain", "level: 1m|1h"); return; }
+  const uint32_t from = epochArg("from", (uint32_t)time(nullptr) - (lv == Rollup::LV_1M ? 86400UL : 7UL * 86400UL));
+  const uint32_t to   = epochArg("to", 0xFFFFFFFFu);
+  RollOut o;
+  o.out.n = 0;
+  o.ch = -1;
+  const String channel = server.arg("channel");
+  if (channel.length() && (o.ch = AdcChannels::find(channel)) < 0) {
+    server.send(400, "text/plain", "unknown channel"); return;
+  }
+
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "text/plain", "");
+  const char head[] = "start;channel;count;min;max;mean;last\r\n";
+  emitRange(&o.out, head, sizeof(head) - 1);
+  uint32_t bytes = 0;
+  const uint32_t t0 = millis();
+  const uint32_t n = Rollup::read(lv, from, to, emitRollup, &o, &bytes);
+  if (o.out.n) server.sendContent(o.out.buf, o.out.n);
+  server.sendContent("");
+  LOGI("/measure/rollup: %s %lu records, %lu B read, %lu ms", lv == Rollup::LV_1M ? "1m" : "1h",
+       (unsigned long)n, (unsigned long)bytes, (unsigned long)(millis() - t0));
+}
+
 static void handleMeasureRotateSend() {
   if (!auth()) { return server.requestAuthentication(); }
-  if (!DataFiles::rotate3()) {
-    server.send(500, "text/plain", "rotate failed"); return;
+  // bieżący plik zamykany w segment (jak przy wysyłce wg harmonogramu)
+  const String toSend = DataFiles::sealCurrent();
+  if (!toSend.length()) {
+    server.send(500, "text/plain", "nothing to send"); return;
   }
-  const String toSend = DataFiles::path1();
   const String dir    = Config::get().ftp_dir;
-  if (FTPQ::enqueue(toSend.c_str(), dir.c_str())) {
+  if (FTPQ::enqueue(toSend.c_str(), dir.c_str(), FTP::defaultCodec(), /*keepLocal=*/true)) {
     server.sendHeader("Location", "/measure");
     server.send(302, "text/plain", "enqueued");
   } else {
+    // segment zostaje na FS – wróci do kolejki przy starcie
     server.send(500, "text/plain", "enqueue failed");
   }
 }
@@ -853,6 +1261,31 @@ static void handleMeasureSetInterval() {
   server.send(302, "text/plain", "ok");
 }
 
+static void handleMeasureAdcProfiles() {
+  if (!auth()) { return server.requestAuthentication(); }
+  for (int i=0;i<AdcChannels::count();++i) {
+    const String pfx = "p" + String(i) + "_";
+    AdcProfiles::Profile p = AdcProfiles::get(i);
+    if (server.hasArg(pfx+"b")) p.bits     = (uint8_t)server.arg(pfx+"b").toInt();
+    if (server.hasArg(pfx+"g")) p.gain     = (uint8_t)server.arg(pfx+"g").toInt();
+    if (server.hasArg(pfx+"t")) p.periodMs = (uint32_t)server.arg(pfx+"t").toInt();
+    if (server.hasArg(pfx+"d")) {
+      long d = server.arg(pfx+"d").toInt();
+      p.depth = (uint8_t)(d < 1 ? 1 : d > AdcProfiles::kMaxDepth ? AdcProfiles::kMaxDepth : d);
+    }
+    AdcProfiles::set(i, p);   // zadanie akwizycji przeładuje zmienione kanały
+    const AdcChannels::Channel& rc = AdcChannels::at(i);
+    float A = rc.A, B = rc.B;
+    if (server.hasArg(pfx+"ca")) A = server.arg(pfx+"ca").toFloat();
+    if (server.hasArg(pfx+"cb")) B = server.arg(pfx+"cb").toFloat();
+    AdcChannels::setCal(i, A, B);
+  }
+  AdcProfiles::save();
+  AdcChannels::save();
+  server.sendHeader("Location", "/measure");
+  server.send(302, "text/plain", "ok");
+}
+
 static void handleMeasureSetMcpInterval() {
   if (!auth()) { return server.requestAuthentication(); }
   if (!server.hasArg("sec")) { server.send(400, "text/plain", "missing 'sec'"); return; }
@@ -957,6 +1390,18 @@ static void handleFtpqStats() {
   sendJson(200, js);
 }
 
+static void handleAdcStats() {
+  sendJson(200, AdcTask::statsJson());
+}
+
+static void handleAdcBench() {
+  if (!auth()) { return server.requestAuthentication(); }
+  long n = server.hasArg("frames") ? server.arg("frames").toInt() : 200;
+  if (n < 1) n = 1;
+  if (n > 5000) n = 5000;
+  sendJson(200, AdcBench::toJson(AdcBench::run((uint32_t)n)));
+}
+
 /* =================== ALARM panel =================== */
 
 static void handleAlarmPage() {
@@ -1017,9 +1462,8 @@ static void handleAlarmPage() {
 
   h += "<div class='card'><h3>Wejścia analogowe</h3>";
   h += "<table><tr><th>Kanał</th><th>Wartość</th><th>Stan</th></tr>";
-  for (int i=0;i<8;++i) {
-    char ch[8]; snprintf(ch, sizeof(ch), "A%03d", i+1);
-    h += "<tr><td>"; h += ch; h += "</td><td>";
+  for (size_t i=0;i<st.anaVal.size();++i) {
+    h += "<tr><td>"; h += AdcChannels::at((int)i).id; h += "</td><td>";
     h += String(st.anaVal[i], 6);
     h += "</td><td>";
     if (st.anaActive[i]) {
@@ -1043,7 +1487,7 @@ static void handleAlarmPage() {
   h += "</p>";
   h += "<p>Bieżący plik alarmów: <code>";
   h += Alarm::alarmBasePath();
-  h += "</code></p>";
+  h += "</code> (<a href='/alarm/tail?n=100' target='_blank'>ostatnie 100 linii</a>)</p>";
   h += "<form method='POST' action='/alarm/sendnow'><button type='submit'>Wyślij log alarmów teraz (rotuj + FTP)</button></form>";
   h += "</div>";
 
@@ -1053,10 +1497,9 @@ static void handleAlarmPage() {
   h += "<form method='POST' action='/alarm/save'>";
 
   auto conf = AlarmCfg::get();
-  h += "<h3>Analog (A001..A008)</h3><table><tr><th>Kanał</th><th>Hi</th><th>Lo</th><th>Hyst+</th><th>Hyst-</th><th>Czas [s]</th><th>Ile pom.</th></tr>";
-  for (int i=0;i<8;++i) {
-    char ch[8]; snprintf(ch, sizeof(ch), "A%03d", i+1);
-    h += String("<tr><td>") + ch + "</td>"
+  h += "<h3>Analog</h3><table><tr><th>Kanał</th><th>Hi</th><th>Lo</th><th>Hyst+</th><th>Hyst-</th><th>Czas [s]</th><th>Ile pom.</th></tr>";
+  for (int i=0;i<(int)conf.analog.size();++i) {
+    h += String("<tr><td>") + AdcChannels::at(i).id + "</td>"
        + "<td><input name='a"+String(i)+"_hi' value='"+String(conf.analog[i].hi,6)+"'></td>"
        + "<td><input name='a"+String(i)+"_lo' value='"+String(conf.analog[i].lo,6)+"'></td>"
        + "<td><input name='a"+String(i)+"_hp' value='"+String(conf.analog[i].hystP,6)+"'></td>"
@@ -1097,7 +1540,7 @@ static void handleAlarmSave() {
   if (!auth()) { return server.requestAuthentication(); }
   auto c = AlarmCfg::get();
 
-  for (int i=0;i<8;++i) {
+  for (int i=0;i<(int)c.analog.size();++i) {
     String pfx = "a" + String(i) + "_";
     if (server.hasArg(pfx+"hi")) c.analog[i].hi = server.arg(pfx+"hi").toFloat();
     if (server.hasArg(pfx+"lo")) c.analog[i].lo = server.arg(pfx+"lo").toFloat();
@@ -1125,6 +1568,12 @@ static void handleAlarmSendNow() {
   server.send(200, "text/plain", ok ? "OK (rotated+enqueued)" : "NO DATA (or rename fail)");
 }
 
+// GET /alarm/tail?n=100 – ostatnie linie bieżącego pliku alarmów
+static void handleAlarmTail() {
+  if (!auth()) { return server.requestAuthentication(); }
+  sendTail(Alarm::alarmBasePath(), tailArg(100));
+}
+
 /* =========== START / LOOP =========== */
 
 void WebUI::begin() {
@@ -1138,6 +1587,7 @@ void WebUI::begin() {
   server.on("/ftp_test", HTTP_GET, handleFTPTest);
   server.on("/ftp_enqueue_test", HTTP_GET, handleFTPEnqueueTest);
   server.on("/logs", HTTP_GET, handleLogsIndex);
+  server.on("/logs/tail", HTTP_GET, handleLogTail);
   server.on("/download", HTTP_GET, handleDownload);
   server.on("/ftp_queue_clear", HTTP_GET, handleFTPQueueClear);
   server.on("/fs", HTTP_GET, handleFS);
@@ -1150,13 +1600,20 @@ void WebUI::begin() {
   server.on("/ftpq/enqueue", HTTP_POST,    handleFtpqEnqueue);
   server.on("/ftpq/clear",   HTTP_POST,    handleFtpqClear);
   server.on("/ftpq/stats",   HTTP_GET,     handleFtpqStats);
+  server.on("/adc/stats",    HTTP_GET,     handleAdcStats);
+  server.on("/adc/bench",    HTTP_GET,     handleAdcBench);
 
   // Measure
   server.on("/measure",              HTTP_GET,  handleMeasurePage);
   server.on("/measure/view",         HTTP_GET,  handleMeasureView);
+  server.on("/measure/range",        HTTP_GET,  handleMeasureRange);
+  server.on("/measure/latest",       HTTP_GET,  handleMeasureLatest);
+  server.on("/measure/history",      HTTP_GET,  handleMeasureHistory);
+  server.on("/measure/rollup",       HTTP_GET,  handleMeasureRollup);
   server.on("/measure/rotate_send",  HTTP_POST, handleMeasureRotateSend);
   server.on("/measure/interval",     HTTP_POST, handleMeasureSetInterval);
   server.on("/measure/mcp_interval", HTTP_POST, handleMeasureSetMcpInterval);
+  server.on("/measure/adc_profiles", HTTP_POST, handleMeasureAdcProfiles);
 
   // Mail
   server.on("/mail",       HTTP_GET,  handleMailPage);
@@ -1171,6 +1628,7 @@ void WebUI::begin() {
   server.on("/alarm",        HTTP_GET,  handleAlarmPage);
   server.on("/alarm/save",   HTTP_POST, handleAlarmSave);
   server.on("/alarm/sendnow",HTTP_POST, handleAlarmSendNow);
+  server.on("/alarm/tail",   HTTP_GET,  handleAlarmTail);
 
   // Menu + zapis interwału FTP
   server.on("/menu",              HTTP_GET,  handleMenu);
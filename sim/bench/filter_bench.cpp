@@ -0,0 +1,93 @@
+// filter_bench.cpp – mikrobenchmark filtra ADC na hoście: dawny
+// trimmedMeanMedianFilter (kopia okna + std::sort na każdą próbkę) kontra
+// TrimmedMeanFilter<N, Trim> z trimmed_filter.h, dla N = 10, 32, 128.
+// Przy okazji sprawdza, że oba dają ten sam wynik.
+//
+// esp_sim_filter_bench [--samples N]
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "trimmed_filter.h"
+
+namespace {
+
+// Dawny filtr z adc_mcp3424.cpp, sparametryzowany rozmiarem okna.
+template <size_t N, size_t Trim>
+struct SortFilter {
+  double buf[N] = {0};
+  size_t index = 0;
+  double update(double x) {
+    buf[index] = x;
+    index = (index + 1) % N;
+    double sorted[N];
+    memcpy(sorted, buf, sizeof(sorted));
+    std::sort(sorted, sorted + N);
+    double sum = 0;
+    int cnt = 0;
+    for (size_t i = Trim; i < N - Trim; ++i) { sum += sorted[i]; ++cnt; }
+    return cnt ? sum / cnt : x;
+  }
+};
+
+// sygnał jak z MCP3424: wolna sinusoida + szum + pojedyncze szpilki
+std::vector<double> makeSignal(size_t n) {
+  std::mt19937 rng(12345);
+  std::normal_distribution<double> noise(0.0, 0.002);
+  std::uniform_int_distribution<int> spike(0, 199);
+  std::vector<double> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    v[i] = 1.2 + 0.3 * std::sin((double)i * 0.01) + noise(rng);
+    if (spike(rng) == 0) v[i] += 2.0;
+    // kwantyzacja 18-bit (15.625 uV) – w oknie zdarzają się równe wartości
+    v[i] = std::round(v[i] / 15.625e-6) * 15.625e-6;
+  }
+  return v;
+}
+
+template <typename F>
+double timeNsPerSample(const std::vector<double>& in, std::vector<double>& out) {
+  F f;
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < in.size(); ++i) out[i] = f.update(in[i]);
+  auto t1 = std::chrono::steady_clock::now();
+  return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count() /
+         (double)in.size();
+}
+
+template <size_t N, size_t Trim>
+bool bench(const std::vector<double>& in) {
+  std::vector<double> a(in.size()), b(in.size());
+  double sortNs = timeNsPerSample<SortFilter<N, Trim>>(in, a);
+  double incNs = timeNsPerSample<TrimmedMeanFilter<N, Trim>>(in, b);
+  double maxErr = 0;
+  for (size_t i = 0; i < in.size(); ++i) maxErr = std::max(maxErr, std::fabs(a[i] - b[i]));
+  std::printf("N=%-4zu trim=%-3zu sort=%8.1f ns/sample  incremental=%8.1f ns/sample  x%5.1f  "
+              "max|diff|=%.3g\n",
+              N, Trim, sortNs, incNs, incNs > 0 ? sortNs / incNs : 0.0, maxErr);
+  return maxErr < 1e-9;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t n = 2000000;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--samples") && i + 1 < argc) n = (size_t)strtoul(argv[++i], nullptr, 0);
+    else {
+      std::fprintf(stderr, "usage: %s [--samples N]\n", argv[0]);
+      return 2;
+    }
+  }
+  const std::vector<double> in = makeSignal(n);
+  bool ok = bench<10, 2>(in);
+  ok = bench<32, 8>(in) && ok;
+  ok = bench<128, 32>(in) && ok;
+  if (!ok) std::fprintf(stderr, "filter_bench: wyniki filtrów się różnią\n");
+  return ok ? 0 : 1;
+}
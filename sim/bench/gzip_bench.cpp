@@ -0,0 +1,164 @@
+// gzip_bench.cpp – kompresja plików D_<MAC>.txt przed wysyłką FTP:
+// Gzip::Encoder (gzip_stream.h, stałe kody Huffmana, okno 2 kB) kontra zlib
+// (poziomy 1/6/9, tylko jako odniesienie). Dla każdego pliku: rozmiar,
+// współczynnik, czas CPU na hoście; wynik Encodera sprawdzany inflate z zlib
+// bajt w bajt. Bez argumentów bierze ~100 kB rekordów jak z myTestPomiar.
+//
+// esp_sim_gzip_bench [plik...]
+#include <Arduino.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "gzip_stream.h"
+#include "record_fmt.h"
+
+namespace {
+
+bool appendOut(void* ctx, const uint8_t* p, size_t n) {
+  ((std::string*)ctx)->append((const char*)p, n);
+  return true;
+}
+
+// ~100 kB (limit D_<MAC>.txt) rekordów 8 kanałów co 600 s
+std::string synthCsv() {
+  std::mt19937 rng(7);
+  std::normal_distribution<double> nd(0.0, 0.0004);
+  std::string out;
+  char stamp[24], xyz[4];
+  for (int b = 0; out.size() < 100 * 1024; ++b) {
+    const int m = b * 10;
+    snprintf(stamp, sizeof(stamp), "26:10:%02d:%02d:%02d:00", 16 + m / 1440, m / 60 % 24, m % 60);
+    snprintf(xyz, sizeof(xyz), "%03u", (unsigned)(rng() % 101));
+    RecordFmt::Line line;
+    line.field("246F285A3C01");
+    line.mark();
+    auto rec = [&](const char* id, double raw, double calc, const char* rs, const char* cs) {
+      line.rewind();
+      line.field(id).field(stamp).field(xyz, 3);
+      if (rs) line.field(rs).field(cs);
+      else    line.fixed6(raw).fixed6(calc);
+      line.field("79").field("0000");
+      size_t n = 0;
+      const char* l = line.finish(&n);
+      out.append(l, n);
+    };
+    for (int c = 0; c < 8; ++c) {
+      if (c == 4) {
+        rec("AKU", 0, 0, "1071", "6.9912345");
+        rec("B001", 0, 0, "1", "1.0");
+        rec("UAZS", 0, 0, "1", "1.0");
+      }
+      char id[8];
+      snprintf(id, sizeof(id), "A%03d", c + 1);
+      const float v = (float)(0.2 + 0.15 * c + 0.05 * std::sin(b / 23.0 + c) + nd(rng));
+      rec(id, v, v, nullptr, nullptr);
+    }
+  }
+  return out;
+}
+
+bool readFile(const char* path, std::string& out) {
+  FILE* f = std::fopen(path, "rb");
+  if (!f) return false;
+  char buf[4096];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) out.append(buf, n);
+  std::fclose(f);
+  return true;
+}
+
+bool gunzip(const std::string& gz, std::string& out) {
+  z_stream z = {};
+  if (inflateInit2(&z, 16 + MAX_WBITS) != Z_OK) return false;
+  z.next_in  = (Bytef*)gz.data();
+  z.avail_in = (uInt)gz.size();
+  char buf[16384];
+  int rc;
+  do {
+    z.next_out  = (Bytef*)buf;
+    z.avail_out = sizeof(buf);
+    rc = inflate(&z, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - z.avail_out);
+  } while (rc == Z_OK);
+  inflateEnd(&z);
+  return rc == Z_STREAM_END;
+}
+
+size_t zlibGzip(const std::string& in, int level) {
+  z_stream z = {};
+  deflateInit2(&z, level, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+  std::vector<uint8_t> out(deflateBound(&z, in.size()));
+  z.next_in   = (Bytef*)in.data();
+  z.avail_in  = (uInt)in.size();
+  z.next_out  = out.data();
+  z.avail_out = (uInt)out.size();
+  deflate(&z, Z_FINISH);
+  const size_t n = z.total_out;
+  deflateEnd(&z);
+  return n;
+}
+
+double secsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::pair<std::string, std::string>> inputs;
+  for (int i = 1; i < argc; ++i) {
+    std::string d;
+    if (!readFile(argv[i], d)) { std::perror(argv[i]); return 2; }
+    const char* base = std::strrchr(argv[i], '/');
+    inputs.emplace_back(base ? base + 1 : argv[i], d);
+  }
+  if (inputs.empty()) inputs.emplace_back("(synth 100 kB)", synthCsv());
+
+  static Gzip::Encoder enc(appendOut, nullptr);   // ~20 kB – jak na płytce, poza stosem
+  std::printf("Gzip::Encoder: okno %u B, pamięć %u B\n",
+              (unsigned)Gzip::Encoder::kWindow, (unsigned)sizeof(Gzip::Encoder));
+  std::printf("%-34s %8s %8s %6s %8s %7s %7s %7s  %s\n", "plik", "B", "gz B", "ratio",
+              "us/kB", "zlib-1", "zlib-6", "zlib-9", "inflate");
+
+  bool allOk = true;
+  uint64_t sumIn = 0, sumOut = 0;
+  for (const auto& in : inputs) {
+    std::string gz;
+    const int reps = in.second.size() < 16384 ? 50 : 5;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < reps; ++r) {
+      gz.clear();
+      enc = Gzip::Encoder(appendOut, &gz);
+      // porcje 512 B jak pętla odczytu w FTP::uploadFile
+      for (size_t off = 0; off < in.second.size(); off += 512) {
+        enc.write(in.second.data() + off, std::min<size_t>(512, in.second.size() - off));
+      }
+      enc.finish();
+    }
+    const double t = secsSince(t0) / reps;
+
+    std::string back;
+    const bool ok = gunzip(gz, back) && back == in.second;
+    allOk = allOk && ok;
+    sumIn += in.second.size();
+    sumOut += gz.size();
+    const double n = (double)in.second.size();
+    std::printf("%-34s %8zu %8zu %5.1fx %8.2f %6.1fx %6.1fx %6.1fx  %s\n", in.first.c_str(),
+                in.second.size(), gz.size(), n / gz.size(), t * 1e6 / (n / 1024),
+                n / zlibGzip(in.second, 1), n / zlibGzip(in.second, 6), n / zlibGzip(in.second, 9),
+                ok ? "ok" : "BŁĄD");
+  }
+  if (inputs.size() > 1) {
+    std::printf("razem: %llu -> %llu B (%.1fx)\n", (unsigned long long)sumIn,
+                (unsigned long long)sumOut, (double)sumIn / sumOut);
+  }
+  return allOk ? 0 : 1;
+}
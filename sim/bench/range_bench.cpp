@@ -0,0 +1,127 @@
+// range_bench.cpp – zapytania /measure/range po czasie na D_<MAC>.txt:
+// przejście całego pliku z filtrem (bez indeksu) kontra skok przez indeks
+// TimeIndex. Plik budowany jak w myTestPomiar() (11 rekordów co 600 s przez
+// FileWriter, wpis indeksu co kStride). Podaje czas zapytania na hoście,
+// bajty czytane z LittleFS (Sim::stats().fsBytesRead) i liczbę linii.
+//
+// esp_sim_range_bench [--blocks N] [--reps N] [--dir KATALOG]
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "bin_series.h"
+#include "file_writer.h"
+#include "record_fmt.h"
+#include "sim.h"
+#include "time_index.h"
+
+namespace {
+
+const char kData[] = "/D_BENCH.txt";
+const char kIdx[]  = "/D_BENCH.idx";
+const char kNoIdx[] = "/D_BENCH.none";
+const char* const kIds[] = { "A001", "A002", "A003", "A004", "AKU", "B001", "UAZS",
+                             "A005", "A006", "A007", "A008" };
+const uint32_t kStart = 20742u * 86400u + 12u * 3600u;   // 2026-10-16 12:00
+const uint32_t kStep  = 600;
+
+uint32_t build(int blocks) {
+  LittleFS.remove(kData);
+  LittleFS.remove(kIdx);
+  uint32_t next = 0;
+  RecordFmt::Line line;
+  for (int b = 0; b < blocks; ++b) {
+    const uint32_t sec = kStart + (uint32_t)b * kStep;
+    const uint32_t off = (uint32_t)FileWriter::size(kData);
+    if (off >= next) {                       // jak DataFiles::noteRecordTime()
+      TimeIndex::append(kIdx, TimeIndex::Entry{ sec, off });
+      next = (off / TimeIndex::kStride + 1) * TimeIndex::kStride;
+    }
+    char stamp[24];
+    const size_t sl = BinSeries::formatStamp(sec, stamp, sizeof(stamp));
+    line.clear();
+    line.field("A1B2C3D4E5F6");
+    line.mark();
+    for (size_t i = 0; i < sizeof(kIds) / sizeof(kIds[0]); ++i) {
+      line.rewind();
+      line.field(kIds[i]).field(stamp, sl).field("042").fixed6(0.1 * i + b * 1e-4).fixed6(0.2 * i);
+      line.field("79").field("0000");
+      size_t n = 0;
+      const char* l = line.finish(&n);
+      FileWriter::append(kData, l, n, FileWriter::Batch);
+    }
+  }
+  FileWriter::release(kData);
+  return kStart + (uint32_t)(blocks - 1) * kStep;
+}
+
+void countLine(void* ctx, const char*, size_t) { ++*(uint32_t*)ctx; }
+
+void query(const char* name, const char* idx, const TimeIndex::Query& q, int reps) {
+  uint32_t lines = 0;
+  uint64_t bytes = 0;
+  auto t0 = std::chrono::steady_clock::now();
+  for (int r = 0; r < reps; ++r) {
+    lines = 0;
+    const uint64_t b0 = Sim::stats().fsBytesRead;
+    const TimeIndex::Span sp = TimeIndex::find(idx, q);
+    File f = LittleFS.open(kData, "r");
+    TimeIndex::scan(f, sp, q, countLine, &lines);
+    f.close();
+    bytes = Sim::stats().fsBytesRead - b0;
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  const double us = std::chrono::duration<double, std::micro>(t1 - t0).count() / reps;
+  std::printf("%-28s %9.1f us  %8llu B read  %6u lines\n", name, us,
+              (unsigned long long)bytes, (unsigned)lines);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int blocks = 128;   // ~100 kB CSV (FILE_SIZE_LIMIT)
+  int reps = 200;
+  std::string dir = "esp_sim_range_bench_fs";
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--blocks") && i + 1 < argc) blocks = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--reps") && i + 1 < argc) reps = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--dir") && i + 1 < argc) dir = argv[++i];
+    else {
+      std::fprintf(stderr, "usage: %s [--blocks N] [--reps N] [--dir KATALOG]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (blocks < 1) blocks = 1;
+  if (reps < 1) reps = 1;
+  Sim::opts().fsRoot = dir;
+  if (!LittleFS.begin(true)) {
+    std::fprintf(stderr, "range_bench: LittleFS.begin(%s) failed\n", dir.c_str());
+    return 1;
+  }
+  FileWriter::begin();
+
+  const uint32_t last = build(blocks);
+  std::printf("blocks=%d data=%u B index=%u B\n", blocks, (unsigned)FileWriter::size(kData),
+              (unsigned)FileWriter::size(kIdx));
+
+  const TimeIndex::Query hour  = { last - 3600 + 1, TimeIndex::kTimeMax, nullptr };
+  const TimeIndex::Query hourC = { last - 3600 + 1, TimeIndex::kTimeMax, "A003" };
+  const uint32_t mid = kStart + (uint32_t)(blocks / 2) * kStep;
+  const TimeIndex::Query midH  = { mid, mid + 3600 - 1, nullptr };
+  const TimeIndex::Query all   = { 0, TimeIndex::kTimeMax, nullptr };
+
+  query("last hour, full scan", kNoIdx, hour, reps);
+  query("last hour, index", kIdx, hour, reps);
+  query("last hour A003, index", kIdx, hourC, reps);
+  query("middle hour, full scan", kNoIdx, midH, reps);
+  query("middle hour, index", kIdx, midH, reps);
+  query("whole file, index", kIdx, all, reps);
+
+  LittleFS.remove(kData);
+  LittleFS.remove(kIdx);
+  return 0;
+}
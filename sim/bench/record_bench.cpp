@@ -0,0 +1,177 @@
+// record_bench.cpp – mikrobenchmark składania rekordów D_<MAC>.txt na hoście:
+// dawne sklejanie Stringów + crcBase + bitowy CRC16 (myTestPomiar sprzed
+// record_fmt) kontra RecordFmt::Line (bufor na stosie, CRC tablicowy w locie).
+// Liczy rekordy/s i alokacje sterty na rekord, sprawdza zgodność bajt w bajt
+// (także dla wartości skrajnych i remisów zaokrąglenia).
+//
+// esp_sim_record_bench [--records N]
+#include <Arduino.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "record_fmt.h"
+
+// ---- licznik alokacji (globalny operator new) ----
+static std::atomic<uint64_t> gAllocs{0};
+
+void* operator new(size_t n) {
+  gAllocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(n ? n : 1)) return p;
+  throw std::bad_alloc();
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+const char* kIds[] = {"A001", "A002", "A003", "A004", "A005", "A006", "A007", "A008"};
+
+// Dawny calculateCRC16 z measurement.cpp.
+String crc16Bitwise(const String& data) {
+  uint16_t crc = 0xFFFF;
+  for (uint16_t i = 0; i < data.length(); ++i) {
+    crc ^= (uint8_t)data[i];
+    for (uint8_t b = 0; b < 8; ++b) {
+      if (crc & 1) crc = (crc >> 1) ^ 0xA001;
+      else         crc = (crc >> 1);
+    }
+  }
+  String s = String(crc, HEX);
+  s.toLowerCase();
+  return s;
+}
+
+struct Block {
+  String IMEI = "A1B2C3D4E5F6";
+  String Rczas = "26:10:16:12:00:00";
+  String xyz = "042";
+  String poziom_GSM = "87";
+  String stan_wyjsc = "0000";
+};
+
+// Dawny appendRecord z myTestPomiar (bez zapisu do pliku).
+String oldRecord(const Block& b, const char* id, double raw, double calc) {
+  const String Czujnik = id;
+  const String rawS = String(raw, 6);
+  const String calcS = String(calc, 6);
+  const String crcBase = b.IMEI + ";" + Czujnik + ";" + b.Rczas + ";" + b.xyz + ";" +
+                         rawS + ";" + calcS + ";" + b.poziom_GSM + ";" + b.stan_wyjsc;
+  const String CRC16 = crc16Bitwise(crcBase);
+
+  String line; line.reserve(128);
+  line += b.IMEI; line+=';'; line+=Czujnik; line+=';'; line+=b.Rczas; line+=';';
+  line+=b.xyz; line+=';'; line+=rawS; line+=';'; line+=calcS; line+=';';
+  line+=b.poziom_GSM; line+=';'; line+=b.stan_wyjsc; line+=';'; line+=CRC16; line+=";\r\n";
+  return line;
+}
+
+// Nowa ścieżka jak w myTestPomiar: IMEI raz (mark), dalej rewind na rekord.
+const char* newRecord(RecordFmt::Line& line, const Block& b, const char* id, double raw,
+                      double calc, size_t* len) {
+  line.rewind();
+  line.field(id).field(b.Rczas).field(b.xyz);
+  line.fixed6(raw).fixed6(calc);
+  line.field(b.poziom_GSM).field(b.stan_wyjsc);
+  return line.finish(len);
+}
+
+// wartości jak z MCP3424 (kwantyzacja 18-bit, A*x+B) plus wartości skrajne
+std::vector<double> makeValues(size_t n) {
+  std::mt19937_64 rng(12345);
+  std::uniform_real_distribution<double> u(-2.048, 2.048);
+  std::uniform_real_distribution<double> wide(-1e7, 1e7);
+  std::uniform_int_distribution<int> pick(0, 99);
+  std::vector<double> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    const int k = pick(rng);
+    if (k < 80) v[i] = std::round(u(rng) / 15.625e-6) * 15.625e-6 * 3.7 + 0.25;
+    else if (k < 90) v[i] = (float)u(rng);                  // ścieżka float
+    else if (k < 95) v[i] = wide(rng);
+    else v[i] = (double)(int64_t)(u(rng) * 1e7) / 1e7 + 5e-7;  // okolice remisów
+  }
+  const double special[] = {0.0, -0.0, 0.5e-6, -0.5e-6, 1.5e-6, 2.5e-6, 0.0000005, 999999.9999995,
+                            1e6, -1e6, 123456789.123456, 1e300, -1e-300,
+                            std::numeric_limits<double>::infinity(),
+                            -std::numeric_limits<double>::infinity(),
+                            std::numeric_limits<double>::quiet_NaN()};
+  for (size_t i = 0; i < sizeof(special) / sizeof(special[0]) && i < n; ++i) v[i] = special[i];
+  return v;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t n = 1000000;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--records") && i + 1 < argc) n = (size_t)strtoul(argv[++i], nullptr, 0);
+    else {
+      std::fprintf(stderr, "usage: %s [--records N]\n", argv[0]);
+      return 2;
+    }
+  }
+  const std::vector<double> vals = makeValues(n + 1);
+  const Block b;
+
+  // zgodność bajt w bajt
+  size_t bad = 0;
+  {
+    RecordFmt::Line line;
+    line.field(b.IMEI);
+    line.mark();
+    for (size_t i = 0; i < n; ++i) {
+      const char* id = kIds[i % 8];
+      String o = oldRecord(b, id, vals[i], vals[i + 1]);
+      size_t len = 0;
+      const char* l = newRecord(line, b, id, vals[i], vals[i + 1], &len);
+      // rekordy dłuższe niż bufor (np. 1e300) – nowa ścieżka odrzuca, stara pisała
+      if (!l) { if (o.length() + 1 <= RecordFmt::Line::kCap) ++bad; continue; }
+      if (len != o.length() || memcmp(l, o.c_str(), len) != 0) {
+        if (bad++ < 5) std::fprintf(stderr, "różnica: '%s' vs '%.*s'\n", o.c_str(), (int)len, l);
+      }
+    }
+  }
+
+  // przepustowość i alokacje
+  volatile size_t sink = 0;
+  uint64_t a0 = gAllocs.load();
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i) sink = sink + oldRecord(b, kIds[i % 8], vals[i], vals[i + 1]).length();
+  auto t1 = std::chrono::steady_clock::now();
+  uint64_t a1 = gAllocs.load();
+
+  RecordFmt::Line line;
+  line.field(b.IMEI);
+  line.mark();
+  uint64_t a2 = gAllocs.load();
+  auto t2 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i) {
+    size_t len = 0;
+    newRecord(line, b, kIds[i % 8], vals[i], vals[i + 1], &len);
+    sink = sink + len;
+  }
+  auto t3 = std::chrono::steady_clock::now();
+  uint64_t a3 = gAllocs.load();
+
+  auto sec = [](std::chrono::steady_clock::time_point x, std::chrono::steady_clock::time_point y) {
+    return std::chrono::duration<double>(y - x).count();
+  };
+  const double oldRps = n / sec(t0, t1), newRps = n / sec(t2, t3);
+  std::printf("records=%zu\n", n);
+  std::printf("String+crcBase : %10.0f rec/s  %6.2f alloc/rec\n", oldRps, (double)(a1 - a0) / n);
+  std::printf("RecordFmt::Line: %10.0f rec/s  %6.2f alloc/rec  x%.1f\n", newRps,
+              (double)(a3 - a2) / n, newRps / oldRps);
+  std::printf("byte-identical : %s (%zu mismatches)\n", bad ? "NO" : "yes", bad);
+  return bad ? 1 : 0;
+}
@@ -0,0 +1,180 @@
+// series_bench.cpp – zapis bloków pomiarów jako CSV (RecordFmt, dzisiejszy
+// D_<MAC>.txt) kontra ramki BinSeries (D_<MAC>.bin, tryb data_bin).
+// Dla kilku modeli sygnału liczy bajty na blok, współczynnik kompresji,
+// czas kodowania/dekodowania i sprawdza, że dekoder odtwarza CSV bajt w bajt.
+//
+// esp_sim_series_bench [--blocks N] [--channels N]
+#include <Arduino.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bin_series.h"
+#include "record_fmt.h"
+
+namespace {
+
+const char kImei[]    = "A1B2C3D4E5F6";
+const char kOutputs[] = "0000";
+const double kLsb     = 2.048 / 131072.0;   // MCP3424 18 bit, PGA 1
+
+const BinSeries::Row kExtras[] = {
+  { "AKU",  "1071", "6.9912345" },
+  { "B001", "1",    "1.0" },
+  { "UAZS", "1",    "1.0" },
+};
+
+enum Model { NOISY, SLOW, MIXED };
+const char* kModelName[] = { "szum", "wolny", "mieszany" };
+
+struct Block {
+  uint32_t   sec;
+  uint8_t    xyz, gsm;
+  adc_real_t raw[ADC_MAX_CHANNELS], calc[ADC_MAX_CHANNELS];
+};
+
+// średnia z 8 próbek 18-bit (jak filtr AdcTask) i kalibracja A*x+B w adc_real_t
+adc_real_t sampleMean(std::mt19937& rng, double v, double noise) {
+  std::normal_distribution<double> nd(0.0, noise);
+  long sum = 0;
+  for (int k = 0; k < 8; ++k) sum += std::lround((v + nd(rng)) / kLsb);
+  return (adc_real_t)(sum * kLsb / 8.0);
+}
+
+std::vector<Block> makeBlocks(Model m, int nBlocks, int nCh) {
+  std::mt19937 rng(12345);
+  std::vector<Block> out(nBlocks);
+  for (int b = 0; b < nBlocks; ++b) {
+    Block& x = out[b];
+    x.sec = 20742u * 86400u + 12u * 3600u + (uint32_t)b * 600u;   // 2026-10-16 12:00, co 600 s
+    x.xyz = (uint8_t)(rng() % 101);
+    x.gsm = (uint8_t)(60 + (b / 50) % 5);
+    for (int c = 0; c < nCh; ++c) {
+      const double base = 0.2 + 0.15 * c;
+      const double day  = 0.05 * std::sin(2 * M_PI * b / 144.0 + c);
+      double v = base, noise = 0;
+      if (m == NOISY || (m == MIXED && c < nCh / 2)) { v += day; noise = 40 * kLsb; }
+      else if (m == SLOW || m == MIXED)              { v += day * 0.01; noise = 0.2 * kLsb; }
+      if (m == MIXED && c == nCh - 1) v = 0;         // kanał niepodłączony
+      x.raw[c]  = sampleMean(rng, v, noise);
+      x.calc[c] = (adc_real_t)25 * x.raw[c] + (adc_real_t)-5;
+    }
+  }
+  return out;
+}
+
+void csvBlock(const Block& x, int nCh, const char* const* ids, std::string& out) {
+  char stamp[24], xyz[4], gsm[4];
+  const size_t sl = BinSeries::formatStamp(x.sec, stamp, sizeof(stamp));
+  snprintf(xyz, sizeof(xyz), "%03u", (unsigned)x.xyz);
+  snprintf(gsm, sizeof(gsm), "%u", (unsigned)x.gsm);
+  RecordFmt::Line line;
+  line.field(kImei);
+  line.mark();
+  auto rec = [&](const char* id, const char* raw, const char* calc, int c) {
+    line.rewind();
+    line.field(id).field(stamp, sl).field(xyz, 3);
+    if (raw) line.field(raw).field(calc);
+    else     line.fixed6(x.raw[c]).fixed6(x.calc[c]);
+    line.field(gsm).field(kOutputs);
+    size_t n = 0;
+    const char* l = line.finish(&n);
+    out.append(l, n);
+  };
+  auto extras = [&]() { for (const BinSeries::Row& r : kExtras) rec(r.id, r.raw, r.calc, 0); };
+  for (int c = 0; c < nCh; ++c) {
+    if (c == 4) extras();
+    rec(ids[c], nullptr, nullptr, c);
+  }
+  if (nCh <= 4) extras();
+}
+
+void appendLine(void* ctx, const char* l, size_t n) { ((std::string*)ctx)->append(l, n); }
+
+double secsSince(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  int nBlocks = 144 * 30;   // 30 dni co 600 s
+  int nCh     = 8;
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--blocks") && i + 1 < argc)        nBlocks = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--channels") && i + 1 < argc) nCh = atoi(argv[++i]);
+    else {
+      std::fprintf(stderr, "usage: %s [--blocks N] [--channels N]\n", argv[0]);
+      return 2;
+    }
+  }
+  if (nCh < 1) nCh = 1;
+  if (nCh > ADC_MAX_CHANNELS) nCh = ADC_MAX_CHANNELS;
+
+  static char idBuf[ADC_MAX_CHANNELS][8];
+  const char* ids[ADC_MAX_CHANNELS];
+  for (int c = 0; c < nCh; ++c) { snprintf(idBuf[c], 8, "A%03d", c + 1); ids[c] = idBuf[c]; }
+
+  std::printf("blocks=%d channels=%d adc_real_t=%s\n", nBlocks, nCh,
+              sizeof(adc_real_t) == 8 ? "double" : "float");
+  std::printf("%-9s %9s %9s %6s %9s %9s %9s  %s\n",
+              "model", "CSV B/blk", "bin B/blk", "ratio", "csv us", "enc us", "dec MB/s", "identical");
+
+  bool allOk = true;
+  for (Model m : { NOISY, SLOW, MIXED }) {
+    const std::vector<Block> blocks = makeBlocks(m, nBlocks, nCh);
+
+    std::string csv;
+    csv.reserve((size_t)nBlocks * 1024);
+    auto t0 = std::chrono::steady_clock::now();
+    for (const Block& x : blocks) csvBlock(x, nCh, ids, csv);
+    const double tCsv = secsSince(t0);
+
+    // kodowanie – układ wierszy jak w Measure::appendBinFrame()
+    BinSeries::Row rows[BinSeries::kMaxRows];
+    int nr = 0;
+    for (int c = 0; c < nCh; ++c) {
+      if (c == 4) for (const BinSeries::Row& r : kExtras) rows[nr++] = r;
+      rows[nr++] = { ids[c], nullptr, nullptr };
+    }
+    if (nCh <= 4) for (const BinSeries::Row& r : kExtras) rows[nr++] = r;
+
+    std::vector<uint8_t> bin;
+    bin.reserve((size_t)nBlocks * 128);
+    BinSeries::Encoder enc;
+    uint8_t frame[BinSeries::kMaxFrame];
+    t0 = std::chrono::steady_clock::now();
+    for (const Block& x : blocks) {
+      BinSeries::Sample s = { x.sec, x.xyz, x.gsm, kImei, kOutputs, rows, nr, x.raw, x.calc };
+      const size_t n = enc.encode(s, frame, sizeof(frame));
+      if (!n) { std::fprintf(stderr, "encode failed\n"); return 1; }
+      bin.insert(bin.end(), frame, frame + n);
+    }
+    const double tEnc = secsSince(t0);
+
+    // dekodowanie kawałkami jak z pliku (512 B)
+    std::string back;
+    back.reserve(csv.size());
+    BinSeries::Decoder dec(appendLine, &back);
+    t0 = std::chrono::steady_clock::now();
+    for (size_t off = 0; off < bin.size(); off += 512) {
+      dec.feed(bin.data() + off, std::min<size_t>(512, bin.size() - off));
+    }
+    dec.finish();
+    const double tDec = secsSince(t0);
+
+    const bool ok = back == csv && dec.stats().badFrames == 0 && dec.stats().dropped == 0;
+    allOk = allOk && ok;
+    std::printf("%-9s %9.1f %9.1f %5.1fx %9.2f %9.2f %9.1f  %s\n", kModelName[m],
+                (double)csv.size() / nBlocks, (double)bin.size() / nBlocks,
+                (double)csv.size() / bin.size(), tCsv * 1e6 / nBlocks, tEnc * 1e6 / nBlocks,
+                csv.size() / tDec / 1e6, ok ? "yes" : "NO");
+  }
+  return allOk ? 0 : 1;
+}
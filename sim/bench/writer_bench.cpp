@@ -0,0 +1,80 @@
+// writer_bench.cpp – dopisywanie linii do pliku na LittleFS symulatora:
+// dawne open→append→close na każdą linię kontra FileWriter (Batch i Sync).
+// Podaje linie/s na hoście oraz commity i kasowania bloków 4 kB wg modelu
+// zużycia flash z fs_littlefs.cpp (Sim::stats().fsCommits/fsErases).
+//
+// esp_sim_writer_bench [--lines N] [--dir KATALOG]
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "file_writer.h"
+#include "sim.h"
+
+namespace {
+
+// rekord D_<MAC>.txt (73 B)
+const char kLine[] =
+    "246F285A3C01;A001;26:10:16:12:00:00;042;0.125004;0.125004;79;0000;c9d8;\r\n";
+const size_t kLineLen = sizeof(kLine) - 1;
+
+void openAppendClose(const char* path) {
+  File f = LittleFS.open(path, "a");
+  if (!f) f = LittleFS.open(path, "w");
+  if (f) { f.write((const uint8_t*)kLine, kLineLen); f.close(); }
+}
+
+template <typename F>
+void run(const char* name, const char* path, size_t n, F&& appendOne) {
+  LittleFS.remove(path);
+  const Sim::Stats s0 = Sim::stats();
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < n; ++i) appendOne(path);
+  FileWriter::release(path);
+  auto t1 = std::chrono::steady_clock::now();
+  const Sim::Stats& s1 = Sim::stats();
+  const double sec = std::chrono::duration<double>(t1 - t0).count();
+  const size_t size = FileWriter::size(path);
+  std::printf("%-18s %10.0f lines/s  %7.3f commits/line  %8.1f erases/1000 lines  %s\n", name,
+              n / sec, (double)(s1.fsCommits - s0.fsCommits) / n,
+              1000.0 * (double)(s1.fsErases - s0.fsErases) / n,
+              size == n * kLineLen ? "size ok" : "SIZE MISMATCH");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t n = 20000;
+  std::string dir = "esp_sim_writer_bench_fs";
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--lines") && i + 1 < argc) n = (size_t)strtoul(argv[++i], nullptr, 0);
+    else if (!strcmp(argv[i], "--dir") && i + 1 < argc) dir = argv[++i];
+    else {
+      std::fprintf(stderr, "usage: %s [--lines N] [--dir KATALOG]\n", argv[0]);
+      return 2;
+    }
+  }
+  Sim::opts().fsRoot = dir;
+  if (!LittleFS.begin(true)) {
+    std::fprintf(stderr, "writer_bench: LittleFS.begin(%s) failed\n", dir.c_str());
+    return 1;
+  }
+  FileWriter::begin();
+
+  std::printf("lines=%zu (%zu B each)\n", n, kLineLen);
+  run("open/append/close", "/bench_a.txt", n, openAppendClose);
+  run("FileWriter Batch", "/bench_b.txt", n, [](const char* p) {
+    FileWriter::append(p, kLine, kLineLen, FileWriter::Batch);
+  });
+  run("FileWriter Sync", "/bench_c.txt", n, [](const char* p) {
+    FileWriter::append(p, kLine, kLineLen, FileWriter::Sync);
+  });
+  LittleFS.remove("/bench_a.txt");
+  LittleFS.remove("/bench_b.txt");
+  LittleFS.remove("/bench_c.txt");
+  return 0;
+}
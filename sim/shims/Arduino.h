@@ -0,0 +1,85 @@
+// Arduino.h – hostowy (Linux) odpowiednik rdzenia Arduino-ESP32 dla esp_sim.
+// Czas (millis/micros/delay) i GPIO idą przez warstwę Sim (sim/src/sim.h).
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctype.h>
+#include <time.h>
+
+#include "WString.h"
+#include "Print.h"
+#include "Stream.h"
+#include "IPAddress.h"
+#include "HardwareSerial.h"
+#include "Esp.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+using std::isinf;
+using std::isnan;
+using std::max;
+using std::min;
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+// --- "wersja" IDF / FreeRTOS widziana przez szkic
+#define ESP_IDF_VERSION_MAJOR 5
+#define portNUM_PROCESSORS 2
+
+// --- GPIO
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define PULLUP 0x04
+#define INPUT_PULLUP 0x05
+#define PULLDOWN 0x08
+#define INPUT_PULLDOWN 0x09
+#define OPEN_DRAIN 0x10
+#define OUTPUT_OPEN_DRAIN 0x13
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// --- czas
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// --- losowość
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+uint32_t esp_random();
+
+// --- pamięć
+bool psramFound();
+void* ps_malloc(size_t size);
+
+// --- SNTP (na hoście zegar systemowy jest już zsynchronizowany)
+void configTime(long gmtOffset_sec, int daylightOffset_sec, const char* server1,
+                const char* server2 = nullptr, const char* server3 = nullptr);
+
+// --- narzędzia znakowe / liczbowe
+inline bool isDigit(int c) { return isdigit(c) != 0; }
+inline bool isAlpha(int c) { return isalpha(c) != 0; }
+inline bool isAlphaNumeric(int c) { return isalnum(c) != 0; }
+inline bool isSpace(int c) { return isspace(c) != 0; }
+inline bool isHexadecimalDigit(int c) { return isxdigit(c) != 0; }
+char* dtostrf(double val, signed char width, unsigned char prec, char* sout);
+
+// szkic wywołuje setup()/loop() – main() jest w sim/src/sim_main.cpp
+void setup();
+void loop();
@@ -0,0 +1,308 @@
+#pragma once
+// ArduinoJson – hostowy podzbiór API v6/v7 używany przez szkic: JsonDocument
+// (także Static/DynamicJsonDocument), JsonVariant/JsonObject/JsonArray,
+// deserializeJson / serializeJson(Pretty). Drzewo węzłów na stercie, bez
+// limitu pojemności dokumentu.
+#include <climits>
+#include <limits>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Arduino.h"
+
+namespace ajson {
+
+struct Node {
+  enum Type : uint8_t { Null, Bool, Int, UInt, Float, Str, Obj, Arr };
+  Type t = Null;
+  bool b = false;
+  int64_t i = 0;
+  uint64_t u = 0;
+  double d = 0;
+  std::string s;
+  std::vector<std::pair<std::string, std::unique_ptr<Node>>> obj;
+  std::vector<std::unique_ptr<Node>> arr;
+
+  void reset() { t = Null; b = false; i = 0; u = 0; d = 0; s.clear(); obj.clear(); arr.clear(); }
+  Node* find(const std::string& k) const {
+    if (t != Obj) return nullptr;
+    for (auto& kv : obj) if (kv.first == k) return kv.second.get();
+    return nullptr;
+  }
+  Node* getOrAdd(const std::string& k) {
+    if (t == Null) t = Obj;
+    if (t != Obj) return nullptr;
+    if (Node* n = find(k)) return n;
+    obj.emplace_back(k, std::unique_ptr<Node>(new Node()));
+    return obj.back().second.get();
+  }
+  Node* addElement() {
+    if (t == Null) t = Arr;
+    if (t != Arr) return nullptr;
+    arr.emplace_back(new Node());
+    return arr.back().get();
+  }
+};
+
+template <typename T>
+void assign(Node& n, const T& v) {
+  n.reset();
+  if constexpr (std::is_same<T, bool>::value) { n.t = Node::Bool; n.b = v; }
+  else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) { n.t = Node::Int; n.i = v; }
+  else if constexpr (std::is_integral<T>::value) { n.t = Node::UInt; n.u = v; }
+  else if constexpr (std::is_floating_point<T>::value) { n.t = Node::Float; n.d = v; }
+  else if constexpr (std::is_same<T, String>::value) { n.t = Node::Str; n.s = v.str(); }
+  else if constexpr (std::is_same<T, std::string>::value) { n.t = Node::Str; n.s = v; }
+  else if constexpr (std::is_convertible<const T&, const char*>::value) {
+    const char* p = v;
+    if (p) { n.t = Node::Str; n.s = p; }
+  } else static_assert(sizeof(T) == 0, "ArduinoJson shim: unsupported type");
+}
+
+std::string serialize(const Node& n, bool pretty);
+
+}  // namespace ajson
+
+class JsonObject;
+class JsonArray;
+
+class JsonVariant {
+ public:
+  JsonVariant() = default;
+  explicit JsonVariant(ajson::Node* node) : node_(node) {}
+  JsonVariant(ajson::Node* parent, std::string key)
+      : parent_(parent), key_(std::move(key)), node_(parent ? parent->find(key_) : nullptr) {}
+
+  bool isNull() const { return !node_ || node_->t == ajson::Node::Null; }
+  template <typename T> bool is() const;
+  template <typename T> T as() const;
+  operator String() const { return as<String>(); }
+
+  template <typename T>
+  auto operator|(const T& def) const -> typename std::enable_if<!std::is_array<T>::value, T>::type {
+    return is<T>() ? as<T>() : def;
+  }
+  const char* operator|(const char* def) const { return is<const char*>() ? as<const char*>() : def; }
+
+  template <typename T>
+  JsonVariant& operator=(const T& v) {
+    if (ajson::Node* n = ensure()) ajson::assign(*n, v);
+    return *this;
+  }
+  JsonVariant& operator=(const JsonVariant&) = default;
+
+  // zapis przez łańcuch doc["a"]["b"] tworzy obiekt "a" (także przy odczycie)
+  JsonVariant operator[](const char* key) {
+    ajson::Node* n = ensure();
+    if (n && n->t == ajson::Node::Null) n->t = ajson::Node::Obj;
+    return JsonVariant(n && n->t == ajson::Node::Obj ? n : nullptr, key);
+  }
+  JsonVariant operator[](const String& key) { return (*this)[key.c_str()]; }
+  JsonVariant operator[](size_t idx) const {
+    if (!node_ || node_->t != ajson::Node::Arr || idx >= node_->arr.size()) return JsonVariant();
+    return JsonVariant(node_->arr[idx].get());
+  }
+  JsonVariant operator[](int idx) const { return (*this)[(size_t)(idx < 0 ? SIZE_MAX : idx)]; }
+
+  bool containsKey(const char* key) const { return node_ && node_->find(key); }
+  bool containsKey(const String& key) const { return containsKey(key.c_str()); }
+  size_t size() const;
+
+  template <typename T> T to();
+
+  ajson::Node* node() const { return node_; }
+
+ private:
+  ajson::Node* ensure() {
+    if (!node_ && parent_) node_ = parent_->getOrAdd(key_);
+    return node_;
+  }
+
+  ajson::Node* parent_ = nullptr;
+  std::string key_;
+  ajson::Node* node_ = nullptr;
+};
+
+class JsonObject {
+ public:
+  JsonObject() = default;
+  explicit JsonObject(ajson::Node* n) : node_(n && n->t == ajson::Node::Obj ? n : nullptr) {}
+  JsonObject(const JsonVariant& v) : JsonObject(v.node()) {}
+
+  bool isNull() const { return !node_; }
+  JsonVariant operator[](const char* key) const { return JsonVariant(node_, key); }
+  JsonVariant operator[](const String& key) const { return JsonVariant(node_, key.c_str()); }
+  bool containsKey(const char* key) const { return node_ && node_->find(key); }
+  size_t size() const { return node_ ? node_->obj.size() : 0; }
+  JsonObject createNestedObject(const char* key) const { return JsonVariant(node_, key).to<JsonObject>(); }
+  ajson::Node* node() const { return node_; }
+
+ private:
+  ajson::Node* node_ = nullptr;
+};
+
+class JsonArray {
+ public:
+  JsonArray() = default;
+  explicit JsonArray(ajson::Node* n) : node_(n && n->t == ajson::Node::Arr ? n : nullptr) {}
+  JsonArray(const JsonVariant& v) : JsonArray(v.node()) {}
+
+  bool isNull() const { return !node_; }
+  size_t size() const { return node_ ? node_->arr.size() : 0; }
+  JsonVariant operator[](size_t i) const { return node_ && i < node_->arr.size() ? JsonVariant(node_->arr[i].get()) : JsonVariant(); }
+  template <typename T>
+  bool add(const T& v) {
+    ajson::Node* n = node_ ? node_->addElement() : nullptr;
+    if (!n) return false;
+    ajson::assign(*n, v);
+    return true;
+  }
+  JsonObject createNestedObject() const {
+    ajson::Node* n = node_ ? node_->addElement() : nullptr;
+    if (!n) return JsonObject();
+    n->t = ajson::Node::Obj;
+    return JsonObject(n);
+  }
+  ajson::Node* node() const { return node_; }
+
+ private:
+  ajson::Node* node_ = nullptr;
+};
+
+template <typename T>
+bool JsonVariant::is() const {
+  using N = ajson::Node;
+  const N* n = node_;
+  if (!n) return false;
+  if constexpr (std::is_same<T, bool>::value) return n->t == N::Bool;
+  else if constexpr (std::is_integral<T>::value) {
+    if (n->t == N::Int) return n->i >= (int64_t)std::numeric_limits<T>::min() &&
+                               (n->i < 0 || (uint64_t)n->i <= (uint64_t)std::numeric_limits<T>::max());
+    if (n->t == N::UInt) return n->u <= (uint64_t)std::numeric_limits<T>::max();
+    return false;
+  } else if constexpr (std::is_floating_point<T>::value) return n->t == N::Int || n->t == N::UInt || n->t == N::Float;
+  else if constexpr (std::is_same<T, const char*>::value || std::is_same<T, String>::value) return n->t == N::Str;
+  else if constexpr (std::is_same<T, JsonObject>::value) return n->t == N::Obj;
+  else if constexpr (std::is_same<T, JsonArray>::value) return n->t == N::Arr;
+  else static_assert(sizeof(T) == 0, "ArduinoJson shim: unsupported is<T>");
+}
+
+template <typename T>
+T JsonVariant::as() const {
+  using N = ajson::Node;
+  const N* n = node_;
+  if constexpr (std::is_same<T, bool>::value) {
+    if (!n) return false;
+    switch (n->t) {
+      case N::Bool: return n->b;
+      case N::Int: return n->i != 0;
+      case N::UInt: return n->u != 0;
+      case N::Float: return n->d != 0;
+      default: return false;
+    }
+  } else if constexpr (std::is_arithmetic<T>::value) {
+    if (!n) return T(0);
+    switch (n->t) {
+      case N::Bool: return (T)n->b;
+      case N::Int: return (T)n->i;
+      case N::UInt: return (T)n->u;
+      case N::Float: return (T)n->d;
+      default: return T(0);
+    }
+  } else if constexpr (std::is_same<T, const char*>::value) {
+    return n && n->t == N::Str ? n->s.c_str() : nullptr;
+  } else if constexpr (std::is_same<T, String>::value) {
+    if (!n || n->t == N::Null) return String();
+    if (n->t == N::Str) return String(n->s);
+    return String(ajson::serialize(*n, false));
+  } else if constexpr (std::is_same<T, JsonObject>::value) return JsonObject(const_cast<N*>(n));
+  else if constexpr (std::is_same<T, JsonArray>::value) return JsonArray(const_cast<N*>(n));
+  else if constexpr (std::is_same<T, JsonVariant>::value) return *this;
+  else static_assert(sizeof(T) == 0, "ArduinoJson shim: unsupported as<T>");
+}
+
+template <typename T>
+T JsonVariant::to() {
+  ajson::Node* n = ensure();
+  if (!n) return T();
+  n->reset();
+  if constexpr (std::is_same<T, JsonObject>::value) { n->t = ajson::Node::Obj; return JsonObject(n); }
+  else if constexpr (std::is_same<T, JsonArray>::value) { n->t = ajson::Node::Arr; return JsonArray(n); }
+  else static_assert(sizeof(T) == 0, "ArduinoJson shim: unsupported to<T>");
+}
+
+inline size_t JsonVariant::size() const {
+  if (!node_) return 0;
+  if (node_->t == ajson::Node::Obj) return node_->obj.size();
+  if (node_->t == ajson::Node::Arr) return node_->arr.size();
+  return 0;
+}
+
+class JsonDocument {
+ public:
+  JsonDocument() = default;
+  explicit JsonDocument(size_t capacity) { (void)capacity; }
+  JsonDocument(JsonDocument&&) = default;
+  JsonDocument& operator=(JsonDocument&&) = default;
+
+  JsonVariant operator[](const char* key) { return JsonVariant(&root_, key); }
+  JsonVariant operator[](const String& key) { return JsonVariant(&root_, key.c_str()); }
+  JsonVariant operator[](size_t idx) { return JsonVariant(&root_).operator[](idx); }
+  bool containsKey(const char* key) const { return root_.find(key) != nullptr; }
+  bool containsKey(const String& key) const { return containsKey(key.c_str()); }
+  JsonObject createNestedObject(const char* key) { return JsonVariant(&root_, key).to<JsonObject>(); }
+  JsonObject createNestedObject(const String& key) { return createNestedObject(key.c_str()); }
+  JsonArray createNestedArray(const char* key) { return JsonVariant(&root_, key).to<JsonArray>(); }
+
+  template <typename T> T to() { return JsonVariant(&root_).to<T>(); }
+  template <typename T> T as() { return JsonVariant(&root_).as<T>(); }
+  template <typename T> bool is() { return JsonVariant(&root_).is<T>(); }
+  bool isNull() const { return root_.t == ajson::Node::Null; }
+  size_t size() const { return JsonVariant(const_cast<ajson::Node*>(&root_)).size(); }
+  void clear() { root_.reset(); }
+  bool overflowed() const { return false; }
+
+  ajson::Node& root() { return root_; }
+  const ajson::Node& root() const { return root_; }
+
+ private:
+  ajson::Node root_;
+};
+
+template <size_t N>
+class StaticJsonDocument : public JsonDocument {};
+
+class DynamicJsonDocument : public JsonDocument {
+ public:
+  explicit DynamicJsonDocument(size_t capacity) : JsonDocument(capacity) {}
+};
+
+class DeserializationError {
+ public:
+  enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput, NoMemory, TooDeep };
+  DeserializationError(Code c = Ok) : code_(c) {}
+  explicit operator bool() const { return code_ != Ok; }
+  Code code() const { return code_; }
+  const char* c_str() const;
+  friend bool operator==(const DeserializationError& e, Code c) { return e.code_ == c; }
+  friend bool operator!=(const DeserializationError& e, Code c) { return e.code_ != c; }
+
+ private:
+  Code code_;
+};
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t len);
+inline DeserializationError deserializeJson(JsonDocument& doc, const char* input) {
+  return deserializeJson(doc, input, input ? strlen(input) : 0);
+}
+inline DeserializationError deserializeJson(JsonDocument& doc, const String& input) {
+  return deserializeJson(doc, input.c_str(), input.length());
+}
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input);
+
+size_t serializeJson(const JsonDocument& doc, Print& out);
+size_t serializeJson(const JsonDocument& doc, String& out);
+size_t serializeJsonPretty(const JsonDocument& doc, Print& out);
+size_t serializeJsonPretty(const JsonDocument& doc, String& out);
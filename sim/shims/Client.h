@@ -0,0 +1,21 @@
+#pragma once
+#include "Stream.h"
+#include "IPAddress.h"
+
+// Client – wspólna baza WiFiClient / TinyGsmClient (jak w Arduino core).
+class Client : public Stream {
+ public:
+  virtual int connect(IPAddress ip, uint16_t port) = 0;
+  virtual int connect(const char* host, uint16_t port) = 0;
+  size_t write(uint8_t b) override = 0;
+  size_t write(const uint8_t* buf, size_t n) override = 0;
+  using Print::write;
+  int available() override = 0;
+  int read() override = 0;
+  int read(uint8_t* buf, size_t n) override = 0;
+  int peek() override = 0;
+  void flush() override = 0;
+  virtual void stop() = 0;
+  virtual uint8_t connected() = 0;
+  virtual operator bool() = 0;
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+
+// ESP – parametry płytki ESP32-S3 N16R8 (16 MB flash, 8 MB PSRAM OPI).
+class EspClass {
+ public:
+  uint32_t getFlashChipSize() const { return 16UL * 1024UL * 1024UL; }
+  uint32_t getPsramSize() const { return 8UL * 1024UL * 1024UL; }
+  uint32_t getFreePsram() const;
+  uint32_t getFreeHeap() const;
+  uint32_t getHeapSize() const { return 320UL * 1024UL; }
+  const char* getChipModel() const { return "ESP32-S3 (esp_sim)"; }
+  uint32_t getCpuFreqMHz() const { return 240; }
+  // licznik cykli CCOUNT: na hoście czas monotoniczny przeliczony na 240 MHz
+  uint32_t getCycleCount() const;
+  [[noreturn]] void restart();
+};
+
+extern EspClass ESP;
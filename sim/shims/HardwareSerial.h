@@ -0,0 +1,24 @@
+#pragma once
+#include "Stream.h"
+
+#define SERIAL_8N1 0x800001c
+
+// UART 0 -> stdout hosta; pozostałe UART-y (np. modem AT) są "niepodłączone".
+class HardwareSerial : public Stream {
+ public:
+  explicit HardwareSerial(int uart) : uart_(uart) {}
+  void begin(unsigned long baud, uint32_t config = SERIAL_8N1, int8_t rxPin = -1, int8_t txPin = -1);
+  void end() {}
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  operator bool() const { return true; }
+
+ private:
+  int uart_;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,17 @@
+#pragma once
+#include <cstdint>
+#include "WString.h"
+
+class IPAddress {
+ public:
+  IPAddress() : a_{0, 0, 0, 0} {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : a_{a, b, c, d} {}
+  explicit IPAddress(uint32_t v) { for (int i = 0; i < 4; ++i) a_[i] = (uint8_t)(v >> (8 * i)); }
+  operator uint32_t() const { return (uint32_t)a_[0] | (uint32_t)a_[1] << 8 | (uint32_t)a_[2] << 16 | (uint32_t)a_[3] << 24; }
+  uint8_t operator[](int i) const { return a_[i & 3]; }
+  bool fromString(const char* s);
+  String toString() const;
+
+ private:
+  uint8_t a_[4];
+};
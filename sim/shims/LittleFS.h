@@ -0,0 +1,20 @@
+#pragma once
+#include "FS.h"
+
+namespace fs {
+
+// LittleFS na katalogu hosta (Sim::opts().fsRoot). Rozmiar partycji jak w
+// partitions.csv (spiffs 0xBF0000); zapisy ponad pojemność są obcinane.
+class LittleFSFS : public FS {
+ public:
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+  bool format();
+  size_t totalBytes();
+  size_t usedBytes();
+  void end() {}
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
@@ -0,0 +1,51 @@
+#pragma once
+#include "Arduino.h"
+#include "Wire.h"
+
+// MCP3424 – model układu dla esp_sim: 4 kanały z jednym przetwornikiem,
+// konwersja one-shot trwa wg rozdzielczości (240/60/15/3.75 SPS), odczyt
+// kosztuje transakcję I2C. Sygnał wejściowy dostarcza Sim::adcSignal().
+
+enum Channel { CH1 = 0, CH2 = 1, CH3 = 2, CH4 = 3 };
+enum Gain { GAINx1 = 0, GAINx2 = 1, GAINx4 = 2, GAINx8 = 3 };
+enum Resolution { R12B = 0, R14B = 1, R16B = 2, R18B = 3 };
+enum ConvMode { ONE_SHOT = 0, CONTINUOUS = 1 };
+enum GeneralCall { GC_LATCH = 0x04, GC_RESET = 0x06, GC_CONVERSION = 0x08 };
+enum ConvStatus { R_STATUS_OK = 0, R_STATUS_NOTRDY = 1, R_STATUS_I2C = 2, R_STATUS_ERROR = 3 };
+
+union _ConfReg {
+  struct {
+    Gain pga : 2;
+    Resolution res : 2;
+    ConvMode conv : 1;
+    Channel ch : 2;
+    uint8_t rdy : 1;
+  } bits;
+  uint8_t reg;
+};
+
+class MCP3424 {
+ public:
+  explicit MCP3424(uint8_t address);
+
+  _ConfReg creg[4];
+
+  // Zapisuje konfigurację kanału (start konwersji one-shot) gdy trzeba,
+  // potem polluje bit RDY. Nie blokuje: zwraca R_STATUS_NOTRDY do czasu końca konwersji.
+  ConvStatus read(Channel ch, double& value);
+  // Wymusza start nowej konwersji wg creg[ch] (zapis rejestru konfiguracji).
+  ConvStatus startNewConversion(Channel ch);
+  // Dobiera wzmocnienie dla napięcia zmierzonego przy GAINx1.
+  Gain findGain(double value) const;
+  void generalCall(GeneralCall call);
+  uint8_t address() const { return addr_; }
+
+  // czas konwersji [us] dla rozdzielczości
+  static uint32_t conversionUs(Resolution r);
+
+ private:
+  uint8_t addr_;
+  bool busy_ = false;        // konwersja w toku
+  uint8_t activeReg_ = 0;    // konfiguracja trwającej/ostatniej konwersji
+  uint64_t startUs_ = 0;     // start konwersji (zegar Sim)
+};
@@ -0,0 +1,48 @@
+#pragma once
+#include "Arduino.h"
+#include "Client.h"
+
+// PubSubClient – minimalny klient MQTT 3.1.1 (CONNECT/PUBLISH QoS0/PINGREQ),
+// wystarczający dla mqtt_client.cpp i stand-ina brokera.
+
+#define MQTT_CONNECTION_TIMEOUT -4
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+class PubSubClient {
+ public:
+  PubSubClient() = default;
+  explicit PubSubClient(Client& c) : client_(&c) {}
+
+  PubSubClient& setServer(const char* host, uint16_t port) { host_ = host ? host : ""; port_ = port; return *this; }
+  PubSubClient& setClient(Client& c) { client_ = &c; return *this; }
+  PubSubClient& setKeepAlive(uint16_t sec) { keepAliveSec_ = sec; return *this; }
+  PubSubClient& setSocketTimeout(uint16_t sec) { socketTimeoutSec_ = sec; return *this; }
+  bool setBufferSize(uint16_t size) { bufferSize_ = size; return true; }
+  uint16_t getBufferSize() const { return bufferSize_; }
+
+  bool connect(const char* id) { return connect(id, nullptr, nullptr); }
+  bool connect(const char* id, const char* user, const char* pass);
+  void disconnect();
+  bool connected();
+  bool loop();
+  bool publish(const char* topic, const char* payload, bool retained = false);
+  int state() const { return state_; }
+
+ private:
+  bool readPacket(uint8_t& type, String& body, uint32_t timeoutMs);
+  bool writePacket(uint8_t header, const String& body);
+
+  Client* client_ = nullptr;
+  String host_;
+  uint16_t port_ = 1883;
+  uint16_t keepAliveSec_ = 15;
+  uint16_t socketTimeoutSec_ = 15;
+  uint16_t bufferSize_ = 256;
+  int state_ = MQTT_DISCONNECTED;
+  unsigned long lastOutMs_ = 0;
+  unsigned long lastInMs_ = 0;
+  bool pingOutstanding_ = false;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "Print.h"
+
+// Stream – odczyt z timeoutem (readStringUntil, readBytes) jak w Arduino core.
+class Stream : public Print {
+ public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+  virtual int read(uint8_t* buf, size_t n) {
+    size_t i = 0;
+    for (; i < n; ++i) { int c = read(); if (c < 0) break; buf[i] = (uint8_t)c; }
+    return (int)i;
+  }
+
+  void setTimeout(unsigned long ms) { timeout_ = ms; }
+  unsigned long getTimeout() const { return timeout_; }
+
+  size_t readBytes(char* buf, size_t n) { return readBytes((uint8_t*)buf, n); }
+  virtual size_t readBytes(uint8_t* buf, size_t n);
+  String readStringUntil(char terminator);
+  String readString();
+
+ protected:
+  int timedRead();
+  unsigned long timeout_ = 1000;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+// TinyGSM – na hoście "modem" A7670 to po prostu łącze hosta: sieć jest dostępna
+// gdy Sim::networkUp(), a TinyGsmClient to zwykłe gniazdo TCP.
+class TinyGsm {
+ public:
+  explicit TinyGsm(Stream& at) : at_(&at) {}
+  bool restart() { return true; }
+  bool init() { return true; }
+  bool simUnlock(const char* pin) { (void)pin; return true; }
+  bool waitForNetwork(uint32_t timeoutMs = 60000L);
+  bool isNetworkConnected();
+  bool gprsConnect(const char* apn, const char* user = nullptr, const char* pwd = nullptr);
+  bool gprsDisconnect() { gprs_ = false; return true; }
+  bool isGprsConnected();
+  int16_t getSignalQuality() { return 20; }
+
+ private:
+  Stream* at_;
+  bool gprs_ = false;
+};
+
+class TinyGsmClient : public WiFiClient {
+ public:
+  TinyGsmClient() = default;
+  explicit TinyGsmClient(TinyGsm& modem, uint8_t mux = 0) { (void)modem; (void)mux; }
+};
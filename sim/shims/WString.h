@@ -0,0 +1,136 @@
+// WString.h – hostowy odpowiednik Arduino String (ESP32 core) na std::string.
+// Zachowuje semantykę używaną w szkicu: konwersje liczbowe, indexOf/substring,
+// toInt/toFloat, trim, porównania i sklejanie operatorem '+'.
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+class String {
+ public:
+  String(const char* s = "") : s_(s ? s : "") {}
+  String(const char* s, size_t n) : s_(s ? s : "", s ? n : 0) {}
+  String(const std::string& s) : s_(s) {}
+  String(std::string&& s) : s_(std::move(s)) {}
+  String(const String&) = default;
+  String(String&&) noexcept = default;
+  String& operator=(const String&) = default;
+  String& operator=(String&&) noexcept = default;
+  String& operator=(const char* s) { s_ = s ? s : ""; return *this; }
+
+  explicit String(char c) : s_(1, c) {}
+  explicit String(unsigned char v, unsigned char base = 10) : s_(fmtU(v, base)) {}
+  explicit String(int v, unsigned char base = 10) : s_(fmtS(v, base)) {}
+  explicit String(unsigned int v, unsigned char base = 10) : s_(fmtU(v, base)) {}
+  explicit String(long v, unsigned char base = 10) : s_(fmtS(v, base)) {}
+  explicit String(unsigned long v, unsigned char base = 10) : s_(fmtU(v, base)) {}
+  explicit String(long long v, unsigned char base = 10) : s_(fmtS(v, base)) {}
+  explicit String(unsigned long long v, unsigned char base = 10) : s_(fmtU(v, base)) {}
+  explicit String(float v, unsigned char decimals = 2) : s_(fmtF(v, decimals)) {}
+  explicit String(double v, unsigned char decimals = 2) : s_(fmtF(v, decimals)) {}
+
+  // --- dostęp
+  const char* c_str() const { return s_.c_str(); }
+  unsigned int length() const { return (unsigned int)s_.size(); }
+  bool isEmpty() const { return s_.empty(); }
+  bool reserve(unsigned int n) { s_.reserve(n); return true; }
+  char charAt(unsigned int i) const { return i < s_.size() ? s_[i] : '\0'; }
+  void setCharAt(unsigned int i, char c) { if (i < s_.size()) s_[i] = c; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  char& operator[](unsigned int i) { static char dummy; if (i >= s_.size()) { dummy = 0; return dummy; } return s_[i]; }
+  const std::string& str() const { return s_; }
+  void toCharArray(char* buf, unsigned int n, unsigned int index = 0) const { getBytes((unsigned char*)buf, n, index); }
+  void getBytes(unsigned char* buf, unsigned int n, unsigned int index = 0) const;
+
+  // --- dopisywanie
+  bool concat(const String& o) { s_ += o.s_; return true; }
+  bool concat(const char* o) { if (o) s_ += o; return true; }
+  bool concat(const char* o, unsigned int n) { if (o) s_.append(o, n); return true; }
+  bool concat(char c) { s_ += c; return true; }
+  bool concat(unsigned char v) { s_ += fmtU(v, 10); return true; }
+  bool concat(int v) { s_ += fmtS(v, 10); return true; }
+  bool concat(unsigned int v) { s_ += fmtU(v, 10); return true; }
+  bool concat(long v) { s_ += fmtS(v, 10); return true; }
+  bool concat(unsigned long v) { s_ += fmtU(v, 10); return true; }
+  bool concat(long long v) { s_ += fmtS(v, 10); return true; }
+  bool concat(unsigned long long v) { s_ += fmtU(v, 10); return true; }
+  bool concat(float v) { s_ += fmtF(v, 2); return true; }
+  bool concat(double v) { s_ += fmtF(v, 2); return true; }
+  template <typename T>
+  String& operator+=(const T& v) { concat(v); return *this; }
+
+  // --- porównania
+  int compareTo(const String& o) const { return s_.compare(o.s_); }
+  bool equals(const String& o) const { return s_ == o.s_; }
+  bool equals(const char* o) const { return s_ == (o ? o : ""); }
+  bool equalsIgnoreCase(const String& o) const;
+  bool startsWith(const String& p) const { return s_.compare(0, p.s_.size(), p.s_) == 0 && s_.size() >= p.s_.size(); }
+  bool startsWith(const String& p, unsigned int off) const { return off <= s_.size() && s_.compare(off, p.s_.size(), p.s_) == 0 && s_.size() - off >= p.s_.size(); }
+  bool endsWith(const String& p) const { return s_.size() >= p.s_.size() && s_.compare(s_.size() - p.s_.size(), p.s_.size(), p.s_) == 0; }
+
+  // --- wyszukiwanie
+  int indexOf(char c, unsigned int from = 0) const { auto p = s_.find(c, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const String& t, unsigned int from = 0) const { auto p = s_.find(t.s_, from); return p == std::string::npos ? -1 : (int)p; }
+  int indexOf(const char* t, unsigned int from = 0) const { auto p = s_.find(t ? t : "", from); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c) const { auto p = s_.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(char c, unsigned int from) const;
+  int lastIndexOf(const String& t) const { auto p = s_.rfind(t.s_); return p == std::string::npos ? -1 : (int)p; }
+  int lastIndexOf(const String& t, unsigned int from) const;
+  String substring(unsigned int left) const { return left >= s_.size() ? String() : String(s_.substr(left)); }
+  String substring(unsigned int left, unsigned int right) const;
+
+  // --- modyfikacje
+  void replace(char a, char b) { for (auto& c : s_) if (c == a) c = b; }
+  void replace(const String& a, const String& b);
+  void remove(unsigned int index) { if (index < s_.size()) s_.erase(index); }
+  void remove(unsigned int index, unsigned int count) { if (index < s_.size()) s_.erase(index, count); }
+  void toLowerCase();
+  void toUpperCase();
+  void trim();
+  void clear() { s_.clear(); }
+
+  // --- konwersje
+  long toInt() const;
+  float toFloat() const { return (float)toDouble(); }
+  double toDouble() const;
+
+  static std::string fmtS(long long v, unsigned char base);
+  static std::string fmtU(unsigned long long v, unsigned char base);
+  static std::string fmtF(double v, unsigned char decimals);
+
+ private:
+  std::string s_;
+};
+
+// --- sklejanie (odpowiednik StringSumHelper)
+inline String operator+(String a, const String& b) { a.concat(b); return a; }
+inline String operator+(String a, const char* b) { a.concat(b); return a; }
+inline String operator+(String a, char b) { a.concat(b); return a; }
+inline String operator+(const char* a, const String& b) { String r(a); r.concat(b); return r; }
+inline String operator+(char a, const String& b) { String r(a); r.concat(b); return r; }
+template <typename T, typename = typename std::enable_if<std::is_arithmetic<T>::value &&
+                                                         !std::is_same<T, char>::value>::type>
+inline String operator+(String a, T v) { a.concat(v); return a; }
+
+inline bool operator==(const String& a, const String& b) { return a.equals(b); }
+inline bool operator==(const String& a, const char* b) { return a.equals(b); }
+inline bool operator==(const char* a, const String& b) { return b.equals(a); }
+inline bool operator!=(const String& a, const String& b) { return !a.equals(b); }
+inline bool operator!=(const String& a, const char* b) { return !a.equals(b); }
+inline bool operator!=(const char* a, const String& b) { return !b.equals(a); }
+inline bool operator<(const String& a, const String& b) { return a.compareTo(b) < 0; }
+inline bool operator>(const String& a, const String& b) { return a.compareTo(b) > 0; }
+inline bool operator<=(const String& a, const String& b) { return a.compareTo(b) <= 0; }
+inline bool operator>=(const String& a, const String& b) { return a.compareTo(b) >= 0; }
+
+// F("...") – na hoście nie ma PROGMEM
+class __FlashStringHelper;
+#define F(s) (s)
+#define PSTR(s) (s)
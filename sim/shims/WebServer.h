@@ -0,0 +1,87 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+#include "Arduino.h"
+#include "FS.h"
+#include "WiFiClient.h"
+
+// WebServer – minimalny serwer HTTP/1.1 na gniazdach hosta (API jak ESP32 WebServer).
+// Port 80 ze szkicu jest mapowany na Sim::opts().httpPort. Jedno żądanie na
+// połączenie (Connection: close), handleClient() nie blokuje gdy brak klientów.
+
+enum HTTPMethod { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH, HTTP_DELETE, HTTP_OPTIONS };
+
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+#define CONTENT_LENGTH_NOT_SET ((size_t)-2)
+
+class WebServer {
+ public:
+  typedef std::function<void(void)> THandlerFunction;
+
+  explicit WebServer(int port = 80);
+  ~WebServer();
+
+  void begin();
+  void stop();
+  void handleClient();
+
+  void on(const String& uri, THandlerFunction fn) { on(uri, HTTP_ANY, fn); }
+  void on(const String& uri, HTTPMethod method, THandlerFunction fn);
+  void onNotFound(THandlerFunction fn) { notFound_ = fn; }
+
+  String uri() const { return uri_; }
+  HTTPMethod method() const { return method_; }
+  String arg(const String& name) const;
+  String arg(int i) const;
+  String argName(int i) const;
+  int args() const { return (int)args_.size(); }
+  bool hasArg(const String& name) const;
+  String header(const String& name) const;
+  bool hasHeader(const String& name) const;
+
+  bool authenticate(const char* user, const char* pass);
+  void requestAuthentication();
+
+  void sendHeader(const String& name, const String& value, bool first = false);
+  void setContentLength(size_t len) { contentLength_ = len; }
+  void send(int code, const char* contentType = nullptr, const String& content = String());
+  void sendContent(const String& content) { sendContent(content.c_str(), content.length()); }
+  void sendContent(const char* content, size_t size);
+  size_t streamFile(File& file, const String& contentType, int code = 200);
+
+  WiFiClient client() { return client_; }
+
+ private:
+  struct Route {
+    String uri;
+    HTTPMethod method;
+    THandlerFunction fn;
+  };
+  struct KV {
+    String key, value;
+  };
+
+  bool readRequest();
+  void dispatch();
+  void finishResponse();
+  void sendHeaders(int code, const char* contentType, size_t length);
+  bool writeAll(const char* p, size_t n);
+
+  int port_;
+  int listenFd_ = -1;
+  uint64_t lastAcceptUs_ = 0;  // Sim::realUs() ostatniego accept()
+  std::vector<Route> routes_;
+  THandlerFunction notFound_;
+
+  // stan bieżącego żądania
+  WiFiClient client_;
+  HTTPMethod method_ = HTTP_GET;
+  String uri_;
+  std::vector<KV> args_;
+  std::vector<KV> reqHeaders_;
+  std::vector<KV> respHeaders_;
+  size_t contentLength_ = CONTENT_LENGTH_NOT_SET;
+  bool headersSent_ = false;
+  bool chunked_ = false;
+};
@@ -0,0 +1,37 @@
+#pragma once
+#include "Arduino.h"
+#include "WiFiClient.h"
+
+typedef enum {
+  WL_NO_SHIELD = 255,
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+// WiFi – stan łącza sterowany przez Sim::setNetworkUp() (symulacja zaników).
+class WiFiClass {
+ public:
+  bool mode(wifi_mode_t m) { mode_ = m; return true; }
+  wl_status_t begin(const char* ssid, const char* pass = nullptr);
+  wl_status_t status();
+  bool isConnected() { return status() == WL_CONNECTED; }
+  bool disconnect(bool wifioff = false) { (void)wifioff; return true; }
+  bool softAP(const char* ssid, const char* pass = nullptr) { (void)ssid; (void)pass; return true; }
+  IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+  IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+  uint8_t* macAddress(uint8_t* mac);
+  String macAddress();
+  int32_t RSSI();
+
+ private:
+  wifi_mode_t mode_ = WIFI_OFF;
+};
+
+extern WiFiClass WiFi;
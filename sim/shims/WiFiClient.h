@@ -0,0 +1,36 @@
+#pragma once
+#include <memory>
+#include "Client.h"
+
+// WiFiClient – prawdziwe gniazdo TCP (POSIX) hosta. Kopie współdzielą gniazdo,
+// jak w rdzeniu ESP32.
+class WiFiClient : public Client {
+ public:
+  WiFiClient();
+  ~WiFiClient() override;
+
+  int connect(IPAddress ip, uint16_t port) override;
+  int connect(const char* host, uint16_t port) override;
+  int connect(const char* host, uint16_t port, int32_t timeoutMs);
+  size_t write(uint8_t b) override { return write(&b, 1); }
+  size_t write(const uint8_t* buf, size_t n) override;
+  using Print::write;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buf, size_t n) override;
+  int peek() override;
+  void flush() override {}
+  void stop() override;
+  uint8_t connected() override;
+  operator bool() override { return connected(); }
+  int fd() const;
+  // esp_sim: opakowuje gniazdo przyjęte przez WebServer
+  static WiFiClient fromFd(int fd);
+  // esp_sim: rozmówca nie odpowie na ostatni zapis (MQTT QoS0), zegar wirtualny
+  // nie musi na nim czekać
+  void noReplyExpected();
+
+ protected:
+  struct Sock;
+  std::shared_ptr<Sock> sock_;
+};
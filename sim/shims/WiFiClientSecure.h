@@ -0,0 +1,9 @@
+#pragma once
+#include "WiFiClient.h"
+
+// Na hoście bez TLS: stand-iny SMTP/POP3 mówią czystym tekstem na porcie z configu.
+class WiFiClientSecure : public WiFiClient {
+ public:
+  void setInsecure() {}
+  void setCACert(const char*) {}
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include "Arduino.h"
+
+// TwoWire – na hoście tylko zegar magistrali; transakcje modeluje MCP3424.h
+// (koszt czasu = bity / zegar I2C).
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool setClock(uint32_t hz) { clock_ = hz ? hz : 100000; return true; }
+  uint32_t getClock() const { return clock_; }
+  void setTimeOut(uint16_t ms) { timeoutMs_ = ms; }
+  uint16_t getTimeOut() const { return timeoutMs_; }
+  // czas (us) transakcji 'bytes' bajtów + adres, 9 bitów na bajt
+  uint32_t transactionUs(size_t bytes) const { return (uint32_t)(((bytes + 1) * 9ULL * 1000000ULL) / clock_); }
+
+ private:
+  uint32_t clock_ = 100000;
+  uint16_t timeoutMs_ = 50;
+};
+
+extern TwoWire Wire;
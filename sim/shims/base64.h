@@ -0,0 +1,9 @@
+#pragma once
+#include "WString.h"
+
+// base64 – jak w rdzeniu ESP32 (libraries/base64).
+class base64 {
+ public:
+  static String encode(const uint8_t* data, size_t length);
+  static String encode(const String& text) { return encode((const uint8_t*)text.c_str(), text.length()); }
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+
+// Task WDT – na hoście tylko liczy przekroczenia (Sim::stats().wdtMisses),
+// nie resetuje procesu.
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERROR_CHECK(x) do { esp_err_t __e = (x); (void)__e; } while (0)
+
+typedef struct {
+  uint32_t timeout_ms;
+  uint32_t idle_core_mask;
+  bool trigger_panic;
+} esp_task_wdt_config_t;
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* config);
+esp_err_t esp_task_wdt_deinit();
+esp_err_t esp_task_wdt_add(void* task);
+esp_err_t esp_task_wdt_delete(void* task);
+esp_err_t esp_task_wdt_reset();
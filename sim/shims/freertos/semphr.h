@@ -0,0 +1,12 @@
+// semphr.h – mutex FreeRTOS dla esp_sim. Zadania działają na przemian z pętlą
+// główną (sim/src/sim.h), więc czekanie na zajęty mutex oddaje sterowanie
+// (yield), aż posiadacz go zwolni albo minie limit ticków.
+#pragma once
+#include "FreeRTOS.h"
+
+typedef void* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
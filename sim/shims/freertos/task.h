@@ -0,0 +1,15 @@
+// task.h – zadania FreeRTOS dla esp_sim. Zadanie jest wątkiem hosta, ale
+// działa na przemian z pętlą główną (patrz Sim::startTask w sim/src/sim.h);
+// priorytet, stos i rdzeń są tylko zapamiętywane.
+#pragma once
+#include "FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* created,
+                                   BaseType_t coreId);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t increment);
+#define vTaskDelayUntil(prev, inc) ((void)xTaskDelayUntil((prev), (inc)))
+TickType_t xTaskGetTickCount();
+BaseType_t xPortGetCoreID();
+void vTaskDelete(TaskHandle_t task);
@@ -0,0 +1,298 @@
+// arduino_core.cpp – implementacja shimów rdzenia: String, Print/Stream, czas,
+// GPIO, Serial, ESP, task WDT, random, base64.
+#include <Arduino.h>
+#include <base64.h>
+#include <esp_task_wdt.h>
+
+#include <chrono>
+#include <malloc.h>
+#include <random>
+#include <thread>
+
+#include "sim.h"
+
+// ================== String ==================
+
+std::string String::fmtS(long long v, unsigned char base) {
+  if (base == 10) return std::to_string(v);
+  if (v < 0) return "-" + fmtU((unsigned long long)(-(v + 1)) + 1ULL, base);
+  return fmtU((unsigned long long)v, base);
+}
+
+std::string String::fmtU(unsigned long long v, unsigned char base) {
+  if (base < 2 || base > 36) base = 10;
+  char buf[72];
+  char* p = buf + sizeof(buf) - 1;
+  *p = '\0';
+  do {
+    unsigned d = (unsigned)(v % base);
+    *--p = (char)(d < 10 ? '0' + d : 'a' + d - 10);
+    v /= base;
+  } while (v);
+  return p;
+}
+
+std::string String::fmtF(double v, unsigned char decimals) {
+  char buf[64];
+  int n = snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+  if (n < (int)sizeof(buf)) return buf;
+  std::string big((size_t)n + 1, '\0');
+  snprintf(&big[0], big.size(), "%.*f", (int)decimals, v);
+  big.resize((size_t)n);
+  return big;
+}
+
+void String::getBytes(unsigned char* buf, unsigned int n, unsigned int index) const {
+  if (!buf || n == 0) return;
+  if (index >= s_.size()) { buf[0] = 0; return; }
+  size_t cnt = std::min<size_t>(n - 1, s_.size() - index);
+  memcpy(buf, s_.data() + index, cnt);
+  buf[cnt] = 0;
+}
+
+bool String::equalsIgnoreCase(const String& o) const {
+  if (s_.size() != o.s_.size()) return false;
+  for (size_t i = 0; i < s_.size(); ++i)
+    if (tolower((unsigned char)s_[i]) != tolower((unsigned char)o.s_[i])) return false;
+  return true;
+}
+
+int String::lastIndexOf(char c, unsigned int from) const {
+  if (from >= s_.size()) return -1;
+  auto p = s_.rfind(c, from);
+  return p == std::string::npos ? -1 : (int)p;
+}
+
+int String::lastIndexOf(const String& t, unsigned int from) const {
+  if (t.s_.empty() || s_.empty() || t.s_.size() > s_.size()) return -1;
+  if (from >= s_.size()) from = (unsigned int)s_.size() - 1;
+  auto p = s_.rfind(t.s_, from);
+  return p == std::string::npos ? -1 : (int)p;
+}
+
+String String::substring(unsigned int left, unsigned int right) const {
+  if (left > right) std::swap(left, right);
+  if (left >= s_.size()) return String();
+  if (right > s_.size()) right = (unsigned int)s_.size();
+  return String(s_.substr(left, right - left));
+}
+
+void String::replace(const String& a, const String& b) {
+  if (a.s_.empty()) return;
+  size_t pos = 0;
+  while ((pos = s_.find(a.s_, pos)) != std::string::npos) {
+    s_.replace(pos, a.s_.size(), b.s_);
+    pos += b.s_.size();
+  }
+}
+
+void String::toLowerCase() { for (auto& c : s_) c = (char)tolower((unsigned char)c); }
+void String::toUpperCase() { for (auto& c : s_) c = (char)toupper((unsigned char)c); }
+
+void String::trim() {
+  size_t b = 0, e = s_.size();
+  while (b < e && isspace((unsigned char)s_[b])) ++b;
+  while (e > b && isspace((unsigned char)s_[e - 1])) --e;
+  s_ = s_.substr(b, e - b);
+}
+
+long String::toInt() const { return atol(s_.c_str()); }
+double String::toDouble() const { return atof(s_.c_str()); }
+
+// ================== Print / Stream ==================
+
+size_t Print::vprintf(const char* fmt, va_list ap) {
+  char small[256];
+  va_list cp;
+  va_copy(cp, ap);
+  int n = vsnprintf(small, sizeof(small), fmt, cp);
+  va_end(cp);
+  if (n < 0) return 0;
+  if (n < (int)sizeof(small)) return write((const uint8_t*)small, (size_t)n);
+  std::string big((size_t)n + 1, '\0');
+  vsnprintf(&big[0], big.size(), fmt, ap);
+  return write((const uint8_t*)big.data(), (size_t)n);
+}
+
+size_t Print::printf(const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  size_t n = vprintf(fmt, ap);
+  va_end(ap);
+  return n;
+}
+
+int Stream::timedRead() {
+  unsigned long t0 = millis();
+  do {
+    int c = read();
+    if (c >= 0) return c;
+    Sim::sleepUs(200);
+  } while (millis() - t0 < timeout_);
+  return -1;
+}
+
+size_t Stream::readBytes(uint8_t* buf, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    int c = timedRead();
+    if (c < 0) break;
+    buf[i++] = (uint8_t)c;
+  }
+  return i;
+}
+
+String Stream::readStringUntil(char terminator) {
+  std::string s;
+  int c = timedRead();
+  while (c >= 0 && c != terminator) {
+    s += (char)c;
+    c = timedRead();
+  }
+  return String(std::move(s));
+}
+
+String Stream::readString() {
+  std::string s;
+  int c = timedRead();
+  while (c >= 0) {
+    s += (char)c;
+    c = timedRead();
+  }
+  return String(std::move(s));
+}
+
+// ================== czas ==================
+
+unsigned long millis() { return (unsigned long)(uint32_t)(Sim::nowUs() / 1000ULL); }
+unsigned long micros() { return (unsigned long)(uint32_t)Sim::nowUs(); }
+void delay(uint32_t ms) { if (ms) Sim::sleepUs((uint64_t)ms * 1000ULL); else yield(); }
+void delayMicroseconds(uint32_t us) { Sim::sleepUs(us); }
+void yield() {
+  Sim::yieldNow();
+  std::this_thread::yield();
+}
+
+void configTime(long, int, const char*, const char*, const char*) {}
+
+// ================== GPIO ==================
+
+namespace {
+struct PinState {
+  uint8_t mode = INPUT;
+  uint8_t out = LOW;
+};
+PinState g_pins[64];
+}  // namespace
+
+void pinMode(uint8_t pin, uint8_t mode) { if (pin < 64) g_pins[pin].mode = mode; }
+void digitalWrite(uint8_t pin, uint8_t val) { if (pin < 64) g_pins[pin].out = val ? HIGH : LOW; }
+
+int digitalRead(uint8_t pin) {
+  if (pin >= 64) return LOW;
+  const PinState& p = g_pins[pin];
+  if ((p.mode & OUTPUT) == OUTPUT && (p.mode & OPEN_DRAIN) == 0) return p.out;
+  auto it = Sim::opts().pinInputs.find(pin);
+  if (it != Sim::opts().pinInputs.end()) return it->second ? HIGH : LOW;
+  if ((p.mode & OPEN_DRAIN) && p.out == LOW) return LOW;
+  return (p.mode & PULLUP) ? HIGH : LOW;
+}
+
+uint16_t analogRead(uint8_t) { return 0; }
+
+// ================== random ==================
+
+namespace {
+std::mt19937& rng() {
+  static std::mt19937 g(Sim::opts().seed);
+  return g;
+}
+}  // namespace
+
+uint32_t esp_random() { return (uint32_t)rng()(); }
+void randomSeed(unsigned long seed) { if (seed) rng().seed((uint32_t)seed); }
+long random(long howbig) { return howbig <= 0 ? 0 : (long)(esp_random() % (uint32_t)howbig); }
+long random(long howsmall, long howbig) { return howsmall >= howbig ? howsmall : howsmall + random(howbig - howsmall); }
+
+// ================== pamięć / ESP ==================
+
+bool psramFound() { return Sim::opts().psram; }
+void* ps_malloc(size_t size) { return Sim::opts().psram ? malloc(size) : nullptr; }
+
+uint32_t EspClass::getCycleCount() const {
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch()).count();
+  return (uint32_t)((uint64_t)ns * getCpuFreqMHz() / 1000ULL);
+}
+
+uint32_t EspClass::getFreeHeap() const {
+  struct mallinfo2 mi = mallinfo2();
+  size_t used = mi.uordblks;
+  return used >= getHeapSize() ? 0 : (uint32_t)(getHeapSize() - used);
+}
+uint32_t EspClass::getFreePsram() const { return getPsramSize(); }
+
+EspClass ESP;
+
+char* dtostrf(double val, signed char width, unsigned char prec, char* sout) {
+  sprintf(sout, "%*.*f", (int)width, (int)prec, val);
+  return sout;
+}
+
+// ================== Serial ==================
+
+void HardwareSerial::begin(unsigned long, uint32_t, int8_t, int8_t) {}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t n) {
+  if (uart_ == 0 && !Sim::opts().quiet) fwrite(buf, 1, n, stdout);
+  return n;
+}
+
+HardwareSerial Serial(0);
+
+// ================== IPAddress ==================
+
+bool IPAddress::fromString(const char* s) {
+  unsigned v[4];
+  if (!s || sscanf(s, "%u.%u.%u.%u", &v[0], &v[1], &v[2], &v[3]) != 4) return false;
+  for (int i = 0; i < 4; ++i) {
+    if (v[i] > 255) return false;
+    a_[i] = (uint8_t)v[i];
+  }
+  return true;
+}
+
+String IPAddress::toString() const {
+  char b[16];
+  snprintf(b, sizeof(b), "%u.%u.%u.%u", a_[0], a_[1], a_[2], a_[3]);
+  return String(b);
+}
+
+// ================== task WDT ==================
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* config) {
+  Sim::wdtConfigure(config ? config->timeout_ms : 0);
+  return ESP_OK;
+}
+esp_err_t esp_task_wdt_deinit() { Sim::wdtConfigure(0); return ESP_OK; }
+esp_err_t esp_task_wdt_add(void*) { return ESP_OK; }
+esp_err_t esp_task_wdt_delete(void*) { return ESP_OK; }
+esp_err_t esp_task_wdt_reset() { Sim::wdtFeed(); return ESP_OK; }
+
+// ================== base64 ==================
+
+String base64::encode(const uint8_t* data, size_t length) {
+  static const char* tbl = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((length + 2) / 3 * 4);
+  for (size_t i = 0; i < length; i += 3) {
+    uint32_t v = (uint32_t)data[i] << 16;
+    if (i + 1 < length) v |= (uint32_t)data[i + 1] << 8;
+    if (i + 2 < length) v |= data[i + 2];
+    out += tbl[(v >> 18) & 63];
+    out += tbl[(v >> 12) & 63];
+    out += (i + 1 < length) ? tbl[(v >> 6) & 63] : '=';
+    out += (i + 2 < length) ? tbl[v & 63] : '=';
+  }
+  return String(std::move(out));
+}
@@ -0,0 +1,332 @@
+// arduino_json.cpp – parser i serializer dla shimu ArduinoJson.h.
+#include <ArduinoJson.h>
+
+namespace {
+
+const int kMaxDepth = 10;  // ARDUINOJSON_DEFAULT_NESTING_LIMIT
+
+class Parser {
+ public:
+  Parser(const char* p, size_t n) : p_(p), end_(p + n) {}
+
+  DeserializationError parse(ajson::Node& root) {
+    skipWs();
+    if (p_ >= end_) return DeserializationError::EmptyInput;
+    return value(root, 0);
+  }
+
+ private:
+  void skipWs() {
+    while (p_ < end_) {
+      if (isspace((unsigned char)*p_)) {
+        ++p_;
+      } else if (*p_ == '/' && p_ + 1 < end_ && p_[1] == '/') {
+        while (p_ < end_ && *p_ != '\n') ++p_;
+      } else if (*p_ == '/' && p_ + 1 < end_ && p_[1] == '*') {
+        p_ += 2;
+        while (p_ + 1 < end_ && !(p_[0] == '*' && p_[1] == '/')) ++p_;
+        p_ = p_ + 2 <= end_ ? p_ + 2 : end_;
+      } else {
+        break;
+      }
+    }
+  }
+
+  DeserializationError value(ajson::Node& n, int depth) {
+    skipWs();
+    if (p_ >= end_) return DeserializationError::IncompleteInput;
+    switch (*p_) {
+      case '{': return object(n, depth + 1);
+      case '[': return array(n, depth + 1);
+      case '"':
+      case '\'':
+        n.t = ajson::Node::Str;
+        return string(n.s);
+      default: return literal(n);
+    }
+  }
+
+  DeserializationError object(ajson::Node& n, int depth) {
+    if (depth > kMaxDepth) return DeserializationError::TooDeep;
+    ++p_;
+    n.reset();
+    n.t = ajson::Node::Obj;
+    skipWs();
+    if (p_ < end_ && *p_ == '}') { ++p_; return DeserializationError::Ok; }
+    for (;;) {
+      skipWs();
+      if (p_ >= end_) return DeserializationError::IncompleteInput;
+      std::string key;
+      if (*p_ != '"' && *p_ != '\'') return DeserializationError::InvalidInput;
+      DeserializationError e = string(key);
+      if (e) return e;
+      skipWs();
+      if (p_ >= end_) return DeserializationError::IncompleteInput;
+      if (*p_ != ':') return DeserializationError::InvalidInput;
+      ++p_;
+      ajson::Node* child = n.getOrAdd(key);
+      child->reset();
+      e = value(*child, depth);
+      if (e) return e;
+      skipWs();
+      if (p_ >= end_) return DeserializationError::IncompleteInput;
+      if (*p_ == ',') { ++p_; continue; }
+      if (*p_ == '}') { ++p_; return DeserializationError::Ok; }
+      return DeserializationError::InvalidInput;
+    }
+  }
+
+  DeserializationError array(ajson::Node& n, int depth) {
+    if (depth > kMaxDepth) return DeserializationError::TooDeep;
+    ++p_;
+    n.reset();
+    n.t = ajson::Node::Arr;
+    skipWs();
+    if (p_ < end_ && *p_ == ']') { ++p_; return DeserializationError::Ok; }
+    for (;;) {
+      DeserializationError e = value(*n.addElement(), depth);
+      if (e) return e;
+      skipWs();
+      if (p_ >= end_) return DeserializationError::IncompleteInput;
+      if (*p_ == ',') { ++p_; continue; }
+      if (*p_ == ']') { ++p_; return DeserializationError::Ok; }
+      return DeserializationError::InvalidInput;
+    }
+  }
+
+  static void putUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+      out += (char)cp;
+    } else if (cp < 0x800) {
+      out += (char)(0xC0 | (cp >> 6));
+      out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      out += (char)(0xE0 | (cp >> 12));
+      out += (char)(0x80 | ((cp >> 6) & 0x3F));
+      out += (char)(0x80 | (cp & 0x3F));
+    } else {
+      out += (char)(0xF0 | (cp >> 18));
+      out += (char)(0x80 | ((cp >> 12) & 0x3F));
+      out += (char)(0x80 | ((cp >> 6) & 0x3F));
+      out += (char)(0x80 | (cp & 0x3F));
+    }
+  }
+
+  DeserializationError string(std::string& out) {
+    const char q = *p_++;
+    out.clear();
+    while (p_ < end_) {
+      char c = *p_++;
+      if (c == q) return DeserializationError::Ok;
+      if (c != '\\') { out += c; continue; }
+      if (p_ >= end_) break;
+      c = *p_++;
+      switch (c) {
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+          if (end_ - p_ < 4) return DeserializationError::IncompleteInput;
+          uint32_t cp = (uint32_t)strtoul(std::string(p_, 4).c_str(), nullptr, 16);
+          p_ += 4;
+          if (cp >= 0xD800 && cp < 0xDC00 && end_ - p_ >= 6 && p_[0] == '\\' && p_[1] == 'u') {
+            uint32_t lo = (uint32_t)strtoul(std::string(p_ + 2, 4).c_str(), nullptr, 16);
+            if (lo >= 0xDC00 && lo < 0xE000) {
+              cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+              p_ += 6;
+            }
+          }
+          putUtf8(out, cp);
+          break;
+        }
+        default: out += c; break;
+      }
+    }
+    return DeserializationError::IncompleteInput;
+  }
+
+  DeserializationError literal(ajson::Node& n) {
+    const char* s = p_;
+    while (p_ < end_ && !isspace((unsigned char)*p_) && *p_ != ',' && *p_ != '}' && *p_ != ']' && *p_ != ':')
+      ++p_;
+    std::string tok(s, p_);
+    n.reset();
+    if (tok == "null") return DeserializationError::Ok;
+    if (tok == "true" || tok == "false") {
+      n.t = ajson::Node::Bool;
+      n.b = tok == "true";
+      return DeserializationError::Ok;
+    }
+    if (tok.empty()) return p_ >= end_ ? DeserializationError::IncompleteInput : DeserializationError::InvalidInput;
+    char* e = nullptr;
+    bool isFloat = tok.find_first_of(".eE") != std::string::npos;
+    if (!isFloat) {
+      errno = 0;
+      if (tok[0] == '-') {
+        long long v = strtoll(tok.c_str(), &e, 10);
+        if (*e == 0 && errno == 0) { n.t = ajson::Node::Int; n.i = v; return DeserializationError::Ok; }
+      } else {
+        unsigned long long v = strtoull(tok.c_str(), &e, 10);
+        if (*e == 0 && errno == 0) {
+          if (v <= (unsigned long long)INT64_MAX) { n.t = ajson::Node::Int; n.i = (int64_t)v; }
+          else { n.t = ajson::Node::UInt; n.u = v; }
+          return DeserializationError::Ok;
+        }
+      }
+    }
+    double d = strtod(tok.c_str(), &e);
+    if (*e != 0) return DeserializationError::InvalidInput;
+    n.t = ajson::Node::Float;
+    n.d = d;
+    return DeserializationError::Ok;
+  }
+
+  const char* p_;
+  const char* end_;
+};
+
+void escape(std::string& out, const std::string& s) {
+  out += '"';
+  for (unsigned char c : s) {
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\b': out += "\\b"; break;
+      case '\f': out += "\\f"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (c < 0x20) {
+          char b[8];
+          snprintf(b, sizeof(b), "\\u%04x", c);
+          out += b;
+        } else {
+          out += (char)c;
+        }
+    }
+  }
+  out += '"';
+}
+
+void indent(std::string& out, int level) {
+  out += '\n';
+  out.append((size_t)level * 2, ' ');
+}
+
+void write(std::string& out, const ajson::Node& n, bool pretty, int level) {
+  using N = ajson::Node;
+  char b[40];
+  switch (n.t) {
+    case N::Null: out += "null"; break;
+    case N::Bool: out += n.b ? "true" : "false"; break;
+    case N::Int: out += std::to_string(n.i); break;
+    case N::UInt: out += std::to_string(n.u); break;
+    case N::Float:
+      if (std::isnan(n.d) || std::isinf(n.d)) {
+        out += "null";
+      } else if (n.d == std::floor(n.d) && std::fabs(n.d) < 1e15) {
+        snprintf(b, sizeof(b), "%.0f", n.d);
+        out += b;
+      } else {
+        snprintf(b, sizeof(b), "%.9g", n.d);
+        out += b;
+      }
+      break;
+    case N::Str: escape(out, n.s); break;
+    case N::Obj: {
+      out += '{';
+      bool first = true;
+      for (auto& kv : n.obj) {
+        if (!first) out += ',';
+        first = false;
+        if (pretty) indent(out, level + 1);
+        escape(out, kv.first);
+        out += pretty ? ": " : ":";
+        write(out, *kv.second, pretty, level + 1);
+      }
+      if (pretty && !n.obj.empty()) indent(out, level);
+      out += '}';
+      break;
+    }
+    case N::Arr: {
+      out += '[';
+      bool first = true;
+      for (auto& e : n.arr) {
+        if (!first) out += ',';
+        first = false;
+        if (pretty) indent(out, level + 1);
+        write(out, *e, pretty, level + 1);
+      }
+      if (pretty && !n.arr.empty()) indent(out, level);
+      out += ']';
+      break;
+    }
+  }
+}
+
+}  // namespace
+
+namespace ajson {
+
+std::string serialize(const Node& n, bool pretty) {
+  std::string out;
+  write(out, n, pretty, 0);
+  return out;
+}
+
+}  // namespace ajson
+
+const char* DeserializationError::c_str() const {
+  switch (code_) {
+    case Ok: return "Ok";
+    case EmptyInput: return "EmptyInput";
+    case IncompleteInput: return "IncompleteInput";
+    case InvalidInput: return "InvalidInput";
+    case NoMemory: return "NoMemory";
+    case TooDeep: return "TooDeep";
+  }
+  return "???";
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t len) {
+  doc.clear();
+  if (!input) return DeserializationError::EmptyInput;
+  Parser p(input, len);
+  DeserializationError e = p.parse(doc.root());
+  if (e) doc.clear();
+  return e;
+}
+
+DeserializationError deserializeJson(JsonDocument& doc, Stream& input) {
+  std::string buf;
+  uint8_t tmp[512];
+  while (input.available() > 0) {
+    int r = input.read(tmp, sizeof(tmp));
+    if (r <= 0) break;
+    buf.append((const char*)tmp, (size_t)r);
+  }
+  return deserializeJson(doc, buf.data(), buf.size());
+}
+
+size_t serializeJson(const JsonDocument& doc, Print& out) {
+  std::string s = ajson::serialize(doc.root(), false);
+  return out.write((const uint8_t*)s.data(), s.size());
+}
+
+size_t serializeJson(const JsonDocument& doc, String& out) {
+  out = String(ajson::serialize(doc.root(), false));
+  return out.length();
+}
+
+size_t serializeJsonPretty(const JsonDocument& doc, Print& out) {
+  std::string s = ajson::serialize(doc.root(), true);
+  return out.write((const uint8_t*)s.data(), s.size());
+}
+
+size_t serializeJsonPretty(const JsonDocument& doc, String& out) {
+  out = String(ajson::serialize(doc.root(), true));
+  return out.length();
+}
@@ -0,0 +1,76 @@
+// freertos.cpp – zadania FreeRTOS na warstwie Sim (korutyny z przekazywaniem sterowania).
+#include <Arduino.h>
+
+#include <atomic>
+
+#include "sim.h"
+
+namespace {
+
+struct TaskInfo {
+  TaskFunction_t fn;
+  void* arg;
+};
+
+}  // namespace
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* created, BaseType_t coreId) {
+  if (!fn) return pdFAIL;
+  TaskInfo* ti = new TaskInfo{fn, arg};   // uchwyt zadania
+  Sim::startTask(fn, arg, name, coreId == tskNO_AFFINITY ? 0 : (int)coreId);
+  if (created) *created = ti;
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+BaseType_t xTaskDelayUntil(TickType_t* previousWake, TickType_t increment) {
+  const TickType_t wake = *previousWake + increment;
+  *previousWake = wake;
+  const int32_t dt = (int32_t)(wake - xTaskGetTickCount());
+  if (dt <= 0) {
+    yield();
+    return pdFALSE;
+  }
+  delay((uint32_t)dt * portTICK_PERIOD_MS);
+  return pdTRUE;
+}
+
+TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+BaseType_t xPortGetCoreID() { return Sim::taskCore(); }
+
+// Zadanie kończy się powrotem z funkcji; usuwanie innych zadań nie jest modelowane.
+void vTaskDelete(TaskHandle_t) {}
+
+// ================== Mutex ==================
+
+namespace {
+struct SimMutex {
+  std::atomic<bool> held{false};
+};
+}  // namespace
+
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new SimMutex; }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  SimMutex* m = static_cast<SimMutex*>(sem);
+  if (!m) return pdFALSE;
+  const TickType_t t0 = xTaskGetTickCount();
+  for (;;) {
+    bool free = false;
+    if (m->held.compare_exchange_strong(free, true, std::memory_order_acquire)) return pdTRUE;
+    if (ticks == 0 || (ticks != portMAX_DELAY && xTaskGetTickCount() - t0 >= ticks)) return pdFALSE;
+    yield();
+  }
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  SimMutex* m = static_cast<SimMutex*>(sem);
+  if (!m) return pdFALSE;
+  m->held.store(false, std::memory_order_release);
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete static_cast<SimMutex*>(sem); }
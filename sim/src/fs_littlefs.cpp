@@ -0,0 +1,374 @@
+// fs_littlefs.cpp – LittleFS na katalogu hosta (Sim::opts().fsRoot).
+// Zajętość liczona blokami 4 kB jak w LittleFS; zapis ponad pojemność partycji
+// zwraca krótki zapis (tak jak pełny system plików na urządzeniu).
+//
+// Model zużycia flash (Sim::stats().fsCommits/fsErases): LittleFS zapisuje dane
+// copy-on-write, więc commit pliku (sync/close po zapisie) kasuje każdy blok
+// 4 kB, do którego trafiły nowe dane – także niepełny ostatni blok, który
+// jest przepisywany w całości. Każdy commit (również create/rename/remove)
+// dopisuje ~128 B do logu pary bloków metadanych, kasowanej po zapełnieniu.
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "sim.h"
+
+namespace {
+
+const uint64_t kBlock = 4096;
+const uint64_t kCapacity = 0xBF0000;  // partitions.csv: spiffs
+const uint64_t kOverheadBlocks = 2;   // superblok LittleFS
+const uint64_t kCommitBytes = 128;    // wpis commitu w logu metadanych
+
+uint64_t g_metaBytes = 0;  // zapełnienie logu metadanych
+
+void metaCommit() {
+  ++Sim::stats().fsCommits;
+  g_metaBytes += kCommitBytes;
+  if (g_metaBytes >= kBlock) {
+    g_metaBytes = 0;
+    ++Sim::stats().fsErases;
+  }
+}
+
+uint64_t g_used = 0;  // bajty zajęte (zaokrąglone do bloków)
+
+uint64_t roundBlocks(uint64_t n) { return (n + kBlock - 1) / kBlock * kBlock; }
+
+bool validPath(const char* p) {
+  if (!p || p[0] != '/') return false;
+  std::string s(p);
+  return s.find("/../") == std::string::npos && (s.size() < 3 || s.compare(s.size() - 3, 3, "/..") != 0);
+}
+
+std::string hostPath(const char* vpath) {
+  std::string v(vpath);
+  while (v.size() > 1 && v.back() == '/') v.pop_back();
+  return Sim::opts().fsRoot + (v == "/" ? "" : v);
+}
+
+bool statHost(const std::string& hp, struct stat& st) { return ::stat(hp.c_str(), &st) == 0; }
+
+uint64_t fileSize(const std::string& hp) {
+  struct stat st;
+  return statHost(hp, st) && S_ISREG(st.st_mode) ? (uint64_t)st.st_size : 0;
+}
+
+void mkdirs(const std::string& hp) {
+  for (size_t i = Sim::opts().fsRoot.size() + 1; i < hp.size(); ++i)
+    if (hp[i] == '/') ::mkdir(hp.substr(0, i).c_str(), 0755);
+}
+
+uint64_t scanUsed(const std::string& dir) {
+  uint64_t sum = 0;
+  DIR* d = opendir(dir.c_str());
+  if (!d) return 0;
+  while (dirent* e = readdir(d)) {
+    if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+    std::string p = dir + "/" + e->d_name;
+    struct stat st;
+    if (!statHost(p, st)) continue;
+    if (S_ISDIR(st.st_mode)) sum += kBlock + scanUsed(p);
+    else sum += roundBlocks((uint64_t)st.st_size);
+  }
+  closedir(d);
+  return sum;
+}
+
+void removeTree(const std::string& dir, bool self) {
+  if (DIR* d = opendir(dir.c_str())) {
+    while (dirent* e = readdir(d)) {
+      if (!strcmp(e->d_name, ".") || !strcmp(e->d_name, "..")) continue;
+      std::string p = dir + "/" + e->d_name;
+      struct stat st;
+      if (statHost(p, st) && S_ISDIR(st.st_mode)) removeTree(p, true);
+      else ::unlink(p.c_str());
+    }
+    closedir(d);
+  }
+  if (self) ::rmdir(dir.c_str());
+}
+
+}  // namespace
+
+namespace fs {
+
+class FileImpl {
+ public:
+  int fd = -1;
+  bool dir = false;
+  bool writable = false;
+  std::string vpath;
+  std::string hpath;
+  std::string base;
+  std::vector<std::string> entries;
+  size_t nextEntry = 0;
+  uint64_t dirtyFrom = 0;   // najniższy zmieniony bajt od commitu
+  bool dirty = false;
+
+  ~FileImpl() { closeFd(); }
+
+  void markDirty(uint64_t from) {
+    if (!dirty || from < dirtyFrom) dirtyFrom = from;
+    dirty = true;
+  }
+
+  void commit() {
+    if (fd < 0 || !dirty) return;
+    struct stat st;
+    uint64_t size = fstat(fd, &st) == 0 ? (uint64_t)st.st_size : dirtyFrom;
+    // bloki od tego z pierwszym zmienionym bajtem do końca pliku
+    if (size > dirtyFrom) Sim::stats().fsErases += (size + kBlock - 1) / kBlock - dirtyFrom / kBlock;
+    metaCommit();
+    dirty = false;
+  }
+
+  void closeFd() {
+    commit();
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+};
+
+// ================== File ==================
+
+size_t File::write(const uint8_t* buf, size_t n) {
+  if (!p_ || p_->fd < 0 || !p_->writable || n == 0) return 0;
+  off_t pos = ::lseek(p_->fd, 0, SEEK_CUR);
+  uint64_t oldSize = fileSize(p_->hpath);
+  uint64_t newSize = std::max<uint64_t>(oldSize, (uint64_t)pos + n);
+  // O_APPEND: zapis i tak trafia na koniec
+  if (fcntl(p_->fd, F_GETFL) & O_APPEND) newSize = oldSize + n;
+  uint64_t delta = roundBlocks(newSize) - roundBlocks(oldSize);
+  if (g_used + delta > kCapacity) {
+    uint64_t room = kCapacity > g_used ? kCapacity - g_used : 0;
+    uint64_t slack = roundBlocks(oldSize) - oldSize;  // wolne miejsce w ostatnim bloku
+    uint64_t allowed = room + slack;
+    if (allowed == 0) return 0;
+    n = (size_t)std::min<uint64_t>(n, allowed);
+    newSize = std::max<uint64_t>(oldSize, (uint64_t)pos + n);
+    delta = roundBlocks(newSize) - roundBlocks(oldSize);
+  }
+  const uint64_t at = (fcntl(p_->fd, F_GETFL) & O_APPEND) ? oldSize : (uint64_t)pos;
+  ssize_t w = ::write(p_->fd, buf, n);
+  if (w <= 0) return 0;
+  p_->markDirty(at);
+  g_used += delta;
+  Sim::stats().fsBytesWritten += (uint64_t)w;
+  return (size_t)w;
+}
+
+int File::available() {
+  if (!p_ || p_->fd < 0) return 0;
+  off_t pos = ::lseek(p_->fd, 0, SEEK_CUR);
+  struct stat st;
+  if (fstat(p_->fd, &st) != 0 || pos < 0) return 0;
+  return st.st_size > pos ? (int)std::min<off_t>(st.st_size - pos, INT32_MAX) : 0;
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::read(uint8_t* buf, size_t n) {
+  if (!p_ || p_->fd < 0) return -1;
+  ssize_t r = ::read(p_->fd, buf, n);
+  if (r < 0) return -1;
+  Sim::stats().fsBytesRead += (uint64_t)r;
+  return (int)r;
+}
+
+int File::peek() {
+  if (!p_ || p_->fd < 0) return -1;
+  uint8_t c;
+  if (::read(p_->fd, &c, 1) != 1) return -1;
+  ::lseek(p_->fd, -1, SEEK_CUR);
+  return c;
+}
+
+void File::flush() {
+  if (p_) p_->commit();
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!p_ || p_->fd < 0) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+  off_t off = mode == SeekEnd ? -(off_t)pos : (off_t)pos;
+  if (mode == SeekEnd && pos == 0) off = 0;
+  return ::lseek(p_->fd, off, whence) >= 0;
+}
+
+size_t File::position() const {
+  if (!p_ || p_->fd < 0) return 0;
+  off_t p = ::lseek(p_->fd, 0, SEEK_CUR);
+  return p < 0 ? 0 : (size_t)p;
+}
+
+size_t File::size() const {
+  if (!p_ || p_->dir) return 0;
+  struct stat st;
+  if (p_->fd >= 0 && fstat(p_->fd, &st) == 0) return (size_t)st.st_size;
+  return (size_t)fileSize(p_->hpath);
+}
+
+bool File::truncate(uint32_t size) {
+  if (!p_ || p_->fd < 0 || !p_->writable) return false;
+  uint64_t oldSize = fileSize(p_->hpath);
+  if (ftruncate(p_->fd, size) != 0) return false;
+  p_->markDirty(size);
+  g_used = g_used + roundBlocks(size) - roundBlocks(oldSize);
+  return true;
+}
+
+void File::close() {
+  if (p_) p_->closeFd();
+  p_.reset();
+}
+
+File::operator bool() const { return p_ && (p_->fd >= 0 || p_->dir); }
+
+const char* File::name() const { return p_ ? p_->base.c_str() : ""; }
+const char* File::path() const { return p_ ? p_->vpath.c_str() : ""; }
+bool File::isDirectory() const { return p_ && p_->dir; }
+
+File File::openNextFile(const char* mode) {
+  if (!p_ || !p_->dir) return File();
+  while (p_->nextEntry < p_->entries.size()) {
+    const std::string& n = p_->entries[p_->nextEntry++];
+    std::string child = (p_->vpath == "/" ? "" : p_->vpath) + "/" + n;
+    File f = LittleFS.open(child.c_str(), mode);
+    if (f) return f;
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (p_ && p_->dir) p_->nextEntry = 0;
+}
+
+time_t File::getLastWrite() {
+  struct stat st;
+  return p_ && statHost(p_->hpath, st) ? st.st_mtime : 0;
+}
+
+// ================== FS ==================
+
+File FS::open(const char* path, const char* mode, bool create) {
+  if (!validPath(path) || !mode) return File();
+  auto impl = std::make_shared<FileImpl>();
+  impl->vpath = path;
+  impl->hpath = hostPath(path);
+  std::string v(path);
+  while (v.size() > 1 && v.back() == '/') v.pop_back();
+  impl->base = v == "/" ? "/" : v.substr(v.rfind('/') + 1);
+
+  struct stat st;
+  bool exists = statHost(impl->hpath, st);
+  if (exists && S_ISDIR(st.st_mode)) {
+    impl->dir = true;
+    if (DIR* d = opendir(impl->hpath.c_str())) {
+      while (dirent* e = readdir(d))
+        if (strcmp(e->d_name, ".") && strcmp(e->d_name, "..")) impl->entries.push_back(e->d_name);
+      closedir(d);
+    }
+    std::sort(impl->entries.begin(), impl->entries.end());
+    ++Sim::stats().fsOpens;
+    return File(impl);
+  }
+
+  int flags;
+  const bool plus = strchr(mode, '+') != nullptr;
+  switch (mode[0]) {
+    case 'r': flags = plus ? O_RDWR : O_RDONLY; break;
+    case 'w': flags = (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_TRUNC; break;
+    case 'a': flags = (plus ? O_RDWR : O_WRONLY) | O_CREAT | O_APPEND; break;
+    default: return File();
+  }
+  if (mode[0] == 'r' && !exists) return File();
+  (void)create;  // jak LittleFS w ESP32: katalogi nadrzędne tworzone przy zapisie
+  if (flags & O_CREAT) mkdirs(impl->hpath);
+  uint64_t oldSize = exists ? (uint64_t)st.st_size : 0;
+  impl->fd = ::open(impl->hpath.c_str(), flags | O_CLOEXEC, 0644);
+  if (impl->fd < 0) return File();
+  impl->writable = mode[0] != 'r' || plus;
+  if (flags & O_TRUNC) g_used -= std::min(g_used, roundBlocks(oldSize));
+  if ((flags & O_TRUNC) || !exists) metaCommit();
+  ++Sim::stats().fsOpens;
+  return File(impl);
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return validPath(path) && statHost(hostPath(path), st);
+}
+
+bool FS::remove(const char* path) {
+  if (!validPath(path)) return false;
+  std::string hp = hostPath(path);
+  uint64_t sz = fileSize(hp);
+  if (::unlink(hp.c_str()) != 0) return false;
+  g_used -= std::min(g_used, roundBlocks(sz));
+  ++Sim::stats().fsRemoves;
+  metaCommit();
+  return true;
+}
+
+bool FS::rename(const char* from, const char* to) {
+  if (!validPath(from) || !validPath(to)) return false;
+  std::string hf = hostPath(from), ht = hostPath(to);
+  struct stat st;
+  if (!statHost(hf, st)) return false;
+  uint64_t dst = fileSize(ht);
+  mkdirs(ht);
+  if (::rename(hf.c_str(), ht.c_str()) != 0) return false;
+  g_used -= std::min(g_used, roundBlocks(dst));
+  ++Sim::stats().fsRenames;
+  metaCommit();
+  return true;
+}
+
+bool FS::mkdir(const char* path) {
+  if (!validPath(path)) return false;
+  std::string hp = hostPath(path);
+  mkdirs(hp + "/");
+  struct stat st;
+  return statHost(hp, st) && S_ISDIR(st.st_mode);
+}
+
+bool FS::rmdir(const char* path) {
+  return validPath(path) && ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+// ================== LittleFSFS ==================
+
+bool LittleFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+  const std::string& root = Sim::opts().fsRoot;
+  struct stat st;
+  if (!statHost(root, st)) {
+    if (!formatOnFail) return false;
+    if (::mkdir(root.c_str(), 0755) != 0) return false;
+  } else if (!S_ISDIR(st.st_mode)) {
+    return false;
+  }
+  g_used = kOverheadBlocks * kBlock + scanUsed(root);
+  return true;
+}
+
+bool LittleFSFS::format() {
+  removeTree(Sim::opts().fsRoot, false);
+  g_used = kOverheadBlocks * kBlock;
+  return true;
+}
+
+size_t LittleFSFS::totalBytes() { return (size_t)kCapacity; }
+size_t LittleFSFS::usedBytes() { return (size_t)std::min(g_used, kCapacity); }
+
+}  // namespace fs
+
+fs::LittleFSFS LittleFS;
@@ -0,0 +1,177 @@
+// pubsub.cpp – minimalny klient MQTT 3.1.1 dla PubSubClient.h.
+#include <PubSubClient.h>
+#include <WiFiClient.h>
+
+namespace {
+
+const uint8_t MQTTCONNECT = 1 << 4;
+const uint8_t MQTTCONNACK = 2 << 4;
+const uint8_t MQTTPUBLISH = 3 << 4;
+const uint8_t MQTTPINGREQ = 12 << 4;
+const uint8_t MQTTPINGRESP = 13 << 4;
+const uint8_t MQTTDISCONNECT = 14 << 4;
+
+void putStr(std::string& b, const char* s) {
+  size_t n = s ? strlen(s) : 0;
+  b += (char)(n >> 8);
+  b += (char)(n & 0xFF);
+  if (n) b.append(s, n);
+}
+
+// po CONNACK/PINGRESP i po PUBLISH QoS0 broker nic więcej nie wysyła
+void noReply(Client* c) {
+  if (auto* w = dynamic_cast<WiFiClient*>(c)) w->noReplyExpected();
+}
+
+}  // namespace
+
+bool PubSubClient::writePacket(uint8_t header, const String& body) {
+  if (!client_) return false;
+  std::string pkt;
+  pkt += (char)header;
+  size_t len = body.length();
+  do {
+    uint8_t d = len % 128;
+    len /= 128;
+    if (len) d |= 0x80;
+    pkt += (char)d;
+  } while (len);
+  pkt.append(body.c_str(), body.length());
+  bool ok = client_->write((const uint8_t*)pkt.data(), pkt.size()) == pkt.size();
+  lastOutMs_ = millis();
+  return ok;
+}
+
+bool PubSubClient::readPacket(uint8_t& type, String& body, uint32_t timeoutMs) {
+  unsigned long t0 = millis();
+  auto readByte = [&](uint8_t& b) {
+    while (!client_->available()) {
+      if (!client_->connected() || millis() - t0 >= timeoutMs) return false;
+      delay(1);
+    }
+    int c = client_->read();
+    if (c < 0) return false;
+    b = (uint8_t)c;
+    return true;
+  };
+
+  uint8_t hdr;
+  if (!readByte(hdr)) return false;
+  size_t len = 0, mul = 1;
+  uint8_t d;
+  do {
+    if (!readByte(d)) return false;
+    len += (d & 0x7F) * mul;
+    mul *= 128;
+  } while ((d & 0x80) && mul <= 128 * 128 * 128);
+  std::string b;
+  b.reserve(len);
+  while (b.size() < len) {
+    uint8_t c;
+    if (!readByte(c)) return false;
+    b += (char)c;
+  }
+  type = hdr & 0xF0;
+  body = String(std::move(b));
+  lastInMs_ = millis();
+  return true;
+}
+
+bool PubSubClient::connect(const char* id, const char* user, const char* pass) {
+  if (!client_) {
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+  if (connected()) return true;
+  if (!client_->connect(host_.c_str(), port_)) {
+    state_ = MQTT_CONNECT_FAILED;
+    return false;
+  }
+
+  std::string b;
+  putStr(b, "MQTT");
+  b += (char)4;  // MQTT 3.1.1
+  uint8_t flags = 0x02;  // clean session
+  if (user) flags |= 0x80;
+  if (user && pass) flags |= 0x40;
+  b += (char)flags;
+  b += (char)(keepAliveSec_ >> 8);
+  b += (char)(keepAliveSec_ & 0xFF);
+  putStr(b, id);
+  if (user) putStr(b, user);
+  if (user && pass) putStr(b, pass);
+  writePacket(MQTTCONNECT, String(b));
+
+  uint8_t type;
+  String resp;
+  if (!readPacket(type, resp, (uint32_t)socketTimeoutSec_ * 1000U)) {
+    state_ = MQTT_CONNECTION_TIMEOUT;
+    client_->stop();
+    return false;
+  }
+  if (type != MQTTCONNACK || resp.length() < 2 || resp[1] != 0) {
+    state_ = resp.length() >= 2 ? (int)(uint8_t)resp[1] : MQTT_CONNECT_FAILED;
+    client_->stop();
+    return false;
+  }
+  state_ = MQTT_CONNECTED;
+  noReply(client_);
+  pingOutstanding_ = false;
+  lastInMs_ = lastOutMs_ = millis();
+  return true;
+}
+
+void PubSubClient::disconnect() {
+  if (client_ && client_->connected()) writePacket(MQTTDISCONNECT, String());
+  if (client_) client_->stop();
+  state_ = MQTT_DISCONNECTED;
+}
+
+bool PubSubClient::connected() {
+  if (!client_) return false;
+  bool rc = client_->connected();
+  if (!rc) {
+    if (state_ == MQTT_CONNECTED) {
+      state_ = MQTT_CONNECTION_LOST;
+      client_->stop();
+    }
+  } else if (state_ != MQTT_CONNECTED) {
+    rc = false;
+  }
+  return rc;
+}
+
+bool PubSubClient::loop() {
+  if (!connected()) return false;
+  unsigned long now = millis();
+  unsigned long ka = (unsigned long)keepAliveSec_ * 1000UL;
+  if (now - lastInMs_ > ka || now - lastOutMs_ > ka) {
+    if (pingOutstanding_) {
+      state_ = MQTT_CONNECTION_TIMEOUT;
+      client_->stop();
+      return false;
+    }
+    writePacket(MQTTPINGREQ, String());
+    lastInMs_ = now;
+    pingOutstanding_ = true;
+  }
+  while (client_->available()) {
+    uint8_t type;
+    String body;
+    if (!readPacket(type, body, (uint32_t)socketTimeoutSec_ * 1000U)) break;
+    if (type == MQTTPINGRESP) pingOutstanding_ = false;
+  }
+  if (!pingOutstanding_) noReply(client_);
+  return true;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+  if (!connected() || !topic) return false;
+  std::string b;
+  putStr(b, topic);
+  if (payload) b += payload;
+  if (b.size() + 5 > bufferSize_) return false;
+  bool ok = writePacket(MQTTPUBLISH | (retained ? 1 : 0), String(b));
+  noReply(client_);
+  return ok;
+}
@@ -0,0 +1,310 @@
+#include "sim.h"
+
+#include <ucontext.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Sim {
+
+namespace {
+const auto kStart = std::chrono::steady_clock::now();
+const int64_t kStartEpoch = (int64_t)std::chrono::duration_cast<std::chrono::seconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+std::atomic<bool> g_netUp{true};
+std::mt19937 g_noise(12345);
+
+uint32_t g_wdtTimeoutMs = 0;
+uint64_t g_wdtLastUs = 0;
+}  // namespace
+
+Options& opts() {
+  static Options o;
+  return o;
+}
+
+Stats& stats() {
+  static Stats s;
+  return s;
+}
+
+uint64_t realUs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now() - kStart).count();
+}
+
+namespace {
+uint64_t realNs() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - kStart).count();
+}
+uint64_t g_offNs = 0;  // czas rzeczywisty pętli głównej spędzony w zadaniach i uśpieniach
+}  // namespace
+
+void addIdleNs(uint64_t ns) {
+  if (!inTask()) g_offNs += ns;
+}
+
+uint64_t nowUs() { return realUs() + stats().skippedUs; }
+
+namespace {
+
+// Zadanie to korutyna (ucontext) na wątku pętli głównej: przełączenie to
+// swapcontext, bez wątków i zmiennych warunkowych. Stos hosta jest większy niż
+// stos zadania na płytce – shimy (String, printf, FS) potrzebują więcej.
+const size_t kTaskStack = 1u << 20;
+
+struct Task {
+  int id;
+  std::string name;
+  void (*fn)(void*) = nullptr;
+  void* arg = nullptr;
+  int core = 1;
+  uint64_t wakeUs = 0;
+  uint64_t round = 0;  // ostatnia runda runDueTasks(), w której działało
+  bool done = false;
+  ucontext_t ctx;
+  std::unique_ptr<char[]> stack;
+};
+
+std::vector<Task*>& tasks() { static auto* v = new std::vector<Task*>; return *v; }
+ucontext_t g_mainCtx;
+Task* g_current = nullptr;           // nullptr = pętla główna
+uint64_t g_round = 0;
+
+void taskEntry() {
+  Task* t = g_current;
+  t->fn(t->arg);
+  t->done = true;                    // powrót do runTask() przez uc_link
+}
+
+// pętla główna: uruchom zadanie aż do jego następnego uśpienia
+void runTask(Task* t) {
+  ++stats().taskSwitches;
+  const uint64_t t0 = realNs();
+  g_current = t;
+  swapcontext(&g_mainCtx, &t->ctx);
+  g_current = nullptr;
+  g_offNs += realNs() - t0;
+}
+
+// zadanie: uśpij się do wakeUs i oddaj sterowanie pętli głównej
+void taskSleepUntil(uint64_t wakeUs) {
+  Task* t = g_current;
+  t->wakeUs = wakeUs;
+  swapcontext(&t->ctx, &g_mainCtx);
+}
+
+uint64_t nextWakeUs() {
+  uint64_t w = UINT64_MAX;
+  for (const Task* t : tasks())
+    if (!t->done && t->wakeUs < w) w = t->wakeUs;
+  return w;
+}
+
+}  // namespace
+
+void startTask(void (*fn)(void*), void* arg, const char* name, int core) {
+  Task* t = new Task;
+  t->id = (int)tasks().size() + 1;
+  t->name = name ? name : "task";
+  t->fn = fn;
+  t->arg = arg;
+  t->core = core;
+  t->wakeUs = nowUs();
+  t->stack.reset(new char[kTaskStack]);
+  getcontext(&t->ctx);
+  t->ctx.uc_stack.ss_sp = t->stack.get();
+  t->ctx.uc_stack.ss_size = kTaskStack;
+  t->ctx.uc_link = &g_mainCtx;
+  makecontext(&t->ctx, taskEntry, 0);
+  tasks().push_back(t);
+}
+
+bool inTask() { return g_current != nullptr; }
+
+int taskCore() { return g_current ? g_current->core : 1; }
+
+void runDueTasks() {
+  if (inTask()) return;
+  // każde zadanie najwyżej raz na rundę – zadanie kręcące się na yield() nie
+  // zagłodzi pętli głównej
+  const uint64_t round = ++g_round;
+  for (;;) {
+    const uint64_t now = nowUs();
+    Task* due = nullptr;
+    for (Task* t : tasks())
+      if (!t->done && t->round != round && t->wakeUs <= now &&
+          (!due || t->wakeUs < due->wakeUs)) due = t;
+    if (!due) return;
+    due->round = round;
+    runTask(due);
+  }
+}
+
+void sleepUs(uint64_t us) {
+  if (inTask()) {
+    taskSleepUntil(nowUs() + us);
+    return;
+  }
+  const uint64_t target = nowUs() + us;
+  for (;;) {
+    runDueTasks();
+    const uint64_t now = nowUs();
+    if (now >= target) return;
+    const uint64_t until = std::min(target, nextWakeUs());
+    if (until <= now) continue;
+    if (opts().virtualClock) {
+      stats().skippedUs += until - now;
+    } else {
+      const uint64_t t0 = realNs();
+      std::this_thread::sleep_for(std::chrono::microseconds(until - now));
+      g_offNs += realNs() - t0;
+    }
+  }
+}
+
+void yieldNow() {
+  if (inTask()) taskSleepUntil(nowUs());
+  else runDueTasks();
+}
+
+void spendUs(uint64_t us) {
+  stats().i2cBusyUs += us;
+  // czas magistrali w zadaniu (rdzeń 1) nie zatrzymuje pętli głównej
+  if (opts().virtualClock && !inTask()) stats().skippedUs += us;
+}
+
+uint64_t ioGraceUs() { return (250ULL + 4ULL * opts().standinRttMs) * 1000ULL; }
+
+int64_t epochNow() {
+  if (!opts().virtualClock) {
+    return (int64_t)std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+  }
+  int64_t base = opts().startEpoch ? opts().startEpoch : kStartEpoch;
+  return base + (int64_t)(nowUs() / 1000000ULL);
+}
+
+void setNetworkUp(bool up) { g_netUp = up; }
+bool networkUp() { return g_netUp; }
+
+double gaussian() {
+  static std::normal_distribution<double> nd(0.0, 1.0);
+  return nd(g_noise);
+}
+
+bool i2cPresent(uint8_t addr) {
+  if (addr < 0x68 || addr > 0x6F) return false;
+  return (opts().i2cPresentMask >> (addr - 0x68)) & 1;
+}
+
+double adcSignal(uint8_t addr, uint8_t ch, uint64_t tUs) {
+  unsigned idx = (unsigned)(addr - 0x68) * 4 + (ch & 3);
+  if (idx >= 32) return 0.0;
+  const AdcSignal& s = opts().adc[idx];
+  double v = s.offset;
+  if (s.amp != 0.0 && s.periodSec > 0.0)
+    v += s.amp * std::sin(2.0 * M_PI * ((double)tUs / 1e6) / s.periodSec);
+  if (s.noise > 0.0) v += s.noise * gaussian();
+  return v;
+}
+
+void wdtConfigure(uint32_t timeoutMs) {
+  g_wdtTimeoutMs = timeoutMs;
+  g_wdtLastUs = nowUs();
+}
+
+void wdtFeed() {
+  uint64_t now = nowUs();
+  if (g_wdtTimeoutMs && now - g_wdtLastUs > (uint64_t)g_wdtTimeoutMs * 1000ULL) {
+    ++stats().wdtMisses;
+    std::fprintf(stderr, "[esp_sim] task WDT would fire: %.1f s without reset\n",
+                 (double)(now - g_wdtLastUs) / 1e6);
+  }
+  g_wdtLastUs = now;
+  ++stats().wdtFeeds;
+}
+
+namespace {
+std::vector<ProfSlot*>& profSlots() {
+  static std::vector<ProfSlot*> v;
+  return v;
+}
+}  // namespace
+
+// sloty żyją do końca procesu (PROF_SCOPE trzyma referencję w zmiennej statycznej)
+ProfSlot& profSlot(const char* name) {
+  std::vector<ProfSlot*>& v = profSlots();
+  for (ProfSlot* p : v)
+    if (!strcmp(p->name, name)) return *p;
+  v.push_back(new ProfSlot{name});
+  return *v.back();
+}
+
+// cpu: zegar rzeczywisty bez zadań i uśpień (vDSO, bez wywołania systemowego
+// CLOCK_THREAD_CPUTIME_ID); sim: ten sam odczyt plus czas przeskoczony
+ProfScope::ProfScope(ProfSlot& slot)
+    : slot_(slot), real0_(realNs()), off0_(g_offNs), skip0_(stats().skippedUs) {}
+
+ProfScope::~ProfScope() {
+  const uint64_t real = realNs() - real0_;
+  ++slot_.calls;
+  slot_.cpuNs += real - (g_offNs - off0_);
+  slot_.simUs += real / 1000ULL + (stats().skippedUs - skip0_);
+}
+
+void printProfile(FILE* out) {
+  const std::vector<ProfSlot*>& v = profSlots();
+  if (v.empty()) return;
+  uint64_t total = 0;
+  for (const ProfSlot* p : v) total += p->cpuNs;
+  std::fprintf(out, "[esp_sim] %-12s %10s %12s %7s %12s\n", "module", "calls", "cpu[ms]", "cpu%",
+               "sim[s]");
+  for (const ProfSlot* p : v) {
+    std::fprintf(out, "[esp_sim] %-12s %10llu %12.1f %6.1f%% %12.1f\n", p->name,
+                 (unsigned long long)p->calls, (double)p->cpuNs / 1e6,
+                 total ? 100.0 * (double)p->cpuNs / (double)total : 0.0, (double)p->simUs / 1e6);
+  }
+}
+
+void printStats(FILE* out) {
+  const Stats& s = stats();
+  std::fprintf(out,
+               "[esp_sim] uptime=%.1fs (real %.1fs) loops=%llu\n"
+               "[esp_sim] i2c: transactions=%llu busy=%.1fms conversions=%llu\n"
+               "[esp_sim] fs: opens=%llu written=%llu B read=%llu B renames=%llu removes=%llu "
+               "commits=%llu erases=%llu\n"
+               "[esp_sim] tcp: connects=%llu fails=%llu out=%llu B in=%llu B http=%llu\n"
+               "[esp_sim] wdt: feeds=%llu misses=%llu tasks=%u switches=%llu\n",
+               (double)nowUs() / 1e6, (double)realUs() / 1e6, (unsigned long long)s.loops,
+               (unsigned long long)s.i2cTransactions, (double)s.i2cBusyUs / 1e3,
+               (unsigned long long)s.adcConversions,
+               (unsigned long long)s.fsOpens, (unsigned long long)s.fsBytesWritten,
+               (unsigned long long)s.fsBytesRead, (unsigned long long)s.fsRenames,
+               (unsigned long long)s.fsRemoves, (unsigned long long)s.fsCommits,
+               (unsigned long long)s.fsErases,
+               (unsigned long long)s.tcpConnects, (unsigned long long)s.tcpConnectFails,
+               (unsigned long long)s.tcpBytesOut, (unsigned long long)s.tcpBytesIn,
+               (unsigned long long)s.httpRequests,
+               (unsigned long long)s.wdtFeeds, (unsigned long long)s.wdtMisses,
+               (unsigned)tasks().size(), (unsigned long long)s.taskSwitches);
+}
+
+}  // namespace Sim
+
+// time(nullptr) szkicu (measurement.cpp, alarm.cpp, data_files.cpp...) idzie za
+// zegarem symulacji; localtime_r()/mktime() działają bez zmian (TZ=UTC0).
+extern "C" time_t time(time_t* t) noexcept {
+  time_t v = (time_t)Sim::epochNow();
+  if (t) *t = v;
+  return v;
+}
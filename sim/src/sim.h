@@ -0,0 +1,139 @@
+// sim.h – warstwa symulacji esp_sim: opcje uruchomienia, zegar, łącze, sygnały
+// wejściowe (MCP3424, GPIO) i liczniki zbierane przez shimy.
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+
+namespace Sim {
+
+// Sygnał na wejściu kanału MCP3424: offset + amp*sin(2*pi*t/period) + szum (sigma) [V]
+struct AdcSignal {
+  double offset = 0.0;
+  double amp = 0.0;
+  double periodSec = 600.0;
+  double noise = 0.0;
+};
+
+struct Options {
+  std::string fsRoot = "esp_sim_fs";  // katalog hosta udający partycję LittleFS
+  int httpPort = 8080;                // port 80 szkicu -> ten port hosta
+  bool quiet = false;                 // bez wyjścia Serial (UART0) na stdout
+  bool psram = true;                  // psramFound(); --no-psram = płytka bez PSRAM
+  uint8_t mac[6] = {0x24, 0x6F, 0x28, 0x5A, 0x3C, 0x01};
+  double runSec = 0;                  // 0 = bez limitu
+  uint32_t seed = 1;                  // random()/esp_random() – powtarzalne przebiegi
+  uint8_t i2cPresentMask = 0x41;      // bit n = układ pod 0x68+n (domyślnie 0x68 i 0x6E)
+  AdcSignal adc[32];                  // kanał 0..31 = (adres-0x68)*4 + CHx
+  std::map<int, int> pinInputs;       // wymuszone poziomy wejść GPIO
+  bool standins = false;              // uruchom stand-iny FTP/SMTP/POP3/MQTT w procesie
+  int standinBasePort = 2121;         // FTP=base, SMTP=base+1, POP3=base+2, MQTT=base+3
+  std::string standinFtpRoot = "esp_sim_ftp";
+  uint32_t standinRttMs = 0;          // opóźnienie odpowiedzi stand-inów (łącze GSM)
+  uint32_t standinFtpCut = 0;         // profil strat: zerwanie DATA po N bajtach wysyłki
+  uint32_t standinFtpCutPct = 100;    // ... w tylu % przesyłów
+  bool seedLocalConfig = false;       // zapisz config.json/email.json wskazujące na stand-iny
+  bool virtualClock = false;          // delay()/czas I2C przesuwają zegar zamiast czekać
+  int64_t startEpoch = 0;             // time(nullptr) na starcie zegara wirtualnego (0 = teraz)
+  double reportSec = 0;               // co ile (czasu symulacji) raport postępu na stderr
+};
+
+Options& opts();
+
+// --- zegar (monotoniczny od startu procesu)
+// Z --virtual-clock nowUs() = czas rzeczywisty + suma „przeskoczonych” delay(),
+// a time(nullptr) liczy się od startEpoch tym samym zegarem. Dzięki temu millis(),
+// time() i delay() szkicu idą razem, a doba harmonogramu mija w sekundy.
+uint64_t nowUs();
+uint64_t realUs();
+void sleepUs(uint64_t us);
+// koszt czasu operacji sprzętowej (np. transakcji I2C), liczony w statystykach;
+// przy zegarze wirtualnym przesuwa go (na płytce to realny czas magistrali)
+void spendUs(uint64_t us);
+// ile czasu rzeczywistego gniazdo czeka na odpowiedź rozmówcy, zanim zegar
+// wirtualny znowu zacznie przeskakiwać (limity czasu klientów nadal działają)
+uint64_t ioGraceUs();
+int64_t epochNow();
+// oddaje sterowanie zadaniom, którym minął czas budzenia (yield()/delay(0))
+void yieldNow();
+
+// --- zadania FreeRTOS (xTaskCreatePinnedToCore)
+// Każde zadanie to korutyna na wątku pętli głównej: pętla główna oddaje
+// sterowanie w sleepUs()/yieldNow() (delay(), yield(), czekanie na gniazdo)
+// zadaniom z minionym czasem budzenia, a zadanie oddaje je z powrotem, gdy samo
+// zasypia (vTaskDelay/xTaskDelayUntil/delay). Shimy nie potrzebują więc blokad,
+// a zegar wirtualny przesuwa tylko pętla główna – skacze najwyżej do
+// najbliższego budzenia zadania, więc okres zadania jest zachowany.
+void startTask(void (*fn)(void*), void* arg, const char* name, int core);
+bool inTask();
+int taskCore();                       // rdzeń bieżącego kontekstu (pętla główna: 1)
+void runDueTasks();
+// czas rzeczywisty, w którym pętla główna czekała (np. poll() na gnieździe) –
+// nie wlicza się do cpu[ms] profilu
+void addIdleNs(uint64_t ns);
+
+// --- łącze sieciowe (WiFi.status(), TinyGsm, connect())
+void setNetworkUp(bool up);
+bool networkUp();
+
+// --- wejścia
+double adcSignal(uint8_t i2cAddr, uint8_t ch, uint64_t tUs);
+bool i2cPresent(uint8_t i2cAddr);
+double gaussian();
+
+// --- watchdog (esp_task_wdt)
+void wdtConfigure(uint32_t timeoutMs);
+void wdtFeed();
+
+// --- liczniki
+struct Stats {
+  uint64_t i2cTransactions = 0;
+  uint64_t i2cBusyUs = 0;
+  uint64_t adcConversions = 0;
+  uint64_t fsOpens = 0;
+  uint64_t fsBytesWritten = 0;
+  uint64_t fsBytesRead = 0;
+  uint64_t fsRenames = 0;
+  uint64_t fsRemoves = 0;
+  uint64_t fsCommits = 0;             // commity metadanych LittleFS (sync/close, create, rename...)
+  uint64_t fsErases = 0;              // kasowania bloków 4 kB wg modelu w fs_littlefs.cpp
+  uint64_t tcpConnects = 0;
+  uint64_t tcpConnectFails = 0;
+  uint64_t tcpBytesOut = 0;
+  uint64_t tcpBytesIn = 0;
+  uint64_t httpRequests = 0;
+  uint64_t wdtFeeds = 0;
+  uint64_t wdtMisses = 0;
+  uint64_t loops = 0;
+  uint64_t skippedUs = 0;             // czas przeskoczony przez zegar wirtualny
+  uint64_t taskSwitches = 0;          // przekazania sterowania do zadań FreeRTOS
+};
+Stats& stats();
+void printStats(FILE* out);
+
+// --- profil CPU modułów (PROF_SCOPE z prof.h szkicu)
+struct ProfSlot {
+  const char* name;
+  uint64_t calls = 0;
+  uint64_t cpuNs = 0;   // czas pracy pętli głównej (bez zadań i uśpień)
+  uint64_t simUs = 0;   // czas zegara symulacji (z delay()/I/O)
+};
+ProfSlot& profSlot(const char* name);
+void printProfile(FILE* out);
+
+class ProfScope {
+ public:
+  explicit ProfScope(ProfSlot& slot);
+  ~ProfScope();
+  ProfScope(const ProfScope&) = delete;
+  ProfScope& operator=(const ProfScope&) = delete;
+
+ private:
+  ProfSlot& slot_;
+  uint64_t real0_;  // jeden odczyt zegara na brzeg zakresu
+  uint64_t off0_;
+  uint64_t skip0_;
+};
+
+}  // namespace Sim
@@ -0,0 +1,287 @@
+// sim_main.cpp – main() esp_sim: opcje, stand-iny, setup()/loop() szkicu.
+//
+//   esp_sim [--fs DIR] [--run-sec S] [--http-port P] [--quiet] [--seed N]
+//           [--mac AA:BB:CC:DD:EE:FF] [--i2c-mask 0x41]
+//           [--adc IDX=offset,amp,periodSec,noise] [--pin N=0|1]
+//           [--standins] [--standin-base-port P] [--standin-ftp-root DIR] [--standin-rtt-ms N]
+//           [--standin-ftp-cut N] [--standin-ftp-cut-pct P]
+//           [--seed-local] [--virtual-clock] [--start-epoch E] [--days D] [--report-sec S]
+//           [--no-psram]
+//
+// Soak: --days 30 --quiet --standins --seed-local  => 30 dób harmonogramu
+// (zegar wirtualny) w kilka minut, raport co dobę i podsumowanie na stderr.
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <LittleFS.h>
+
+#include <algorithm>
+#include <csignal>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include "config.h"
+#include "data_files.h"
+#include "ftp_queue.h"
+#include "sim.h"
+#include "standins.h"
+
+namespace {
+
+std::vector<char*> g_argv;
+volatile std::sig_atomic_t g_stop = 0;
+
+void usage(const char* argv0) {
+  fprintf(stderr,
+          "usage: %s [--fs DIR] [--run-sec S] [--http-port P] [--quiet] [--seed N]\n"
+          "          [--mac AA:BB:CC:DD:EE:FF] [--i2c-mask M] [--adc IDX=off,amp,period,noise]\n"
+          "          [--pin N=0|1] [--standins] [--standin-base-port P] [--standin-ftp-root DIR]\n"
+          "          [--standin-rtt-ms N] [--standin-ftp-cut N] [--standin-ftp-cut-pct P]\n"
+          "          [--seed-local] [--virtual-clock] [--start-epoch E]\n"
+          "          [--days D] [--report-sec S] [--no-psram]\n",
+          argv0);
+}
+
+bool parseArgs(int argc, char** argv) {
+  Sim::Options& o = Sim::opts();
+  for (int i = 1; i < argc; ++i) {
+    const char* a = argv[i];
+    auto next = [&]() -> const char* {
+      if (i + 1 >= argc) {
+        fprintf(stderr, "brak wartości dla %s\n", a);
+        exit(2);
+      }
+      return argv[++i];
+    };
+    if (!strcmp(a, "--fs")) o.fsRoot = next();
+    else if (!strcmp(a, "--run-sec")) o.runSec = atof(next());
+    else if (!strcmp(a, "--http-port")) o.httpPort = atoi(next());
+    else if (!strcmp(a, "--quiet")) o.quiet = true;
+    else if (!strcmp(a, "--no-psram")) o.psram = false;
+    else if (!strcmp(a, "--seed")) o.seed = (uint32_t)strtoul(next(), nullptr, 0);
+    else if (!strcmp(a, "--i2c-mask")) o.i2cPresentMask = (uint8_t)strtoul(next(), nullptr, 0);
+    else if (!strcmp(a, "--mac")) {
+      unsigned m[6];
+      if (sscanf(next(), "%x:%x:%x:%x:%x:%x", &m[0], &m[1], &m[2], &m[3], &m[4], &m[5]) != 6) return false;
+      for (int k = 0; k < 6; ++k) o.mac[k] = (uint8_t)m[k];
+    } else if (!strcmp(a, "--adc")) {
+      unsigned idx;
+      Sim::AdcSignal s;
+      int n = sscanf(next(), "%u=%lf,%lf,%lf,%lf", &idx, &s.offset, &s.amp, &s.periodSec, &s.noise);
+      if (n < 2 || idx >= 32) return false;
+      o.adc[idx] = s;
+    } else if (!strcmp(a, "--pin")) {
+      int pin, lvl;
+      if (sscanf(next(), "%d=%d", &pin, &lvl) != 2) return false;
+      o.pinInputs[pin] = lvl;
+    } else if (!strcmp(a, "--standins")) o.standins = true;
+    else if (!strcmp(a, "--standin-base-port")) o.standinBasePort = atoi(next());
+    else if (!strcmp(a, "--standin-ftp-root")) o.standinFtpRoot = next();
+    else if (!strcmp(a, "--standin-rtt-ms")) o.standinRttMs = (uint32_t)atoi(next());
+    else if (!strcmp(a, "--standin-ftp-cut")) o.standinFtpCut = (uint32_t)strtoul(next(), nullptr, 0);
+    else if (!strcmp(a, "--standin-ftp-cut-pct")) o.standinFtpCutPct = (uint32_t)atoi(next());
+    else if (!strcmp(a, "--seed-local")) o.seedLocalConfig = true;
+    else if (!strcmp(a, "--virtual-clock")) o.virtualClock = true;
+    else if (!strcmp(a, "--start-epoch")) o.startEpoch = strtoll(next(), nullptr, 0);
+    else if (!strcmp(a, "--days")) {
+      o.runSec = atof(next()) * 86400.0;
+      o.virtualClock = true;
+      if (o.reportSec == 0) o.reportSec = 86400.0;
+    } else if (!strcmp(a, "--report-sec")) o.reportSec = atof(next());
+    else return false;
+  }
+  return true;
+}
+
+// Domyślne sygnały: 0x68 CH1..4 i 0x6E CH1..4 (A001..A008) w różnych zakresach PGA.
+void defaultSignals() {
+  static const double offsets[8] = {0.120, 0.350, 0.700, 1.500, 0.050, 0.200, 0.450, 0.900};
+  for (int k = 0; k < 8; ++k) {
+    Sim::AdcSignal& s = Sim::opts().adc[k < 4 ? k : 24 + (k - 4)];
+    s.offset = offsets[k];
+    s.amp = offsets[k] * 0.05;
+    s.periodSec = 600.0 + 60.0 * k;
+    s.noise = 0.0002;
+  }
+}
+
+bool writeJsonFile(const char* path, JsonDocument& doc) {
+  File f = LittleFS.open(path, "w");
+  if (!f) return false;
+  serializeJsonPretty(doc, f);
+  f.close();
+  return true;
+}
+
+// config.json / email.json wskazujące na lokalne stand-iny (przed setup(), więc
+// Config::begin() i EmailCfg::load() od razu je widzą).
+void seedLocalConfig() {
+  const Sim::Options& o = Sim::opts();
+  if (!LittleFS.begin(true)) return;
+
+  JsonDocument cfg;
+  if (File f = LittleFS.open("/config.json", "r")) {
+    deserializeJson(cfg, f);
+    f.close();
+  }
+  cfg["net_mode"] = "wifi";
+  cfg["wifi_ssid"] = "esp_sim";
+  cfg["mqtt_host"] = "127.0.0.1";
+  cfg["mqtt_port"] = o.standinBasePort + 3;
+  cfg["ftp_host"] = "127.0.0.1";
+  cfg["ftp_port"] = o.standinBasePort;
+  if (!cfg.containsKey("ftp_dir")) cfg["ftp_dir"] = "/Dane";
+  writeJsonFile("/config.json", cfg);
+
+  JsonDocument em;
+  if (File f = LittleFS.open("/email.json", "r")) {
+    deserializeJson(em, f);
+    f.close();
+  }
+  em["smtp_host"] = "127.0.0.1";
+  em["smtp_port"] = o.standinBasePort + 1;
+  em["pop3_host"] = "127.0.0.1";
+  em["pop3_port"] = o.standinBasePort + 2;
+  if (!em.containsKey("user")) em["user"] = "esp_sim@localhost";
+  if (!em.containsKey("pass")) em["pass"] = "esp_sim";
+  writeJsonFile("/email.json", em);
+
+  // katalog zdalny z configu musi istnieć na serwerze
+  String dir = cfg["ftp_dir"].as<String>();
+  if (o.standins && dir.length()) {
+    std::string p = o.standinFtpRoot;
+    ::mkdir(p.c_str(), 0755);
+    p += dir.startsWith("/") ? dir.c_str() : ("/" + dir).c_str();
+    ::mkdir(p.c_str(), 0755);
+  }
+}
+
+String utcStamp(time_t t) {
+  struct tm tmv;
+  gmtime_r(&t, &tmv);
+  char b[24];
+  strftime(b, sizeof(b), "%Y-%m-%d %H:%M:%S", &tmv);
+  return String(b);
+}
+
+// Raport postępu (co --report-sec czasu symulacji): wzrost D_<MAC>.txt, kolejka, FS.
+void printProgress() {
+  const FTPQ::Stats q = FTPQ::stats();
+  fprintf(stderr,
+          "[esp_sim] t=%.2fd (%s, real %.1fs) %s=%u B fs_used=%u B written=%llu B "
+          "ftpq=%u ok=%u fail=%u drop=%u\n",
+          (double)Sim::nowUs() / 86400e6, utcStamp(time(nullptr)).c_str(),
+          (double)Sim::realUs() / 1e6, DataFiles::pathCurrent().c_str(),
+          (unsigned)DataFiles::fileSize(DataFiles::pathCurrent()), (unsigned)LittleFS.usedBytes(),
+          (unsigned long long)Sim::stats().fsBytesWritten, (unsigned)q.size, (unsigned)q.uploadsOk,
+          (unsigned)q.failures, (unsigned)q.dropped);
+}
+
+// Pliki w katalogu stand-inu FTP (nazwy D_<MAC>_<epoch>.txt pokazują krawędzie od 12:00).
+void printRemoteUploads(const std::string& dir) {
+  std::vector<std::string> names;
+  if (DIR* d = opendir(dir.c_str())) {
+    while (dirent* e = readdir(d))
+      if (e->d_name[0] != '.') names.push_back(e->d_name);
+    closedir(d);
+  }
+  std::sort(names.begin(), names.end());
+  fprintf(stderr, "[esp_sim] ftp %s: %u files\n", dir.c_str(), (unsigned)names.size());
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (i == 3 && names.size() > 6) {
+      fprintf(stderr, "[esp_sim]   ...\n");
+      i = names.size() - 3;
+    }
+    const char* us = strrchr(names[i].c_str(), '_');
+    long long ep = us ? atoll(us + 1) : 0;
+    fprintf(stderr, "[esp_sim]   %s%s%s\n", names[i].c_str(), ep ? "  " : "",
+            ep ? utcStamp((time_t)ep).c_str() : "");
+  }
+}
+
+void printSummary() {
+  fflush(stdout);
+  Sim::printStats(stderr);
+  Sim::printProfile(stderr);
+
+  const FTPQ::Stats q = FTPQ::stats();
+  fprintf(stderr, "[esp_sim] ftpq: size=%u uploads=%u failures=%u retries=%u dropped=%u\n",
+          (unsigned)q.size, (unsigned)q.uploadsOk, (unsigned)q.failures, (unsigned)q.retries,
+          (unsigned)q.dropped);
+
+  fprintf(stderr, "[esp_sim] littlefs: used=%u/%u B\n", (unsigned)LittleFS.usedBytes(),
+          (unsigned)LittleFS.totalBytes());
+  if (File root = LittleFS.open("/")) {
+    for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+      if (!f.isDirectory()) fprintf(stderr, "[esp_sim]   /%-28s %8u B\n", f.name(), (unsigned)f.size());
+    }
+  }
+
+  const Sim::Options& o = Sim::opts();
+  if (o.standins) {
+    Standins::printCounters(stderr);
+    String dir = Config::get().ftp_dir;
+    printRemoteUploads(o.standinFtpRoot + (dir.startsWith("/") ? "" : "/") + dir.c_str());
+  }
+}
+
+}  // namespace
+
+void EspClass::restart() {
+  fprintf(stderr, "[esp_sim] ESP.restart()\n");
+  printSummary();
+  if (Sim::opts().standins) Standins::stop();
+  execv("/proc/self/exe", g_argv.data());
+  perror("[esp_sim] execv");
+  _exit(1);
+}
+
+int main(int argc, char** argv) {
+  g_argv.assign(argv, argv + argc);
+  g_argv.push_back(nullptr);
+
+  defaultSignals();
+  if (!parseArgs(argc, argv)) {
+    usage(argv[0]);
+    return 2;
+  }
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  setenv("TZ", "UTC0", 1);
+  tzset();
+
+  Sim::Options& o = Sim::opts();
+  if (o.standins) {
+    Standins::Options so;
+    so.ftpPort = o.standinBasePort;
+    so.smtpPort = o.standinBasePort + 1;
+    so.pop3Port = o.standinBasePort + 2;
+    so.mqttPort = o.standinBasePort + 3;
+    so.ftpRoot = o.standinFtpRoot;
+    so.rttMs = o.standinRttMs;
+    so.ftpCutBytes = o.standinFtpCut;
+    so.ftpCutPct = o.standinFtpCutPct;
+    if (!Standins::start(so)) return 1;
+  }
+  if (o.seedLocalConfig) seedLocalConfig();
+
+  std::signal(SIGINT, [](int) { g_stop = 1; });
+  std::signal(SIGTERM, [](int) { g_stop = 1; });
+
+  setup();
+  const uint64_t limitUs = (uint64_t)(o.runSec * 1e6);
+  const uint64_t reportUs = (uint64_t)(o.reportSec * 1e6);
+  uint64_t nextReportUs = reportUs;
+  while (!g_stop && (limitUs == 0 || Sim::nowUs() < limitUs)) {
+    loop();
+    ++Sim::stats().loops;
+    if (reportUs && Sim::nowUs() >= nextReportUs) {
+      printProgress();
+      nextReportUs += reportUs;
+    }
+  }
+
+  printSummary();
+  if (o.standins) Standins::stop();
+  return 0;
+}
@@ -0,0 +1,347 @@
+// web_server.cpp – WebServer (ESP32 API) na gnieździe nasłuchującym hosta.
+#include <WebServer.h>
+#include <base64.h>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+namespace {
+
+const int kRequestTimeoutMs = 2000;
+// accept() najwyżej co tyle czasu rzeczywistego: z zegarem wirtualnym pętla
+// główna woła handleClient() dziesiątki razy na milisekundę
+const uint64_t kAcceptPollUs = 1000;
+
+const char* statusText(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 206: return "Partial Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 416: return "Range Not Satisfiable";
+    case 500: return "Internal Server Error";
+    case 503: return "Service Unavailable";
+    default: return "";
+  }
+}
+
+int hexVal(char c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+String urlDecode(const std::string& s) {
+  std::string out;
+  out.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (s[i] == '+') {
+      out += ' ';
+    } else if (s[i] == '%' && i + 2 < s.size() && hexVal(s[i + 1]) >= 0 && hexVal(s[i + 2]) >= 0) {
+      out += (char)(hexVal(s[i + 1]) * 16 + hexVal(s[i + 2]));
+      i += 2;
+    } else {
+      out += s[i];
+    }
+  }
+  return String(std::move(out));
+}
+
+HTTPMethod parseMethod(const std::string& m) {
+  if (m == "GET") return HTTP_GET;
+  if (m == "HEAD") return HTTP_HEAD;
+  if (m == "POST") return HTTP_POST;
+  if (m == "PUT") return HTTP_PUT;
+  if (m == "PATCH") return HTTP_PATCH;
+  if (m == "DELETE") return HTTP_DELETE;
+  if (m == "OPTIONS") return HTTP_OPTIONS;
+  return HTTP_ANY;
+}
+
+// czyta do 'n' bajtów z limitem czasu; false przy zamknięciu/timeout
+bool recvSome(int fd, std::string& buf, uint64_t deadlineUs) {
+  for (;;) {
+    uint64_t now = Sim::nowUs();
+    if (now >= deadlineUs) return false;
+    pollfd p{fd, POLLIN, 0};
+    int rc = ::poll(&p, 1, (int)((deadlineUs - now) / 1000 + 1));
+    if (rc < 0 && errno == EINTR) continue;
+    if (rc <= 0) return false;
+    char tmp[2048];
+    ssize_t r = ::recv(fd, tmp, sizeof(tmp), 0);
+    if (r <= 0) return false;
+    Sim::stats().tcpBytesIn += (uint64_t)r;
+    buf.append(tmp, (size_t)r);
+    return true;
+  }
+}
+
+}  // namespace
+
+WebServer::WebServer(int port) : port_(port) {}
+
+WebServer::~WebServer() { stop(); }
+
+void WebServer::begin() {
+  stop();
+  int s = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (s < 0) return;
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  // obiekt szkicu jest statyczny – mapowanie portu dopiero po parsowaniu opcji
+  const int port = port_ == 80 ? Sim::opts().httpPort : port_;
+  a.sin_port = htons((uint16_t)port);
+  a.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (::bind(s, (sockaddr*)&a, sizeof(a)) != 0 || ::listen(s, 8) != 0) {
+    fprintf(stderr, "[esp_sim] WebServer: port %d niedostępny (%s)\n", port, strerror(errno));
+    ::close(s);
+    return;
+  }
+  listenFd_ = s;
+}
+
+void WebServer::stop() {
+  if (listenFd_ >= 0) ::close(listenFd_);
+  listenFd_ = -1;
+}
+
+void WebServer::on(const String& uri, HTTPMethod method, THandlerFunction fn) {
+  routes_.push_back(Route{uri, method, fn});
+}
+
+void WebServer::handleClient() {
+  if (listenFd_ < 0) return;
+  const uint64_t now = Sim::realUs();
+  if (now - lastAcceptUs_ < kAcceptPollUs) return;
+  lastAcceptUs_ = now;
+  int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) return;
+  client_ = WiFiClient::fromFd(fd);
+  ++Sim::stats().httpRequests;
+  if (readRequest()) {
+    dispatch();
+    finishResponse();
+  }
+  client_.stop();
+  args_.clear();
+  reqHeaders_.clear();
+  respHeaders_.clear();
+}
+
+bool WebServer::readRequest() {
+  const int fd = client_.fd();
+  const uint64_t deadline = Sim::nowUs() + (uint64_t)kRequestTimeoutMs * 1000ULL;
+  std::string buf;
+  size_t hdrEnd;
+  while ((hdrEnd = buf.find("\r\n\r\n")) == std::string::npos) {
+    if (buf.size() > 16384 || !recvSome(fd, buf, deadline)) return false;
+  }
+
+  // linia żądania
+  size_t eol = buf.find("\r\n");
+  std::string line = buf.substr(0, eol);
+  size_t sp1 = line.find(' '), sp2 = line.rfind(' ');
+  if (sp1 == std::string::npos || sp2 == sp1) return false;
+  method_ = parseMethod(line.substr(0, sp1));
+  std::string target = line.substr(sp1 + 1, sp2 - sp1 - 1);
+  std::string query;
+  size_t q = target.find('?');
+  if (q != std::string::npos) {
+    query = target.substr(q + 1);
+    target.resize(q);
+  }
+  uri_ = urlDecode(target);
+
+  // nagłówki
+  size_t pos = eol + 2;
+  size_t contentLen = 0;
+  std::string contentType;
+  while (pos < hdrEnd) {
+    size_t e = buf.find("\r\n", pos);
+    std::string h = buf.substr(pos, e - pos);
+    pos = e + 2;
+    size_t c = h.find(':');
+    if (c == std::string::npos) continue;
+    std::string k = h.substr(0, c), v = h.substr(c + 1);
+    while (!v.empty() && v[0] == ' ') v.erase(0, 1);
+    reqHeaders_.push_back(KV{String(k), String(v)});
+    if (strcasecmp(k.c_str(), "Content-Length") == 0) contentLen = strtoul(v.c_str(), nullptr, 10);
+    if (strcasecmp(k.c_str(), "Content-Type") == 0) contentType = v;
+  }
+
+  // ciało
+  std::string body = buf.substr(hdrEnd + 4);
+  while (body.size() < contentLen) {
+    if (!recvSome(fd, body, deadline)) return false;
+  }
+  body.resize(std::min(body.size(), contentLen));
+
+  auto parseArgs = [this](const std::string& s) {
+    size_t i = 0;
+    while (i <= s.size() && !s.empty()) {
+      size_t amp = s.find('&', i);
+      std::string kv = s.substr(i, amp == std::string::npos ? std::string::npos : amp - i);
+      if (!kv.empty()) {
+        size_t eq = kv.find('=');
+        if (eq == std::string::npos) args_.push_back(KV{urlDecode(kv), String()});
+        else args_.push_back(KV{urlDecode(kv.substr(0, eq)), urlDecode(kv.substr(eq + 1))});
+      }
+      if (amp == std::string::npos) break;
+      i = amp + 1;
+    }
+  };
+  parseArgs(query);
+  if (!body.empty()) {
+    if (contentType.find("application/x-www-form-urlencoded") != std::string::npos) parseArgs(body);
+    else args_.push_back(KV{String("plain"), String(body)});
+  }
+  return true;
+}
+
+void WebServer::dispatch() {
+  contentLength_ = CONTENT_LENGTH_NOT_SET;
+  headersSent_ = false;
+  chunked_ = false;
+  for (const Route& r : routes_) {
+    if (r.uri != uri_) continue;
+    if (r.method != HTTP_ANY && r.method != method_ &&
+        !(r.method == HTTP_GET && method_ == HTTP_HEAD))
+      continue;
+    r.fn();
+    return;
+  }
+  if (notFound_) notFound_();
+  else send(404, "text/plain", "Not found: " + uri_);
+}
+
+void WebServer::finishResponse() {
+  if (chunked_) writeAll("0\r\n\r\n", 5);
+  else if (!headersSent_) send(500, "text/plain", "Handler did not handle the request");
+  chunked_ = false;
+}
+
+String WebServer::arg(const String& name) const {
+  for (const KV& kv : args_)
+    if (kv.key == name) return kv.value;
+  return String();
+}
+
+String WebServer::arg(int i) const { return i >= 0 && i < (int)args_.size() ? args_[i].value : String(); }
+String WebServer::argName(int i) const { return i >= 0 && i < (int)args_.size() ? args_[i].key : String(); }
+
+bool WebServer::hasArg(const String& name) const {
+  for (const KV& kv : args_)
+    if (kv.key == name) return true;
+  return false;
+}
+
+String WebServer::header(const String& name) const {
+  for (const KV& kv : reqHeaders_)
+    if (kv.key.equalsIgnoreCase(name)) return kv.value;
+  return String();
+}
+
+bool WebServer::hasHeader(const String& name) const {
+  for (const KV& kv : reqHeaders_)
+    if (kv.key.equalsIgnoreCase(name)) return true;
+  return false;
+}
+
+bool WebServer::authenticate(const char* user, const char* pass) {
+  String a = header("Authorization");
+  if (!a.startsWith("Basic ")) return false;
+  String cred = a.substring(6);
+  cred.trim();
+  return cred == base64::encode(String(user ? user : "") + ":" + (pass ? pass : ""));
+}
+
+void WebServer::requestAuthentication() {
+  sendHeader("WWW-Authenticate", "Basic realm=\"Login Required\"");
+  send(401, "text/plain", "Unauthorized");
+}
+
+void WebServer::sendHeader(const String& name, const String& value, bool first) {
+  if (first) respHeaders_.insert(respHeaders_.begin(), KV{name, value});
+  else respHeaders_.push_back(KV{name, value});
+}
+
+bool WebServer::writeAll(const char* p, size_t n) {
+  return client_.write((const uint8_t*)p, n) == n;
+}
+
+void WebServer::sendHeaders(int code, const char* contentType, size_t length) {
+  std::string h = "HTTP/1.1 " + std::to_string(code) + " " + statusText(code) + "\r\n";
+  h += "Content-Type: ";
+  h += contentType && *contentType ? contentType : "text/html";
+  h += "\r\n";
+  if (length == CONTENT_LENGTH_UNKNOWN) {
+    chunked_ = true;
+    h += "Transfer-Encoding: chunked\r\n";
+  } else {
+    h += "Content-Length: " + std::to_string(length) + "\r\n";
+  }
+  for (const KV& kv : respHeaders_) h += std::string(kv.key.c_str()) + ": " + kv.value.c_str() + "\r\n";
+  h += "Connection: close\r\n\r\n";
+  respHeaders_.clear();
+  headersSent_ = true;
+  writeAll(h.data(), h.size());
+}
+
+void WebServer::send(int code, const char* contentType, const String& content) {
+  if (headersSent_) return;
+  size_t len = contentLength_ == CONTENT_LENGTH_NOT_SET ? content.length() : contentLength_;
+  sendHeaders(code, contentType, len);
+  if (method_ == HTTP_HEAD) return;
+  if (content.length()) sendContent(content);
+}
+
+void WebServer::sendContent(const char* content, size_t size) {
+  if (method_ == HTTP_HEAD) return;
+  if (!chunked_) {
+    writeAll(content, size);
+    return;
+  }
+  if (size == 0) {
+    // pusty fragment kończy odpowiedź chunked
+    writeAll("0\r\n\r\n", 5);
+    chunked_ = false;
+    return;
+  }
+  char hdr[16];
+  int n = snprintf(hdr, sizeof(hdr), "%zx\r\n", size);
+  writeAll(hdr, (size_t)n);
+  writeAll(content, size);
+  writeAll("\r\n", 2);
+}
+
+size_t WebServer::streamFile(File& file, const String& contentType, int code) {
+  setContentLength(file.size());
+  send(code, contentType.c_str(), String());
+  if (method_ == HTTP_HEAD) return 0;
+  size_t total = 0;
+  uint8_t buf[1460];
+  for (;;) {
+    int r = file.read(buf, sizeof(buf));
+    if (r <= 0) break;
+    if (!writeAll((const char*)buf, (size_t)r)) break;
+    total += (size_t)r;
+  }
+  return total;
+}
@@ -0,0 +1,238 @@
+// wifi_client.cpp – WiFiClient na gniazdach POSIX, WiFi i TinyGsm sterowane
+// flagą łącza Sim::networkUp().
+#include <WiFi.h>
+#include <TinyGsmClient.h>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "sim.h"
+
+namespace {
+const int32_t kConnectTimeoutMs = 3000;  // jak WIFI_CLIENT_DEF_CONN_TIMEOUT_MS
+// bezczynne gniazdo (np. MQTT między pingami) jest sprawdzane najwyżej co tyle
+// czasu rzeczywistego – pętla główna pyta o nie w każdym przebiegu
+const uint64_t kIdlePollUs = 1000;
+}
+
+// Zegar wirtualny nie może przeskoczyć czasu, w którym rozmówca (stand-in) ma
+// odpowiedzieć: po wysłaniu danych gniazdo jest „zajęte” i available()/read()
+// czekają na nie naprawdę (po 1 ms), aż minie Sim::ioGraceUs() od ostatniego I/O.
+struct WiFiClient::Sock {
+  int fd = -1;
+  bool idle = true;       // rozmówca nic nie jest winien
+  uint64_t lastIoUs = 0;  // Sim::realUs() ostatniego zapisu/odczytu
+  uint64_t quietUs = 0;   // Sim::realUs() ostatniego sprawdzenia bez danych
+  ~Sock() { closeFd(); }
+  void closeFd() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+  }
+  void touch(bool sent) {
+    lastIoUs = Sim::realUs();
+    quietUs = 0;
+    if (sent) idle = false;
+  }
+  // bezczynne i niedawno sprawdzone bez danych: bez wywołań systemowych
+  bool quiet() const { return idle && quietUs && Sim::realUs() - quietUs < kIdlePollUs; }
+  // true, gdy coś mogło nadejść w trakcie oczekiwania
+  bool waitPeer() {
+    if (!Sim::opts().virtualClock || idle) return false;
+    if (Sim::realUs() - lastIoUs >= Sim::ioGraceUs()) {
+      idle = true;
+      return false;
+    }
+    Sim::runDueTasks();  // na płytce zadanie na rdzeniu 1 działa dalej
+    pollfd p{fd, POLLIN, 0};
+    const uint64_t t0 = Sim::realUs();
+    const bool rc = ::poll(&p, 1, 1) == 1;
+    Sim::addIdleNs((Sim::realUs() - t0) * 1000ULL);
+    return rc;
+  }
+};
+
+WiFiClient::WiFiClient() = default;
+WiFiClient::~WiFiClient() = default;
+
+int WiFiClient::fd() const { return sock_ ? sock_->fd : -1; }
+
+WiFiClient WiFiClient::fromFd(int fd) {
+  WiFiClient c;
+  c.sock_ = std::make_shared<Sock>();
+  c.sock_->fd = fd;
+  return c;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port) {
+  return connect(ip.toString().c_str(), port, kConnectTimeoutMs);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port) {
+  return connect(host, port, kConnectTimeoutMs);
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+  if (!host || !*host || !Sim::networkUp()) {
+    ++Sim::stats().tcpConnectFails;
+    return 0;
+  }
+
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* res = nullptr;
+  char portStr[8];
+  snprintf(portStr, sizeof(portStr), "%u", (unsigned)port);
+  if (getaddrinfo(host, portStr, &hints, &res) != 0 || !res) {
+    ++Sim::stats().tcpConnectFails;
+    return 0;
+  }
+
+  int s = ::socket(res->ai_family, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+  if (s < 0) {
+    freeaddrinfo(res);
+    ++Sim::stats().tcpConnectFails;
+    return 0;
+  }
+  int rc = ::connect(s, res->ai_addr, res->ai_addrlen);
+  freeaddrinfo(res);
+  if (rc != 0 && errno == EINPROGRESS) {
+    pollfd p{s, POLLOUT, 0};
+    rc = ::poll(&p, 1, timeoutMs > 0 ? timeoutMs : kConnectTimeoutMs);
+    int err = 0;
+    socklen_t len = sizeof(err);
+    if (rc == 1 && getsockopt(s, SOL_SOCKET, SO_ERROR, &err, &len) == 0 && err == 0) rc = 0;
+    else rc = -1;
+  }
+  if (rc != 0) {
+    ::close(s);
+    ++Sim::stats().tcpConnectFails;
+    return 0;
+  }
+  fcntl(s, F_SETFL, fcntl(s, F_GETFL) & ~O_NONBLOCK);
+  int one = 1;
+  setsockopt(s, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+  sock_ = std::make_shared<Sock>();
+  sock_->fd = s;
+  sock_->touch(true);  // powitanie serwera (220/+OK) albo odpowiedź na CONNECT
+  ++Sim::stats().tcpConnects;
+  return 1;
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t n) {
+  if (fd() < 0 || n == 0) return 0;
+  size_t done = 0;
+  while (done < n) {
+    ssize_t w = ::send(sock_->fd, buf + done, n - done, MSG_NOSIGNAL);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) {
+      stop();
+      break;
+    }
+    done += (size_t)w;
+  }
+  if (sock_) sock_->touch(true);
+  Sim::stats().tcpBytesOut += done;
+  return done;
+}
+
+int WiFiClient::available() {
+  if (fd() < 0 || sock_->quiet()) return 0;
+  int n = 0;
+  if (ioctl(sock_->fd, FIONREAD, &n) != 0) return 0;
+  if (n == 0 && sock_->waitPeer() && ioctl(sock_->fd, FIONREAD, &n) != 0) return 0;
+  if (n == 0 && sock_->idle) sock_->quietUs = Sim::realUs();
+  return n;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t* buf, size_t n) {
+  if (fd() < 0) return -1;
+  ssize_t r = ::recv(sock_->fd, buf, n, MSG_DONTWAIT);
+  if (r < 0 && sock_->waitPeer()) r = ::recv(sock_->fd, buf, n, MSG_DONTWAIT);
+  if (r <= 0) return -1;
+  sock_->touch(false);
+  Sim::stats().tcpBytesIn += (uint64_t)r;
+  return (int)r;
+}
+
+int WiFiClient::peek() {
+  if (fd() < 0) return -1;
+  uint8_t c;
+  return ::recv(sock_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) == 1 ? c : -1;
+}
+
+void WiFiClient::noReplyExpected() {
+  if (sock_) sock_->idle = true;
+}
+
+void WiFiClient::stop() {
+  if (sock_) sock_->closeFd();
+  sock_.reset();
+}
+
+uint8_t WiFiClient::connected() {
+  if (fd() < 0) return 0;
+  if (sock_->quiet()) return 1;
+  uint8_t c;
+  ssize_t r = ::recv(sock_->fd, &c, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (r > 0) return 1;
+  if (r == 0) return 0;
+  return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 1 : 0;
+}
+
+// ================== WiFi ==================
+
+wl_status_t WiFiClass::begin(const char*, const char*) { return status(); }
+
+wl_status_t WiFiClass::status() { return Sim::networkUp() ? WL_CONNECTED : WL_DISCONNECTED; }
+
+uint8_t* WiFiClass::macAddress(uint8_t* mac) {
+  memcpy(mac, Sim::opts().mac, 6);
+  return mac;
+}
+
+String WiFiClass::macAddress() {
+  const uint8_t* m = Sim::opts().mac;
+  char b[18];
+  snprintf(b, sizeof(b), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+  return String(b);
+}
+
+int32_t WiFiClass::RSSI() { return Sim::networkUp() ? -60 : 0; }
+
+WiFiClass WiFi;
+
+// ================== TinyGsm ==================
+
+bool TinyGsm::waitForNetwork(uint32_t timeoutMs) {
+  uint32_t t0 = millis();
+  while (!Sim::networkUp()) {
+    if (millis() - t0 >= timeoutMs) return false;
+    delay(100);
+  }
+  return true;
+}
+
+bool TinyGsm::isNetworkConnected() { return Sim::networkUp(); }
+
+bool TinyGsm::gprsConnect(const char*, const char*, const char*) {
+  gprs_ = Sim::networkUp();
+  return gprs_;
+}
+
+bool TinyGsm::isGprsConnected() { return gprs_ && Sim::networkUp(); }
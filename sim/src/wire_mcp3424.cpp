@@ -0,0 +1,87 @@
+// wire_mcp3424.cpp – magistrala I2C (tylko zegar/koszt) i model MCP3424.
+#include <MCP3424.h>
+
+#include "sim.h"
+
+bool TwoWire::begin(int, int, uint32_t frequency) {
+  if (frequency) setClock(frequency);
+  return true;
+}
+
+TwoWire Wire;
+
+namespace {
+
+void chargeTransaction(size_t bytes) {
+  ++Sim::stats().i2cTransactions;
+  Sim::spendUs(Wire.transactionUs(bytes));
+}
+
+const double kVref = 2.048;
+
+}  // namespace
+
+MCP3424::MCP3424(uint8_t address) : addr_(address) {
+  for (int i = 0; i < 4; ++i) {
+    creg[i].reg = 0;
+    creg[i].bits = {GAINx1, R12B, ONE_SHOT, (Channel)i, 1};
+  }
+}
+
+uint32_t MCP3424::conversionUs(Resolution r) {
+  switch (r) {
+    case R12B: return 4167;
+    case R14B: return 16667;
+    case R16B: return 66667;
+    default: return 266667;
+  }
+}
+
+ConvStatus MCP3424::startNewConversion(Channel ch) {
+  chargeTransaction(1);
+  if (!Sim::i2cPresent(addr_)) return R_STATUS_I2C;
+  activeReg_ = creg[ch].reg & 0x7F;
+  startUs_ = Sim::nowUs();
+  busy_ = true;
+  ++Sim::stats().adcConversions;
+  return R_STATUS_OK;
+}
+
+ConvStatus MCP3424::read(Channel ch, double& value) {
+  const uint8_t want = creg[ch].reg & 0x7F;
+  if (!busy_ || activeReg_ != want) {
+    ConvStatus st = startNewConversion(ch);
+    return st == R_STATUS_OK ? R_STATUS_NOTRDY : st;
+  }
+
+  const _ConfReg& c = creg[ch];
+  chargeTransaction(c.bits.res == R18B ? 4 : 3);
+  if (!Sim::i2cPresent(addr_)) return R_STATUS_I2C;
+
+  const uint32_t convUs = conversionUs(c.bits.res);
+  if (Sim::nowUs() - startUs_ < convUs) return R_STATUS_NOTRDY;
+
+  // wynik: próbka z końca konwersji, wzmocnienie PGA, nasycenie i kwantyzacja
+  const int bits = 12 + 2 * (int)c.bits.res;
+  const double gain = (double)(1 << (int)c.bits.pga);
+  const double lsb = 2.0 * kVref / (double)(1L << bits);
+  double x = Sim::adcSignal(addr_, (uint8_t)ch, startUs_ + convUs) * gain;
+  if (x > kVref - lsb) x = kVref - lsb;
+  if (x < -kVref) x = -kVref;
+  value = std::floor(x / lsb) * lsb / gain;
+  busy_ = false;
+  return R_STATUS_OK;
+}
+
+Gain MCP3424::findGain(double value) const {
+  const double a = std::fabs(value);
+  if (a < 0.256) return GAINx8;
+  if (a < 0.512) return GAINx4;
+  if (a < 1.024) return GAINx2;
+  return GAINx1;
+}
+
+void MCP3424::generalCall(GeneralCall call) {
+  chargeTransaction(1);
+  if (call == GC_RESET) busy_ = false;
+}
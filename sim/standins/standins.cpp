@@ -0,0 +1,599 @@
+// standins.cpp – serwery zastępcze FTP/SMTP/POP3/MQTT dla esp_sim.
+#include "standins.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <mutex>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <random>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace Standins {
+
+namespace {
+
+Options g_opt;
+Counters g_cnt;
+std::atomic<bool> g_running{false};
+std::vector<int> g_listenFds;
+std::mutex g_rngMu;
+std::mt19937 g_rng(1);                     // profil strat powtarzalny między uruchomieniami
+
+bool drawCut() {
+  if (!g_opt.ftpCutBytes) return false;
+  std::lock_guard<std::mutex> lk(g_rngMu);
+  return g_rng() % 100 < g_opt.ftpCutPct;
+}
+
+const int kIdleTimeoutMs = 300000;
+const int kDataAcceptTimeoutMs = 10000;
+
+int listenOn(const std::string& host, int port) {
+  int s = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (s < 0) return -1;
+  int one = 1;
+  setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  sockaddr_in a{};
+  a.sin_family = AF_INET;
+  a.sin_port = htons((uint16_t)port);
+  inet_pton(AF_INET, host.c_str(), &a.sin_addr);
+  if (::bind(s, (sockaddr*)&a, sizeof(a)) != 0 || ::listen(s, 16) != 0) {
+    ::close(s);
+    return -1;
+  }
+  return s;
+}
+
+int localPort(int fd) {
+  sockaddr_in a{};
+  socklen_t len = sizeof(a);
+  getsockname(fd, (sockaddr*)&a, &len);
+  return ntohs(a.sin_port);
+}
+
+int acceptWithTimeout(int lfd, int timeoutMs) {
+  pollfd p{lfd, POLLIN, 0};
+  if (::poll(&p, 1, timeoutMs) != 1) return -1;
+  return ::accept4(lfd, nullptr, nullptr, SOCK_CLOEXEC);
+}
+
+bool sendAll(int fd, const char* p, size_t n) {
+  while (n) {
+    ssize_t w = ::send(fd, p, n, MSG_NOSIGNAL);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) return false;
+    p += w;
+    n -= (size_t)w;
+  }
+  return true;
+}
+
+// Połączenie tekstowe (linie CRLF) z buforem odczytu.
+class Conn {
+ public:
+  explicit Conn(int fd) : fd_(fd) {
+    int one = 1;
+    setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  ~Conn() { ::close(fd_); }
+
+  bool readLine(std::string& line, int timeoutMs = kIdleTimeoutMs) {
+    for (;;) {
+      size_t nl = buf_.find('\n');
+      if (nl != std::string::npos) {
+        line = buf_.substr(0, nl);
+        buf_.erase(0, nl + 1);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        return true;
+      }
+      if (!fill(timeoutMs)) return false;
+    }
+  }
+
+  bool readBytes(uint8_t* out, size_t n, int timeoutMs = kIdleTimeoutMs) {
+    while (buf_.size() < n)
+      if (!fill(timeoutMs)) return false;
+    memcpy(out, buf_.data(), n);
+    buf_.erase(0, n);
+    return true;
+  }
+
+  void reply(const std::string& s) {
+    if (g_opt.rttMs) std::this_thread::sleep_for(std::chrono::milliseconds(g_opt.rttMs));
+    std::string out = s + "\r\n";
+    sendAll(fd_, out.data(), out.size());
+  }
+
+  void raw(const void* p, size_t n) { sendAll(fd_, (const char*)p, n); }
+
+ private:
+  bool fill(int timeoutMs) {
+    if (!g_running) return false;
+    pollfd p{fd_, POLLIN, 0};
+    if (::poll(&p, 1, timeoutMs) != 1) return false;
+    char tmp[4096];
+    ssize_t r = ::recv(fd_, tmp, sizeof(tmp), 0);
+    if (r <= 0) return false;
+    buf_.append(tmp, (size_t)r);
+    return true;
+  }
+
+  int fd_;
+  std::string buf_;
+};
+
+void acceptLoop(int lfd, void (*handler)(int)) {
+  while (g_running) {
+    int fd = acceptWithTimeout(lfd, 200);
+    if (fd < 0) continue;
+    std::thread(handler, fd).detach();
+  }
+}
+
+std::string upper(std::string s) {
+  for (auto& c : s) c = (char)toupper((unsigned char)c);
+  return s;
+}
+
+// ================== FTP ==================
+
+class FtpSession {
+ public:
+  explicit FtpSession(int fd) : c_(fd) {}
+  ~FtpSession() { closePasv(); }
+
+  void run() {
+    ++g_cnt.ftpSessions;
+    c_.reply("220 esp_sim FTP stand-in ready");
+    std::string line;
+    while (c_.readLine(line)) {
+      ++g_cnt.ftpCommands;
+      size_t sp = line.find(' ');
+      std::string cmd = upper(line.substr(0, sp));
+      std::string arg = sp == std::string::npos ? "" : line.substr(sp + 1);
+      if (!handle(cmd, arg)) break;
+    }
+  }
+
+ private:
+  std::string normalize(const std::string& arg) const {
+    std::string p = arg.empty() ? cwd_ : (arg[0] == '/' ? arg : cwd_ + "/" + arg);
+    std::vector<std::string> parts;
+    size_t i = 0;
+    while (i <= p.size()) {
+      size_t j = p.find('/', i);
+      if (j == std::string::npos) j = p.size();
+      std::string seg = p.substr(i, j - i);
+      if (seg == "..") {
+        if (!parts.empty()) parts.pop_back();
+      } else if (!seg.empty() && seg != ".") {
+        parts.push_back(seg);
+      }
+      i = j + 1;
+    }
+    std::string out;
+    for (auto& s : parts) out += "/" + s;
+    return out.empty() ? "/" : out;
+  }
+
+  std::string host(const std::string& vpath) const { return g_opt.ftpRoot + (vpath == "/" ? "" : vpath); }
+
+  static bool statPath(const std::string& hp, struct stat& st) { return ::stat(hp.c_str(), &st) == 0; }
+
+  void closePasv() {
+    if (pasvFd_ >= 0) ::close(pasvFd_);
+    pasvFd_ = -1;
+  }
+
+  bool openPasv() {
+    closePasv();
+    pasvFd_ = listenOn(g_opt.bindHost, 0);
+    return pasvFd_ >= 0;
+  }
+
+  int acceptData() {
+    if (pasvFd_ < 0) return -1;
+    int fd = acceptWithTimeout(pasvFd_, kDataAcceptTimeoutMs);
+    closePasv();
+    if (fd >= 0) ++g_cnt.ftpDataConns;
+    return fd;
+  }
+
+  static std::string mtime(time_t t) {
+    char b[20];
+    struct tm tmv;
+    gmtime_r(&t, &tmv);
+    strftime(b, sizeof(b), "%Y%m%d%H%M%S", &tmv);
+    return b;
+  }
+
+  std::vector<std::string> listDir(const std::string& hp) const {
+    std::vector<std::string> names;
+    if (DIR* d = opendir(hp.c_str())) {
+      while (dirent* e = readdir(d))
+        if (strcmp(e->d_name, ".") && strcmp(e->d_name, "..")) names.push_back(e->d_name);
+      closedir(d);
+    }
+    return names;
+  }
+
+  std::string facts(const std::string& hp, const std::string& name) const {
+    struct stat st;
+    if (!statPath(hp, st)) return "";
+    std::string f = S_ISDIR(st.st_mode) ? "type=dir;" : "type=file;size=" + std::to_string((long long)st.st_size) + ";";
+    return f + "modify=" + mtime(st.st_mtime) + "; " + name;
+  }
+
+  void sendListing(const std::string& cmd, const std::string& arg) {
+    std::string a = arg;
+    if (!a.empty() && a[0] == '-') a.clear();  // "LIST -la"
+    std::string vp = normalize(a), hp = host(vp);
+    struct stat st;
+    if (!statPath(hp, st)) {
+      c_.reply("550 No such file or directory");
+      return;
+    }
+    std::string out;
+    std::vector<std::string> names;
+    if (S_ISDIR(st.st_mode)) names = listDir(hp);
+    else names.push_back(vp.substr(vp.rfind('/') + 1));
+    const std::string dirHp = S_ISDIR(st.st_mode) ? hp : hp.substr(0, hp.rfind('/'));
+    for (auto& n : names) {
+      const std::string p = dirHp + "/" + n;
+      if (cmd == "NLST") {
+        out += n + "\r\n";
+      } else if (cmd == "MLSD") {
+        out += facts(p, n) + "\r\n";
+      } else {
+        struct stat es;
+        if (!statPath(p, es)) continue;
+        char line[512];
+        snprintf(line, sizeof(line), "%s 1 esp esp %12lld Jan  1 00:00 %s\r\n",
+                 S_ISDIR(es.st_mode) ? "drwxr-xr-x" : "-rw-r--r--", (long long)es.st_size, n.c_str());
+        out += line;
+      }
+    }
+    c_.reply("150 Opening data connection");
+    int dfd = acceptData();
+    if (dfd < 0) {
+      c_.reply("425 Can't open data connection");
+      return;
+    }
+    sendAll(dfd, out.data(), out.size());
+    g_cnt.ftpBytesSent += out.size();
+    ::close(dfd);
+    c_.reply("226 Transfer complete");
+  }
+
+  void store(const std::string& arg, bool append) {
+    std::string hp = host(normalize(arg));
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC;
+    if (append) flags |= O_APPEND;
+    else if (rest_ == 0) flags |= O_TRUNC;
+    int f = ::open(hp.c_str(), flags, 0644);
+    if (f < 0) {
+      c_.reply("553 Could not create file");
+      rest_ = 0;
+      return;
+    }
+    if (!append && rest_) {
+      if (ftruncate(f, (off_t)rest_) != 0 || lseek(f, (off_t)rest_, SEEK_SET) < 0) {
+        ::close(f);
+        c_.reply("554 Invalid REST offset");
+        rest_ = 0;
+        return;
+      }
+    }
+    rest_ = 0;
+    c_.reply("150 Ok to send data");
+    int dfd = acceptData();
+    if (dfd < 0) {
+      ::close(f);
+      c_.reply("425 Can't open data connection");
+      return;
+    }
+    char buf[8192];
+    uint64_t total = 0;
+    const uint64_t cutAt = drawCut() ? g_opt.ftpCutBytes : UINT64_MAX;
+    bool cut = false;
+    for (;;) {
+      pollfd p{dfd, POLLIN, 0};
+      if (::poll(&p, 1, kIdleTimeoutMs) != 1) break;
+      ssize_t r = ::recv(dfd, buf, sizeof(buf), 0);
+      if (r <= 0) break;
+      if (total + (uint64_t)r >= cutAt) {   // zapis do progu, reszta przepada (jak po zerwaniu)
+        r = (ssize_t)(cutAt - total);
+        cut = true;
+      }
+      if (::write(f, buf, (size_t)r) != r) break;
+      total += (uint64_t)r;
+      if (cut) break;
+    }
+    g_cnt.ftpBytesStored += total;
+    ::close(dfd);                            // nieodczytane dane: RST do klienta
+    ::close(f);
+    if (cut) {
+      ++g_cnt.ftpDataCuts;
+      c_.reply("426 Connection closed; transfer aborted");
+      return;
+    }
+    ++g_cnt.ftpFilesStored;
+    c_.reply("226 Transfer complete");
+  }
+
+  void retrieve(const std::string& arg) {
+    std::string hp = host(normalize(arg));
+    int f = ::open(hp.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (f < 0 || fstat(f, &st) != 0 || !S_ISREG(st.st_mode)) {
+      if (f >= 0) ::close(f);
+      c_.reply("550 No such file");
+      rest_ = 0;
+      return;
+    }
+    if (rest_) lseek(f, (off_t)rest_, SEEK_SET);
+    rest_ = 0;
+    c_.reply("150 Opening BINARY mode data connection (" + std::to_string((long long)st.st_size) + " bytes)");
+    int dfd = acceptData();
+    if (dfd < 0) {
+      ::close(f);
+      c_.reply("425 Can't open data connection");
+      return;
+    }
+    char buf[8192];
+    ssize_t r;
+    while ((r = ::read(f, buf, sizeof(buf))) > 0) {
+      if (!sendAll(dfd, buf, (size_t)r)) break;
+      g_cnt.ftpBytesSent += (uint64_t)r;
+    }
+    ::close(dfd);
+    ::close(f);
+    c_.reply("226 Transfer complete");
+  }
+
+  bool handle(const std::string& cmd, const std::string& arg) {
+    struct stat st;
+    if (cmd == "USER") c_.reply("331 Password required");
+    else if (cmd == "PASS") c_.reply("230 Logged in");
+    else if (cmd == "SYST") c_.reply("215 UNIX Type: L8");
+    else if (cmd == "FEAT") {
+      c_.reply("211-Features:\r\n EPSV\r\n PASV\r\n SIZE\r\n MDTM\r\n MLST type*;size*;modify*;\r\n REST STREAM\r\n UTF8\r\n211 End");
+    } else if (cmd == "OPTS" || cmd == "TYPE" || cmd == "MODE" || cmd == "STRU") c_.reply("200 OK");
+    else if (cmd == "NOOP") c_.reply("200 NOOP ok");
+    else if (cmd == "PWD" || cmd == "XPWD") c_.reply("257 \"" + cwd_ + "\" is the current directory");
+    else if (cmd == "CWD" || cmd == "CDUP") {
+      std::string vp = normalize(cmd == "CDUP" ? ".." : arg);
+      if (statPath(host(vp), st) && S_ISDIR(st.st_mode)) {
+        cwd_ = vp;
+        c_.reply("250 Directory successfully changed");
+      } else {
+        c_.reply("550 Failed to change directory");
+      }
+    } else if (cmd == "EPSV") {
+      if (openPasv()) c_.reply("229 Entering Extended Passive Mode (|||" + std::to_string(localPort(pasvFd_)) + "|)");
+      else c_.reply("425 Cannot open passive connection");
+    } else if (cmd == "PASV") {
+      if (openPasv()) {
+        int p = localPort(pasvFd_);
+        c_.reply("227 Entering Passive Mode (127,0,0,1," + std::to_string(p / 256) + "," + std::to_string(p % 256) + ")");
+      } else {
+        c_.reply("425 Cannot open passive connection");
+      }
+    } else if (cmd == "REST") {
+      rest_ = strtoull(arg.c_str(), nullptr, 10);
+      c_.reply("350 Restart position accepted (" + std::to_string(rest_) + ")");
+    } else if (cmd == "STOR") store(arg, false);
+    else if (cmd == "APPE") store(arg, true);
+    else if (cmd == "RETR") retrieve(arg);
+    else if (cmd == "NLST" || cmd == "LIST" || cmd == "MLSD") sendListing(cmd, arg);
+    else if (cmd == "SIZE") {
+      if (statPath(host(normalize(arg)), st) && S_ISREG(st.st_mode)) c_.reply("213 " + std::to_string((long long)st.st_size));
+      else c_.reply("550 Could not get file size");
+    } else if (cmd == "MDTM") {
+      if (statPath(host(normalize(arg)), st) && S_ISREG(st.st_mode)) c_.reply("213 " + mtime(st.st_mtime));
+      else c_.reply("550 Could not get file modification time");
+    } else if (cmd == "MLST") {
+      std::string vp = normalize(arg);
+      std::string f = facts(host(vp), vp);
+      if (f.empty()) c_.reply("550 No such file or directory");
+      else c_.reply("250-Listing " + vp + "\r\n " + f + "\r\n250 End");
+    } else if (cmd == "RNFR") {
+      rnfr_ = normalize(arg);
+      if (statPath(host(rnfr_), st)) c_.reply("350 Ready for RNTO");
+      else {
+        rnfr_.clear();
+        c_.reply("550 RNFR command failed");
+      }
+    } else if (cmd == "RNTO") {
+      if (!rnfr_.empty() && ::rename(host(rnfr_).c_str(), host(normalize(arg)).c_str()) == 0) c_.reply("250 Rename successful");
+      else c_.reply("550 Rename failed");
+      rnfr_.clear();
+    } else if (cmd == "DELE") {
+      if (::unlink(host(normalize(arg)).c_str()) == 0) c_.reply("250 Delete operation successful");
+      else c_.reply("550 Delete operation failed");
+    } else if (cmd == "MKD" || cmd == "XMKD") {
+      std::string vp = normalize(arg);
+      if (::mkdir(host(vp).c_str(), 0755) == 0) c_.reply("257 \"" + vp + "\" created");
+      else c_.reply("550 Create directory operation failed");
+    } else if (cmd == "RMD" || cmd == "XRMD") {
+      if (::rmdir(host(normalize(arg)).c_str()) == 0) c_.reply("250 Remove directory operation successful");
+      else c_.reply("550 Remove directory operation failed");
+    } else if (cmd == "ABOR") {
+      closePasv();
+      c_.reply("225 No transfer to ABOR");
+    } else if (cmd == "QUIT") {
+      c_.reply("221 Goodbye");
+      return false;
+    } else {
+      c_.reply("502 Command not implemented");
+    }
+    return true;
+  }
+
+  Conn c_;
+  std::string cwd_ = "/";
+  std::string rnfr_;
+  uint64_t rest_ = 0;
+  int pasvFd_ = -1;
+};
+
+void ftpHandler(int fd) {
+  FtpSession s(fd);
+  s.run();
+}
+
+// ================== SMTP ==================
+
+void smtpHandler(int fd) {
+  Conn c(fd);
+  c.reply("220 esp_sim SMTP stand-in");
+  std::string line;
+  while (c.readLine(line)) {
+    std::string cmd = upper(line.substr(0, line.find(' ')));
+    if (cmd == "EHLO") {
+      c.reply("250-esp_sim\r\n250-AUTH LOGIN PLAIN\r\n250 8BITMIME");
+    } else if (cmd == "HELO") {
+      c.reply("250 esp_sim");
+    } else if (cmd == "AUTH") {
+      std::string mech = upper(line.size() > 5 ? line.substr(5) : "");
+      if (mech.rfind("LOGIN", 0) == 0) {
+        c.reply("334 VXNlcm5hbWU6");
+        if (!c.readLine(line)) break;
+        c.reply("334 UGFzc3dvcmQ6");
+        if (!c.readLine(line)) break;
+      }
+      c.reply("235 Authentication successful");
+    } else if (cmd == "MAIL" || cmd == "RCPT" || cmd == "RSET" || cmd == "NOOP") {
+      c.reply("250 OK");
+    } else if (cmd == "DATA") {
+      c.reply("354 End data with <CR><LF>.<CR><LF>");
+      while (c.readLine(line) && line != ".") {
+      }
+      ++g_cnt.smtpMessages;
+      c.reply("250 OK queued");
+    } else if (cmd == "QUIT") {
+      c.reply("221 Bye");
+      break;
+    } else {
+      c.reply("502 Command not implemented");
+    }
+  }
+}
+
+// ================== POP3 ==================
+
+void pop3Handler(int fd) {
+  Conn c(fd);
+  ++g_cnt.pop3Sessions;
+  c.reply("+OK esp_sim POP3 stand-in");
+  std::string line;
+  while (c.readLine(line)) {
+    std::string cmd = upper(line.substr(0, line.find(' ')));
+    if (cmd == "USER" || cmd == "PASS" || cmd == "NOOP" || cmd == "RSET") c.reply("+OK");
+    else if (cmd == "STAT") c.reply("+OK 0 0");
+    else if (cmd == "LIST" || cmd == "UIDL") c.reply("+OK 0 messages\r\n.");
+    else if (cmd == "QUIT") {
+      c.reply("+OK Bye");
+      break;
+    } else c.reply("-ERR no such message");
+  }
+}
+
+// ================== MQTT ==================
+
+void mqttHandler(int fd) {
+  Conn c(fd);
+  for (;;) {
+    uint8_t hdr;
+    if (!c.readBytes(&hdr, 1)) break;
+    size_t len = 0, mul = 1;
+    uint8_t d;
+    do {
+      if (!c.readBytes(&d, 1)) return;
+      len += (d & 0x7F) * mul;
+      mul *= 128;
+    } while (d & 0x80);
+    std::vector<uint8_t> body(len);
+    if (len && !c.readBytes(body.data(), len)) break;
+    switch (hdr >> 4) {
+      case 1: {  // CONNECT
+        ++g_cnt.mqttConnects;
+        const uint8_t ack[4] = {0x20, 0x02, 0x00, 0x00};
+        c.raw(ack, sizeof(ack));
+        break;
+      }
+      case 3:  // PUBLISH (QoS0)
+        ++g_cnt.mqttPublishes;
+        break;
+      case 12: {  // PINGREQ
+        const uint8_t resp[2] = {0xD0, 0x00};
+        c.raw(resp, sizeof(resp));
+        break;
+      }
+      case 14:  // DISCONNECT
+        return;
+      default:
+        break;
+    }
+  }
+}
+
+bool serve(int port, void (*handler)(int), const char* name) {
+  if (port <= 0) return true;
+  int fd = listenOn(g_opt.bindHost, port);
+  if (fd < 0) {
+    fprintf(stderr, "[standins] %s: port %d niedostępny (%s)\n", name, port, strerror(errno));
+    return false;
+  }
+  g_listenFds.push_back(fd);
+  std::thread(acceptLoop, fd, handler).detach();
+  return true;
+}
+
+}  // namespace
+
+bool start(const Options& o) {
+  g_opt = o;
+  ::mkdir(g_opt.ftpRoot.c_str(), 0755);
+  g_running = true;
+  bool ok = serve(o.ftpPort, ftpHandler, "FTP");
+  ok = serve(o.smtpPort, smtpHandler, "SMTP") && ok;
+  ok = serve(o.pop3Port, pop3Handler, "POP3") && ok;
+  ok = serve(o.mqttPort, mqttHandler, "MQTT") && ok;
+  return ok;
+}
+
+void stop() {
+  g_running = false;
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  for (int fd : g_listenFds) ::close(fd);
+  g_listenFds.clear();
+}
+
+Counters& counters() { return g_cnt; }
+
+void printCounters(FILE* out) {
+  const Counters& c = g_cnt;
+  fprintf(out,
+          "[standins] ftp: sessions=%llu commands=%llu data=%llu stored=%llu files / %llu B sent=%llu B cuts=%llu\n"
+          "[standins] smtp: messages=%llu pop3: sessions=%llu mqtt: connects=%llu publishes=%llu\n",
+          (unsigned long long)c.ftpSessions, (unsigned long long)c.ftpCommands,
+          (unsigned long long)c.ftpDataConns, (unsigned long long)c.ftpFilesStored,
+          (unsigned long long)c.ftpBytesStored, (unsigned long long)c.ftpBytesSent,
+          (unsigned long long)c.ftpDataCuts,
+          (unsigned long long)c.smtpMessages, (unsigned long long)c.pop3Sessions,
+          (unsigned long long)c.mqttConnects, (unsigned long long)c.mqttPublishes);
+}
+
+}  // namespace Standins
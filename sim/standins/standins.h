@@ -0,0 +1,44 @@
+// standins.h – lokalne serwery zastępcze dla esp_sim: FTP (na katalogu hosta),
+// SMTP (akceptuje wszystko), POP3 (pusta skrzynka) i broker MQTT (CONNACK/PINGRESP).
+// Każde połączenie obsługuje osobny wątek; liczniki do porównań wydajności.
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace Standins {
+
+struct Options {
+  std::string bindHost = "127.0.0.1";
+  int ftpPort = 2121;
+  int smtpPort = 2122;
+  int pop3Port = 2123;
+  int mqttPort = 2124;
+  std::string ftpRoot = "esp_sim_ftp";  // katalog główny serwera FTP
+  uint32_t rttMs = 0;                   // opóźnienie każdej odpowiedzi (symulacja łącza GSM)
+  uint32_t ftpCutBytes = 0;             // STOR/APPE: zerwanie DATA po tylu bajtach (0 = bez strat)
+  uint32_t ftpCutPct = 100;             // odsetek przesyłów, które są zrywane
+};
+
+struct Counters {
+  std::atomic<uint64_t> ftpSessions{0};
+  std::atomic<uint64_t> ftpCommands{0};
+  std::atomic<uint64_t> ftpDataConns{0};
+  std::atomic<uint64_t> ftpFilesStored{0};
+  std::atomic<uint64_t> ftpBytesStored{0};   // zapisane bajty (także z przesyłów zerwanych)
+  std::atomic<uint64_t> ftpDataCuts{0};
+  std::atomic<uint64_t> ftpBytesSent{0};
+  std::atomic<uint64_t> smtpMessages{0};
+  std::atomic<uint64_t> pop3Sessions{0};
+  std::atomic<uint64_t> mqttConnects{0};
+  std::atomic<uint64_t> mqttPublishes{0};
+};
+
+// Uruchamia serwery (wątki w tle). Port 0 = usługa wyłączona.
+bool start(const Options& o);
+void stop();
+Counters& counters();
+void printCounters(FILE* out);
+
+}  // namespace Standins
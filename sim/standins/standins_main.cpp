@@ -0,0 +1,57 @@
+// esp_sim_standins – serwery zastępcze jako osobny proces (np. dla płytki w LAN
+// albo drugiej instancji esp_sim).
+//   esp_sim_standins [--base-port 2121] [--bind 0.0.0.0] [--ftp-root dir] [--rtt-ms N]
+//                    [--ftp-cut N] [--ftp-cut-pct P]
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "standins.h"
+
+static volatile std::sig_atomic_t g_stop = 0;
+
+int main(int argc, char** argv) {
+  Standins::Options o;
+  for (int i = 1; i < argc; ++i) {
+    auto next = [&](const char* name) -> const char* {
+      if (i + 1 >= argc) {
+        fprintf(stderr, "brak wartości dla %s\n", name);
+        exit(2);
+      }
+      return argv[++i];
+    };
+    if (!strcmp(argv[i], "--base-port")) {
+      int base = atoi(next("--base-port"));
+      o.ftpPort = base;
+      o.smtpPort = base + 1;
+      o.pop3Port = base + 2;
+      o.mqttPort = base + 3;
+    } else if (!strcmp(argv[i], "--bind")) {
+      o.bindHost = next("--bind");
+    } else if (!strcmp(argv[i], "--ftp-root")) {
+      o.ftpRoot = next("--ftp-root");
+    } else if (!strcmp(argv[i], "--rtt-ms")) {
+      o.rttMs = (uint32_t)atoi(next("--rtt-ms"));
+    } else if (!strcmp(argv[i], "--ftp-cut")) {
+      o.ftpCutBytes = (uint32_t)strtoul(next("--ftp-cut"), nullptr, 0);
+    } else if (!strcmp(argv[i], "--ftp-cut-pct")) {
+      o.ftpCutPct = (uint32_t)atoi(next("--ftp-cut-pct"));
+    } else {
+      fprintf(stderr, "usage: %s [--base-port P] [--bind ADDR] [--ftp-root DIR] [--rtt-ms N] [--ftp-cut N] [--ftp-cut-pct P]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (!Standins::start(o)) return 1;
+  printf("[standins] FTP=%d SMTP=%d POP3=%d MQTT=%d root=%s\n", o.ftpPort, o.smtpPort, o.pop3Port,
+         o.mqttPort, o.ftpRoot.c_str());
+  fflush(stdout);
+
+  std::signal(SIGINT, [](int) { g_stop = 1; });
+  std::signal(SIGTERM, [](int) { g_stop = 1; });
+  while (!g_stop) std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  Standins::stop();
+  Standins::printCounters(stdout);
+  return 0;
+}
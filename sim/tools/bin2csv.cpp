@@ -0,0 +1,41 @@
+// bin2csv.cpp – konwersja D_<MAC>.bin (BinSeries, tryb data_bin) na linie
+// CSV jak w D_<MAC>.txt, razem z CRC16 – po stronie serwera albo do wglądu.
+// Ramki z błędnym CRC są pomijane (do najbliższej ramki KEY), statystyka na
+// stderr; kod wyjścia 1, gdy coś pominięto.
+//
+// esp_sim_bin2csv plik.bin [plik.csv]      (bez plik.csv: stdout)
+#include <Arduino.h>
+
+#include <cstdio>
+#include <cstring>
+
+#include "bin_series.h"
+
+static void emitLine(void* ctx, const char* line, size_t n) {
+  std::fwrite(line, 1, n, (FILE*)ctx);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2 || argc > 3 || !strcmp(argv[1], "--help")) {
+    std::fprintf(stderr, "usage: %s file.bin [out.csv]\n", argv[0]);
+    return 2;
+  }
+  FILE* in = std::fopen(argv[1], "rb");
+  if (!in) { std::perror(argv[1]); return 2; }
+  FILE* out = argc == 3 ? std::fopen(argv[2], "wb") : stdout;
+  if (!out) { std::perror(argv[2]); std::fclose(in); return 2; }
+
+  static BinSeries::Decoder dec(emitLine, out);
+  uint8_t buf[4096];
+  size_t n;
+  while ((n = std::fread(buf, 1, sizeof(buf), in)) > 0) dec.feed(buf, n);
+  dec.finish();
+  std::fclose(in);
+  if (out != stdout) std::fclose(out);
+
+  const BinSeries::Decoder::Stats& st = dec.stats();
+  std::fprintf(stderr, "frames=%lu lines=%lu bad=%lu dropped=%lu skipped=%luB\n",
+               (unsigned long)st.frames, (unsigned long)st.lines, (unsigned long)st.badFrames,
+               (unsigned long)st.dropped, (unsigned long)st.skipped);
+  return (st.badFrames || st.dropped || st.skipped) ? 1 : 0;
+}